@@ -18,6 +18,8 @@
 #include "data.h"
 #include "interest.h"
 #include "signed-interest.h"
+#include "../util/hash.h"
+#include "../ndn-enums.h"
 
 size_t
 tlv_get_tlvar(uint8_t* buf, size_t buflen, uint32_t* var){
@@ -90,20 +92,20 @@ tlv_get_uint(uint8_t* buf, size_t buflen)
 {
   uint64_t ret = 0;
   while(buflen --){
-    ret = (ret << (uint64_t)8) + buf[0];
+    ret = (ret << (uint64_t)8) + *buf++;
   }
   return ret;
 }
 
 int
-tlv_interest_get_header(uint8_t* interest,
-                        size_t buflen,
-                        interest_options_t* options,
-                        uint8_t** name,
-                        size_t* name_len)
+tlv_interest_get_header_parsed(uint8_t* interest,
+                               size_t buflen,
+                               interest_options_t* options,
+                               ndn_parsed_name_t* name)
 {
   uint32_t real_type, real_len;
   uint8_t* ptr;
+  int ret;
 
   ptr = tlv_get_type_length(interest, buflen, &real_type, &real_len);
   if (ptr == NULL) {
@@ -117,16 +119,14 @@ tlv_interest_get_header(uint8_t* interest,
   }
 
   // Name
-  *name = ptr;
-  ptr = tlv_get_type_length(ptr, buflen - (ptr - interest), &real_type, &real_len);
-  if(ptr == NULL){
-    return NDN_OVERSIZE_VAR;
-  }
-  if(real_type != TLV_Name){
+  ret = tlv_name_parse(ptr, buflen - (ptr - interest), name);
+  if(ret == NDN_WRONG_TLV_TYPE){
     return NDN_UNSUPPORTED_FORMAT;
   }
-  *name_len = real_len;
-  ptr += real_len;
+  if(ret != NDN_SUCCESS){
+    return ret;
+  }
+  ptr += name->name_len;
 
   // Options
   if(options == NULL){
@@ -162,15 +162,74 @@ tlv_interest_get_header(uint8_t* interest,
   return NDN_SUCCESS;
 }
 
+int
+tlv_interest_get_header(uint8_t* interest,
+                        size_t buflen,
+                        interest_options_t* options,
+                        uint8_t** name,
+                        size_t* name_len)
+{
+  ndn_parsed_name_t parsed;
+  int ret = tlv_interest_get_header_parsed(interest, buflen, options, &parsed);
+  if(ret == NDN_SUCCESS){
+    *name = parsed.name;
+    *name_len = parsed.name_len;
+  }
+  return ret;
+}
+
+int
+tlv_data_get_name_parsed(uint8_t* data,
+                         size_t buflen,
+                         ndn_parsed_name_t* name)
+{
+  uint32_t real_type, real_len;
+  uint8_t* ptr;
+  int ret;
+
+  ptr = tlv_get_type_length(data, buflen, &real_type, &real_len);
+  if(ptr == NULL){
+    return NDN_OVERSIZE_VAR;
+  }
+  if(real_type != TLV_Data){
+    return NDN_WRONG_TLV_TYPE;
+  }
+  if(real_len != buflen - (ptr - data)){
+    return NDN_WRONG_TLV_LENGTH;
+  }
+
+  // Name
+  ret = tlv_name_parse(ptr, buflen - (ptr - data), name);
+  if(ret == NDN_WRONG_TLV_TYPE){
+    return NDN_UNSUPPORTED_FORMAT;
+  }
+  return ret;
+}
+
 int
 tlv_data_get_name(uint8_t* data,
                   size_t buflen,
                   uint8_t** name,
                   size_t* name_len)
+{
+  ndn_parsed_name_t parsed;
+  int ret = tlv_data_get_name_parsed(data, buflen, &parsed);
+  if(ret == NDN_SUCCESS){
+    *name = parsed.name;
+    *name_len = parsed.name_len;
+  }
+  return ret;
+}
+
+int
+tlv_data_get_freshness_period(uint8_t* data,
+                              size_t buflen,
+                              uint64_t* freshness_period)
 {
   uint32_t real_type, real_len;
-  uint8_t* ptr;
+  uint8_t *ptr, *end, *meta_end;
 
+  *freshness_period = 0;
   ptr = tlv_get_type_length(data, buflen, &real_type, &real_len);
   if(ptr == NULL){
     return NDN_OVERSIZE_VAR;
@@ -178,21 +237,132 @@ tlv_data_get_name(uint8_t* data,
   if(real_type != TLV_Data){
     return NDN_WRONG_TLV_TYPE;
   }
-  if(real_len != buflen - (ptr - data)){
+  end = ptr + real_len;
+  if(end > data + buflen){
     return NDN_WRONG_TLV_LENGTH;
   }
 
-  // Name
-  *name = ptr;
-  ptr = tlv_get_type_length(ptr, buflen - (ptr - data), &real_type, &real_len);
+  // Skip Name
+  ptr = tlv_get_type_length(ptr, end - ptr, &real_type, &real_len);
+  if(ptr == NULL || ptr + real_len > end){
+    return NDN_OVERSIZE_VAR;
+  }
+  ptr += real_len;
+  if(ptr >= end){
+    return NDN_SUCCESS;
+  }
+
+  // MetaInfo is optional
+  ptr = tlv_get_type_length(ptr, end - ptr, &real_type, &real_len);
+  if(ptr == NULL || ptr + real_len > end){
+    return NDN_OVERSIZE_VAR;
+  }
+  if(real_type != TLV_MetaInfo){
+    return NDN_SUCCESS;
+  }
+  meta_end = ptr + real_len;
+  while(ptr < meta_end){
+    ptr = tlv_get_type_length(ptr, meta_end - ptr, &real_type, &real_len);
+    if(ptr == NULL || ptr + real_len > meta_end){
+      return NDN_OVERSIZE_VAR;
+    }
+    if(real_type == TLV_FreshnessPeriod){
+      *freshness_period = tlv_get_uint(ptr, real_len);
+      break;
+    }
+    ptr += real_len;
+  }
+  return NDN_SUCCESS;
+}
+
+int
+tlv_name_get_prefix_hashes(uint8_t* name,
+                           size_t name_len,
+                           uint32_t* hashes,
+                           size_t* offsets,
+                           size_t max_count)
+{
+  uint32_t real_type, real_len;
+  uint8_t *ptr, *end, *comp;
+  size_t count = 0;
+
+  ptr = tlv_get_type_length(name, name_len, &real_type, &real_len);
   if(ptr == NULL){
     return NDN_OVERSIZE_VAR;
   }
   if(real_type != TLV_Name){
-    return NDN_UNSUPPORTED_FORMAT;
+    return NDN_WRONG_TLV_TYPE;
+  }
+  end = ptr + real_len;
+  if(end > name + name_len){
+    return NDN_WRONG_TLV_LENGTH;
+  }
+
+  hashes[0] = NDN_HASH_INIT;
+  if(offsets != NULL){
+    offsets[0] = ptr - name;
+  }
+  while(ptr < end){
+    if(count + 1 >= max_count){
+      return NDN_OVERSIZE;
+    }
+    comp = ptr;
+    ptr = tlv_get_type_length(ptr, end - ptr, &real_type, &real_len);
+    if(ptr == NULL || ptr + real_len > end){
+      return NDN_WRONG_TLV_LENGTH;
+    }
+    ptr += real_len;
+    hashes[count + 1] = ndn_hash_update(hashes[count], comp, ptr - comp);
+    count ++;
+    if(offsets != NULL){
+      offsets[count] = ptr - name;
+    }
   }
-  *name_len = real_len;
+  return (int)count;
+}
+
+int
+tlv_name_parse(uint8_t* name, size_t name_len, ndn_parsed_name_t* parsed)
+{
+  uint32_t real_type, real_len;
+  uint8_t *ptr, *end, *comp;
+  uint32_t hash = NDN_HASH_INIT;
 
+  ptr = tlv_get_type_length(name, name_len, &real_type, &real_len);
+  if(ptr == NULL){
+    return NDN_OVERSIZE_VAR;
+  }
+  if(real_type != TLV_Name){
+    return NDN_WRONG_TLV_TYPE;
+  }
+  end = ptr + real_len;
+  if(real_len > name_len - (ptr - name)){
+    return NDN_WRONG_TLV_LENGTH;
+  }
+
+  parsed->name = name;
+  parsed->name_len = end - name;
+  parsed->comps = ptr;
+  parsed->comp_len = real_len;
+  parsed->count = 0;
+  parsed->hashes[0] = hash;
+  parsed->lens[0] = 0;
+  while(ptr < end){
+    comp = ptr;
+    ptr = tlv_get_type_length(ptr, end - ptr, &real_type, &real_len);
+    if(ptr == NULL || real_len > (size_t)(end - ptr)){
+      return NDN_WRONG_TLV_LENGTH;
+    }
+    ptr += real_len;
+    hash = ndn_hash_update(hash, comp, ptr - comp);
+    parsed->count ++;
+    // Longer names are still hashed as a whole
+    if(parsed->count <= NDN_FWD_NAME_MAX_COMPONENTS){
+      parsed->hashes[parsed->count] = hash;
+      parsed->lens[parsed->count] = ptr - parsed->comps;
+    }
+  }
+  parsed->hash = hash;
   return NDN_SUCCESS;
 }
 
@@ -217,3 +387,227 @@ tlv_interest_get_hoplimit_ptr(uint8_t* interest, size_t buflen){
   }
   return NULL;
 }
+
+uint8_t*
+tlv_interest_get_nonce_ptr(uint8_t* interest, size_t buflen){
+  uint32_t real_type, real_len;
+  uint8_t* ptr;
+
+  ptr = tlv_get_type_length(interest, buflen, &real_type, &real_len);
+  if(ptr == NULL){
+    return NULL;
+  }
+  while(ptr < interest + buflen){
+    ptr = tlv_get_type_length(ptr, buflen - (ptr - interest), &real_type, &real_len);
+    if(ptr == NULL){
+      return NULL;
+    }
+    if(real_type == TLV_Nonce && real_len == sizeof(uint32_t)){
+      return ptr;
+    }
+    ptr += real_len;
+  }
+  return NULL;
+}
+
+/** Copy the elements of an Interest which a Nack needs to match it,
+ * dropping ForwardingHint, ApplicationParameters and the signature.
+ * @param[in, out] encoder Where to copy them. @c NULL to only count their size.
+ * @return The size of the elements kept. 0 if @c interest is malformed.
+ */
+static uint32_t
+tlv_nack_reduce_interest(const uint8_t* interest, size_t interest_len, ndn_encoder_t* encoder)
+{
+  uint32_t real_type, real_len, ret = 0;
+  uint8_t *ptr, *element;
+
+  ptr = tlv_get_type_length((uint8_t*)interest, interest_len, &real_type, &real_len);
+  if(ptr == NULL || real_type != TLV_Interest){
+    return 0;
+  }
+  while(ptr < interest + interest_len){
+    element = ptr;
+    ptr = tlv_get_type_length(ptr, interest_len - (ptr - interest), &real_type, &real_len);
+    if(ptr == NULL || real_len > interest_len - (ptr - interest)){
+      return 0;
+    }
+    ptr += real_len;
+    if(real_type == TLV_Name || real_type == TLV_CanBePrefix || real_type == TLV_MustBeFresh ||
+       real_type == TLV_Nonce || real_type == TLV_InterestLifetime || real_type == TLV_HopLimit){
+      if(encoder != NULL){
+        encoder_append_raw_buffer_value(encoder, element, ptr - element);
+      }
+      ret += ptr - element;
+    }
+  }
+  return ret;
+}
+
+int
+tlv_make_nack(uint8_t* buf,
+              size_t buflen,
+              const uint8_t* interest,
+              size_t interest_len,
+              uint8_t reason,
+              size_t* length)
+{
+  ndn_encoder_t encoder;
+  uint32_t reason_size = encoder_probe_block_size(TLV_NackReason, encoder_probe_uint_length(reason));
+  uint32_t nack_size = encoder_probe_block_size(TLV_Nack, reason_size);
+  uint32_t payload_size, fragment_len = interest_len, reduced_len = 0;
+
+  payload_size = nack_size + encoder_probe_block_size(TLV_LpFragment, fragment_len);
+  if(encoder_probe_block_size(TLV_LpPacket, payload_size) > buflen){
+    reduced_len = tlv_nack_reduce_interest(interest, interest_len, NULL);
+    if(reduced_len == 0){
+      return NDN_OVERSIZE;
+    }
+    fragment_len = encoder_probe_block_size(TLV_Interest, reduced_len);
+    payload_size = nack_size + encoder_probe_block_size(TLV_LpFragment, fragment_len);
+  }
+  if(encoder_probe_block_size(TLV_LpPacket, payload_size) > buflen){
+    return NDN_OVERSIZE;
+  }
+  encoder_init(&encoder, buf, buflen);
+  encoder_append_type(&encoder, TLV_LpPacket);
+  encoder_append_length(&encoder, payload_size);
+  encoder_append_type(&encoder, TLV_Nack);
+  encoder_append_length(&encoder, reason_size);
+  encoder_append_type(&encoder, TLV_NackReason);
+  encoder_append_length(&encoder, encoder_probe_uint_length(reason));
+  encoder_append_uint_value(&encoder, reason);
+  encoder_append_type(&encoder, TLV_LpFragment);
+  encoder_append_length(&encoder, fragment_len);
+  if(reduced_len == 0){
+    encoder_append_raw_buffer_value(&encoder, interest, interest_len);
+  }
+  else{
+    encoder_append_type(&encoder, TLV_Interest);
+    encoder_append_length(&encoder, reduced_len);
+    tlv_nack_reduce_interest(interest, interest_len, &encoder);
+  }
+  *length = encoder.offset;
+  return NDN_SUCCESS;
+}
+
+int
+tlv_make_congestion_mark_header(uint8_t* buf,
+                                size_t buflen,
+                                size_t packet_len,
+                                uint64_t mark,
+                                size_t* length)
+{
+  ndn_encoder_t encoder;
+  uint32_t mark_size = encoder_probe_block_size(TLV_CongestionMark, encoder_probe_uint_length(mark));
+  uint32_t payload_size = mark_size + encoder_probe_block_size(TLV_LpFragment, packet_len);
+  // Everything but the packet itself
+  uint32_t header_size = encoder_probe_block_size(TLV_LpPacket, payload_size) - packet_len;
+
+  if(header_size > buflen){
+    return NDN_OVERSIZE;
+  }
+  encoder_init(&encoder, buf, buflen);
+  encoder_append_type(&encoder, TLV_LpPacket);
+  encoder_append_length(&encoder, payload_size);
+  encoder_append_type(&encoder, TLV_CongestionMark);
+  encoder_append_length(&encoder, encoder_probe_uint_length(mark));
+  encoder_append_uint_value(&encoder, mark);
+  encoder_append_type(&encoder, TLV_LpFragment);
+  encoder_append_length(&encoder, packet_len);
+  *length = encoder.offset;
+  return NDN_SUCCESS;
+}
+
+int
+tlv_make_congestion_mark(uint8_t* buf,
+                         size_t buflen,
+                         const uint8_t* packet,
+                         size_t packet_len,
+                         uint64_t mark,
+                         size_t* length)
+{
+  size_t header_len;
+
+  if(packet_len > buflen ||
+     tlv_make_congestion_mark_header(buf, buflen - packet_len, packet_len, mark, &header_len) != NDN_SUCCESS){
+    return NDN_OVERSIZE;
+  }
+  memcpy(buf + header_len, packet, packet_len);
+  *length = header_len + packet_len;
+  return NDN_SUCCESS;
+}
+
+uint64_t
+tlv_lp_packet_get_congestion_mark(uint8_t* packet, size_t buflen)
+{
+  uint32_t real_type, real_len;
+  uint8_t *ptr;
+
+  ptr = tlv_get_type_length(packet, buflen, &real_type, &real_len);
+  if (ptr == NULL || real_type != TLV_LpPacket || real_len != buflen - (ptr - packet)) {
+    return 0;
+  }
+  while (ptr < packet + buflen) {
+    ptr = tlv_get_type_length(ptr, buflen - (ptr - packet), &real_type, &real_len);
+    if (ptr == NULL || real_len > buflen - (ptr - packet)) {
+      return 0;
+    }
+    if (real_type == TLV_CongestionMark) {
+      return tlv_get_uint(ptr, real_len);
+    }
+    ptr += real_len;
+  }
+  return 0;
+}
+
+int
+tlv_lp_packet_parse(uint8_t* packet,
+                    size_t buflen,
+                    uint8_t** fragment,
+                    size_t* fragment_len,
+                    bool* nack,
+                    uint8_t* reason)
+{
+  uint32_t real_type, real_len, field_type, field_len;
+  uint8_t *ptr, *field;
+  uint64_t value;
+
+  ptr = tlv_get_type_length(packet, buflen, &real_type, &real_len);
+  if (ptr == NULL) {
+    return NDN_OVERSIZE_VAR;
+  }
+  if (real_type != TLV_LpPacket) {
+    return NDN_WRONG_TLV_TYPE;
+  }
+  if (real_len != buflen - (ptr - packet)) {
+    return NDN_WRONG_TLV_LENGTH;
+  }
+
+  *fragment = NULL;
+  *fragment_len = 0;
+  *nack = false;
+  *reason = NDN_NACK_REASON_NONE;
+  while (ptr < packet + buflen) {
+    ptr = tlv_get_type_length(ptr, buflen - (ptr - packet), &real_type, &real_len);
+    if (ptr == NULL || real_len > buflen - (ptr - packet)) {
+      return NDN_OVERSIZE_VAR;
+    }
+    if (real_type == TLV_LpFragment) {
+      *fragment = ptr;
+      *fragment_len = real_len;
+    }
+    else if (real_type == TLV_Nack) {
+      *nack = true;
+      field = tlv_get_type_length(ptr, real_len, &field_type, &field_len);
+      if (field != NULL && field_type == TLV_NackReason && field_len <= real_len - (field - ptr)) {
+        value = tlv_get_uint(field, field_len);
+        *reason = (value <= 0xFF) ? (uint8_t)value : NDN_NACK_REASON_NONE;
+      }
+    }
+    ptr += real_len;
+  }
+  if (*fragment == NULL) {
+    return NDN_UNSUPPORTED_FORMAT;
+  }
+  return NDN_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #ifndef NDN_ENCODING_FORWARD_HELPER_H
 #define NDN_ENCODING_FORWARD_HELPER_H
 
+#include "../ndn-constants.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -42,6 +43,56 @@ typedef struct interest_options{
   bool must_be_fresh;
 }interest_options_t;
 
+/**
+ * A Name parsed once per packet.
+ *
+ * It's filled when the packet is decoded, and every table lookup of the packet reuses it
+ * instead of walking the wire name again.
+ */
+typedef struct ndn_parsed_name{
+  /** The Name TLV block.
+   */
+  uint8_t* name;
+
+  /** The length of @c name.
+   */
+  size_t name_len;
+
+  /** The encoded components, right after the Name TLV header.
+   */
+  uint8_t* comps;
+
+  /** The length of @c comps.
+   */
+  size_t comp_len;
+
+  /** Hash of all components, equal to <tt>ndn_hash(comps, comp_len)</tt>.
+   */
+  uint32_t hash;
+
+  /** The number of components.
+   * Only the first #NDN_FWD_NAME_MAX_COMPONENTS prefixes are in @c hashes and @c lens.
+   */
+  uint32_t count;
+
+  /** @c hashes[i] is the hash of the first @c i components.
+   * @sa tlv_name_get_prefix_hashes
+   */
+  uint32_t hashes[NDN_FWD_NAME_MAX_COMPONENTS + 1];
+
+  /** @c lens[i] is the length of the first @c i components.
+   */
+  size_t lens[NDN_FWD_NAME_MAX_COMPONENTS + 1];
+} ndn_parsed_name_t;
+
+/** The number of prefixes of a parsed name in ndn_parsed_name#hashes, minus one.
+ */
+static inline uint32_t
+ndn_parsed_name_depth(const ndn_parsed_name_t* name)
+{
+  return (name->count < NDN_FWD_NAME_MAX_COMPONENTS) ? name->count : NDN_FWD_NAME_MAX_COMPONENTS;
+}
+
 /** Get the first variable of type or length from a TLV encoded form.
  *
  * @param[in] buf The buffer containing the TLV encoded form.
@@ -85,8 +136,7 @@ tlv_check_type_length(uint8_t* buf, size_t buflen, uint32_t type);
  * @param[in] interest The Interest packet.
  * @param[in] buflen The length of @c interest.
  * @param[out] options [Optional] Options of @c interest.
- * @param[out] name A pointer to the name in @c interest.
- * @param[out] name_len The length of @c name.
+ * @param[out] name The parsed name of @c interest.
  * @retval #NDN_SUCCESS The operation succeeds.
  * @retval #NDN_OVERSIZE_VAR Either type of length in @c buf is truncated or malicious.
  * @retval #NDN_WRONG_TLV_TYPE The type of @c buf is not #TLV_Interest.
@@ -94,6 +144,17 @@ tlv_check_type_length(uint8_t* buf, size_t buflen, uint32_t type);
  * @retval #NDN_UNSUPPORTED_FORMAT The first element of @c interest is not #TLV_Name.
  */
 int
+tlv_interest_get_header_parsed(uint8_t* interest,
+                               size_t buflen,
+                               interest_options_t* options,
+                               ndn_parsed_name_t* name);
+
+/** Same as tlv_interest_get_header_parsed(), giving only where the name is.
+ *
+ * @param[out] name A pointer to the name in @c interest.
+ * @param[out] name_len The length of @c name.
+ */
+int
 tlv_interest_get_header(uint8_t* interest,
                         size_t buflen,
                         interest_options_t* options,
@@ -104,31 +165,194 @@ tlv_interest_get_header(uint8_t* interest,
  *
  * @param[in] data The Data packet.
  * @param[in] buflen The length of @c data.
- * @param[out] name A pointer to the name in @c data.
- * @param[out] name_len The length of @c name.
-* @retval #NDN_SUCCESS The operation succeeds.
+ * @param[out] name The parsed name of @c data.
+ * @retval #NDN_SUCCESS The operation succeeds.
  * @retval #NDN_OVERSIZE_VAR Either type of length in @c buf is truncated or malicious.
  * @retval #NDN_WRONG_TLV_TYPE The type of @c buf is not #TLV_Data.
  * @retval #NDN_WRONG_TLV_LENGTH The length of @c buf is different from @c length.
  * @retval #NDN_UNSUPPORTED_FORMAT The first element of @c interest is not #TLV_Name.
  */
 int
+tlv_data_get_name_parsed(uint8_t* data,
+                         size_t buflen,
+                         ndn_parsed_name_t* name);
+
+/** Same as tlv_data_get_name_parsed(), giving only where the name is.
+ *
+ * @param[out] name A pointer to the name in @c data.
+ * @param[out] name_len The length of @c name.
+ */
+int
 tlv_data_get_name(uint8_t* data,
                   size_t buflen,
                   uint8_t** name,
                   size_t* name_len);
 
+/** Parse a Name, computing the hash of every prefix.
+ *
+ * @param[in] name The Name TLV block.
+ * @param[in] name_len The length of @c name.
+ * @param[out] parsed The parsed name.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR Either type of length in @c name is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE @c name is not a #TLV_Name block.
+ * @retval #NDN_WRONG_TLV_LENGTH @c name or one of its components is truncated.
+ */
+int
+tlv_name_parse(uint8_t* name, size_t name_len, ndn_parsed_name_t* parsed);
+
 /** Get the pointer to hop limit field of a Interest packet.
  *
  * @param[in] interest The Interest packet.
  * @param[in] buflen The length of @c interest.
  * @return If the function succeeds, return a pointer to the hop limit.
  *         If @c interest doesn't contain a hop limit field, return @c NULL.
- * @pre #tlv_interest_get_header should succeed for @c interest.
+ * @pre #tlv_interest_get_header_parsed should succeed for @c interest.
  */
 uint8_t*
 tlv_interest_get_hoplimit_ptr(uint8_t* interest, size_t buflen);
 
+/** Get the pointer to the nonce field of a Interest packet.
+ *
+ * @param[in] interest The Interest packet.
+ * @param[in] buflen The length of @c interest.
+ * @return If the function succeeds, return a pointer to the 4-byte nonce.
+ *         If @c interest doesn't contain a nonce field, return @c NULL.
+ * @pre #tlv_interest_get_header_parsed should succeed for @c interest.
+ */
+uint8_t*
+tlv_interest_get_nonce_ptr(uint8_t* interest, size_t buflen);
+
+/** Encode an NDNLPv2 Nack of an Interest.
+ *
+ * If the Interest doesn't fit in @c buf, the Nack carries it reduced to
+ * Name, CanBePrefix, MustBeFresh, Nonce, InterestLifetime and HopLimit,
+ * which are enough for the downstream to match it.
+ * @param[out] buf The buffer to encode the Nack into.
+ * @param[in] buflen The size of @c buf.
+ * @param[in] interest The Interest packet.
+ * @param[in] interest_len The length of @c interest.
+ * @param[in] reason The Nack reason.
+ * @param[out] length The length of the Nack.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE @c buf is too small.
+ */
+int
+tlv_make_nack(uint8_t* buf,
+              size_t buflen,
+              const uint8_t* interest,
+              size_t interest_len,
+              uint8_t reason,
+              size_t* length);
+
+/** Encode an NDNLPv2 packet carrying a packet with a CongestionMark.
+ *
+ * @param[out] buf The buffer to encode the LpPacket into.
+ * @param[in] buflen The size of @c buf.
+ * @param[in] packet The network layer packet.
+ * @param[in] packet_len The length of @c packet.
+ * @param[in] mark The CongestionMark, greater than 0.
+ * @param[out] length The length of the LpPacket.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE @c buf is too small.
+ */
+int
+tlv_make_congestion_mark(uint8_t* buf,
+                         size_t buflen,
+                         const uint8_t* packet,
+                         size_t packet_len,
+                         uint64_t mark,
+                         size_t* length);
+
+/** Encode the NDNLPv2 header which puts a CongestionMark on a packet.
+ *
+ * The header followed by the packet is the same as tlv_make_congestion_mark() makes,
+ * so a packet with room before it can be marked without a copy.
+ * @param[out] buf The buffer to encode the header into.
+ * @param[in] buflen The size of @c buf.
+ * @param[in] packet_len The length of the network layer packet.
+ * @param[in] mark The CongestionMark, greater than 0.
+ * @param[out] length The length of the header.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE @c buf is too small.
+ */
+int
+tlv_make_congestion_mark_header(uint8_t* buf,
+                                size_t buflen,
+                                size_t packet_len,
+                                uint64_t mark,
+                                size_t* length);
+
+/** Get the CongestionMark of an NDNLPv2 packet.
+ *
+ * @param[in] packet The LpPacket.
+ * @param[in] buflen The length of @c packet.
+ * @return The CongestionMark. 0 if absent or @c packet is malformed.
+ */
+uint64_t
+tlv_lp_packet_get_congestion_mark(uint8_t* packet, size_t buflen);
+
+/** Get the fragment and the Nack header of an NDNLPv2 packet.
+ *
+ * Other header fields are skipped.
+ * @param[in] packet The LpPacket.
+ * @param[in] buflen The length of @c packet.
+ * @param[out] fragment The network layer packet in the fragment.
+ * @param[out] fragment_len The length of @c fragment.
+ * @param[out] nack Whether the packet is a Nack.
+ * @param[out] reason The Nack reason. #NDN_NACK_REASON_NONE if absent or too large.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR Either type of length in @c buf is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE The type of @c buf is not #TLV_LpPacket.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c buf is different from @c length.
+ * @retval #NDN_UNSUPPORTED_FORMAT @c packet has no fragment.
+ */
+int
+tlv_lp_packet_parse(uint8_t* packet,
+                    size_t buflen,
+                    uint8_t** fragment,
+                    size_t* fragment_len,
+                    bool* nack,
+                    uint8_t* reason);
+
+/** Compute the hash of every prefix of a Name.
+ *
+ * The hash covers the encoded components only, not the Name TLV header,
+ * so a prefix hashes to the same value as that prefix encoded as a Name on its own.
+ * @param[in] name The Name TLV block.
+ * @param[in] name_len The length of @c name.
+ * @param[out] hashes @c hashes[i] is the hash of the first @c i components.
+ * @param[out] offsets [Optional] @c offsets[i] is the offset in @c name right after
+ *                     the first @c i components.
+ * @param[in] max_count The size of @c hashes and @c offsets.
+ * @return The number of components if the function succeeds. The error code otherwise.
+ * @retval #NDN_OVERSIZE @c name has @c max_count components or more.
+ * @retval #NDN_WRONG_TLV_TYPE @c name is not a #TLV_Name block.
+ * @retval #NDN_WRONG_TLV_LENGTH @c name is truncated.
+ */
+int
+tlv_name_get_prefix_hashes(uint8_t* name,
+                           size_t name_len,
+                           uint32_t* hashes,
+                           size_t* offsets,
+                           size_t max_count);
+
+/** Get the FreshnessPeriod of a Data packet.
+ *
+ * @param[in] data The Data packet.
+ * @param[in] buflen The length of @c data.
+ * @param[out] freshness_period The FreshnessPeriod in milliseconds. 0 if absent.
+ * @retval #NDN_SUCCESS The operation succeeds.
+ * @retval #NDN_OVERSIZE_VAR Either type of length in @c buf is truncated or malicious.
+ * @retval #NDN_WRONG_TLV_TYPE The type of @c buf is not #TLV_Data.
+ * @retval #NDN_WRONG_TLV_LENGTH The length of @c buf is different from @c length.
+ * @pre #tlv_data_get_name_parsed should succeed for @c data.
+ */
+int
+tlv_data_get_freshness_period(uint8_t* data,
+                              size_t buflen,
+                              uint64_t* freshness_period);
+
 /** Decode an unsigned integer value.
  *
  * @param[in] buf Buffer pointing to the value, not including T and L.
@@ -73,6 +73,15 @@ enum {
   TLV_NotAfter = 255
 };
 
+// NDN Link Protocol v2
+enum {
+  TLV_LpPacket = 100,
+  TLV_LpFragment = 80,
+  TLV_Nack = 800,
+  TLV_NackReason = 801,
+  TLV_CongestionMark = 832,
+};
+
 // App Support Specific
 enum {
   TLV_AC_KEYID = 129,
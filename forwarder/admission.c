@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#include "admission.h"
+
+void
+ndn_token_bucket_init(ndn_token_bucket_t* self, uint32_t rate, uint32_t burst, ndn_time_ms_t now)
+{
+  self->rate = rate;
+  self->burst = (burst > 0) ? burst : 1;
+  self->tokens = (uint64_t)self->burst * 1000;
+  self->last_time = now;
+}
+
+bool
+ndn_token_bucket_consume(ndn_token_bucket_t* self, ndn_time_ms_t now)
+{
+  uint64_t max = (uint64_t)self->burst * 1000;
+
+  if(self->rate == 0){
+    return true;
+  }
+  // A token per second is a thousandth per millisecond
+  if(now > self->last_time){
+    if(now - self->last_time >= max / self->rate + 1){
+      self->tokens = max;
+    }
+    else{
+      self->tokens += (now - self->last_time) * self->rate;
+      if(self->tokens > max){
+        self->tokens = max;
+      }
+    }
+    self->last_time = now;
+  }
+  if(self->tokens < 1000){
+    return false;
+  }
+  self->tokens -= 1000;
+  return true;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_ADMISSION_H_
+#define FORWARDER_ADMISSION_H_
+
+#include "../ndn-constants.h"
+#include "../util/uniform-time.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdAdmission Admission
+ * @brief Limits on the Interests a face can make the forwarder keep
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * A token bucket, refilled at @c rate tokens per second up to @c burst tokens.
+ */
+typedef struct ndn_token_bucket {
+  /** Tokens per second. 0 for no limit.
+   */
+  uint32_t rate;
+
+  /** The most tokens the bucket holds.
+   */
+  uint32_t burst;
+
+  /** Tokens in thousandths, so a refill of less than a token per millisecond is not lost.
+   */
+  uint64_t tokens;
+
+  /** The time of the last refill.
+   */
+  ndn_time_ms_t last_time;
+} ndn_token_bucket_t;
+
+/** Initialize a token bucket, full.
+ * @param[in] rate Tokens per second. 0 for no limit.
+ * @param[in] burst The most tokens the bucket holds, at least 1.
+ */
+void
+ndn_token_bucket_init(ndn_token_bucket_t* self, uint32_t rate, uint32_t burst, ndn_time_ms_t now);
+
+/** Take a token.
+ * @return Whether there was a token, or there is no limit.
+ */
+bool
+ndn_token_bucket_consume(ndn_token_bucket_t* self, ndn_time_ms_t now);
+
+/**
+ * The limits of a face and what they shed.
+ */
+typedef struct ndn_face_admission {
+  /** The most PIT entries the face can be a downstream of. 0 for no quota.
+   */
+  ndn_table_id_t pit_quota;
+
+  /** Rate limit of the Interests from the face.
+   */
+  ndn_token_bucket_t bucket;
+
+  /** Interests dropped because the face was at its quota.
+   */
+  uint32_t quota_shed;
+
+  /** Interests dropped by the rate limit.
+   */
+  uint32_t rate_shed;
+} ndn_face_admission_t;
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_ADMISSION_H_
@@ -0,0 +1,472 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#define ENABLE_NDN_LOG_INFO 0
+#define ENABLE_NDN_LOG_DEBUG 0
+#define ENABLE_NDN_LOG_ERROR 1
+#include "cs.h"
+#include "../encode/forwarder-helper.h"
+#include "../encode/tlv.h"
+#include "../util/hash.h"
+#include "../util/logger.h"
+#include <string.h>
+
+#define NDN_CS_NO_CHUNK 0xFF
+
+static inline size_t
+ndn_cs_chunk_size(uint8_t size_class)
+{
+  return (size_t)NDN_CS_MIN_CHUNK_SIZE << size_class;
+}
+
+static inline uint8_t*
+ndn_cs_chunk_at(ndn_cs_t* self, ndn_table_id_t page, uint8_t chunk, uint8_t size_class)
+{
+  return self->arena + (size_t)page * NDN_CS_PAGE_SIZE + chunk * ndn_cs_chunk_size(size_class);
+}
+
+void
+ndn_cs_init(void* memory, uint32_t size, const ndn_cs_policy_t* policy)
+{
+  ndn_cs_t* self = (ndn_cs_t*)memory;
+  uint32_t bucket_count = 0, j;
+  ndn_table_id_t i;
+  uint8_t c;
+
+  self->policy = policy;
+  self->capacity = NDN_CS_ENTRY_COUNT(size);
+  self->page_count = size / NDN_CS_PAGE_SIZE;
+
+  for(i = 0; i < self->capacity; i ++){
+    self->slots[i].length = 0;
+    self->slots[i].prev = (i + 1 < self->capacity) ? i + 1 : NDN_INVALID_ID;
+  }
+  self->free_head = (self->capacity > 0) ? 0 : NDN_INVALID_ID;
+
+  // An empty CS has no buckets reserved, and is never looked up
+  if(self->capacity > 0){
+    bucket_count = 2;
+    while(bucket_count < 2 * (uint32_t)self->capacity){
+      bucket_count <<= 1;
+    }
+  }
+  self->bucket_mask = (bucket_count > 0) ? bucket_count - 1 : 0;
+  self->buckets = (ndn_cs_bucket_t*)&self->slots[self->capacity];
+  for(j = 0; j < bucket_count; j ++){
+    self->buckets[j].hash = 0;
+    self->buckets[j].entry_id = NDN_INVALID_ID;
+  }
+
+  self->pages = (ndn_cs_page_t*)&self->buckets[4 * (uint32_t)self->capacity];
+  for(i = 0; i < self->page_count; i ++){
+    self->pages[i].next = (i + 1 < self->page_count) ? i + 1 : NDN_INVALID_ID;
+  }
+  self->free_page = (self->page_count > 0) ? 0 : NDN_INVALID_ID;
+  self->arena = (uint8_t*)&self->pages[self->page_count];
+
+  for(c = 0; c < NDN_CS_SIZE_CLASSES; c ++){
+    self->lru_head[c] = self->lru_tail[c] = NDN_INVALID_ID;
+    self->partial_pages[c] = NDN_INVALID_ID;
+    self->class_pages[c] = 0;
+  }
+}
+
+void
+ndn_cs_set_policy(ndn_cs_t* self, const ndn_cs_policy_t* policy)
+{
+  self->policy = policy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Recency lists
+
+static void
+ndn_cs_lru_unlink(ndn_cs_t* self, ndn_cs_entry_t* entry)
+{
+  if(entry->prev != NDN_INVALID_ID){
+    self->slots[entry->prev].next = entry->next;
+  }
+  else{
+    self->lru_head[entry->size_class] = entry->next;
+  }
+  if(entry->next != NDN_INVALID_ID){
+    self->slots[entry->next].prev = entry->prev;
+  }
+  else{
+    self->lru_tail[entry->size_class] = entry->prev;
+  }
+}
+
+static void
+ndn_cs_lru_push_front(ndn_cs_t* self, ndn_cs_entry_t* entry)
+{
+  ndn_table_id_t id = entry - &self->slots[0];
+  uint8_t c = entry->size_class;
+
+  entry->prev = NDN_INVALID_ID;
+  entry->next = self->lru_head[c];
+  if(self->lru_head[c] != NDN_INVALID_ID){
+    self->slots[self->lru_head[c]].prev = id;
+  }
+  else{
+    self->lru_tail[c] = id;
+  }
+  self->lru_head[c] = id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Slab arena
+
+static void
+ndn_cs_page_list_remove(ndn_cs_t* self, ndn_table_id_t page)
+{
+  ndn_cs_page_t* p = &self->pages[page];
+  if(p->prev != NDN_INVALID_ID){
+    self->pages[p->prev].next = p->next;
+  }
+  else{
+    self->partial_pages[p->size_class] = p->next;
+  }
+  if(p->next != NDN_INVALID_ID){
+    self->pages[p->next].prev = p->prev;
+  }
+}
+
+static void
+ndn_cs_page_list_push(ndn_cs_t* self, ndn_table_id_t page)
+{
+  ndn_cs_page_t* p = &self->pages[page];
+  p->prev = NDN_INVALID_ID;
+  p->next = self->partial_pages[p->size_class];
+  if(p->next != NDN_INVALID_ID){
+    self->pages[p->next].prev = page;
+  }
+  self->partial_pages[p->size_class] = page;
+}
+
+/** Split a free page into chunks of a size class.
+ */
+static void
+ndn_cs_page_assign(ndn_cs_t* self, uint8_t size_class)
+{
+  ndn_table_id_t page = self->free_page;
+  ndn_cs_page_t* p = &self->pages[page];
+  uint8_t count = NDN_CS_PAGE_SIZE / ndn_cs_chunk_size(size_class);
+  uint8_t i;
+
+  self->free_page = p->next;
+  p->size_class = size_class;
+  p->used = 0;
+  p->free_chunk = 0;
+  for(i = 0; i < count; i ++){
+    *ndn_cs_chunk_at(self, page, i, size_class) = (i + 1 < count) ? i + 1 : NDN_CS_NO_CHUNK;
+  }
+  self->class_pages[size_class] ++;
+  ndn_cs_page_list_push(self, page);
+}
+
+static uint32_t
+ndn_cs_chunk_take(ndn_cs_t* self, uint8_t size_class)
+{
+  ndn_table_id_t page = self->partial_pages[size_class];
+  ndn_cs_page_t* p = &self->pages[page];
+  uint8_t chunk = p->free_chunk;
+  uint8_t* ptr = ndn_cs_chunk_at(self, page, chunk, size_class);
+
+  p->free_chunk = *ptr;
+  p->used ++;
+  if(p->free_chunk == NDN_CS_NO_CHUNK){
+    ndn_cs_page_list_remove(self, page);
+  }
+  return ptr - self->arena;
+}
+
+static void
+ndn_cs_chunk_release(ndn_cs_t* self, uint32_t offset)
+{
+  ndn_table_id_t page = offset / NDN_CS_PAGE_SIZE;
+  ndn_cs_page_t* p = &self->pages[page];
+  uint8_t chunk = (offset % NDN_CS_PAGE_SIZE) / ndn_cs_chunk_size(p->size_class);
+
+  if(p->free_chunk == NDN_CS_NO_CHUNK){
+    ndn_cs_page_list_push(self, page);
+  }
+  self->arena[offset] = p->free_chunk;
+  p->free_chunk = chunk;
+  p->used --;
+  if(p->used == 0){
+    // Give the page back so any size class can use it
+    ndn_cs_page_list_remove(self, page);
+    self->class_pages[p->size_class] --;
+    p->next = self->free_page;
+    self->free_page = page;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Hash index
+
+/** Look up a name in the hash index.
+ * Returns the entry's ID, or #NDN_INVALID_ID with @c pos set to the empty bucket to insert into.
+ */
+static ndn_table_id_t
+ndn_cs_index_lookup(ndn_cs_t* self, uint32_t hash, const uint8_t* comps, size_t comp_len, uint32_t* pos)
+{
+  uint32_t i = hash & self->bucket_mask;
+  ndn_table_id_t id;
+  ndn_cs_entry_t* entry;
+  while((id = self->buckets[i].entry_id) != NDN_INVALID_ID){
+    entry = &self->slots[id];
+    if(self->buckets[i].hash == hash &&
+       entry->comp_len == comp_len &&
+       memcmp(ndn_cs_entry_data(self, entry) + entry->comp_offset, comps, comp_len) == 0)
+    {
+      break;
+    }
+    i = (i + 1) & self->bucket_mask;
+  }
+  if(pos != NULL){
+    *pos = i;
+  }
+  return id;
+}
+
+static void
+ndn_cs_index_remove(ndn_cs_t* self, ndn_table_id_t id)
+{
+  uint32_t mask = self->bucket_mask;
+  uint32_t i = self->slots[id].name_hash & mask;
+  uint32_t j, home;
+
+  while(self->buckets[i].entry_id != id){
+    i = (i + 1) & mask;
+  }
+  // Backward-shift deletion, same as the PIT
+  for(j = (i + 1) & mask; self->buckets[j].entry_id != NDN_INVALID_ID; j = (j + 1) & mask){
+    home = self->buckets[j].hash & mask;
+    if(((j - home) & mask) >= ((j - i) & mask)){
+      self->buckets[i] = self->buckets[j];
+      i = j;
+    }
+  }
+  self->buckets[i].entry_id = NDN_INVALID_ID;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Entries
+
+void
+ndn_cs_remove_entry(ndn_cs_t* self, ndn_cs_entry_t* entry)
+{
+  ndn_table_id_t id = entry - &self->slots[0];
+  if(entry->length == 0){
+    return;
+  }
+  ndn_cs_index_remove(self, id);
+  ndn_cs_lru_unlink(self, entry);
+  ndn_cs_chunk_release(self, entry->offset);
+  entry->length = 0;
+  entry->prev = self->free_head;
+  self->free_head = id;
+}
+
+/** Make sure a chunk of @c size_class can be taken, evicting entries if needed.
+ */
+static void
+ndn_cs_make_room(ndn_cs_t* self, uint8_t size_class)
+{
+  uint8_t c, victim_class;
+
+  while(self->partial_pages[size_class] == NDN_INVALID_ID){
+    if(self->free_page != NDN_INVALID_ID){
+      ndn_cs_page_assign(self, size_class);
+      return;
+    }
+    if(self->lru_tail[size_class] != NDN_INVALID_ID){
+      victim_class = size_class;
+    }
+    else{
+      // Reclaim a page from the size class holding the most pages
+      victim_class = 0;
+      for(c = 1; c < NDN_CS_SIZE_CLASSES; c ++){
+        if(self->class_pages[c] > self->class_pages[victim_class]){
+          victim_class = c;
+        }
+      }
+    }
+    ndn_cs_remove_entry(self, &self->slots[self->policy->select_victim(self, victim_class)]);
+  }
+}
+
+ndn_cs_entry_t*
+ndn_cs_insert_parsed(ndn_cs_t* self, uint8_t* data, size_t length,
+                     const ndn_parsed_name_t* name, ndn_time_ms_t now)
+{
+  uint32_t pos;
+  uint64_t freshness_period;
+  ndn_table_id_t id;
+  ndn_cs_entry_t* entry;
+  uint8_t size_class = 0;
+
+  if(length > NDN_CS_PAGE_SIZE || self->page_count == 0 ||
+     name->name < data || name->name + name->name_len > data + length){
+    return NULL;
+  }
+  if(tlv_data_get_freshness_period(data, length, &freshness_period) != NDN_SUCCESS){
+    return NULL;
+  }
+  while(ndn_cs_chunk_size(size_class) < length){
+    size_class ++;
+  }
+
+  id = ndn_cs_index_lookup(self, name->hash, name->comps, name->comp_len, NULL);
+  if(id != NDN_INVALID_ID){
+    ndn_cs_remove_entry(self, &self->slots[id]);
+  }
+  ndn_cs_make_room(self, size_class);
+
+  id = self->free_head;
+  entry = &self->slots[id];
+  self->free_head = entry->prev;
+  entry->size_class = size_class;
+  entry->offset = ndn_cs_chunk_take(self, size_class);
+  entry->length = length;
+  entry->comp_offset = name->comps - data;
+  entry->comp_len = name->comp_len;
+  entry->name_hash = name->hash;
+  entry->freq = 0;
+  entry->fresh_until = now + freshness_period;
+  memcpy(ndn_cs_entry_data(self, entry), data, length);
+
+  // Evictions may have moved buckets, so find the slot again
+  ndn_cs_index_lookup(self, name->hash, name->comps, name->comp_len, &pos);
+  self->buckets[pos].hash = name->hash;
+  self->buckets[pos].entry_id = id;
+  ndn_cs_lru_push_front(self, entry);
+  NDN_LOG_DEBUG("[CS] Cache a Data packet of %u bytes\n", (unsigned)length);
+  return entry;
+}
+
+ndn_cs_entry_t*
+ndn_cs_insert(ndn_cs_t* self, uint8_t* data, size_t length,
+              uint8_t* name, size_t name_len, ndn_time_ms_t now)
+{
+  ndn_parsed_name_t parsed;
+  if(tlv_name_parse(name, name_len, &parsed) != NDN_SUCCESS){
+    return NULL;
+  }
+  return ndn_cs_insert_parsed(self, data, length, &parsed, now);
+}
+
+static inline bool
+ndn_cs_entry_usable(const ndn_cs_entry_t* entry, bool must_be_fresh, ndn_time_ms_t now)
+{
+  return !must_be_fresh || now < entry->fresh_until;
+}
+
+ndn_cs_entry_t*
+ndn_cs_match_parsed(ndn_cs_t* self, const ndn_parsed_name_t* name,
+                    bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now)
+{
+  ndn_table_id_t id;
+  ndn_cs_entry_t* entry = NULL;
+
+  if(self->capacity == 0){
+    return NULL;
+  }
+
+  id = ndn_cs_index_lookup(self, name->hash, name->comps, name->comp_len, NULL);
+  if(id != NDN_INVALID_ID && ndn_cs_entry_usable(&self->slots[id], must_be_fresh, now)){
+    entry = &self->slots[id];
+  }
+  else if(can_be_prefix){
+    // Components are whole TLVs, so a byte prefix is a name prefix
+    for(id = 0; id < self->capacity; id ++){
+      entry = &self->slots[id];
+      if(entry->length != 0 &&
+         entry->comp_len >= name->comp_len &&
+         memcmp(ndn_cs_entry_data(self, entry) + entry->comp_offset, name->comps, name->comp_len) == 0 &&
+         ndn_cs_entry_usable(entry, must_be_fresh, now))
+      {
+        break;
+      }
+    }
+    if(id == self->capacity){
+      entry = NULL;
+    }
+  }
+
+  if(entry != NULL){
+    ndn_cs_lru_unlink(self, entry);
+    ndn_cs_lru_push_front(self, entry);
+    if(self->policy->on_hit != NULL){
+      self->policy->on_hit(self, entry);
+    }
+  }
+  return entry;
+}
+
+ndn_cs_entry_t*
+ndn_cs_match(ndn_cs_t* self, uint8_t* name, size_t name_len,
+             bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now)
+{
+  ndn_parsed_name_t parsed;
+  if(tlv_name_parse(name, name_len, &parsed) != NDN_SUCCESS){
+    return NULL;
+  }
+  return ndn_cs_match_parsed(self, &parsed, can_be_prefix, must_be_fresh, now);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Replacement policies
+
+static ndn_table_id_t
+ndn_cs_lru_select_victim(ndn_cs_t* self, uint8_t size_class)
+{
+  return self->lru_tail[size_class];
+}
+
+const ndn_cs_policy_t ndn_cs_policy_lru = {
+  .on_hit = NULL,
+  .select_victim = ndn_cs_lru_select_victim,
+};
+
+static void
+ndn_cs_lfu_on_hit(ndn_cs_t* self, ndn_cs_entry_t* entry)
+{
+  (void)self;
+  if(entry->freq < UINT8_MAX){
+    entry->freq ++;
+  }
+}
+
+static ndn_table_id_t
+ndn_cs_lfu_select_victim(ndn_cs_t* self, uint8_t size_class)
+{
+  ndn_table_id_t id = self->lru_tail[size_class];
+  ndn_table_id_t victim = id;
+  uint8_t victim_freq = UINT8_MAX;
+  int i;
+
+  // Ties go to the least recently used
+  for(i = 0; i < NDN_CS_LFU_SAMPLES && id != NDN_INVALID_ID; i ++){
+    if(self->slots[id].freq < victim_freq){
+      victim = id;
+      victim_freq = self->slots[id].freq;
+    }
+    self->slots[id].freq >>= 1;
+    id = self->slots[id].prev;
+  }
+  return victim;
+}
+
+const ndn_cs_policy_t ndn_cs_policy_lfu = {
+  .on_hit = ndn_cs_lfu_on_hit,
+  .select_victim = ndn_cs_lfu_select_victim,
+};
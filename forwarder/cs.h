@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_CS_H_
+#define FORWARDER_CS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../ndn-constants.h"
+#include "../encode/forwarder-helper.h"
+#include "../util/uniform-time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdCS CS
+ * @brief Content Store
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/** Size of the smallest chunk in the arena.
+ */
+#define NDN_CS_MIN_CHUNK_SIZE 128
+
+/** Number of chunk size classes. Chunk sizes double from #NDN_CS_MIN_CHUNK_SIZE.
+ */
+#define NDN_CS_SIZE_CLASSES 5
+
+/** Size of an arena page, which is also the largest chunk.
+ * Data packets larger than this are not cached.
+ */
+#define NDN_CS_PAGE_SIZE (NDN_CS_MIN_CHUNK_SIZE << (NDN_CS_SIZE_CLASSES - 1))
+
+/** Number of least recently used entries the LFU policy compares.
+ */
+#define NDN_CS_LFU_SAMPLES 8
+
+/**
+ * CS entry.
+ */
+typedef struct ndn_cs_entry {
+  /** Hash of the name components.
+   * @sa tlv_name_get_prefix_hashes
+   */
+  uint32_t name_hash;
+
+  /** Offset of the Data packet in ndn_cs#arena.
+   */
+  uint32_t offset;
+
+  /** Length of the Data packet. 0 if the entry is empty.
+   */
+  uint16_t length;
+
+  /** Offset of the name components in the Data packet.
+   */
+  uint16_t comp_offset;
+
+  /** Length of the name components.
+   */
+  uint16_t comp_len;
+
+  /** Size class of the chunk holding the packet.
+   */
+  uint8_t size_class;
+
+  /** Access counter used by the LFU policy.
+   */
+  uint8_t freq;
+
+  /** The time the Data stops being fresh.
+   */
+  ndn_time_ms_t fresh_until;
+
+  /** Previous (more recently used) entry of the same size class.
+   * Next entry in the free list if the entry is empty.
+   */
+  ndn_table_id_t prev;
+
+  /** Next (less recently used) entry of the same size class.
+   */
+  ndn_table_id_t next;
+} ndn_cs_entry_t;
+
+/**
+ * A bucket of the CS hash index.
+ */
+typedef struct ndn_cs_bucket {
+  /** Hash of the name of the entry.
+   */
+  uint32_t hash;
+
+  /** Index of the entry.
+   * #NDN_INVALID_ID if the bucket is empty.
+   */
+  ndn_table_id_t entry_id;
+} ndn_cs_bucket_t;
+
+/**
+ * An arena page. Every page is split into chunks of a single size class.
+ */
+typedef struct ndn_cs_page {
+  /** Previous page in the list of partially used pages of the size class.
+   */
+  ndn_table_id_t prev;
+
+  /** Next page in the list of partially used pages, or in the free page list.
+   */
+  ndn_table_id_t next;
+
+  /** Number of chunks in use.
+   */
+  uint8_t used;
+
+  /** First free chunk. The first byte of a free chunk is the next free chunk.
+   * 0xFF if the page is full.
+   */
+  uint8_t free_chunk;
+
+  /** Size class of the page.
+   */
+  uint8_t size_class;
+} ndn_cs_page_t;
+
+typedef struct ndn_cs ndn_cs_t;
+
+/**
+ * Replacement policy of the CS.
+ *
+ * The CS keeps entries of each size class in recency order;
+ * the policy decides which one to drop when a chunk is needed.
+ */
+typedef struct ndn_cs_policy {
+  /** Called when an entry is used to satisfy an Interest.
+   */
+  void (*on_hit)(ndn_cs_t* self, ndn_cs_entry_t* entry);
+
+  /** Choose the entry to evict from a size class.
+   * The size class is not empty.
+   * @return The ID of the entry.
+   */
+  ndn_table_id_t (*select_victim)(ndn_cs_t* self, uint8_t size_class);
+} ndn_cs_policy_t;
+
+/** Least recently used replacement.
+ */
+extern const ndn_cs_policy_t ndn_cs_policy_lru;
+
+/** Approximate least frequently used replacement.
+ * The victim is the least used of the #NDN_CS_LFU_SAMPLES least recently used entries,
+ * and the counters of the others are halved so that old popularity fades.
+ */
+extern const ndn_cs_policy_t ndn_cs_policy_lfu;
+
+/**
+ * Content Store (CS).
+ *
+ * Data packets are copied into a slab arena of fixed-size pages, so caching needs no malloc.
+ * Entries are indexed by the hash of the Data name.
+ */
+struct ndn_cs {
+  const ndn_cs_policy_t* policy;
+
+  /** Number of entries. One per smallest chunk of the arena.
+   */
+  ndn_table_id_t capacity;
+
+  /** Head of the free entry list.
+   */
+  ndn_table_id_t free_head;
+
+  /** Number of pages in the arena.
+   */
+  ndn_table_id_t page_count;
+
+  /** Head of the free page list.
+   */
+  ndn_table_id_t free_page;
+
+  /** Most recently used entry of each size class.
+   */
+  ndn_table_id_t lru_head[NDN_CS_SIZE_CLASSES];
+
+  /** Least recently used entry of each size class.
+   */
+  ndn_table_id_t lru_tail[NDN_CS_SIZE_CLASSES];
+
+  /** Pages with free chunks of each size class.
+   */
+  ndn_table_id_t partial_pages[NDN_CS_SIZE_CLASSES];
+
+  /** Number of pages of each size class.
+   */
+  ndn_table_id_t class_pages[NDN_CS_SIZE_CLASSES];
+
+  /** Number of buckets minus one. The number of buckets is a power of 2.
+   */
+  uint32_t bucket_mask;
+
+  /** Hash index, linear probing.
+   */
+  ndn_cs_bucket_t* buckets;
+
+  ndn_cs_page_t* pages;
+
+  /** Packet storage, #NDN_CS_PAGE_SIZE bytes per page.
+   */
+  uint8_t* arena;
+
+  ndn_cs_entry_t slots[];
+};
+
+/** The number of entries of a CS of @c size bytes.
+ */
+#define NDN_CS_ENTRY_COUNT(size) \
+  ((size) / NDN_CS_PAGE_SIZE * (NDN_CS_PAGE_SIZE / NDN_CS_MIN_CHUNK_SIZE))
+
+/** The memory reserved for CS.
+ * @param[in] size Bytes of Data packets to store, rounded down to #NDN_CS_PAGE_SIZE.
+ */
+#define NDN_CS_RESERVE_SIZE(size) \
+  (sizeof(ndn_cs_t) + \
+   (sizeof(ndn_cs_entry_t) + sizeof(ndn_cs_bucket_t) * 4) * NDN_CS_ENTRY_COUNT(size) + \
+   (sizeof(ndn_cs_page_t) + NDN_CS_PAGE_SIZE) * ((size) / NDN_CS_PAGE_SIZE))
+
+/** Initialize CS at specified memory space.
+ * @param[in, out] memory Memory reserved for CS.
+ * @param[in] size Bytes of Data packets to store. The same value given to #NDN_CS_RESERVE_SIZE.
+ * @param[in] policy The replacement policy.
+ */
+void
+ndn_cs_init(void* memory, uint32_t size, const ndn_cs_policy_t* policy);
+
+/** Change the replacement policy. Cached Data are kept.
+ */
+void
+ndn_cs_set_policy(ndn_cs_t* self, const ndn_cs_policy_t* policy);
+
+/** Cache a Data packet.
+ *
+ * An existing entry with the same name is replaced.
+ * If there is no room, entries are evicted following the replacement policy.
+ * @param[in] self The CS.
+ * @param[in] data The Data packet.
+ * @param[in] length The length of @c data.
+ * @param[in] name The name of @c data. Must point into @c data.
+ * @param[in] name_len The length of @c name.
+ * @param[in] now The current time.
+ * @return The new entry. @c NULL if the packet can't be cached.
+ */
+ndn_cs_entry_t*
+ndn_cs_insert(ndn_cs_t* self, uint8_t* data, size_t length,
+              uint8_t* name, size_t name_len, ndn_time_ms_t now);
+
+/** Find a Data packet satisfying an Interest.
+ * @param[in] self The CS.
+ * @param[in] name The name of the Interest.
+ * @param[in] name_len The length of @c name.
+ * @param[in] can_be_prefix Whether the Interest has CanBePrefix.
+ * @param[in] must_be_fresh Whether the Interest has MustBeFresh.
+ * @param[in] now The current time. Only used when @c must_be_fresh.
+ * @return The matching entry. @c NULL if none.
+ */
+ndn_cs_entry_t*
+ndn_cs_match(ndn_cs_t* self, uint8_t* name, size_t name_len,
+             bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now);
+
+/** Same as ndn_cs_insert(), with a name parsed by tlv_name_parse().
+ */
+ndn_cs_entry_t*
+ndn_cs_insert_parsed(ndn_cs_t* self, uint8_t* data, size_t length,
+                     const ndn_parsed_name_t* name, ndn_time_ms_t now);
+
+/** Same as ndn_cs_match(), with a name parsed by tlv_name_parse().
+ */
+ndn_cs_entry_t*
+ndn_cs_match_parsed(ndn_cs_t* self, const ndn_parsed_name_t* name,
+                    bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now);
+
+/** Drop a cached Data packet.
+ */
+void
+ndn_cs_remove_entry(ndn_cs_t* self, ndn_cs_entry_t* entry);
+
+/** Get the Data packet of an entry.
+ * @return The Data packet, whose length is <tt>entry->length</tt>.
+ */
+static inline uint8_t*
+ndn_cs_entry_data(const ndn_cs_t* self, const ndn_cs_entry_t* entry)
+{
+  return self->arena + entry->offset;
+}
+
+struct ndn_cs_tier;
+
+/** Find a Data packet in a CS tier.
+ * @param[in] name The name of the Interest.
+ * @param[in] name_len The length of @c name.
+ * @param[in] can_be_prefix Whether the Interest has CanBePrefix.
+ * @param[in] must_be_fresh Whether the Interest has MustBeFresh.
+ * @param[in] now The current time. Only used when @c must_be_fresh.
+ * @param[out] data The Data packet, owned by the tier. Valid until the next insertion.
+ * @return The length of the Data packet. 0 if none.
+ */
+typedef size_t (*ndn_cs_tier_match)(struct ndn_cs_tier* self, uint8_t* name, size_t name_len,
+                                    bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now,
+                                    const uint8_t** data);
+
+/** Store a Data packet in a CS tier. Same parameters as ndn_cs_insert().
+ */
+typedef void (*ndn_cs_tier_insert)(struct ndn_cs_tier* self, uint8_t* data, size_t length,
+                                   uint8_t* name, size_t name_len, ndn_time_ms_t now);
+
+/**
+ * A second-level content store, consulted when the CS misses.
+ *
+ * A tier keeps the packets in its own storage, such as a file on a disk,
+ * and matched packets are sent from there without being copied into the CS.
+ * Implementations embed this struct, like faces embed ndn_face_intf.
+ * @sa ndn_forwarder_set_cs_tier
+ */
+typedef struct ndn_cs_tier {
+  ndn_cs_tier_match match;
+  ndn_cs_tier_insert insert;
+} ndn_cs_tier_t;
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_CS_H_
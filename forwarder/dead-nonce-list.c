@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#include "dead-nonce-list.h"
+
+#define NDN_DEAD_NONCE_BUCKET_MASK (2 * NDN_DEAD_NONCE_LIST_SIZE - 1)
+
+#if (NDN_DEAD_NONCE_LIST_SIZE & (NDN_DEAD_NONCE_LIST_SIZE - 1)) != 0
+#error "NDN_DEAD_NONCE_LIST_SIZE must be a power of 2"
+#endif
+
+void
+ndn_dead_nonce_list_init(ndn_dead_nonce_list_t* self)
+{
+  uint32_t i;
+
+  self->head = 0;
+  self->count = 0;
+  for(i = 0; i < 2 * NDN_DEAD_NONCE_LIST_SIZE; i ++){
+    self->buckets[i] = NDN_DEAD_NONCE_EMPTY;
+  }
+}
+
+/** Find the bucket of a key.
+ * Returns the bucket, which is empty if the key is not in the index.
+ */
+static uint32_t
+ndn_dead_nonce_list_lookup(const ndn_dead_nonce_list_t* self, uint32_t key)
+{
+  uint32_t i = key & NDN_DEAD_NONCE_BUCKET_MASK;
+  while(self->buckets[i] != NDN_DEAD_NONCE_EMPTY && self->ring[self->buckets[i]].key != key){
+    i = (i + 1) & NDN_DEAD_NONCE_BUCKET_MASK;
+  }
+  return i;
+}
+
+static void
+ndn_dead_nonce_list_drop_oldest(ndn_dead_nonce_list_t* self)
+{
+  uint32_t pos = self->head;
+  uint32_t i = ndn_dead_nonce_list_lookup(self, self->ring[pos].key);
+  uint32_t j, home;
+
+  self->head = (pos + 1) % NDN_DEAD_NONCE_LIST_SIZE;
+  self->count --;
+  // A key added again points to its newer record, which stays
+  if(self->buckets[i] != pos){
+    return;
+  }
+  // Backward-shift deletion, as the PIT hash index
+  for(j = (i + 1) & NDN_DEAD_NONCE_BUCKET_MASK; self->buckets[j] != NDN_DEAD_NONCE_EMPTY;
+      j = (j + 1) & NDN_DEAD_NONCE_BUCKET_MASK)
+  {
+    home = self->ring[self->buckets[j]].key & NDN_DEAD_NONCE_BUCKET_MASK;
+    if(((j - home) & NDN_DEAD_NONCE_BUCKET_MASK) >= ((j - i) & NDN_DEAD_NONCE_BUCKET_MASK)){
+      self->buckets[i] = self->buckets[j];
+      i = j;
+    }
+  }
+  self->buckets[i] = NDN_DEAD_NONCE_EMPTY;
+}
+
+void
+ndn_dead_nonce_list_add(ndn_dead_nonce_list_t* self, uint32_t key, ndn_time_ms_t now)
+{
+  uint32_t pos;
+
+  while(self->count > 0 &&
+        (self->count == NDN_DEAD_NONCE_LIST_SIZE || self->ring[self->head].expiry <= now))
+  {
+    ndn_dead_nonce_list_drop_oldest(self);
+  }
+  pos = (self->head + self->count) % NDN_DEAD_NONCE_LIST_SIZE;
+  self->count ++;
+  self->ring[pos].key = key;
+  self->ring[pos].expiry = now + NDN_DEAD_NONCE_LIFETIME;
+  self->buckets[ndn_dead_nonce_list_lookup(self, key)] = pos;
+}
+
+bool
+ndn_dead_nonce_list_has(const ndn_dead_nonce_list_t* self, uint32_t key, ndn_time_ms_t now)
+{
+  uint32_t pos = self->buckets[ndn_dead_nonce_list_lookup(self, key)];
+  return pos != NDN_DEAD_NONCE_EMPTY && self->ring[pos].expiry > now;
+}
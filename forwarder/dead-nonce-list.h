@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_DEAD_NONCE_LIST_H_
+#define FORWARDER_DEAD_NONCE_LIST_H_
+
+#include "../ndn-constants.h"
+#include "../util/hash.h"
+#include "../util/uniform-time.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdDeadNonceList Dead Nonce List
+ * @brief Nonces forwarded by PIT entries which are gone
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/** A bucket of the Dead Nonce List with no record.
+ */
+#define NDN_DEAD_NONCE_EMPTY 0xFFFFFFFF
+
+/**
+ * A record of the Dead Nonce List.
+ */
+typedef struct ndn_dead_nonce {
+  /** Hash of the name and the nonce.
+   * @sa ndn_dead_nonce_key
+   */
+  uint32_t key;
+
+  /** The time the record is dropped.
+   */
+  ndn_time_ms_t expiry;
+} ndn_dead_nonce_t;
+
+/**
+ * Dead Nonce List.
+ *
+ * Remembers the nonces a PIT entry forwarded after the entry is gone,
+ * so an Interest coming back over a loop is still detected.
+ * Records are kept in a ring in the order they are added, and found through a hash index.
+ * The oldest record is dropped when it expires or the ring is full.
+ */
+typedef struct ndn_dead_nonce_list {
+  /** Position of the oldest record in @c ring.
+   */
+  uint32_t head;
+
+  /** Number of records in @c ring.
+   */
+  uint32_t count;
+
+  ndn_dead_nonce_t ring[NDN_DEAD_NONCE_LIST_SIZE];
+
+  /** Hash index of the positions in @c ring, linear probing.
+   * #NDN_DEAD_NONCE_EMPTY if the bucket is empty.
+   */
+  uint32_t buckets[2 * NDN_DEAD_NONCE_LIST_SIZE];
+} ndn_dead_nonce_list_t;
+
+/** Get the key of a nonce of a name.
+ * @param[in] name_hash The hash of the name, as ndn_parsed_name#hash.
+ * @param[in] nonce The nonce.
+ */
+static inline uint32_t
+ndn_dead_nonce_key(uint32_t name_hash, uint32_t nonce)
+{
+  return ndn_hash_update(name_hash, (const uint8_t*)&nonce, sizeof(nonce));
+}
+
+void
+ndn_dead_nonce_list_init(ndn_dead_nonce_list_t* self);
+
+/** Add a record, dropping the oldest one if the list is full.
+ * @param[in] key The key from ndn_dead_nonce_key().
+ * @param[in] now The time the nonce was last forwarded.
+ *            The record expires #NDN_DEAD_NONCE_LIFETIME after it.
+ */
+void
+ndn_dead_nonce_list_add(ndn_dead_nonce_list_t* self, uint32_t key, ndn_time_ms_t now);
+
+/** Check whether a record is in the list and not expired.
+ * @param[in] key The key from ndn_dead_nonce_key().
+ * @param[in] now The current time.
+ */
+bool
+ndn_dead_nonce_list_has(const ndn_dead_nonce_list_t* self, uint32_t key, ndn_time_ms_t now);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_DEAD_NONCE_LIST_H_
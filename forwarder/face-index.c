@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#include "face-index.h"
+
+void
+ndn_face_index_init(ndn_face_index_t* self, void* memory, uint32_t entry_count,
+                    ndn_table_id_t face_count)
+{
+  uint32_t link_count = NDN_FACE_INDEX_LINK_COUNT(entry_count), i;
+  ndn_face_link_t* links = (ndn_face_link_t*)memory;
+
+  self->links = links;
+  self->heads = (ndn_table_id_t*)&links[link_count];
+  self->face_count = face_count;
+  // The last ID is reserved for NDN_INVALID_ID
+  if(link_count > NDN_INVALID_ID){
+    link_count = NDN_INVALID_ID;
+  }
+  for(i = 0; i < link_count; i ++){
+    links[i].face_next = (i + 1 < link_count) ? i + 1 : NDN_INVALID_ID;
+  }
+  self->free_head = (link_count > 0) ? 0 : NDN_INVALID_ID;
+  for(i = 0; i < face_count; i ++){
+    self->heads[i] = NDN_INVALID_ID;
+  }
+  ndn_faceset_clear(&self->overflow);
+}
+
+void
+ndn_face_index_add(ndn_face_index_t* self, ndn_table_id_t* entry_links,
+                   ndn_table_id_t entry_id, ndn_table_id_t face_id)
+{
+  ndn_table_id_t id = self->free_head;
+  ndn_face_link_t* link;
+
+  if(id == NDN_INVALID_ID || face_id >= self->face_count){
+    ndn_faceset_add(&self->overflow, face_id);
+    return;
+  }
+  link = &self->links[id];
+  self->free_head = link->face_next;
+
+  link->entry_id = entry_id;
+  link->face_id = face_id;
+  link->face_prev = NDN_INVALID_ID;
+  link->face_next = self->heads[face_id];
+  if(link->face_next != NDN_INVALID_ID){
+    self->links[link->face_next].face_prev = id;
+  }
+  self->heads[face_id] = id;
+  link->entry_next = *entry_links;
+  *entry_links = id;
+}
+
+static void
+ndn_face_index_unlink(ndn_face_index_t* self, ndn_table_id_t id)
+{
+  ndn_face_link_t* link = &self->links[id];
+
+  if(link->face_prev != NDN_INVALID_ID){
+    self->links[link->face_prev].face_next = link->face_next;
+  }
+  else{
+    self->heads[link->face_id] = link->face_next;
+  }
+  if(link->face_next != NDN_INVALID_ID){
+    self->links[link->face_next].face_prev = link->face_prev;
+  }
+  link->face_next = self->free_head;
+  self->free_head = id;
+}
+
+void
+ndn_face_index_remove(ndn_face_index_t* self, ndn_table_id_t* entry_links, ndn_table_id_t face_id)
+{
+  ndn_table_id_t* prev = entry_links;
+  ndn_table_id_t id;
+
+  // Entries have a few faces, so a singly linked list is short enough
+  while((id = *prev) != NDN_INVALID_ID){
+    if(self->links[id].face_id == face_id){
+      *prev = self->links[id].entry_next;
+      ndn_face_index_unlink(self, id);
+      return;
+    }
+    prev = &self->links[id].entry_next;
+  }
+}
+
+void
+ndn_face_index_remove_all(ndn_face_index_t* self, ndn_table_id_t* entry_links)
+{
+  ndn_table_id_t id, next;
+
+  for(id = *entry_links; id != NDN_INVALID_ID; id = next){
+    next = self->links[id].entry_next;
+    ndn_face_index_unlink(self, id);
+  }
+  *entry_links = NDN_INVALID_ID;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_FACE_INDEX_H_
+#define FORWARDER_FACE_INDEX_H_
+
+#include "faceset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdFaceIndex Face Index
+ * @brief Reverse index from faces to table entries
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * A link recording that a table entry references a face.
+ *
+ * Every link is in two lists: the doubly linked list of its face,
+ * and the singly linked list of its entry.
+ */
+typedef struct ndn_face_link {
+  ndn_table_id_t entry_id;
+  ndn_table_id_t face_id;
+
+  /** Previous link of the same face.
+   */
+  ndn_table_id_t face_prev;
+
+  /** Next link of the same face. Next free link if the link is not used.
+   */
+  ndn_table_id_t face_next;
+
+  /** Next link of the same entry.
+   */
+  ndn_table_id_t entry_next;
+} ndn_face_link_t;
+
+/**
+ * Reverse index from faces to the entries of a PIT or FIB,
+ * so that removing a face only visits the entries referencing it.
+ *
+ * Links come from a fixed pool. When it runs out, the face is marked as overflowed,
+ * and removing it falls back to scanning the whole table.
+ */
+typedef struct ndn_face_index {
+  /** Head of the free link list.
+   */
+  ndn_table_id_t free_head;
+
+  /** Number of faces in @c heads. Larger face IDs are never linked, as if overflowed.
+   */
+  ndn_table_id_t face_count;
+
+  /** First link of every face.
+   */
+  ndn_table_id_t* heads;
+
+  /** Faces some of whose entries are not linked.
+   */
+  ndn_faceset_t overflow;
+
+  ndn_face_link_t* links;
+} ndn_face_index_t;
+
+/** The number of links for @c entry_count entries,
+ * which is enough if entries have #NDN_MAX_FACE_PER_PIT_ENTRY faces on average.
+ */
+#define NDN_FACE_INDEX_LINK_COUNT(entry_count) (NDN_MAX_FACE_PER_PIT_ENTRY * (entry_count))
+
+/** The size of the links for @c entry_count entries and the heads of @c face_count faces.
+ */
+#define NDN_FACE_INDEX_RESERVE_SIZE(entry_count, face_count) \
+  (sizeof(ndn_face_link_t) * NDN_FACE_INDEX_LINK_COUNT(entry_count) + \
+   sizeof(ndn_table_id_t) * (face_count))
+
+/** Initialize a face index.
+ * @param[in] memory Memory of #NDN_FACE_INDEX_RESERVE_SIZE, aligned for ndn_face_link_t.
+ * @param[in] entry_count The number of entries of the table.
+ * @param[in] face_count The number of faces, at most #NDN_FACESET_CAPACITY.
+ */
+void
+ndn_face_index_init(ndn_face_index_t* self, void* memory, uint32_t entry_count,
+                    ndn_table_id_t face_count);
+
+/** Record that an entry references a face.
+ * @param[in, out] entry_links The head of the entry's link list.
+ * @param[in] entry_id The ID of the entry.
+ * @param[in] face_id The face, not yet recorded for the entry.
+ */
+void
+ndn_face_index_add(ndn_face_index_t* self, ndn_table_id_t* entry_links,
+                   ndn_table_id_t entry_id, ndn_table_id_t face_id);
+
+/** Forget that an entry references a face. No effect if it's not recorded.
+ */
+void
+ndn_face_index_remove(ndn_face_index_t* self, ndn_table_id_t* entry_links, ndn_table_id_t face_id);
+
+/** Forget all faces of an entry.
+ */
+void
+ndn_face_index_remove_all(ndn_face_index_t* self, ndn_table_id_t* entry_links);
+
+/** Get an entry referencing a face.
+ * @return The ID of the entry. #NDN_INVALID_ID if none is linked.
+ */
+static inline ndn_table_id_t
+ndn_face_index_first(const ndn_face_index_t* self, ndn_table_id_t face_id)
+{
+  ndn_table_id_t link = (face_id < self->face_count) ? self->heads[face_id] : NDN_INVALID_ID;
+  return (link == NDN_INVALID_ID) ? NDN_INVALID_ID : self->links[link].entry_id;
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_FACE_INDEX_H_
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#include "face-queue.h"
+#include "../ndn-error-code.h"
+#include "../encode/tlv.h"
+#include "../encode/forwarder-helper.h"
+#include <string.h>
+
+/** The room kept before a packet, where a CongestionMark header is written if it is marked.
+ * Only Data are marked.
+ */
+static uint32_t
+ndn_face_queue_headroom(const uint8_t* packet)
+{
+  return packet[0] == TLV_Data ? NDN_FACE_QUEUE_MARK_HEADROOM : 0;
+}
+
+/** Position of the room taken by an item in ndn_face_queue#buffer.
+ */
+static uint32_t
+ndn_face_queue_item_start(const ndn_face_queue_t* self, const ndn_face_queue_item_t* item)
+{
+  return item->offset - ndn_face_queue_headroom(&self->buffer[item->offset]);
+}
+
+void
+ndn_face_queue_init(ndn_face_queue_t* self)
+{
+  self->head = 0;
+  self->count = 0;
+  self->first_above_time = 0;
+  self->mark_next = 0;
+  self->mark_count = 0;
+  self->marking = false;
+  self->drop_time = 0;
+  self->dropped = 0;
+  self->timed_out = 0;
+  self->marked = 0;
+}
+
+bool
+ndn_face_queue_push(ndn_face_queue_t* self, const uint8_t* packet, size_t length, ndn_time_ms_t now)
+{
+  ndn_face_queue_item_t* item;
+  uint32_t head_start, tail_start, tail_end, start, size;
+
+  if(self->count >= NDN_FACE_QUEUE_SIZE || length == 0 ||
+     length > NDN_FACE_QUEUE_BYTES - ndn_face_queue_headroom(packet)){
+    self->dropped ++;
+    return false;
+  }
+  size = ndn_face_queue_headroom(packet) + (uint32_t)length;
+  if(self->count == 0){
+    start = 0;
+  }
+  else{
+    // Packets are contiguous: after the tail, or from the start if the tail is too close to the end
+    head_start = ndn_face_queue_item_start(self, &self->items[self->head]);
+    item = &self->items[(self->head + self->count - 1) % NDN_FACE_QUEUE_SIZE];
+    tail_start = ndn_face_queue_item_start(self, item);
+    tail_end = item->offset + item->length;
+    if(tail_start >= head_start && size <= NDN_FACE_QUEUE_BYTES - tail_end){
+      start = tail_end;
+    }
+    else if(tail_start >= head_start && size <= head_start){
+      start = 0;
+    }
+    else if(tail_start < head_start && size <= head_start - tail_end){
+      start = tail_end;
+    }
+    else{
+      self->dropped ++;
+      return false;
+    }
+  }
+  item = &self->items[(self->head + self->count) % NDN_FACE_QUEUE_SIZE];
+  item->offset = start + size - (uint32_t)length;
+  item->length = (uint32_t)length;
+  item->enqueue_time = now;
+  memcpy(&self->buffer[item->offset], packet, length);
+  self->count ++;
+  return true;
+}
+
+uint8_t*
+ndn_face_queue_front(ndn_face_queue_t* self, size_t* length)
+{
+  if(self->count == 0){
+    return NULL;
+  }
+  *length = self->items[self->head].length;
+  return &self->buffer[self->items[self->head].offset];
+}
+
+uint8_t*
+ndn_face_queue_mark_front(ndn_face_queue_t* self, size_t* length)
+{
+  ndn_face_queue_item_t* item = &self->items[self->head];
+  uint8_t header[NDN_FACE_QUEUE_MARK_HEADROOM];
+  size_t header_len;
+
+  if(ndn_face_queue_headroom(&self->buffer[item->offset]) == 0 ||
+     tlv_make_congestion_mark_header(header, sizeof(header), item->length, 1, &header_len) != NDN_SUCCESS){
+    return NULL;
+  }
+  // The header ends where the packet starts. Writing it again, if the face refused it, changes nothing.
+  memcpy(&self->buffer[item->offset - header_len], header, header_len);
+  *length = header_len + item->length;
+  return &self->buffer[item->offset - header_len];
+}
+
+/** Integer square root of x.
+ */
+static uint32_t
+ndn_face_queue_isqrt(uint32_t x)
+{
+  uint32_t ret = 0, bit = 1u << 30;
+
+  while(bit > x){
+    bit >>= 2;
+  }
+  while(bit != 0){
+    if(x >= ret + bit){
+      x -= ret + bit;
+      ret = (ret >> 1) + bit;
+    }
+    else{
+      ret >>= 1;
+    }
+    bit >>= 2;
+  }
+  return ret;
+}
+
+/** The time after @c t to mark the next packet: the interval divided by the square root of the count.
+ */
+static ndn_time_ms_t
+ndn_face_queue_control_law(const ndn_face_queue_t* self, ndn_time_ms_t t)
+{
+  uint32_t count = (self->mark_count < 0xFFFF) ? self->mark_count : 0xFFFF;
+  // Both sides are scaled by 256
+  return t + (ndn_time_ms_t)NDN_CODEL_INTERVAL * 256 / ndn_face_queue_isqrt(count << 16);
+}
+
+bool
+ndn_face_queue_should_mark(const ndn_face_queue_t* self, ndn_time_ms_t now)
+{
+  ndn_time_ms_t sojourn = now - self->items[self->head].enqueue_time;
+
+  if(sojourn < NDN_CODEL_TARGET || self->first_above_time == 0){
+    return false;
+  }
+  if(!self->marking){
+    return now >= self->first_above_time;
+  }
+  return now >= self->mark_next;
+}
+
+void
+ndn_face_queue_pop(ndn_face_queue_t* self, ndn_time_ms_t now)
+{
+  ndn_time_ms_t sojourn = now - self->items[self->head].enqueue_time;
+  bool mark = ndn_face_queue_should_mark(self, now);
+
+  self->head = (self->head + 1) % NDN_FACE_QUEUE_SIZE;
+  self->count --;
+  self->drop_time = 0;
+
+  if(sojourn < NDN_CODEL_TARGET){
+    self->first_above_time = 0;
+    self->marking = false;
+    return;
+  }
+  if(self->first_above_time == 0){
+    self->first_above_time = now + NDN_CODEL_INTERVAL;
+  }
+  else if(mark && !self->marking){
+    self->marking = true;
+    self->mark_count = 1;
+    self->mark_next = ndn_face_queue_control_law(self, now);
+  }
+  else if(mark){
+    self->mark_count ++;
+    self->mark_next = ndn_face_queue_control_law(self, self->mark_next);
+  }
+  if(mark){
+    self->marked ++;
+  }
+}
+
+bool
+ndn_face_queue_refuse(ndn_face_queue_t* self, ndn_time_ms_t now)
+{
+  if(self->drop_time == 0){
+    self->drop_time = now + NDN_FACE_QUEUE_SEND_TIMEOUT;
+    return false;
+  }
+  if(now < self->drop_time){
+    return false;
+  }
+  // Not a pop: the packet was never sent, so it tells nothing of the wait
+  self->head = (self->head + 1) % NDN_FACE_QUEUE_SIZE;
+  self->count --;
+  self->drop_time = 0;
+  self->timed_out ++;
+  return true;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_FACE_QUEUE_H_
+#define FORWARDER_FACE_QUEUE_H_
+
+#include "../ndn-constants.h"
+#include "../util/uniform-time.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdFaceQueue Face Queue
+ * @brief Bounded transmit queue of a face with CoDel congestion marking
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * A packet in a face queue.
+ */
+typedef struct ndn_face_queue_item {
+  /** The time the packet was queued.
+   */
+  ndn_time_ms_t enqueue_time;
+
+  /** Position of the packet in ndn_face_queue#buffer.
+   * Data have #NDN_FACE_QUEUE_MARK_HEADROOM bytes free before them.
+   */
+  uint32_t offset;
+
+  uint32_t length;
+} ndn_face_queue_item_t;
+
+/**
+ * Transmit queue of a face.
+ *
+ * Packets are kept in order in a ring of bytes, so small packets don't take a full slot each.
+ * A packet which doesn't fit is dropped.
+ *
+ * The time packets wait is tracked as CoDel (RFC 8289) does, but packets are marked instead of dropped:
+ * once it stays above #NDN_CODEL_TARGET for #NDN_CODEL_INTERVAL, a packet is marked,
+ * then the next ones at intervals shrinking with the square root of the number marked,
+ * until a packet waits less than the target.
+ *
+ * A packet the face keeps refusing for #NDN_FACE_QUEUE_SEND_TIMEOUT is dropped,
+ * so a stuck face can't hold the queue forever.
+ */
+typedef struct ndn_face_queue {
+  ndn_face_queue_item_t items[NDN_FACE_QUEUE_SIZE];
+
+  /** Position of the oldest item in @c items.
+   */
+  uint16_t head;
+
+  /** Number of items.
+   */
+  uint16_t count;
+
+  /** The time the wait will have been above the target for an interval.
+   * 0 if the wait is below the target.
+   */
+  ndn_time_ms_t first_above_time;
+
+  /** The time to mark the next packet, if @c marking.
+   */
+  ndn_time_ms_t mark_next;
+
+  /** Packets marked since @c marking was set.
+   */
+  uint32_t mark_count;
+
+  /** Whether packets are being marked.
+   */
+  bool marking;
+
+  /** The time the packet at the head is dropped if the face still refuses it.
+   * 0 if the face has not refused it.
+   */
+  ndn_time_ms_t drop_time;
+
+  /** Packets dropped because the queue was full.
+   */
+  uint32_t dropped;
+
+  /** Packets dropped because the face refused them for #NDN_FACE_QUEUE_SEND_TIMEOUT.
+   */
+  uint32_t timed_out;
+
+  /** Packets marked.
+   */
+  uint32_t marked;
+
+  uint8_t buffer[NDN_FACE_QUEUE_BYTES];
+} ndn_face_queue_t;
+
+/** Initialize an empty queue.
+ */
+void
+ndn_face_queue_init(ndn_face_queue_t* self);
+
+/** Check whether a queue is empty.
+ */
+static inline bool
+ndn_face_queue_is_empty(const ndn_face_queue_t* self)
+{
+  return self->count == 0;
+}
+
+/** Add a packet at the tail.
+ * @param[in] now The current time.
+ * @return Whether the packet was queued. If not, ndn_face_queue#dropped is increased.
+ */
+bool
+ndn_face_queue_push(ndn_face_queue_t* self, const uint8_t* packet, size_t length, ndn_time_ms_t now);
+
+/** Get the packet at the head.
+ * @param[out] length The length of the packet.
+ * @return The packet. @c NULL if the queue is empty.
+ */
+uint8_t*
+ndn_face_queue_front(ndn_face_queue_t* self, size_t* length);
+
+/** Put a CongestionMark on the packet at the head, for sending it in place of ndn_face_queue_front().
+ *
+ * The NDNLPv2 header is written into the room kept before the packet, so nothing is copied.
+ * @param[out] length The length of the marked packet.
+ * @return The marked packet. @c NULL if the packet is not a Data, which is never marked.
+ * @pre The queue is not empty.
+ */
+uint8_t*
+ndn_face_queue_mark_front(ndn_face_queue_t* self, size_t* length);
+
+/** Check whether the packet at the head should be marked, by the time it waited.
+ * @param[in] now The current time.
+ * @pre The queue is not empty.
+ */
+bool
+ndn_face_queue_should_mark(const ndn_face_queue_t* self, ndn_time_ms_t now);
+
+/** Remove the packet at the head, once the face sent it.
+ * @param[in] now The current time, as given to ndn_face_queue_should_mark().
+ * @pre The queue is not empty.
+ */
+void
+ndn_face_queue_pop(ndn_face_queue_t* self, ndn_time_ms_t now);
+
+/** Note that the face refused the packet at the head,
+ * and drop it if the face has refused it for #NDN_FACE_QUEUE_SEND_TIMEOUT.
+ * @param[in] now The current time.
+ * @return Whether the packet was dropped. If so, ndn_face_queue#timed_out is increased.
+ * @pre The queue is not empty.
+ */
+bool
+ndn_face_queue_refuse(ndn_face_queue_t* self, ndn_time_ms_t now);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_FACE_QUEUE_H_
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_FACESET_H_
+#define FORWARDER_FACESET_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../ndn-constants.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdFaceSet Face Set
+ * @brief A set of face IDs
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/** Number of 64-bit words in a face set.
+ */
+#define NDN_FACESET_WORDS ((NDN_FACESET_CAPACITY + 63) / 64)
+
+/**
+ * A set of face IDs smaller than #NDN_FACESET_CAPACITY.
+ *
+ * A bitmap of fixed size, which is a single word by default.
+ * Set operations are loops of a constant trip count, so compilers unroll or vectorize them.
+ * Every set pays for the capacity however few faces it holds, so a large capacity is
+ * for gateways with many faces; sets which grow on demand would cost a pointer and a pool instead.
+ */
+typedef struct ndn_faceset {
+  uint64_t words[NDN_FACESET_WORDS];
+} ndn_faceset_t;
+
+static inline void
+ndn_faceset_clear(ndn_faceset_t* self)
+{
+  int i;
+  for(i = 0; i < NDN_FACESET_WORDS; i ++){
+    self->words[i] = 0;
+  }
+}
+
+static inline void
+ndn_faceset_add(ndn_faceset_t* self, ndn_table_id_t face_id)
+{
+  self->words[face_id / 64] |= (uint64_t)1 << (face_id % 64);
+}
+
+static inline void
+ndn_faceset_remove(ndn_faceset_t* self, ndn_table_id_t face_id)
+{
+  self->words[face_id / 64] &= ~((uint64_t)1 << (face_id % 64));
+}
+
+static inline bool
+ndn_faceset_contains(const ndn_faceset_t* self, ndn_table_id_t face_id)
+{
+  return (self->words[face_id / 64] >> (face_id % 64)) & 1;
+}
+
+static inline bool
+ndn_faceset_is_empty(const ndn_faceset_t* self)
+{
+  uint64_t any = 0;
+  int i;
+  for(i = 0; i < NDN_FACESET_WORDS; i ++){
+    any |= self->words[i];
+  }
+  return any == 0;
+}
+
+/** <tt>self |= other</tt>
+ */
+static inline void
+ndn_faceset_union(ndn_faceset_t* self, const ndn_faceset_t* other)
+{
+  int i;
+  for(i = 0; i < NDN_FACESET_WORDS; i ++){
+    self->words[i] |= other->words[i];
+  }
+}
+
+/** <tt>ret = lhs & ~rhs</tt>
+ */
+static inline void
+ndn_faceset_difference(ndn_faceset_t* ret, const ndn_faceset_t* lhs, const ndn_faceset_t* rhs)
+{
+  int i;
+  for(i = 0; i < NDN_FACESET_WORDS; i ++){
+    ret->words[i] = lhs->words[i] & ~rhs->words[i];
+  }
+}
+
+static inline int
+ndn_faceset_ctz(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(word);
+#else
+  int n = 0;
+  while((word & 1) == 0){
+    word >>= 1;
+    n ++;
+  }
+  return n;
+#endif
+}
+
+/** Find the smallest face ID in the set which is not less than @c from.
+ * @return The face ID. #NDN_INVALID_ID if none.
+ */
+static inline ndn_table_id_t
+ndn_faceset_next(const ndn_faceset_t* self, ndn_table_id_t from)
+{
+  int i = from / 64;
+  uint64_t word;
+
+  if(from >= NDN_FACESET_WORDS * 64){
+    return NDN_INVALID_ID;
+  }
+  word = self->words[i] & (~(uint64_t)0 << (from % 64));
+  while(word == 0){
+    if(++ i == NDN_FACESET_WORDS){
+      return NDN_INVALID_ID;
+    }
+    word = self->words[i];
+  }
+  return (ndn_table_id_t)(i * 64 + ndn_faceset_ctz(word));
+}
+
+/** Iterate over the face IDs of a set in ascending order.
+ * @param[in] set Pointer to the set.
+ * @param[out] id A #ndn_table_id_t variable.
+ */
+#define NDN_FACESET_FOREACH(set, id) \
+  for((id) = ndn_faceset_next((set), 0); \
+      (id) != NDN_INVALID_ID; \
+      (id) = ndn_faceset_next((set), (id) + 1))
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_FACESET_H_
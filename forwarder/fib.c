@@ -9,18 +9,38 @@
  */
 
 #include "fib.h"
+#include "../encode/tlv.h"
+#include "../encode/forwarder-helper.h"
+#include "../util/hash.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+static inline void
+ndn_fib_clear_costs(ndn_fib_entry_t* self)
+{
+  int i;
+  for(i = 0; i < NDN_MAX_COST_PER_FIB_ENTRY; i ++){
+    self->costs[i].face_id = NDN_INVALID_ID;
+  }
+}
 
 static inline void
 ndn_fib_entry_reset(ndn_fib_entry_t* self)
 {
+#if NDN_FIB_HASH_ENGINE
+  self->node_id = NDN_INVALID_ID;
+#else
   self->nametree_id = NDN_INVALID_ID;
-  self->nexthop = 0;
+#endif
+  ndn_faceset_clear(&self->nexthop);
+  ndn_fib_clear_costs(self);
+  self->rr_counter = 0;
   self->on_interest = NULL;
   self->userdata = NULL;
 }
 
 void
-ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree)
+ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_table_id_t face_count, ndn_nametree_t* nametree)
 {
   ndn_table_id_t i;
   ndn_fib_t* self = (ndn_fib_t*)memory;
@@ -28,48 +48,427 @@ ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree)
   self->nametree = nametree;
   for(i = 0; i < capacity; i ++){
     ndn_fib_entry_reset(&self->slots[i]);
+    self->slots[i].next_free = (i + 1 < capacity) ? i + 1 : NDN_INVALID_ID;
+    self->slots[i].face_links = NDN_INVALID_ID;
+    self->slots[i].measurements = NDN_INVALID_ID;
+  }
+  self->free_head = (capacity > 0) ? 0 : NDN_INVALID_ID;
+  ndn_measurements_init(&self->measurements, (ndn_measurement_t*)&self->slots[capacity],
+                        NDN_MEASUREMENTS_COUNT((uint32_t)capacity));
+
+#if NDN_FIB_HASH_ENGINE
+  uint32_t bucket_count = 2, j;
+  self->node_capacity = NDN_FIB_NODE_COUNT(capacity);
+  self->nodes = (ndn_fib_node_t*)&self->measurements.records[NDN_MEASUREMENTS_COUNT((uint32_t)capacity)];
+  for(i = 0; i < self->node_capacity; i ++){
+    self->nodes[i].entry_id = NDN_INVALID_ID;
+    self->nodes[i].marker_refs = 0;
+    self->nodes[i].next_free = (i + 1 < self->node_capacity) ? i + 1 : NDN_INVALID_ID;
   }
+  self->free_node_head = (self->node_capacity > 0) ? 0 : NDN_INVALID_ID;
+  self->free_node_count = self->node_capacity;
+
+  while(bucket_count < 2 * (uint32_t)self->node_capacity){
+    bucket_count <<= 1;
+  }
+  self->bucket_mask = bucket_count - 1;
+  self->buckets = (ndn_fib_bucket_t*)&self->nodes[self->node_capacity];
+  for(j = 0; j < bucket_count; j ++){
+    self->buckets[j].hash = 0;
+    self->buckets[j].node_id = NDN_INVALID_ID;
+  }
+  self->names = (uint8_t*)&self->buckets[NDN_FIB_BUCKET_RESERVE((uint32_t)self->node_capacity)];
+  ndn_face_index_init(&self->face_index,
+                      self->names + (size_t)self->node_capacity * NDN_NAME_MAX_BLOCK_SIZE,
+                      capacity, face_count);
+#else
+  ndn_face_index_init(&self->face_index,
+                      &self->measurements.records[NDN_MEASUREMENTS_COUNT((uint32_t)capacity)],
+                      capacity, face_count);
+#endif
 }
 
-static inline void
-ndn_fib_remove_entry(ndn_fib_t* self, ndn_fib_entry_t* entry)
+static ndn_table_id_t
+ndn_fib_alloc_entry(ndn_fib_t* self)
 {
-  ndn_nametree_at(self->nametree, entry->nametree_id)->fib_id = NDN_INVALID_ID;
+  ndn_table_id_t id = self->free_head;
+  if(id == NDN_INVALID_ID){
+    return NDN_INVALID_ID;
+  }
+  self->free_head = self->slots[id].next_free;
+  ndn_fib_entry_reset(&self->slots[id]);
+  return id;
+}
+
+static void
+ndn_fib_free_entry(ndn_fib_t* self, ndn_fib_entry_t* entry)
+{
+  ndn_face_index_remove_all(&self->face_index, &entry->face_links);
+  ndn_measurements_remove_all(&self->measurements, &entry->measurements);
   ndn_fib_entry_reset(entry);
+  entry->next_free = self->free_head;
+  self->free_head = entry - &self->slots[0];
 }
 
-void
-ndn_fib_remove_entry_if_empty(ndn_fib_t* self, ndn_fib_entry_t* entry)
+#if NDN_FIB_HASH_ENGINE
+
+static inline uint8_t*
+ndn_fib_name_at(ndn_fib_t* self, ndn_table_id_t id)
 {
-  if(entry->nametree_id == NDN_INVALID_ID){
-    return;
+  return self->names + (size_t)id * NDN_NAME_MAX_BLOCK_SIZE;
+}
+
+/** Look up a prefix in the hash index.
+ * Returns the node's ID, or #NDN_INVALID_ID with @c pos set to the empty bucket to insert into.
+ */
+static ndn_table_id_t
+ndn_fib_index_lookup(ndn_fib_t* self, uint32_t hash, uint8_t depth,
+                     const uint8_t* comps, size_t comp_len, uint32_t* pos)
+{
+  uint32_t i = hash & self->bucket_mask;
+  ndn_table_id_t id;
+  while((id = self->buckets[i].node_id) != NDN_INVALID_ID){
+    if(self->buckets[i].hash == hash &&
+       self->nodes[id].depth == depth &&
+       self->nodes[id].name_len == comp_len &&
+       memcmp(ndn_fib_name_at(self, id), comps, comp_len) == 0)
+    {
+      break;
+    }
+    i = (i + 1) & self->bucket_mask;
   }
-  if(entry->nexthop == 0 && entry->on_interest == NULL){
-    ndn_fib_remove_entry(self, entry);
+  if(pos != NULL){
+    *pos = i;
   }
+  return id;
 }
 
-void
-ndn_fib_unregister_face(ndn_fib_t* self, ndn_table_id_t face_id)
+static void
+ndn_fib_index_remove(ndn_fib_t* self, ndn_table_id_t id)
+{
+  uint32_t mask = self->bucket_mask;
+  uint32_t i = self->nodes[id].hash & mask;
+  uint32_t j, home;
+
+  while(self->buckets[i].node_id != id){
+    i = (i + 1) & mask;
+  }
+  // Backward-shift deletion, same as the PIT
+  for(j = (i + 1) & mask; self->buckets[j].node_id != NDN_INVALID_ID; j = (j + 1) & mask){
+    home = self->buckets[j].hash & mask;
+    if(((j - home) & mask) >= ((j - i) & mask)){
+      self->buckets[i] = self->buckets[j];
+      i = j;
+    }
+  }
+  self->buckets[i].node_id = NDN_INVALID_ID;
+}
+
+/** Compute the hash and the length of every prefix of a node.
+ * The components were validated when the node was created.
+ */
+static void
+ndn_fib_node_prefixes(ndn_fib_t* self, ndn_table_id_t id, uint32_t* hashes, size_t* lens)
 {
-  for (ndn_table_id_t i = 0; i < self -> capacity; ++i) {
-    self->slots[i].nexthop = bitset_unset(self->slots[i].nexthop , face_id);
-    ndn_fib_remove_entry_if_empty(self, &self->slots[i]);
+  uint8_t* comps = ndn_fib_name_at(self, id);
+  uint8_t* end = comps + self->nodes[id].name_len;
+  uint8_t* ptr = comps;
+  uint8_t* comp;
+  uint32_t type, len;
+  uint8_t d;
+
+  hashes[0] = NDN_HASH_INIT;
+  lens[0] = 0;
+  for(d = 1; d <= self->nodes[id].depth; d ++){
+    comp = ptr;
+    ptr = tlv_get_type_length(ptr, end - ptr, &type, &len);
+    ptr += len;
+    hashes[d] = ndn_hash_update(hashes[d - 1], comp, ptr - comp);
+    lens[d] = ptr - comps;
   }
 }
 
+/** The FIB entry of the longest route which is a prefix of the node, including itself.
+ */
 static ndn_table_id_t
-ndn_fib_add_new_entry(ndn_fib_t* fib , int nametree_id)
+ndn_fib_node_bmp(ndn_fib_t* self, ndn_table_id_t id)
 {
-  ndn_table_id_t i;
-  for (i = 0; i < fib -> capacity; ++i) {
-    if (fib->slots[i].nametree_id == NDN_INVALID_ID) {
-      ndn_fib_entry_reset(&fib->slots[i]);
-      fib->slots[i].nametree_id = nametree_id;
-      return i;
+  uint32_t hashes[NDN_FWD_NAME_MAX_COMPONENTS + 1];
+  size_t lens[NDN_FWD_NAME_MAX_COMPONENTS + 1];
+  uint8_t* comps = ndn_fib_name_at(self, id);
+  ndn_table_id_t bmp = NDN_INVALID_ID;
+  ndn_table_id_t prefix_id;
+  uint8_t d;
+
+  ndn_fib_node_prefixes(self, id, hashes, lens);
+  for(d = 0; d <= self->nodes[id].depth; d ++){
+    prefix_id = ndn_fib_index_lookup(self, hashes[d], d, comps, lens[d], NULL);
+    if(prefix_id != NDN_INVALID_ID && self->nodes[prefix_id].entry_id != NDN_INVALID_ID){
+      bmp = self->nodes[prefix_id].entry_id;
+    }
+  }
+  return bmp;
+}
+
+/** Recompute the best matching prefix of every node under a route which was added or removed.
+ * Route changes are rare compared to lookups, so a full scan is acceptable.
+ */
+static void
+ndn_fib_refresh_bmp(ndn_fib_t* self, ndn_table_id_t route_id)
+{
+  uint8_t* route = ndn_fib_name_at(self, route_id);
+  size_t route_len = self->nodes[route_id].name_len;
+  uint32_t j;
+  ndn_table_id_t id;
+
+  for(j = 0; j <= self->bucket_mask; j ++){
+    id = self->buckets[j].node_id;
+    if(id == NDN_INVALID_ID ||
+       self->nodes[id].name_len < route_len ||
+       memcmp(ndn_fib_name_at(self, id), route, route_len) != 0)
+    {
+      continue;
     }
+    self->nodes[id].bmp = ndn_fib_node_bmp(self, id);
   }
-  return NDN_INVALID_ID;
+}
+
+/** The prefix lengths where a route of @c depth needs a marker.
+ * These are the lengths probed by a lookup before it reaches @c depth.
+ * @return The number of markers.
+ */
+static uint8_t
+ndn_fib_marker_depths(uint8_t depth, uint8_t* markers)
+{
+  uint8_t lo = 1, hi = NDN_FWD_NAME_MAX_COMPONENTS, mid, count = 0;
+  while(lo <= hi){
+    mid = (lo + hi) / 2;
+    if(mid < depth){
+      markers[count ++] = mid;
+      lo = mid + 1;
+    }
+    else if(mid > depth){
+      hi = mid - 1;
+    }
+    else{
+      break;
+    }
+  }
+  return count;
+}
+
+/** Find a node, or create it if it does not exist.
+ * The caller must make sure there is a free node.
+ */
+static ndn_table_id_t
+ndn_fib_node_get(ndn_fib_t* self, uint32_t hash, uint8_t depth, const uint8_t* comps, size_t comp_len)
+{
+  uint32_t pos;
+  ndn_table_id_t id = ndn_fib_index_lookup(self, hash, depth, comps, comp_len, &pos);
+  if(id != NDN_INVALID_ID){
+    return id;
+  }
+  id = self->free_node_head;
+  self->free_node_head = self->nodes[id].next_free;
+  self->free_node_count --;
+
+  self->nodes[id].hash = hash;
+  self->nodes[id].depth = depth;
+  self->nodes[id].name_len = comp_len;
+  self->nodes[id].entry_id = NDN_INVALID_ID;
+  self->nodes[id].marker_refs = 0;
+  memcpy(ndn_fib_name_at(self, id), comps, comp_len);
+  self->buckets[pos].hash = hash;
+  self->buckets[pos].node_id = id;
+  self->nodes[id].bmp = ndn_fib_node_bmp(self, id);
+  return id;
+}
+
+/** Free a node if it is neither a route nor a marker.
+ */
+static void
+ndn_fib_node_release(ndn_fib_t* self, ndn_table_id_t id)
+{
+  if(self->nodes[id].entry_id != NDN_INVALID_ID || self->nodes[id].marker_refs > 0){
+    return;
+  }
+  ndn_fib_index_remove(self, id);
+  self->nodes[id].next_free = self->free_node_head;
+  self->free_node_head = id;
+  self->free_node_count ++;
+}
+
+/** Recompute the best matching prefix of every node, after several routes were removed at once.
+ */
+static void
+ndn_fib_refresh_all_bmp(ndn_fib_t* self)
+{
+  uint32_t j;
+  ndn_table_id_t id;
+
+  for(j = 0; j <= self->bucket_mask; j ++){
+    id = self->buckets[j].node_id;
+    if(id != NDN_INVALID_ID){
+      self->nodes[id].bmp = ndn_fib_node_bmp(self, id);
+    }
+  }
+}
+
+/** Remove a route.
+ * @param[in] refresh Whether to refresh the nodes under it.
+ *            If @c false, the caller must call ndn_fib_refresh_all_bmp() afterwards.
+ */
+static inline void
+ndn_fib_remove_entry(ndn_fib_t* self, ndn_fib_entry_t* entry, bool refresh)
+{
+  uint32_t hashes[NDN_FWD_NAME_MAX_COMPONENTS + 1];
+  size_t lens[NDN_FWD_NAME_MAX_COMPONENTS + 1];
+  uint8_t markers[NDN_FWD_NAME_MAX_COMPONENTS];
+  ndn_table_id_t node_id = entry->node_id;
+  uint8_t* comps = ndn_fib_name_at(self, node_id);
+  uint8_t count, i;
+
+  self->nodes[node_id].entry_id = NDN_INVALID_ID;
+  if(refresh){
+    ndn_fib_refresh_bmp(self, node_id);
+  }
+
+  ndn_fib_node_prefixes(self, node_id, hashes, lens);
+  count = ndn_fib_marker_depths(self->nodes[node_id].depth, markers);
+  for(i = 0; i < count; i ++){
+    ndn_table_id_t marker_id = ndn_fib_index_lookup(self, hashes[markers[i]], markers[i],
+                                                    comps, lens[markers[i]], NULL);
+    self->nodes[marker_id].marker_refs --;
+    ndn_fib_node_release(self, marker_id);
+  }
+  ndn_fib_node_release(self, node_id);
+  ndn_fib_free_entry(self, entry);
+}
+
+ndn_fib_entry_t*
+ndn_fib_find_or_insert(ndn_fib_t* self, uint8_t* prefix, size_t length)
+{
+  ndn_parsed_name_t name;
+  uint8_t markers[NDN_FWD_NAME_MAX_COMPONENTS];
+  uint8_t depth, count, i;
+  ndn_table_id_t node_id, entry_id, needed;
+
+  if(tlv_name_parse(prefix, length, &name) != NDN_SUCCESS ||
+     name.count > NDN_FWD_NAME_MAX_COMPONENTS || name.comp_len > NDN_NAME_MAX_BLOCK_SIZE){
+    return NULL;
+  }
+  depth = name.count;
+  node_id = ndn_fib_index_lookup(self, name.hash, depth, name.comps, name.comp_len, NULL);
+  if(node_id != NDN_INVALID_ID && self->nodes[node_id].entry_id != NDN_INVALID_ID){
+    return &self->slots[self->nodes[node_id].entry_id];
+  }
+  if(self->free_head == NDN_INVALID_ID){
+    return NULL;
+  }
+
+  // Reserve every node before changing anything, so a full table leaves no partial route
+  count = ndn_fib_marker_depths(depth, markers);
+  needed = (node_id == NDN_INVALID_ID) ? 1 : 0;
+  for(i = 0; i < count; i ++){
+    if(ndn_fib_index_lookup(self, name.hashes[markers[i]], markers[i],
+                            name.comps, name.lens[markers[i]], NULL) == NDN_INVALID_ID){
+      needed ++;
+    }
+  }
+  if(needed > self->free_node_count){
+    return NULL;
+  }
+
+  for(i = 0; i < count; i ++){
+    ndn_table_id_t marker_id = ndn_fib_node_get(self, name.hashes[markers[i]], markers[i],
+                                                name.comps, name.lens[markers[i]]);
+    self->nodes[marker_id].marker_refs ++;
+  }
+  node_id = ndn_fib_node_get(self, name.hash, depth, name.comps, name.comp_len);
+  entry_id = ndn_fib_alloc_entry(self);
+  self->slots[entry_id].node_id = node_id;
+  self->nodes[node_id].entry_id = entry_id;
+  ndn_fib_refresh_bmp(self, node_id);
+  return &self->slots[entry_id];
+}
+
+ndn_fib_entry_t*
+ndn_fib_find(ndn_fib_t* self, uint8_t* prefix, size_t length)
+{
+  ndn_parsed_name_t name;
+  ndn_table_id_t node_id;
+
+  if(tlv_name_parse(prefix, length, &name) != NDN_SUCCESS || name.count > NDN_FWD_NAME_MAX_COMPONENTS){
+    return NULL;
+  }
+  node_id = ndn_fib_index_lookup(self, name.hash, name.count, name.comps, name.comp_len, NULL);
+  if(node_id == NDN_INVALID_ID || self->nodes[node_id].entry_id == NDN_INVALID_ID){
+    return NULL;
+  }
+  return &self->slots[self->nodes[node_id].entry_id];
+}
+
+ndn_fib_entry_t*
+ndn_fib_prefix_match_parsed(ndn_fib_t* self, const ndn_parsed_name_t* name)
+{
+  // Routes have at most NDN_FWD_NAME_MAX_COMPONENTS components, so longer names match by their prefixes
+  int count = ndn_parsed_name_depth(name);
+  int lo = 1, hi = NDN_FWD_NAME_MAX_COMPONENTS, mid;
+  ndn_table_id_t node_id, best;
+
+  node_id = ndn_fib_index_lookup(self, name->hashes[0], 0, name->comps, 0, NULL);
+  best = (node_id != NDN_INVALID_ID) ? self->nodes[node_id].entry_id : NDN_INVALID_ID;
+
+  // Binary search on the number of components.
+  // A hit (route or marker) means a longer match may exist; its BMP covers everything up to it.
+  while(lo <= hi){
+    mid = (lo + hi) / 2;
+    if(mid > count){
+      hi = mid - 1;
+      continue;
+    }
+    node_id = ndn_fib_index_lookup(self, name->hashes[mid], mid, name->comps, name->lens[mid], NULL);
+    if(node_id == NDN_INVALID_ID){
+      hi = mid - 1;
+    }
+    else{
+      best = self->nodes[node_id].bmp;
+      lo = mid + 1;
+    }
+  }
+
+  if(best == NDN_INVALID_ID){
+    return NULL;
+  }
+  return &self->slots[best];
+}
+
+ndn_fib_entry_t*
+ndn_fib_prefix_match(ndn_fib_t* self, uint8_t* prefix, size_t length)
+{
+  ndn_parsed_name_t name;
+  if(tlv_name_parse(prefix, length, &name) != NDN_SUCCESS){
+    return NULL;
+  }
+  return ndn_fib_prefix_match_parsed(self, &name);
+}
+
+#else
+
+static inline void
+ndn_fib_refresh_all_bmp(ndn_fib_t* self)
+{
+  (void)self;
+}
+
+static inline void
+ndn_fib_remove_entry(ndn_fib_t* self, ndn_fib_entry_t* entry, bool refresh)
+{
+  (void)refresh;
+  nametree_entry_t* node = ndn_nametree_at(self->nametree, entry->nametree_id);
+  node->fib_id = NDN_INVALID_ID;
+  ndn_nametree_release(self->nametree, node);
+  ndn_fib_free_entry(self, entry);
 }
 
 ndn_fib_entry_t*
@@ -80,10 +479,12 @@ ndn_fib_find_or_insert(ndn_fib_t* self, uint8_t* prefix, size_t length)
     return NULL;
   }
   if(entry->fib_id == NDN_INVALID_ID) {
-    entry->fib_id = ndn_fib_add_new_entry(self, ndn_nametree_getid(self->nametree, entry));
+    entry->fib_id = ndn_fib_alloc_entry(self);
     if(entry->fib_id == NDN_INVALID_ID) {
+      ndn_nametree_release(self->nametree, entry);
       return NULL;
     }
+    self->slots[entry->fib_id].nametree_id = ndn_nametree_getid(self->nametree, entry);
   }
   return &self->slots[entry->fib_id];
 }
@@ -107,3 +508,127 @@ ndn_fib_prefix_match(ndn_fib_t* self, uint8_t* prefix, size_t length)
   }
   return &self->slots[entry->fib_id];
 }
+
+ndn_fib_entry_t*
+ndn_fib_prefix_match_parsed(ndn_fib_t* self, const ndn_parsed_name_t* name)
+{
+  return ndn_fib_prefix_match(self, name->name, name->name_len);
+}
+
+#endif
+
+/** Whether an entry is allocated but has neither a nexthop nor a callback.
+ */
+static inline bool
+ndn_fib_entry_is_unused(ndn_fib_entry_t* entry)
+{
+  return !ndn_fib_entry_is_empty(entry) &&
+         ndn_faceset_is_empty(&entry->nexthop) && entry->on_interest == NULL;
+}
+
+void
+ndn_fib_remove_entry_if_empty(ndn_fib_t* self, ndn_fib_entry_t* entry)
+{
+  if(ndn_fib_entry_is_unused(entry)){
+    ndn_fib_remove_entry(self, entry, true);
+  }
+}
+
+void
+ndn_fib_add_nexthop(ndn_fib_t* self, ndn_fib_entry_t* entry, ndn_table_id_t face_id)
+{
+  if(!ndn_faceset_contains(&entry->nexthop, face_id)){
+    ndn_faceset_add(&entry->nexthop, face_id);
+    ndn_face_index_add(&self->face_index, &entry->face_links, entry - &self->slots[0], face_id);
+  }
+}
+
+void
+ndn_fib_remove_nexthop(ndn_fib_t* self, ndn_fib_entry_t* entry, ndn_table_id_t face_id)
+{
+  int i;
+  ndn_faceset_remove(&entry->nexthop, face_id);
+  ndn_face_index_remove(&self->face_index, &entry->face_links, face_id);
+  ndn_measurements_remove(&self->measurements, &entry->measurements, face_id);
+  for(i = 0; i < NDN_MAX_COST_PER_FIB_ENTRY; i ++){
+    if(entry->costs[i].face_id == face_id){
+      entry->costs[i].face_id = NDN_INVALID_ID;
+    }
+  }
+}
+
+void
+ndn_fib_clear_nexthops(ndn_fib_t* self, ndn_fib_entry_t* entry)
+{
+  ndn_faceset_clear(&entry->nexthop);
+  ndn_face_index_remove_all(&self->face_index, &entry->face_links);
+  ndn_measurements_remove_all(&self->measurements, &entry->measurements);
+  ndn_fib_clear_costs(entry);
+}
+
+int
+ndn_fib_set_cost(ndn_fib_entry_t* entry, ndn_table_id_t face_id, uint16_t cost)
+{
+  int i, slot = -1;
+
+  if(!ndn_faceset_contains(&entry->nexthop, face_id)){
+    return NDN_FWD_NO_EFFECT;
+  }
+  for(i = 0; i < NDN_MAX_COST_PER_FIB_ENTRY; i ++){
+    if(entry->costs[i].face_id == face_id){
+      slot = i;
+      break;
+    }
+    if(slot < 0 && entry->costs[i].face_id == NDN_INVALID_ID){
+      slot = i;
+    }
+  }
+  if(cost == NDN_FACE_DEFAULT_COST){
+    // The default needs no record
+    if(slot >= 0 && entry->costs[slot].face_id == face_id){
+      entry->costs[slot].face_id = NDN_INVALID_ID;
+    }
+    return NDN_SUCCESS;
+  }
+  if(slot < 0){
+    return NDN_FWD_FIB_FULL;
+  }
+  entry->costs[slot].face_id = face_id;
+  entry->costs[slot].cost = cost;
+  return NDN_SUCCESS;
+}
+
+void
+ndn_fib_unregister_face(ndn_fib_t* self, ndn_table_id_t face_id)
+{
+  ndn_fib_entry_t* entry;
+  ndn_table_id_t id;
+  bool single;
+  bool deferred = false;
+
+  if(ndn_faceset_contains(&self->face_index.overflow, face_id)){
+    // Some entries are not linked
+    ndn_faceset_remove(&self->face_index.overflow, face_id);
+    for(id = 0; id < self->capacity; id ++){
+      entry = &self->slots[id];
+      ndn_fib_remove_nexthop(self, entry, face_id);
+      if(ndn_fib_entry_is_unused(entry)){
+        ndn_fib_remove_entry(self, entry, false);
+        deferred = true;
+      }
+    }
+  }
+  while((id = ndn_face_index_first(&self->face_index, face_id)) != NDN_INVALID_ID){
+    entry = &self->slots[id];
+    ndn_fib_remove_nexthop(self, entry, face_id);
+    if(ndn_fib_entry_is_unused(entry)){
+      // Refresh once at the end if more than one route goes away
+      single = !deferred && ndn_face_index_first(&self->face_index, face_id) == NDN_INVALID_ID;
+      ndn_fib_remove_entry(self, entry, single);
+      deferred = deferred || !single;
+    }
+  }
+  if(deferred){
+    ndn_fib_refresh_all_bmp(self);
+  }
+}
@@ -11,9 +11,13 @@
 #ifndef FORWARDER_FIB_H_
 #define FORWARDER_FIB_H_
 
-#include "../util/bit-operations.h"
+#include <stdbool.h>
+#include "faceset.h"
+#include "face-index.h"
+#include "measurements.h"
 #include "callback-funcs.h"
 #include "name-tree.h"
+#include "../encode/forwarder-helper.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,13 +29,40 @@ extern "C" {
  * @{
  */
 
+/**
+ * The cost of a next hop of a FIB entry.
+ */
+typedef struct ndn_fib_cost {
+  /** The next hop. #NDN_INVALID_ID if the record is not used.
+   */
+  ndn_table_id_t face_id;
+
+  uint16_t cost;
+} ndn_fib_cost_t;
+
 /**
  * FIB entry.
  */
 typedef struct ndn_fib_entry {
-  /** A bitset recording all next hops.
+  /** All next hops.
+   */
+  ndn_faceset_t nexthop;
+
+  /** Costs of next hops. A next hop without a record costs #NDN_FACE_DEFAULT_COST.
+   */
+  ndn_fib_cost_t costs[NDN_MAX_COST_PER_FIB_ENTRY];
+
+  /** Round-robin position of the load-balance strategy.
+   */
+  uint32_t rr_counter;
+
+  /** Head of the links of @c nexthop in ndn_fib#face_index.
+   */
+  ndn_table_id_t face_links;
+
+  /** Head of the records of next hops in ndn_fib#measurements.
    */
-  ndn_bitset_t nexthop;
+  ndn_table_id_t measurements;
 
   /** OnOnterest callback function if registered.
    */
@@ -41,30 +72,231 @@ typedef struct ndn_fib_entry {
    */
   void* userdata;
 
+#if NDN_FIB_HASH_ENGINE
+  /** Prefix node's ID.
+   * #NDN_INVALID_ID if the entry is empty.
+   */
+  ndn_table_id_t node_id;
+#else
   /** NameTree entry's ID.
    * #NDN_INVALID_ID if the entry is empty.
    */
   ndn_table_id_t nametree_id;
+#endif
+
+  /** Next entry in the free list.
+   * Only meaningful when the entry is empty.
+   */
+  ndn_table_id_t next_free;
 } ndn_fib_entry_t;
 
+#if NDN_FIB_HASH_ENGINE
+/**
+ * A prefix stored in the FIB hash index.
+ *
+ * A node is either a route (it has a FIB entry), a marker, or both.
+ * Markers are placed on the binary search path of every route, so that a lookup
+ * which has matched a marker knows a longer prefix may exist.
+ */
+typedef struct ndn_fib_node {
+  /** Hash of the prefix components.
+   * @sa tlv_name_get_prefix_hashes
+   */
+  uint32_t hash;
+
+  /** Length of the prefix components stored in ndn_fib#names.
+   */
+  uint16_t name_len;
+
+  /** Number of components.
+   */
+  uint8_t depth;
+
+  /** The FIB entry of this prefix.
+   * #NDN_INVALID_ID if this node is only a marker.
+   */
+  ndn_table_id_t entry_id;
+
+  /** Number of longer routes using this node as a marker.
+   */
+  ndn_table_id_t marker_refs;
+
+  /** Best matching prefix: the FIB entry of the longest route which is a prefix of
+   * this node, including itself.
+   * #NDN_INVALID_ID if none.
+   */
+  ndn_table_id_t bmp;
+
+  /** Next node in the free list.
+   * Only meaningful when the node is not used.
+   */
+  ndn_table_id_t next_free;
+} ndn_fib_node_t;
+
+/**
+ * A bucket of the FIB hash index.
+ */
+typedef struct ndn_fib_bucket {
+  /** Hash of the prefix of the node.
+   */
+  uint32_t hash;
+
+  /** Index of the node.
+   * #NDN_INVALID_ID if the bucket is empty.
+   */
+  ndn_table_id_t node_id;
+} ndn_fib_bucket_t;
+
+/** The number of prefix nodes for @c entry_count FIB entries.
+ */
+#define NDN_FIB_NODE_COUNT(entry_count) (4 * (entry_count))
+
+/** The number of hash buckets reserved for @c node_count nodes,
+ * room for the smallest power of 2 which is at least twice @c node_count and at least 2.
+ */
+#define NDN_FIB_BUCKET_RESERVE(node_count) ((node_count) > 0 ? 4 * (node_count) : 2)
+#endif
+
 /**
  * Forwarding Information Base (FIB).
+ *
+ * By default, entries are indexed by the NameTree.
+ * If #NDN_FIB_HASH_ENGINE is set, they are indexed by a hash table of prefixes instead,
+ * and longest prefix match is a binary search on the number of components.
+ * Names longer than #NDN_FWD_NAME_MAX_COMPONENTS are not supported by the hash engine.
  */
 typedef struct ndn_fib {
   ndn_nametree_t* nametree;
   ndn_table_id_t capacity;
+
+  /** Head of the free entry list.
+   * #NDN_INVALID_ID if the FIB is full.
+   */
+  ndn_table_id_t free_head;
+
+#if NDN_FIB_HASH_ENGINE
+  /** Number of prefix nodes.
+   */
+  ndn_table_id_t node_capacity;
+
+  /** Head of the free node list.
+   */
+  ndn_table_id_t free_node_head;
+
+  /** Number of free nodes.
+   */
+  ndn_table_id_t free_node_count;
+
+  /** Number of buckets minus one. The number of buckets is a power of 2.
+   */
+  uint32_t bucket_mask;
+
+  /** Prefix nodes.
+   */
+  ndn_fib_node_t* nodes;
+
+  /** Hash index, linear probing.
+   */
+  ndn_fib_bucket_t* buckets;
+
+  /** Name components of nodes, #NDN_NAME_MAX_BLOCK_SIZE bytes per node.
+   */
+  uint8_t* names;
+#endif
+
+  /** Entries of every next hop.
+   */
+  ndn_face_index_t face_index;
+
+  /** Round-trip times of next hops, placed right after @c slots.
+   */
+  ndn_measurements_t measurements;
+
   ndn_fib_entry_t slots[];
 } ndn_fib_t;
 
-#define NDN_FIB_RESERVE_SIZE(entry_count) \
-  (sizeof(ndn_fib_t) + sizeof(ndn_fib_entry_t) * (entry_count))
+#if NDN_FIB_HASH_ENGINE
+#define NDN_FIB_RESERVE_SIZE(entry_count, face_count) \
+  (sizeof(ndn_fib_t) + sizeof(ndn_fib_entry_t) * (entry_count) + \
+   sizeof(ndn_measurement_t) * NDN_MEASUREMENTS_COUNT(entry_count) + \
+   (sizeof(ndn_fib_node_t) + NDN_NAME_MAX_BLOCK_SIZE) * NDN_FIB_NODE_COUNT(entry_count) + \
+   sizeof(ndn_fib_bucket_t) * NDN_FIB_BUCKET_RESERVE(NDN_FIB_NODE_COUNT(entry_count)) + \
+   NDN_FACE_INDEX_RESERVE_SIZE(entry_count, face_count))
+#else
+#define NDN_FIB_RESERVE_SIZE(entry_count, face_count) \
+  (sizeof(ndn_fib_t) + sizeof(ndn_fib_entry_t) * (entry_count) + \
+   sizeof(ndn_measurement_t) * NDN_MEASUREMENTS_COUNT(entry_count) + \
+   NDN_FACE_INDEX_RESERVE_SIZE(entry_count, face_count))
+#endif
+
+/** Check whether a FIB entry is empty.
+ * @param[in] entry The FIB entry.
+ * @return Whether @c entry is not in use.
+ */
+static inline bool
+ndn_fib_entry_is_empty(const ndn_fib_entry_t* entry)
+{
+#if NDN_FIB_HASH_ENGINE
+  return entry->node_id == NDN_INVALID_ID;
+#else
+  return entry->nametree_id == NDN_INVALID_ID;
+#endif
+}
 
+/** Initialize a FIB.
+ * @param[in] memory Memory of #NDN_FIB_RESERVE_SIZE.
+ * @param[in] capacity The number of entries.
+ * @param[in] face_count The number of faces, at most #NDN_FACESET_CAPACITY.
+ *                       Removing a face with a larger ID scans the table.
+ * @param[in] nametree The NameTree indexing the entries.
+ */
 void
-ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree);
+ndn_fib_init(void* memory, ndn_table_id_t capacity, ndn_table_id_t face_count, ndn_nametree_t* nametree);
 
+/** Remove a face from all entries, and remove entries left empty.
+ *
+ * Only the entries of the face are visited.
+ */
 void
 ndn_fib_unregister_face(ndn_fib_t* self, ndn_table_id_t face_id);
 
+/** Add a next hop to an entry.
+ *
+ * ndn_fib_entry#nexthop must only be changed through ndn_fib_add_nexthop(),
+ * ndn_fib_remove_nexthop() and ndn_fib_clear_nexthops(),
+ * so that ndn_fib_unregister_face() can find the entry.
+ */
+void
+ndn_fib_add_nexthop(ndn_fib_t* self, ndn_fib_entry_t* entry, ndn_table_id_t face_id);
+
+void
+ndn_fib_remove_nexthop(ndn_fib_t* self, ndn_fib_entry_t* entry, ndn_table_id_t face_id);
+
+void
+ndn_fib_clear_nexthops(ndn_fib_t* self, ndn_fib_entry_t* entry);
+
+/** Set the cost of a next hop of an entry.
+ * @return #NDN_SUCCESS if the cost is set.
+ *         #NDN_FWD_NO_EFFECT if @c face_id is not a next hop.
+ *         #NDN_FWD_FIB_FULL if #NDN_MAX_COST_PER_FIB_ENTRY next hops already have a cost.
+ */
+int
+ndn_fib_set_cost(ndn_fib_entry_t* entry, ndn_table_id_t face_id, uint16_t cost);
+
+/** Get the cost of a next hop of an entry.
+ */
+static inline uint16_t
+ndn_fib_get_cost(const ndn_fib_entry_t* entry, ndn_table_id_t face_id)
+{
+  int i;
+  for(i = 0; i < NDN_MAX_COST_PER_FIB_ENTRY; i ++){
+    if(entry->costs[i].face_id == face_id){
+      return entry->costs[i].cost;
+    }
+  }
+  return NDN_FACE_DEFAULT_COST;
+}
+
 ndn_fib_entry_t*
 ndn_fib_find_or_insert(ndn_fib_t* self, uint8_t* prefix, size_t length);
 
@@ -77,6 +309,11 @@ ndn_fib_remove_entry_if_empty(ndn_fib_t* self, ndn_fib_entry_t* entry);
 ndn_fib_entry_t*
 ndn_fib_prefix_match(ndn_fib_t* self, uint8_t* prefix, size_t length);
 
+/** Same as ndn_fib_prefix_match(), with a name parsed by tlv_name_parse().
+ */
+ndn_fib_entry_t*
+ndn_fib_prefix_match_parsed(ndn_fib_t* self, const ndn_parsed_name_t* name);
+
 /*@}*/
 
 #ifdef __cplusplus
@@ -15,10 +15,39 @@
 #include "../ndn-error-code.h"
 #include "../encode/tlv.h"
 #include "../encode/name.h"
+#include "../ndn-enums.h"
 #include "../util/logger.h"
+#include <string.h>
 
 uint8_t encoding_buf[2048];
 
+/** Buffer of Nacks, which carry an Interest after the NDNLPv2 header.
+ * Room for a long Name: larger Interests are reduced by tlv_make_nack().
+ */
+static uint8_t nack_buf[NDN_NAME_MAX_BLOCK_SIZE + 64];
+
+/**
+ * An Interest kept to send to other upstreams if those it was sent to are too slow.
+ * @sa ndn_strategy#retx_timeout
+ */
+typedef struct fwd_retx {
+  /** The PIT entry. @c NULL if the slot is not used.
+   */
+  ndn_pit_entry_t* entry;
+
+  /** ndn_pit_entry#name_hash and the nonce of the Interest, so a slot whose entry
+   * was satisfied or reused is dropped.
+   */
+  uint32_t name_hash;
+  uint32_t nonce;
+
+  ndn_time_ms_t deadline;
+  size_t length;
+  uint8_t packet[NDN_FWD_RETX_PACKET_SIZE];
+} fwd_retx_t;
+
+static fwd_retx_t retx_slots[NDN_FWD_RETX_SLOTS];
+
 static ndn_forwarder_t forwarder;
 
 // face_id is optional
@@ -26,54 +55,183 @@ static int
 fwd_on_incoming_interest(uint8_t* interest,
                          size_t length,
                          interest_options_t* options,
-                         uint8_t* name,
-                         size_t name_len,
+                         const ndn_parsed_name_t* name,
                          ndn_table_id_t face_id);
 
 static int
 fwd_on_outgoing_interest(uint8_t* interest,
                          size_t length,
-                         uint8_t* name,
-                         size_t name_len,
+                         const interest_options_t* options,
+                         const ndn_parsed_name_t* name,
                          ndn_pit_entry_t* entry,
-                         ndn_table_id_t face_id);
+                         ndn_table_id_t face_id,
+                         bool retransmission,
+                         ndn_time_ms_t now);
+
+static void
+fwd_send_upstream(uint8_t* interest,
+                  size_t length,
+                  const interest_options_t* options,
+                  const ndn_strategy_context_t* ctx,
+                  const ndn_faceset_t* out_faces);
+
+static void
+fwd_process_retx(ndn_time_ms_t now);
+
+static ndn_pit_entry_t*
+fwd_pit_insert(const ndn_parsed_name_t* name, ndn_table_id_t face_id);
+
+static int
+fwd_on_incoming_nack(uint8_t* interest,
+                     size_t length,
+                     uint8_t reason,
+                     ndn_table_id_t face_id);
+
+static void
+fwd_send_nack(ndn_table_id_t face_id,
+              const uint8_t* interest,
+              size_t length,
+              const uint32_t* nonce,
+              uint8_t reason);
 
 static int
 fwd_data_pipeline(uint8_t* data,
                   size_t length,
-                  uint8_t* name,
-                  size_t name_len,
-                  ndn_table_id_t face_id);
+                  const ndn_parsed_name_t* name,
+                  ndn_table_id_t face_id,
+                  uint64_t congestion_mark);
 
-static ndn_bitset_t
+static void
+fwd_face_send(ndn_table_id_t face_id, const uint8_t* packet, size_t length);
+
+static void
+fwd_process_queues(ndn_time_ms_t now);
+
+static void
 fwd_multicast(uint8_t* packet,
               size_t length,
-              ndn_bitset_t out_faces,
-              ndn_table_id_t in_face);
+              const ndn_faceset_t* out_faces,
+              ndn_table_id_t in_face,
+              ndn_faceset_t* sent);
+
+static inline void
+fwd_strategy_context(ndn_strategy_context_t* ctx,
+                     ndn_pit_entry_t* entry,
+                     ndn_fib_entry_t* fib_entry,
+                     ndn_table_id_t face_id,
+                     bool retransmission,
+                     ndn_time_ms_t now)
+{
+  ctx->pit = forwarder.pit;
+  ctx->fib = forwarder.fib;
+  ctx->pit_entry = entry;
+  ctx->fib_entry = fib_entry;
+  ctx->face_id = face_id;
+  ctx->retransmission = retransmission;
+  ctx->congestion_mark = 0;
+  ctx->now = now;
+}
 
 /////////////////////////////////////////////////////////////////////////////////
 
+void
+ndn_forwarder_config_default(ndn_forwarder_config_t* config)
+{
+  memset(config, 0, sizeof(ndn_forwarder_config_t));
+  config->nametree_size = NDN_NAMETREE_MAX_SIZE;
+  config->facetab_size = NDN_FACE_TABLE_MAX_SIZE;
+  config->fib_size = NDN_FIB_MAX_SIZE;
+  config->pit_size = NDN_PIT_MAX_SIZE;
+  config->cs_size = NDN_CS_MAX_SIZE;
+  config->pit_face_quota = NDN_PIT_FACE_QUOTA;
+  config->pit_eviction = NDN_PIT_EVICT_NEAREST_EXPIRY;
+}
+
 void
 ndn_forwarder_init(void)
 {
-  uint8_t* ptr = (uint8_t*)forwarder.memory;
+  ndn_forwarder_config_t config;
+  ndn_forwarder_config_default(&config);
+  ndn_forwarder_init_with_config(&config);
+}
+
+int
+ndn_forwarder_init_with_config(const ndn_forwarder_config_t* config)
+{
+  uint8_t* ptr;
+  size_t size;
+
+  if(config == NULL)
+    return NDN_INVALID_POINTER;
+  // Tables deriving more entries from their size must still fit in ndn_table_id_t
+  if(config->facetab_size > NDN_FACESET_CAPACITY ||
+     NDN_CS_ENTRY_COUNT((uint64_t)config->cs_size) > NDN_INVALID_ID)
+    return NDN_OVERSIZE;
+#if NDN_FIB_HASH_ENGINE
+  if(NDN_FIB_NODE_COUNT((uint64_t)config->fib_size) > NDN_INVALID_ID)
+    return NDN_OVERSIZE;
+#endif
+
+  size = NDN_FORWARDER_RESERVE_SIZE(config->nametree_size, config->facetab_size,
+                                    config->fib_size, config->pit_size, config->cs_size);
+  if(config->alloc != NULL){
+    ptr = (uint8_t*)config->alloc(size, config->hugepage, config->userdata);
+    if(ptr == NULL)
+      return NDN_FWD_NO_MEMORY;
+  }
+  else if(size <= sizeof(forwarder.memory)){
+    ptr = forwarder.memory;
+  }
+  else{
+    return NDN_FWD_NO_MEMORY;
+  }
+
+  if(forwarder.region != NULL && forwarder.region != forwarder.memory && forwarder.config.free != NULL){
+    forwarder.config.free(forwarder.region, forwarder.region_size,
+                          forwarder.config.hugepage, forwarder.config.userdata);
+  }
+  forwarder.config = *config;
+  forwarder.region = ptr;
+  forwarder.region_size = size;
   ndn_msgqueue_init();
 
-  ndn_nametree_init(ptr, NDN_NAMETREE_MAX_SIZE);
+  ndn_nametree_init(ptr, config->nametree_size);
   forwarder.nametree = (ndn_nametree_t*)ptr;
-  ptr += NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE);
+  ptr += NDN_FORWARDER_ALIGN(NDN_NAMETREE_RESERVE_SIZE(config->nametree_size));
 
-  ndn_facetab_init(ptr, NDN_FACE_TABLE_MAX_SIZE);
+  ndn_facetab_init(ptr, config->facetab_size);
   forwarder.facetab = (ndn_face_table_t*)ptr;
-  ptr += NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE);
+  ptr += NDN_FORWARDER_ALIGN(NDN_FACE_TABLE_RESERVE_SIZE(config->facetab_size));
 
-  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, forwarder.nametree);
+  ndn_fib_init(ptr, config->fib_size, config->facetab_size, forwarder.nametree);
   forwarder.fib = (ndn_fib_t*)ptr;
-  ptr += NDN_FIB_RESERVE_SIZE(NDN_FIB_MAX_SIZE);
+  ptr += NDN_FORWARDER_ALIGN(NDN_FIB_RESERVE_SIZE(config->fib_size, config->facetab_size));
 
-  ndn_pit_init(ptr, NDN_PIT_MAX_SIZE, forwarder.nametree);
+  ndn_pit_init(ptr, config->pit_size, config->facetab_size, forwarder.nametree);
   forwarder.pit = (ndn_pit_t*)ptr;
-  ptr += NDN_PIT_RESERVE_SIZE(NDN_PIT_MAX_SIZE);
+  ptr += NDN_FORWARDER_ALIGN(NDN_PIT_RESERVE_SIZE(config->pit_size, config->facetab_size));
+
+  forwarder.cs = NULL;
+  if(config->cs_size >= NDN_CS_PAGE_SIZE){
+    ndn_cs_init(ptr, config->cs_size, &ndn_cs_policy_lru);
+    forwarder.cs = (ndn_cs_t*)ptr;
+  }
+  ptr += NDN_FORWARDER_CS_RESERVE_SIZE(config->cs_size);
+
+  forwarder.admission = (ndn_face_admission_t*)ptr;
+  memset(forwarder.admission, 0, sizeof(ndn_face_admission_t) * config->facetab_size);
+  ptr += NDN_FORWARDER_ALIGN(sizeof(ndn_face_admission_t) * config->facetab_size);
+
+  forwarder.queues = (ndn_face_queue_t**)ptr;
+  memset(forwarder.queues, 0, sizeof(ndn_face_queue_t*) * config->facetab_size);
+
+  forwarder.cs_tier = NULL;
+  ndn_strategy_choice_init(&forwarder.strategy_choice, &ndn_strategy_multicast);
+  memset(retx_slots, 0, sizeof(retx_slots));
+  memset(&forwarder.counters, 0, sizeof(forwarder.counters));
+  ndn_faceset_clear(&forwarder.queued);
+  forwarder.queue_retry = 0;
+  return NDN_SUCCESS;
 }
 
 const ndn_forwarder_t*
@@ -83,12 +241,48 @@ ndn_forwarder_get(void){
 
 void
 ndn_forwarder_process(void){
+  ndn_time_ms_t now;
+
   ndn_msgqueue_process();
+  // Only read the clock when some entry can expire. An Interest to retransmit has an entry.
+  if(ndn_pit_next_expiry(forwarder.pit) != NDN_PIT_NO_EXPIRY){
+    now = ndn_time_now_ms();
+    fwd_process_retx(now);
+    ndn_pit_process_timeouts(forwarder.pit, now);
+  }
+  // Packets sent above are queued behind the earlier ones
+  if(!ndn_faceset_is_empty(&forwarder.queued)){
+    fwd_process_queues(ndn_time_now_ms());
+  }
+}
+
+ndn_time_ms_t
+ndn_forwarder_next_deadline(void){
+  ndn_time_ms_t ret = ndn_pit_next_expiry(forwarder.pit);
+  int i;
+
+  // Retrying at once would spin while a face stays busy
+  if(!ndn_faceset_is_empty(&forwarder.queued) && forwarder.queue_retry < ret){
+    ret = forwarder.queue_retry;
+  }
+  for(i = 0; i < NDN_FWD_RETX_SLOTS; i ++){
+    if(retx_slots[i].entry != NULL && retx_slots[i].deadline < ret){
+      ret = retx_slots[i].deadline;
+    }
+  }
+  return ret;
+}
+
+void
+ndn_forwarder_set_cs_tier(ndn_cs_tier_t* tier){
+  forwarder.cs_tier = tier;
 }
 
 int
 ndn_forwarder_register_face(ndn_face_intf_t* face)
 {
+  uint32_t quota;
+
   if(face == NULL)
     return NDN_INVALID_POINTER;
   if(face->face_id != NDN_INVALID_ID)
@@ -96,6 +290,42 @@ ndn_forwarder_register_face(ndn_face_intf_t* face)
   face->face_id = ndn_facetab_register(forwarder.facetab, face);
   if(face->face_id == NDN_INVALID_ID)
     return NDN_FWD_FACE_TABLE_FULL;
+
+  quota = (uint32_t)forwarder.config.pit_size * forwarder.config.pit_face_quota / 100;
+  if(quota == 0 && forwarder.config.pit_face_quota > 0)
+    quota = 1;
+  forwarder.queues[face->face_id] = NULL;
+  return ndn_forwarder_set_face_limits(face, (ndn_table_id_t)quota, 0, 1);
+}
+
+int
+ndn_forwarder_set_face_queue(ndn_face_intf_t* face, ndn_face_queue_t* queue)
+{
+  if(face == NULL)
+    return NDN_INVALID_POINTER;
+  if(face->face_id >= forwarder.facetab->capacity)
+    return NDN_FWD_INVALID_FACE;
+  if(queue != NULL)
+    ndn_face_queue_init(queue);
+  forwarder.queues[face->face_id] = queue;
+  ndn_faceset_remove(&forwarder.queued, face->face_id);
+  return NDN_SUCCESS;
+}
+
+int
+ndn_forwarder_set_face_limits(ndn_face_intf_t* face, ndn_table_id_t pit_quota,
+                              uint32_t rate, uint32_t burst)
+{
+  ndn_face_admission_t* admission;
+
+  if(face == NULL)
+    return NDN_INVALID_POINTER;
+  if(face->face_id >= forwarder.facetab->capacity)
+    return NDN_FWD_INVALID_FACE;
+  admission = &forwarder.admission[face->face_id];
+  memset(admission, 0, sizeof(ndn_face_admission_t));
+  admission->pit_quota = pit_quota;
+  ndn_token_bucket_init(&admission->bucket, rate, burst, ndn_time_now_ms());
   return NDN_SUCCESS;
 }
 
@@ -110,14 +340,32 @@ ndn_forwarder_unregister_face(ndn_face_intf_t* face)
     return NDN_FWD_INVALID_FACE;
   ndn_fib_unregister_face(forwarder.fib, face->face_id);
   ndn_pit_unregister_face(forwarder.pit, face->face_id);
+  forwarder.queues[face->face_id] = NULL;
+  ndn_faceset_remove(&forwarder.queued, face->face_id);
   ndn_facetab_unregister(forwarder.facetab, face->face_id);
   face->face_id = NDN_INVALID_ID;
   return NDN_SUCCESS;
 }
 
+int
+ndn_forwarder_set_strategy(uint8_t* prefix, size_t length, const ndn_strategy_t* strategy)
+{
+  if(prefix == NULL)
+    return NDN_INVALID_POINTER;
+  return ndn_strategy_choice_set(&forwarder.strategy_choice, prefix, length, strategy);
+}
+
 int
 ndn_forwarder_add_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length){
+  return ndn_forwarder_add_route_with_cost(face, prefix, length, NDN_FACE_DEFAULT_COST);
+}
+
+int
+ndn_forwarder_add_route_with_cost(ndn_face_intf_t* face, uint8_t* prefix, size_t length,
+                                  uint16_t cost)
+{
   int ret;
+  bool added;
   ndn_fib_entry_t* fib_entry;
 
   if(face == NULL)
@@ -131,8 +379,17 @@ ndn_forwarder_add_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length){
   fib_entry = ndn_fib_find_or_insert(forwarder.fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_FIB_FULL;
-  fib_entry->nexthop = bitset_set(fib_entry->nexthop, face->face_id);
-  return NDN_SUCCESS;
+  // The route may cover any name of the negative cache
+  ndn_negative_cache_clear(&forwarder.pit->negative_cache);
+  added = !ndn_faceset_contains(&fib_entry->nexthop, face->face_id);
+  ndn_fib_add_nexthop(forwarder.fib, fib_entry, face->face_id);
+  ret = ndn_fib_set_cost(fib_entry, face->face_id, cost);
+  if (ret != NDN_SUCCESS && added) {
+    // No room for the cost, so the route is not added
+    ndn_fib_remove_nexthop(forwarder.fib, fib_entry, face->face_id);
+    ndn_fib_remove_entry_if_empty(forwarder.fib, fib_entry);
+  }
+  return ret;
 }
 
 int
@@ -171,7 +428,7 @@ ndn_forwarder_remove_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length
   ndn_fib_entry_t* fib_entry = ndn_fib_find(forwarder.fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_NO_EFFECT;
-  fib_entry->nexthop = bitset_unset(fib_entry->nexthop, face->face_id);
+  ndn_fib_remove_nexthop(forwarder.fib, fib_entry, face->face_id);
   ndn_fib_remove_entry_if_empty(forwarder.fib, fib_entry);
   return NDN_SUCCESS;
 }
@@ -186,7 +443,7 @@ ndn_forwarder_remove_all_routes(uint8_t* prefix, size_t length)
   ndn_fib_entry_t* fib_entry = ndn_fib_find(forwarder.fib, prefix, length);
   if (fib_entry == NULL)
     return NDN_FWD_NO_EFFECT;
-  fib_entry->nexthop = 0;
+  ndn_fib_clear_nexthops(forwarder.fib, fib_entry);
   ndn_fib_remove_entry_if_empty(forwarder.fib, fib_entry);
   return NDN_SUCCESS;
 }
@@ -207,6 +464,7 @@ ndn_forwarder_register_prefix(uint8_t* prefix, size_t length,
     return NDN_FWD_FIB_FULL;
   fib_entry->on_interest = on_interest;
   fib_entry->userdata = userdata;
+  ndn_negative_cache_clear(&forwarder.pit->negative_cache);
   return NDN_SUCCESS;
 }
 
@@ -242,31 +500,45 @@ ndn_forwarder_express_interest(uint8_t* interest, size_t length,
                                ndn_on_data_func on_data,
                                ndn_on_timeout_func on_timeout,
                                void* userdata)
+{
+  return ndn_forwarder_express_interest_with_nack(interest, length, on_data, on_timeout, NULL, userdata);
+}
+
+int
+ndn_forwarder_express_interest_with_nack(uint8_t* interest, size_t length,
+                                         ndn_on_data_func on_data,
+                                         ndn_on_timeout_func on_timeout,
+                                         ndn_on_nack_func on_nack,
+                                         void* userdata)
 {
   int ret;
   interest_options_t options;
-  uint8_t *name;
-  size_t name_len;
+  ndn_parsed_name_t name;
   ndn_pit_entry_t* pit_entry;
+  bool retransmission;
 
   if(interest == NULL || on_data == NULL)
     return NDN_INVALID_POINTER;
 
-  ret = tlv_interest_get_header(interest, length, &options, &name, &name_len);
+  ret = tlv_interest_get_header_parsed(interest, length, &options, &name);
   if(ret != NDN_SUCCESS)
     return ret;
 
-  pit_entry = ndn_pit_find_or_insert(forwarder.pit, name, name_len);
+  pit_entry = fwd_pit_insert(&name, NDN_INVALID_ID);
   if (pit_entry == NULL)
     return NDN_FWD_PIT_FULL;
+  retransmission = (pit_entry->on_data != NULL);
   pit_entry->options = options;
   pit_entry->on_data = on_data;
   pit_entry->on_timeout = on_timeout;
+  pit_entry->on_nack = on_nack;
   pit_entry->userdata = userdata;
 
-  pit_entry->last_time = pit_entry->express_time = ndn_time_now_ms();
+  pit_entry->express_time = ndn_time_now_ms();
+  ndn_pit_touch(forwarder.pit, pit_entry, pit_entry->express_time);
 
-  return fwd_on_outgoing_interest(interest, length, name, name_len, pit_entry, NDN_INVALID_ID);
+  return fwd_on_outgoing_interest(interest, length, &options, &name, pit_entry, NDN_INVALID_ID,
+                                  retransmission, pit_entry->last_time);
 }
 
 int
@@ -286,16 +558,15 @@ int
 ndn_forwarder_put_data(uint8_t* data, size_t length)
 {
   int ret;
-  uint8_t *name;
-  size_t name_len;
+  ndn_parsed_name_t name;
 
   if(data == NULL)
     return NDN_INVALID_POINTER;
-  ret = tlv_data_get_name(data, length, &name, &name_len);
+  ret = tlv_data_get_name_parsed(data, length, &name);
   if(ret != NDN_SUCCESS)
     return ret;
 
-  return fwd_data_pipeline(data, length, name, name_len, NDN_INVALID_ID);
+  return fwd_data_pipeline(data, length, &name, NDN_INVALID_ID, 0);
 }
 
 int
@@ -303,9 +574,12 @@ ndn_forwarder_receive(ndn_face_intf_t* face, uint8_t* packet, size_t length)
 {
   uint32_t type, val_len;
   uint8_t* buf;
-  uint8_t *name;
-  size_t name_len;
+  ndn_parsed_name_t name;
   interest_options_t options;
+  size_t frag_len;
+  bool nack;
+  uint8_t reason;
+  uint64_t congestion_mark;
   int ret;
   ndn_table_id_t face_id = (face ? face->face_id : NDN_INVALID_ID);
 
@@ -317,40 +591,124 @@ ndn_forwarder_receive(ndn_face_intf_t* face, uint8_t* packet, size_t length)
     return NDN_WRONG_TLV_LENGTH;
 
   if (type == TLV_Interest) {
-    ret = tlv_interest_get_header(packet, length, &options, &name, &name_len);
+    ret = tlv_interest_get_header_parsed(packet, length, &options, &name);
     if (ret != NDN_SUCCESS)
       return ret;
-    return fwd_on_incoming_interest(packet, length, &options, name, name_len, face_id);
+    return fwd_on_incoming_interest(packet, length, &options, &name, face_id);
   }
   else if(type == TLV_Data) {
-    ret = tlv_data_get_name(packet, length, &name, &name_len);
+    ret = tlv_data_get_name_parsed(packet, length, &name);
+    if (ret != NDN_SUCCESS)
+      return ret;
+    return fwd_data_pipeline(packet, length, &name, face_id, 0);
+  }
+  else if(type == TLV_LpPacket) {
+    ret = tlv_lp_packet_parse(packet, length, &buf, &frag_len, &nack, &reason);
     if (ret != NDN_SUCCESS)
       return ret;
-    return fwd_data_pipeline(packet, length, name, name_len, face_id);
+    if (nack)
+      return fwd_on_incoming_nack(buf, frag_len, reason, face_id);
+    // The strategy is told when an upstream is congested
+    congestion_mark = tlv_lp_packet_get_congestion_mark(packet, length);
+    if (congestion_mark > 0 && frag_len > 0 && buf[0] == TLV_Data) {
+      ret = tlv_data_get_name_parsed(buf, frag_len, &name);
+      if (ret != NDN_SUCCESS)
+        return ret;
+      return fwd_data_pipeline(buf, frag_len, &name, face_id, congestion_mark);
+    }
+    return ndn_forwarder_receive(face, buf, frag_len);
   }
   else {
     return NDN_WRONG_TLV_TYPE;
   }
 }
 
+size_t
+ndn_forwarder_receive_batch(ndn_face_intf_t* face, uint8_t* const* packets, const size_t* lengths,
+                            size_t count)
+{
+  size_t i, ret = 0;
+
+  for (i = 0; i < count; i ++) {
+    if (ndn_forwarder_receive(face, packets[i], lengths[i]) == NDN_SUCCESS)
+      ret ++;
+  }
+  return ret;
+}
+
 static int
 fwd_on_incoming_interest(uint8_t* interest,
                          size_t length,
                          interest_options_t* options,
-                         uint8_t* name,
-                         size_t name_len,
+                         const ndn_parsed_name_t* name,
                          ndn_table_id_t face_id)
 {
   ndn_pit_entry_t *pit_entry;
+  ndn_cs_entry_t *cs_entry;
+  ndn_face_admission_t *admission;
+  const uint8_t *cached;
+  size_t cached_len;
+  bool retransmission = false;
+  ndn_time_ms_t now = ndn_time_now_ms();
+  int reason;
 
-  pit_entry = ndn_pit_find_or_insert(forwarder.pit, name, name_len);
+  if(face_id != NDN_INVALID_ID){
+    cs_entry = NULL;
+    if(forwarder.cs != NULL){
+      cs_entry = ndn_cs_match_parsed(forwarder.cs, name, options->can_be_prefix, options->must_be_fresh, now);
+    }
+    if(cs_entry != NULL){
+      NDN_LOG_DEBUG("[FORWARDER] Satisfied by the content store\n");
+      fwd_face_send(face_id, ndn_cs_entry_data(forwarder.cs, cs_entry), cs_entry->length);
+      return NDN_SUCCESS;
+    }
+    if(forwarder.cs_tier != NULL){
+      cached_len = forwarder.cs_tier->match(forwarder.cs_tier, name->name, name->name_len,
+                                            options->can_be_prefix, options->must_be_fresh, now, &cached);
+      if(cached_len > 0){
+        NDN_LOG_DEBUG("[FORWARDER] Satisfied by the content store tier\n");
+        fwd_face_send(face_id, cached, cached_len);
+        return NDN_SUCCESS;
+      }
+    }
+
+    // A name which just had no route or no answer is Nacked before the PIT is walked
+    reason = ndn_negative_cache_find(&forwarder.pit->negative_cache, name->hash, now);
+    if(reason >= 0){
+      fwd_send_nack(face_id, interest, length, NULL, (uint8_t)reason);
+      return (reason == NDN_NACK_REASON_NO_ROUTE) ? NDN_FWD_NO_ROUTE : NDN_FWD_INTEREST_REJECTED;
+    }
+
+    // Only Interests which may take a PIT entry count against the rate limit
+    admission = &forwarder.admission[face_id];
+    if(!ndn_token_bucket_consume(&admission->bucket, now)){
+      NDN_LOG_ERROR("[FORWARDER] Drop by rate limit\n");
+      admission->rate_shed ++;
+      forwarder.counters.rate_shed ++;
+      fwd_send_nack(face_id, interest, length, NULL, NDN_NACK_REASON_CONGESTION);
+      return NDN_FWD_INTEREST_REJECTED;
+    }
+  }
+
+  // A nonce forwarded by an entry which is gone
+  if(options->nonce != 0 && ndn_pit_is_dead_nonce(forwarder.pit, name->hash, options->nonce, now)){
+    NDN_LOG_ERROR("[FORWARDER] Drop by dead nonce\n");
+    fwd_send_nack(face_id, interest, length, NULL, NDN_NACK_REASON_DUPLICATE);
+    return NDN_FWD_INTEREST_REJECTED;
+  }
+
+  pit_entry = fwd_pit_insert(name, face_id);
   if (pit_entry == NULL){
+    fwd_send_nack(face_id, interest, length, NULL, NDN_NACK_REASON_CONGESTION);
     return NDN_FWD_PIT_FULL;
   }
 
-  // Randomized dead nonce list
-  if(pit_entry->options.nonce == options->nonce && options->nonce != 0){
-    NDN_LOG_ERROR("[FORWARDER] Drop by dead nonce\n");
+  // A nonce of another downstream or sent upstream: the Interest looped.
+  // The same nonce from the same face is a retransmission.
+  if(options->nonce != 0 &&
+     ndn_pit_check_nonce(forwarder.pit, pit_entry, face_id, options->nonce) == NDN_PIT_NONCE_LOOP){
+    NDN_LOG_ERROR("[FORWARDER] Drop by duplicate nonce\n");
+    fwd_send_nack(face_id, interest, length, NULL, NDN_NACK_REASON_DUPLICATE);
     return NDN_FWD_INTEREST_REJECTED;
   }
   if(pit_entry->on_data == NULL && pit_entry->on_timeout == NULL){
@@ -359,92 +717,179 @@ fwd_on_incoming_interest(uint8_t* interest,
     // and forwarded Interest's lifetime.
     pit_entry->options = *options;
   }
-  pit_entry->last_time = ndn_time_now_ms();
+  ndn_pit_touch(forwarder.pit, pit_entry, now);
   if(face_id != NDN_INVALID_ID){
-    pit_entry->incoming_faces = bitset_set(pit_entry->incoming_faces, face_id);
+    retransmission = ndn_faceset_contains(&pit_entry->incoming_faces, face_id);
+    ndn_pit_insert_in_record(forwarder.pit, pit_entry, face_id, options, now);
   }
 
-  return fwd_on_outgoing_interest(interest, length, name, name_len, pit_entry, face_id);
+  return fwd_on_outgoing_interest(interest, length, options, name, pit_entry, face_id,
+                                  retransmission, now);
+}
+
+/** Find or insert the PIT entry of an Interest within the quota of its face,
+ * evicting an entry if the PIT is full.
+ * @param[in] face_id The face of the Interest. #NDN_INVALID_ID for the application.
+ * @return The entry. @c NULL if the Interest is shed.
+ */
+static ndn_pit_entry_t*
+fwd_pit_insert(const ndn_parsed_name_t* name, ndn_table_id_t face_id)
+{
+  ndn_pit_entry_t* entry;
+  ndn_face_admission_t* admission;
+
+  if(face_id != NDN_INVALID_ID){
+    admission = &forwarder.admission[face_id];
+    if(admission->pit_quota > 0 &&
+       ndn_pit_face_entry_count(forwarder.pit, face_id) >= admission->pit_quota){
+      // The face can still refresh the entries it is a downstream of
+      entry = ndn_pit_find_parsed(forwarder.pit, name);
+      if(entry == NULL || !ndn_faceset_contains(&entry->incoming_faces, face_id)){
+        NDN_LOG_ERROR("[FORWARDER] Drop by PIT quota\n");
+        admission->quota_shed ++;
+        forwarder.counters.quota_shed ++;
+        return NULL;
+      }
+      return entry;
+    }
+  }
+
+  entry = ndn_pit_find_or_insert_parsed(forwarder.pit, name);
+  if(entry == NULL && ndn_pit_evict(forwarder.pit, forwarder.config.pit_eviction)){
+    forwarder.counters.pit_evicted ++;
+    entry = ndn_pit_find_or_insert_parsed(forwarder.pit, name);
+  }
+  if(entry == NULL){
+    forwarder.counters.pit_full_shed ++;
+  }
+  return entry;
 }
 
 static int
 fwd_data_pipeline(uint8_t* data,
                   size_t length,
-                  uint8_t* name,
-                  size_t name_len,
-                  ndn_table_id_t face_id)
+                  const ndn_parsed_name_t* name,
+                  ndn_table_id_t face_id,
+                  uint64_t congestion_mark)
 {
-  ndn_pit_entry_t* pit_entry;
-
-  pit_entry = ndn_pit_prefix_match(forwarder.pit, name, name_len);
-  if (pit_entry == NULL) {
+  ndn_pit_entry_t* entries[NDN_PIT_MAX_MATCHES];
+  ndn_on_data_func on_data[NDN_PIT_MAX_MATCHES];
+  void* userdata[NDN_PIT_MAX_MATCHES];
+  ndn_faceset_t downstream;
+  ndn_strategy_context_t ctx;
+  bool fib_looked_up = false;
+  size_t count, i;
+  ndn_time_ms_t now;
+
+  count = ndn_pit_match_data(forwarder.pit, name, entries, NDN_PIT_MAX_MATCHES);
+  if (count == 0) {
     return NDN_FWD_NO_ROUTE;
   }
-  if (!pit_entry->options.can_be_prefix) {
-    // Quick and dirty solution
-    if (ndn_pit_find(forwarder.pit, name, name_len) != pit_entry)
-      return NDN_FWD_NO_ROUTE;
+
+  // Only solicited Data is cached
+  now = ndn_time_now_ms();
+  if (forwarder.cs != NULL) {
+    ndn_cs_insert_parsed(forwarder.cs, data, length, name, now);
+  }
+  if (forwarder.cs_tier != NULL) {
+    forwarder.cs_tier->insert(forwarder.cs_tier, data, length, name->name, name->name_len, now);
   }
 
-  if (pit_entry->on_data != NULL) {
-    pit_entry->on_data(data, length, pit_entry->userdata);
+  // Entries are removed before any callback, so an Interest expressed again by one is kept
+  ndn_faceset_clear(&downstream);
+  fwd_strategy_context(&ctx, NULL, NULL, face_id, false, now);
+  ctx.congestion_mark = congestion_mark;
+  for (i = 0; i < count; i ++) {
+    if (entries[i]->strategy != NULL && entries[i]->strategy->on_data != NULL) {
+      if (!fib_looked_up) {
+        ctx.fib_entry = ndn_fib_prefix_match_parsed(forwarder.fib, name);
+        fib_looked_up = true;
+      }
+      ctx.pit_entry = entries[i];
+      entries[i]->strategy->on_data(&ctx);
+    }
+    ndn_faceset_union(&downstream, &entries[i]->incoming_faces);
+    on_data[i] = entries[i]->on_data;
+    userdata[i] = entries[i]->userdata;
+    ndn_pit_remove_entry(forwarder.pit, entries[i]);
   }
 
-  fwd_multicast(data, length, pit_entry->incoming_faces, face_id);
+  // A face waiting on several entries gets the Data once
+  fwd_multicast(data, length, &downstream, face_id, NULL);
 
-  ndn_pit_remove_entry(forwarder.pit, pit_entry);
+  for (i = 0; i < count; i ++) {
+    if (on_data[i] != NULL) {
+      on_data[i](data, length, userdata[i]);
+    }
+  }
 
   return NDN_SUCCESS;
 }
 
-static ndn_bitset_t
+static void
 fwd_multicast(uint8_t* packet,
               size_t length,
-              ndn_bitset_t out_faces,
-              ndn_table_id_t in_face)
+              const ndn_faceset_t* out_faces,
+              ndn_table_id_t in_face,
+              ndn_faceset_t* sent)
 {
   ndn_table_id_t id;
   ndn_face_intf_t* face;
-  ndn_bitset_t ret = 0;
 
-  while(out_faces != 0){
-    id = bitset_pop_least(&out_faces);
+  NDN_FACESET_FOREACH(out_faces, id){
+    if(id >= forwarder.facetab->capacity){
+      break;
+    }
     face = forwarder.facetab->slots[id];
     if(id != in_face && face != NULL){
-      ndn_face_send(face, packet, length);
-      ret = bitset_set(ret, id);
+      fwd_face_send(id, packet, length);
+      if(sent != NULL){
+        ndn_faceset_add(sent, id);
+      }
     }
   }
-  return ret;
 }
 
 static int
 fwd_on_outgoing_interest(uint8_t* interest,
                          size_t length,
-                         uint8_t* name,
-                         size_t name_len,
+                         const interest_options_t* options,
+                         const ndn_parsed_name_t* name,
                          ndn_pit_entry_t* entry,
-                         ndn_table_id_t face_id)
+                         ndn_table_id_t face_id,
+                         bool retransmission,
+                         ndn_time_ms_t now)
 {
   ndn_fib_entry_t* fib_entry;
-  int strategy;
+  int action;
   uint8_t *hop_limit;
-  ndn_bitset_t outfaces;
+  ndn_faceset_t eligible, outfaces;
+  interest_options_t out_options = *options;
+  ndn_strategy_context_t ctx;
 
-  fib_entry = ndn_fib_prefix_match(forwarder.fib, name, name_len);
+  fib_entry = ndn_fib_prefix_match_parsed(forwarder.fib, name);
   if(fib_entry == NULL){
     NDN_LOG_ERROR("[FORWARDER] Drop by no route\n");
+    if(face_id != NDN_INVALID_ID){
+      fwd_send_nack(face_id, interest, length, NULL, NDN_NACK_REASON_NO_ROUTE);
+      ndn_negative_cache_add(&forwarder.pit->negative_cache, name->hash, NDN_NACK_REASON_NO_ROUTE, now);
+      ndn_pit_remove_downstream(forwarder.pit, entry, face_id);
+    }
+    else if(entry->on_nack != NULL){
+      // The application is told by the return value
+      ndn_pit_remove_application(forwarder.pit, entry);
+    }
     return NDN_FWD_NO_ROUTE;
   }
 
   if(fib_entry->on_interest){
-    strategy = fib_entry->on_interest(interest, length, fib_entry->userdata);
+    action = fib_entry->on_interest(interest, length, fib_entry->userdata);
   }else{
-    strategy = NDN_FWD_STRATEGY_MULTICAST;
+    action = NDN_FWD_STRATEGY_MULTICAST;
   }
 
   // The interest may be satisfied immediately so check again
-  if(entry->nametree_id == NDN_INVALID_ID){
+  if(ndn_pit_entry_is_empty(entry)){
     return NDN_SUCCESS;
   }
 
@@ -457,12 +902,312 @@ fwd_on_outgoing_interest(uint8_t* interest,
     if(face_id != NDN_INVALID_ID){
       *hop_limit -= 1;
     }
+    out_options.hop_limit = *hop_limit;
   }
 
-  outfaces = (fib_entry->nexthop & (~entry->outgoing_faces));
-  if(strategy == NDN_FWD_STRATEGY_MULTICAST){
-    entry->outgoing_faces |= fwd_multicast(interest, length, outfaces, face_id);
+  // An Interest the application let through goes to the strategy of its name
+  if(action != NDN_FWD_STRATEGY_MULTICAST){
+    return NDN_SUCCESS;
   }
+  entry->strategy = ndn_strategy_choice_find(&forwarder.strategy_choice, name);
+
+  // Upstreams are not sent the Interest again until their out-records expire
+  ndn_pit_expire_out_records(forwarder.pit, entry, now);
+  ndn_faceset_difference(&eligible, &fib_entry->nexthop, &entry->outgoing_faces);
+  if(face_id != NDN_INVALID_ID){
+    ndn_faceset_remove(&eligible, face_id);
+  }
+  fwd_strategy_context(&ctx, entry, fib_entry, face_id, retransmission, now);
+  ndn_faceset_clear(&outfaces);
+  entry->strategy->after_receive_interest(&ctx, &eligible, &outfaces);
+  fwd_send_upstream(interest, length, &out_options, &ctx, &outfaces);
 
   return NDN_SUCCESS;
 }
+
+/** Send an Interest to the upstreams chosen by the strategy,
+ * and keep it if the strategy asks for a retransmission timer.
+ */
+static void
+fwd_send_upstream(uint8_t* interest,
+                  size_t length,
+                  const interest_options_t* options,
+                  const ndn_strategy_context_t* ctx,
+                  const ndn_faceset_t* out_faces)
+{
+  ndn_pit_entry_t* entry = ctx->pit_entry;
+  ndn_faceset_t sent;
+  ndn_table_id_t id;
+  fwd_retx_t* slot = NULL;
+  uint32_t timeout;
+  int i;
+
+  ndn_faceset_clear(&sent);
+  fwd_multicast(interest, length, out_faces, ctx->face_id, &sent);
+  NDN_FACESET_FOREACH(&sent, id){
+    ndn_pit_insert_out_record(forwarder.pit, entry, id, options, ctx->now);
+  }
+
+  if(ndn_faceset_is_empty(&sent) || entry->strategy->retx_timeout == NULL ||
+     length > NDN_FWD_RETX_PACKET_SIZE){
+    return;
+  }
+  timeout = entry->strategy->retx_timeout(ctx, &sent);
+  if(timeout == 0 || ctx->now + timeout >= entry->expiry){
+    return;
+  }
+  for(i = 0; i < NDN_FWD_RETX_SLOTS; i ++){
+    if(retx_slots[i].entry == entry){
+      slot = &retx_slots[i];
+      break;
+    }
+    if(slot == NULL && retx_slots[i].entry == NULL){
+      slot = &retx_slots[i];
+    }
+  }
+  if(slot == NULL){
+    return;
+  }
+  slot->entry = entry;
+  slot->name_hash = entry->name_hash;
+  slot->nonce = options->nonce;
+  slot->deadline = ctx->now + timeout;
+  slot->length = length;
+  // The Interest may be the one of a slot being retransmitted
+  memmove(slot->packet, interest, length);
+}
+
+/** Whether the PIT entry of a slot still waits for the Interest kept.
+ */
+static bool
+fwd_retx_is_valid(const fwd_retx_t* slot)
+{
+  ndn_pit_entry_t* entry = slot->entry;
+  ndn_table_id_t id;
+
+  if(ndn_pit_entry_is_empty(entry) || entry->name_hash != slot->name_hash){
+    return false;
+  }
+  for(id = entry->out_records; id != NDN_INVALID_ID; id = forwarder.pit->records[id].next){
+    if(forwarder.pit->records[id].nonce == slot->nonce){
+      return true;
+    }
+  }
+  return false;
+}
+
+static void
+fwd_process_retx(ndn_time_ms_t now)
+{
+  fwd_retx_t* slot;
+  ndn_pit_entry_t* entry;
+  interest_options_t options;
+  ndn_parsed_name_t name;
+  ndn_faceset_t eligible, outfaces;
+  ndn_strategy_context_t ctx;
+  int i;
+
+  for(i = 0; i < NDN_FWD_RETX_SLOTS; i ++){
+    slot = &retx_slots[i];
+    if(slot->entry == NULL || slot->deadline > now){
+      continue;
+    }
+    entry = slot->entry;
+    if(!fwd_retx_is_valid(slot) || entry->strategy == NULL ||
+       tlv_interest_get_header_parsed(slot->packet, slot->length, &options, &name) != NDN_SUCCESS){
+      slot->entry = NULL;
+      continue;
+    }
+    // Free the slot so the retransmission can take it again
+    slot->entry = NULL;
+
+    // The upstreams are too slow: try others as if the downstream retransmitted
+    fwd_strategy_context(&ctx, entry, ndn_fib_prefix_match_parsed(forwarder.fib, &name),
+                         NDN_INVALID_ID, true, now);
+    if(ctx.fib_entry == NULL){
+      continue;
+    }
+    if(entry->strategy->on_timeout != NULL){
+      entry->strategy->on_timeout(&ctx);
+    }
+    ndn_pit_expire_out_records(forwarder.pit, entry, now);
+    ndn_faceset_difference(&eligible, &ctx.fib_entry->nexthop, &entry->outgoing_faces);
+    ndn_faceset_difference(&eligible, &eligible, &entry->incoming_faces);
+    ndn_faceset_clear(&outfaces);
+    entry->strategy->after_receive_interest(&ctx, &eligible, &outfaces);
+    fwd_send_upstream(slot->packet, slot->length, &options, &ctx, &outfaces);
+  }
+}
+
+static int
+fwd_on_incoming_nack(uint8_t* interest,
+                     size_t length,
+                     uint8_t reason,
+                     ndn_table_id_t face_id)
+{
+  interest_options_t options;
+  ndn_parsed_name_t name;
+  ndn_pit_entry_t* entry;
+  ndn_pit_record_t* record;
+  ndn_faceset_t downstream, eligible, retry;
+  ndn_strategy_context_t ctx;
+  ndn_on_nack_func on_nack;
+  void* userdata;
+  ndn_table_id_t id;
+  int ret;
+
+  ret = tlv_interest_get_header_parsed(interest, length, &options, &name);
+  if(ret != NDN_SUCCESS)
+    return ret;
+
+  // Only a Nack of the Interest last sent to the face counts
+  entry = ndn_pit_find_parsed(forwarder.pit, &name);
+  if(entry == NULL)
+    return NDN_FWD_NO_EFFECT;
+  record = ndn_pit_find_record(forwarder.pit, entry->out_records, face_id);
+  if(record == NULL || record->nonce != options.nonce)
+    return NDN_FWD_NO_EFFECT;
+  record->nacked = true;
+  record->nack_reason = reason;
+
+  // The strategy may try upstreams which have not been tried
+  if(entry->strategy != NULL && entry->strategy->on_nack != NULL){
+    fwd_strategy_context(&ctx, entry, ndn_fib_prefix_match_parsed(forwarder.fib, &name),
+                         face_id, false, ndn_time_now_ms());
+    ndn_faceset_clear(&eligible);
+    if(ctx.fib_entry != NULL){
+      ndn_faceset_difference(&eligible, &ctx.fib_entry->nexthop, &entry->outgoing_faces);
+      ndn_faceset_difference(&eligible, &eligible, &entry->incoming_faces);
+    }
+    ndn_faceset_clear(&retry);
+    entry->strategy->on_nack(&ctx, reason, &eligible, &retry);
+    fwd_send_upstream(interest, length, &options, &ctx, &retry);
+  }
+
+  // Other upstreams may still bring the Data
+  ret = ndn_pit_nack_reason(forwarder.pit, entry);
+  if(ret < 0)
+    return NDN_SUCCESS;
+  NDN_LOG_DEBUG("[FORWARDER] Nacked by all upstreams\n");
+  // A duplicate is about the nonce, not the name, and congestion passes before the name would expire
+  if(ret != NDN_NACK_REASON_DUPLICATE && ret != NDN_NACK_REASON_CONGESTION){
+    ndn_negative_cache_add(&forwarder.pit->negative_cache, name.hash, (uint8_t)ret, ndn_time_now_ms());
+  }
+
+  downstream = entry->incoming_faces;
+  NDN_FACESET_FOREACH(&downstream, id){
+    record = ndn_pit_find_record(forwarder.pit, entry->in_records, id);
+    fwd_send_nack(id, interest, length, record ? &record->nonce : NULL, (uint8_t)ret);
+  }
+  if(entry->on_data != NULL && entry->on_nack == NULL){
+    // The application keeps waiting for its timeout
+    NDN_FACESET_FOREACH(&downstream, id){
+      ndn_pit_remove_downstream(forwarder.pit, entry, id);
+    }
+    return NDN_SUCCESS;
+  }
+  on_nack = entry->on_nack;
+  userdata = entry->userdata;
+  ndn_pit_remove_entry(forwarder.pit, entry);
+  if(on_nack != NULL){
+    on_nack(interest, length, (uint8_t)ret, userdata);
+  }
+  return NDN_SUCCESS;
+}
+
+static void
+fwd_send_nack(ndn_table_id_t face_id,
+              const uint8_t* interest,
+              size_t length,
+              const uint32_t* nonce,
+              uint8_t reason)
+{
+  size_t nack_len, fragment_len;
+  uint8_t *ptr, *fragment, nack_reason;
+  bool is_nack;
+
+  if(face_id >= forwarder.facetab->capacity || forwarder.facetab->slots[face_id] == NULL){
+    return;
+  }
+  if(tlv_make_nack(nack_buf, sizeof(nack_buf), interest, length, reason, &nack_len) != NDN_SUCCESS){
+    return;
+  }
+  // Each downstream gets the Interest with its own nonce
+  if(nonce != NULL &&
+     tlv_lp_packet_parse(nack_buf, nack_len, &fragment, &fragment_len, &is_nack, &nack_reason) == NDN_SUCCESS){
+    ptr = tlv_interest_get_nonce_ptr(fragment, fragment_len);
+    if(ptr != NULL){
+      memcpy(ptr, nonce, sizeof(*nonce));
+    }
+  }
+  fwd_face_send(face_id, nack_buf, nack_len);
+}
+
+/** Send a packet through a face, or queue it if the face has a queue and can't send it now.
+ * @pre The face is registered.
+ */
+static void
+fwd_face_send(ndn_table_id_t face_id, const uint8_t* packet, size_t length)
+{
+  ndn_face_intf_t* face = forwarder.facetab->slots[face_id];
+  ndn_face_queue_t* queue = forwarder.queues[face_id];
+  ndn_time_ms_t now;
+
+  if(queue == NULL){
+    ndn_face_send(face, packet, length);
+    return;
+  }
+  // An empty queue is bypassed, so packets only wait while the face is busy
+  if(ndn_face_queue_is_empty(queue) && ndn_face_send(face, packet, length) == NDN_SUCCESS){
+    return;
+  }
+  now = ndn_time_now_ms();
+  if(ndn_face_queue_is_empty(queue)){
+    // The face refused it
+    forwarder.queue_retry = now + NDN_FACE_QUEUE_RETRY_INTERVAL;
+  }
+  if(ndn_face_queue_push(queue, packet, length, now)){
+    ndn_faceset_add(&forwarder.queued, face_id);
+  }
+}
+
+/** Send the queued packets of faces until they are busy.
+ *
+ * A busy face is retried at every call, in case it became ready, and by
+ * ndn_forwarder_next_deadline() after #NDN_FACE_QUEUE_RETRY_INTERVAL.
+ */
+static void
+fwd_process_queues(ndn_time_ms_t now)
+{
+  ndn_table_id_t id;
+  ndn_face_intf_t* face;
+  ndn_face_queue_t* queue;
+  uint8_t* packet;
+  uint8_t* marked;
+  size_t length, mark_len;
+  int ret;
+
+  NDN_FACESET_FOREACH(&forwarder.queued, id){
+    face = forwarder.facetab->slots[id];
+    queue = forwarder.queues[id];
+    while((packet = ndn_face_queue_front(queue, &length)) != NULL){
+      // The packet stays at the head until the face takes it, so a busy face loses nothing
+      if(ndn_face_queue_should_mark(queue, now) &&
+         (marked = ndn_face_queue_mark_front(queue, &mark_len)) != NULL){
+        ret = ndn_face_send(face, marked, mark_len);
+      }
+      else{
+        ret = ndn_face_send(face, packet, length);
+      }
+      if(ret != NDN_SUCCESS){
+        ndn_face_queue_refuse(queue, now);
+        forwarder.queue_retry = now + NDN_FACE_QUEUE_RETRY_INTERVAL;
+        break;
+      }
+      ndn_face_queue_pop(queue, now);
+    }
+    if(ndn_face_queue_is_empty(queue)){
+      ndn_faceset_remove(&forwarder.queued, id);
+    }
+  }
+}
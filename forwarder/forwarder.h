@@ -15,33 +15,139 @@
 #include "name-tree.h"
 #include "pit.h"
 #include "fib.h"
+#include "cs.h"
+#include "strategy.h"
+#include "admission.h"
+#include "face-queue.h"
 #include "face-table.h"
 #include "../encode/name.h"
 #include "../encode/interest.h"
 #include "callback-funcs.h"
 #include "../util/msg-queue.h"
 
-#define NDN_FORWARDER_RESERVE_SIZE(nametree_size, facetab_size, fib_size, pit_size) \
-  (NDN_NAMETREE_RESERVE_SIZE(nametree_size) + \
-   NDN_FACE_TABLE_RESERVE_SIZE(facetab_size) + \
-   NDN_FIB_RESERVE_SIZE(fib_size) + \
-   NDN_PIT_RESERVE_SIZE(pit_size))
+/** Round up the size of a table so that the next one is aligned.
+ */
+#define NDN_FORWARDER_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+/** The size of the state the forwarder keeps for each face: its limits and its transmit queue.
+ */
+#define NDN_FORWARDER_FACE_RESERVE_SIZE(facetab_size) \
+  (NDN_FORWARDER_ALIGN(sizeof(ndn_face_admission_t) * (facetab_size)) + \
+   NDN_FORWARDER_ALIGN(sizeof(ndn_face_queue_t*) * (facetab_size)))
+
+/** The size of the content store. Nothing is reserved for one smaller than a page.
+ */
+#define NDN_FORWARDER_CS_RESERVE_SIZE(cs_size) \
+  (((cs_size) >= NDN_CS_PAGE_SIZE) ? NDN_FORWARDER_ALIGN(NDN_CS_RESERVE_SIZE(cs_size)) : 0)
+
+/** The size of the forwarder tables.
+ *
+ * What each table costs with the default options on a 64-bit target:
+ * - NameTree: about 104 bytes per node, 48 of them for name components.
+ * - Face table: 56 bytes per face, with the limits and the queue of each face.
+ * - FIB: about 160 bytes per entry, with its next hops and RTT measurements.
+ * - PIT: about 360 bytes per entry, with its in-records and out-records,
+ *   and 1.9 KB for the Dead Nonce List and the negative cache.
+ * - CS: none unless #NDN_CS_MAX_SIZE is set, then about 1.5 bytes per byte of Data.
+ */
+#define NDN_FORWARDER_RESERVE_SIZE(nametree_size, facetab_size, fib_size, pit_size, cs_size) \
+  (NDN_FORWARDER_ALIGN(NDN_NAMETREE_RESERVE_SIZE(nametree_size)) + \
+   NDN_FORWARDER_ALIGN(NDN_FACE_TABLE_RESERVE_SIZE(facetab_size)) + \
+   NDN_FORWARDER_ALIGN(NDN_FIB_RESERVE_SIZE(fib_size, facetab_size)) + \
+   NDN_FORWARDER_ALIGN(NDN_PIT_RESERVE_SIZE(pit_size, facetab_size)) + \
+   NDN_FORWARDER_CS_RESERVE_SIZE(cs_size) + \
+   NDN_FORWARDER_FACE_RESERVE_SIZE(facetab_size))
 
 #define NDN_FORWARDER_DEFAULT_SIZE \
   NDN_FORWARDER_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE, \
                              NDN_FACE_TABLE_MAX_SIZE, \
                              NDN_FIB_MAX_SIZE, \
-                             NDN_PIT_MAX_SIZE)
+                             NDN_PIT_MAX_SIZE, \
+                             NDN_CS_MAX_SIZE)
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// TODO: Add support of content store and make it a modular component: can be realized with RAM, ROM, etc. the size is configurable.
+/** Allocate the memory of the forwarder tables.
+ * @param[in] size The size in bytes.
+ * @param[in] hugepage Whether huge pages are preferred.
+ * @param[in] userdata User defined data given in the config.
+ * @return The memory, 8-byte aligned. @c NULL on failure.
+ */
+typedef void* (*ndn_forwarder_alloc_func)(size_t size, bool hugepage, void* userdata);
+
+/** Free memory returned by the ndn_forwarder_alloc_func with the same arguments.
+ */
+typedef void (*ndn_forwarder_free_func)(void* memory, size_t size, bool hugepage, void* userdata);
+
+/**
+ * Sizes and memory of the forwarder tables.
+ * @sa ndn_forwarder_init_with_config
+ */
+typedef struct ndn_forwarder_config {
+  ndn_table_id_t nametree_size;
+
+  /** At most #NDN_FACESET_CAPACITY.
+   */
+  ndn_table_id_t facetab_size;
+  ndn_table_id_t fib_size;
+  ndn_table_id_t pit_size;
+
+  /** Bytes of Data packets in the content store.
+   * Below #NDN_CS_PAGE_SIZE, there is no content store: nothing is reserved or looked up.
+   */
+  uint32_t cs_size;
+
+  /** [Optional] The allocator. If @c NULL, the tables must fit in ndn_forwarder#memory.
+   */
+  ndn_forwarder_alloc_func alloc;
+
+  /** [Optional] Called with the memory when the forwarder is initialized again.
+   */
+  ndn_forwarder_free_func free;
+
+  /** User defined data, passed to @c alloc and @c free.
+   */
+  void* userdata;
+
+  /** Ask @c alloc for huge pages, which save TLB misses on large tables.
+   */
+  bool hugepage;
+
+  /** The share of the PIT in percent one face can be a downstream of. 0 for no quota.
+   * @sa ndn_forwarder_set_face_limits
+   */
+  uint8_t pit_face_quota;
+
+  /** An #NDN_PIT_EVICTION, how to make room for an Interest from a face when the PIT is full.
+   */
+  uint8_t pit_eviction;
+} ndn_forwarder_config_t;
+
+/**
+ * Interests and PIT entries the forwarder shed under load.
+ */
+typedef struct ndn_forwarder_counters {
+  /** Interests dropped because their face was at its PIT quota.
+   */
+  uint32_t quota_shed;
+
+  /** Interests dropped by the rate limit of their face.
+   */
+  uint32_t rate_shed;
+
+  /** Interests dropped because the PIT was full and no entry could be evicted.
+   */
+  uint32_t pit_full_shed;
+
+  /** Entries evicted from the PIT for new Interests.
+   */
+  uint32_t pit_evicted;
+} ndn_forwarder_counters_t;
 
 /**
  * NDN-Lite forwarder.
- * We will support content store in future versions.
  * The NDN forwarder is a singleton in an application.
  */
 typedef struct ndn_forwarder {
@@ -56,7 +162,58 @@ typedef struct ndn_forwarder {
    * The pending Interest table (PIT).
    */
   ndn_pit_t* pit;
+  /**
+   * The content store (CS). @c NULL if there is none.
+   */
+  ndn_cs_t* cs;
+  /**
+   * [Optional] The second-level content store.
+   */
+  ndn_cs_tier_t* cs_tier;
+  /**
+   * The strategy of each prefix.
+   */
+  ndn_strategy_choice_t strategy_choice;
+
+  /**
+   * The limits of each face, ndn_forwarder_config#facetab_size of them.
+   */
+  ndn_face_admission_t* admission;
+
+  /**
+   * What was shed under load.
+   */
+  ndn_forwarder_counters_t counters;
 
+  /**
+   * The transmit queue of each face. @c NULL if the face sends at once.
+   */
+  ndn_face_queue_t** queues;
+
+  /**
+   * Faces whose queues are not empty.
+   */
+  ndn_faceset_t queued;
+
+  /**
+   * The time to retry sending the queued packets, once a face refused one.
+   */
+  ndn_time_ms_t queue_retry;
+
+  /**
+   * The config the tables were created with.
+   */
+  ndn_forwarder_config_t config;
+
+  /**
+   * The memory holding all tables, either #memory or one from ndn_forwarder_config#alloc.
+   */
+  uint8_t* region;
+  size_t region_size;
+
+  /**
+   * Built-in memory for tables of the default sizes.
+   */
   uint8_t memory[NDN_FORWARDER_DEFAULT_SIZE];
 } ndn_forwarder_t;
 
@@ -70,23 +227,110 @@ typedef struct ndn_forwarder {
  * @{
  */
 
-/** Initialize all components of the forwarder.
+/** Initialize all components of the forwarder with the default sizes.
+ *
+ * The tables are placed in the built-in memory.
  */
 void
 ndn_forwarder_init(void);
 
+/** Fill a config with the default sizes and no allocator.
+ */
+void
+ndn_forwarder_config_default(ndn_forwarder_config_t* config);
+
+/** Initialize all components of the forwarder with specified sizes.
+ *
+ * All tables are laid out in one region, obtained from @c config->alloc.
+ * Memory from an earlier initialization is released.
+ * @param[in] config The sizes and the allocator.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_OVERSIZE A size exceeds the limit of the table ID type. See #NDN_TABLE_ID_32BIT.
+ * @retval #NDN_FWD_NO_MEMORY The allocation failed,
+ *                            or the tables don't fit in the built-in memory without an allocator.
+ */
+int
+ndn_forwarder_init_with_config(const ndn_forwarder_config_t* config);
+
 /** Returns the forwarder as a pointer
  */
 const ndn_forwarder_t*
 ndn_forwarder_get(void);
 
-/** Process event messages.
+/** Process event messages, expired PIT entries, and the transmit queues of faces.
  *
- * This should be called at a fixed interval.
+ * This should be called at a fixed interval, or whenever a packet arrives
+ * or ndn_forwarder_next_deadline() is reached.
  */
 void
 ndn_forwarder_process(void);
 
+/** Get the time the forwarder next needs to run.
+ *
+ * An event loop may sleep until then if no packet arrives.
+ * @return The earliest PIT expiry in ndn_time_now_ms() units,
+ *         #NDN_FACE_QUEUE_RETRY_INTERVAL after a face refused a packet if it has packets queued,
+ *         or #NDN_PIT_NO_EXPIRY if there is nothing to do.
+ */
+ndn_time_ms_t
+ndn_forwarder_next_deadline(void);
+
+/** Attach a second-level content store.
+ *
+ * Cached Data are also written to @c tier, and Interests missing the CS are looked up in it.
+ * @param[in] tier The tier. @c NULL to detach the current one.
+ */
+void
+ndn_forwarder_set_cs_tier(ndn_cs_tier_t* tier);
+
+/** Set the forwarding strategy of a prefix.
+ *
+ * An Interest is forwarded by the strategy of its longest prefix which has one.
+ * "/" has #ndn_strategy_multicast after initialization.
+ * @param[in] prefix The prefix.
+ * @param[in] length The length of @c prefix.
+ * @param[in] strategy The strategy, e.g. #ndn_strategy_best_route.
+ *                     @c NULL to use the strategy of the parent prefix again.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_OVERSIZE @c prefix is longer than #NDN_STRATEGY_CHOICE_NAME_SIZE.
+ * @retval #NDN_FWD_STRATEGY_CHOICE_FULL See also #NDN_STRATEGY_CHOICE_MAX_SIZE.
+ */
+int
+ndn_forwarder_set_strategy(uint8_t* prefix, size_t length, const ndn_strategy_t* strategy);
+
+/** Set the limits of a face.
+ *
+ * An Interest from the face is Nacked with #NDN_NACK_REASON_CONGESTION
+ * if it would make the face a downstream of more PIT entries than the quota,
+ * or the face sent more Interests than the rate limit allows.
+ * A registered face has no rate limit and ndn_forwarder_config#pit_face_quota of the PIT.
+ * @param[in] face The face.
+ * @param[in] pit_quota The most PIT entries the face can be a downstream of. 0 for no quota.
+ * @param[in] rate Interests per second. 0 for no limit.
+ * @param[in] burst The most Interests the face can send at once under the rate limit.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_INVALID_FACE @c face is not registered.
+ */
+int
+ndn_forwarder_set_face_limits(ndn_face_intf_t* face, ndn_table_id_t pit_quota,
+                              uint32_t rate, uint32_t burst);
+
+/** Give a face a transmit queue.
+ *
+ * A packet the face can't send at once, or which would pass packets already queued,
+ * is queued and sent by ndn_forwarder_process().
+ * Data which waited too long is sent with an NDNLPv2 CongestionMark. See #NDN_CODEL_TARGET.
+ * A face which can't send should return an error, so the packet is retried later,
+ * and dropped after #NDN_FACE_QUEUE_SEND_TIMEOUT.
+ * A registered face has no queue, and sends synchronously ignoring failures.
+ * @param[in] face The face.
+ * @param[in] queue The queue, owned by the face. @c NULL to send synchronously again.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_INVALID_FACE @c face is not registered.
+ */
+int
+ndn_forwarder_set_face_queue(ndn_face_intf_t* face, ndn_face_queue_t* queue);
+
 /** Register a new face.
  *
  * The face should call this to get a face id during creation.
@@ -126,6 +370,22 @@ ndn_forwarder_unregister_face(ndn_face_intf_t* face);
 int
 ndn_forwarder_add_route(ndn_face_intf_t* face, uint8_t* prefix, size_t length);
 
+/** Add a route into FIB with a cost.
+ *
+ * A route added by ndn_forwarder_add_route() costs #NDN_FACE_DEFAULT_COST.
+ * Adding an existing route changes its cost.
+ * @param[in] face The face to forward.
+ * @param[in] prefix The prefix of the route.
+ * @param[in] length The length of @c prefix.
+ * @param[in] cost The cost. Strategies prefer routes of lower costs.
+ * @return #NDN_SUCCESS if the call succeeded. The error code otherwise.
+ * @retval #NDN_FWD_FIB_FULL FIB or NameTree is full, or #NDN_MAX_COST_PER_FIB_ENTRY routes
+ *                          of the prefix already have a cost other than the default.
+ */
+int
+ndn_forwarder_add_route_with_cost(ndn_face_intf_t* face, uint8_t* prefix, size_t length,
+                                  uint16_t cost);
+
 int
 ndn_forwarder_add_route_by_str(ndn_face_intf_t* face, const char* prefix, size_t length);
 
@@ -157,10 +417,23 @@ ndn_forwarder_remove_all_routes(uint8_t* prefix, size_t length);
 
 /** Receive a packet from a face.
  *
+ * The packet is an Interest, a Data, or an NDNLPv2 LpPacket carrying one of them or a Nack.
  */
 int
 ndn_forwarder_receive(ndn_face_intf_t* face, uint8_t* packet, size_t length);
 
+/** Receive packets read together from a face, in order.
+ *
+ * Each packet is handled as by ndn_forwarder_receive(), and one failing doesn't stop the others.
+ * @param[in] packets The packets.
+ * @param[in] lengths The length of each packet.
+ * @param[in] count The number of packets.
+ * @return The number of packets received successfully.
+ */
+size_t
+ndn_forwarder_receive_batch(ndn_face_intf_t* face, uint8_t* const* packets, const size_t* lengths,
+                            size_t count);
+
 /** Register a prefix.
  *
  * A latter registration cancels the former one.
@@ -211,6 +484,22 @@ ndn_forwarder_express_interest(uint8_t* interest, size_t length,
                                ndn_on_timeout_func on_timeout,
                                void* userdata);
 
+/** Express an interest, and get a Nack instead of waiting for the timeout
+ * when no upstream can bring the Data.
+ *
+ * Same as ndn_forwarder_express_interest(), except that exactly one of @c on_data,
+ * @c on_timeout and @c on_nack will be called.
+ * If an error is returned, none of them will be called.
+ * @param[in] on_nack [Optional] The callback function when all upstreams return Nacks.
+ * @retval #NDN_FWD_NO_ROUTE No route matches the Interest.
+ */
+int
+ndn_forwarder_express_interest_with_nack(uint8_t* interest, size_t length,
+                                         ndn_on_data_func on_data,
+                                         ndn_on_timeout_func on_timeout,
+                                         ndn_on_nack_func on_nack,
+                                         void* userdata);
+
 int
 ndn_forwarder_express_interest_struct(ndn_interest_t* interest,
                                       ndn_on_data_func on_data,
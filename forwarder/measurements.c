@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#include "measurements.h"
+
+void
+ndn_measurements_init(ndn_measurements_t* self, ndn_measurement_t* records, uint32_t count)
+{
+  uint32_t i;
+
+  // The last ID is reserved for NDN_INVALID_ID
+  if(count > NDN_INVALID_ID){
+    count = NDN_INVALID_ID;
+  }
+  self->records = records;
+  for(i = 0; i < count; i ++){
+    records[i].next = (i + 1 < count) ? i + 1 : NDN_INVALID_ID;
+  }
+  self->free_head = (count > 0) ? 0 : NDN_INVALID_ID;
+}
+
+ndn_measurement_t*
+ndn_measurements_find(const ndn_measurements_t* self, ndn_table_id_t head, ndn_table_id_t face_id)
+{
+  ndn_table_id_t id;
+  for(id = head; id != NDN_INVALID_ID; id = self->records[id].next){
+    if(self->records[id].face_id == face_id){
+      return &self->records[id];
+    }
+  }
+  return NULL;
+}
+
+ndn_measurement_t*
+ndn_measurements_find_or_insert(ndn_measurements_t* self, ndn_table_id_t* head, ndn_table_id_t face_id)
+{
+  ndn_measurement_t* record = ndn_measurements_find(self, *head, face_id);
+  ndn_table_id_t id = self->free_head;
+
+  if(record != NULL || id == NDN_INVALID_ID){
+    return record;
+  }
+  record = &self->records[id];
+  self->free_head = record->next;
+  record->face_id = face_id;
+  record->srtt = NDN_MEASUREMENTS_NO_RTT;
+  record->rttvar = 0;
+  record->last_time = 0;
+  record->next = *head;
+  *head = id;
+  return record;
+}
+
+void
+ndn_measurements_remove(ndn_measurements_t* self, ndn_table_id_t* head, ndn_table_id_t face_id)
+{
+  ndn_table_id_t* link = head;
+  ndn_table_id_t id;
+
+  while((id = *link) != NDN_INVALID_ID){
+    if(self->records[id].face_id == face_id){
+      *link = self->records[id].next;
+      self->records[id].next = self->free_head;
+      self->free_head = id;
+      return;
+    }
+    link = &self->records[id].next;
+  }
+}
+
+void
+ndn_measurements_remove_all(ndn_measurements_t* self, ndn_table_id_t* head)
+{
+  ndn_table_id_t id;
+
+  while((id = *head) != NDN_INVALID_ID){
+    *head = self->records[id].next;
+    self->records[id].next = self->free_head;
+    self->free_head = id;
+  }
+}
+
+void
+ndn_measurement_add_sample(ndn_measurement_t* self, uint32_t rtt, ndn_time_ms_t now)
+{
+  uint32_t delta;
+
+  if(self->srtt == NDN_MEASUREMENTS_NO_RTT){
+    self->srtt = rtt;
+    self->rttvar = rtt / 2;
+  }
+  else{
+    // alpha = 1/8, beta = 1/4
+    delta = (self->srtt > rtt) ? self->srtt - rtt : rtt - self->srtt;
+    self->rttvar = (3 * self->rttvar + delta) / 4;
+    self->srtt = (7 * self->srtt + rtt) / 8;
+  }
+  self->last_time = now;
+}
+
+void
+ndn_measurement_backoff(ndn_measurement_t* self)
+{
+  if(self->srtt == NDN_MEASUREMENTS_NO_RTT){
+    return;
+  }
+  self->srtt = (self->srtt < NDN_RTO_MAX / 2) ? 2 * self->srtt : NDN_RTO_MAX;
+  self->rttvar = (self->rttvar < NDN_RTO_MAX / 2) ? 2 * self->rttvar : NDN_RTO_MAX;
+}
+
+uint32_t
+ndn_measurement_rto(const ndn_measurement_t* self)
+{
+  uint64_t rto;
+
+  if(self == NULL || self->srtt == NDN_MEASUREMENTS_NO_RTT){
+    return NDN_RTO_INITIAL;
+  }
+  rto = (uint64_t)self->srtt + 4 * (uint64_t)self->rttvar;
+  if(rto < NDN_RTO_MIN){
+    return NDN_RTO_MIN;
+  }
+  return (rto > NDN_RTO_MAX) ? NDN_RTO_MAX : (uint32_t)rto;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_MEASUREMENTS_H_
+#define FORWARDER_MEASUREMENTS_H_
+
+#include "../ndn-constants.h"
+#include "../util/uniform-time.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdMeasurements Measurements
+ * @brief Round-trip times of next hops
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/** ndn_measurement#srtt of a face which has not brought Data yet.
+ */
+#define NDN_MEASUREMENTS_NO_RTT 0xFFFFFFFF
+
+/**
+ * The round-trip time of a next hop of a prefix, estimated as in RFC 6298.
+ */
+typedef struct ndn_measurement {
+  /** The last time the face brought Data or was probed.
+   */
+  ndn_time_ms_t last_time;
+
+  /** Smoothed RTT in milliseconds. #NDN_MEASUREMENTS_NO_RTT if there is no sample.
+   */
+  uint32_t srtt;
+
+  /** RTT variation in milliseconds.
+   */
+  uint32_t rttvar;
+
+  ndn_table_id_t face_id;
+
+  /** Next record of the same prefix. Next free record if the record is not used.
+   */
+  ndn_table_id_t next;
+} ndn_measurement_t;
+
+/**
+ * Measurements table.
+ *
+ * Records come from a fixed pool, and each prefix links its own in a list.
+ * The FIB keeps one, and a FIB entry owns the records of its next hops.
+ */
+typedef struct ndn_measurements {
+  /** Head of the free record list.
+   */
+  ndn_table_id_t free_head;
+
+  ndn_measurement_t* records;
+} ndn_measurements_t;
+
+/** The number of records for @c entry_count prefixes,
+ * which is enough if prefixes have #NDN_MAX_FACE_PER_PIT_ENTRY measured faces on average.
+ */
+#define NDN_MEASUREMENTS_COUNT(entry_count) (NDN_MAX_FACE_PER_PIT_ENTRY * (entry_count))
+
+/** Initialize a measurements table.
+ * @param[in] records Memory of #NDN_MEASUREMENTS_COUNT records.
+ * @param[in] count The number of records.
+ */
+void
+ndn_measurements_init(ndn_measurements_t* self, ndn_measurement_t* records, uint32_t count);
+
+/** Find the record of a face in a list.
+ * @param[in] head The head of the prefix's list.
+ * @return The record. @c NULL if none.
+ */
+ndn_measurement_t*
+ndn_measurements_find(const ndn_measurements_t* self, ndn_table_id_t head, ndn_table_id_t face_id);
+
+/** Find the record of a face in a list, or add one with no sample.
+ * @param[in, out] head The head of the prefix's list.
+ * @return The record. @c NULL if the pool ran out.
+ */
+ndn_measurement_t*
+ndn_measurements_find_or_insert(ndn_measurements_t* self, ndn_table_id_t* head, ndn_table_id_t face_id);
+
+/** Remove the record of a face from a list. No effect if there is none.
+ */
+void
+ndn_measurements_remove(ndn_measurements_t* self, ndn_table_id_t* head, ndn_table_id_t face_id);
+
+/** Remove all records of a list.
+ */
+void
+ndn_measurements_remove_all(ndn_measurements_t* self, ndn_table_id_t* head);
+
+/** Add an RTT sample.
+ * @param[in] rtt The time from sending the Interest to receiving the Data.
+ */
+void
+ndn_measurement_add_sample(ndn_measurement_t* self, uint32_t rtt, ndn_time_ms_t now);
+
+/** Back off after the face left an Interest unanswered for its RTO.
+ *
+ * SRTT and RTT variation are doubled, up to #NDN_RTO_MAX,
+ * so the face ranks behind faster ones until it brings Data again.
+ */
+void
+ndn_measurement_backoff(ndn_measurement_t* self);
+
+/** Get the retransmission timeout: SRTT plus 4 times the variation,
+ * within #NDN_RTO_MIN and #NDN_RTO_MAX.
+ * @param[in] self The record. @c NULL for a face with no record.
+ * @return The timeout in milliseconds. #NDN_RTO_INITIAL if there is no sample.
+ */
+uint32_t
+ndn_measurement_rto(const ndn_measurement_t* self);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_MEASUREMENTS_H_
@@ -9,147 +9,739 @@
  */
 
 #include "name-tree.h"
+#include "../encode/forwarder-helper.h"
+#include "../util/hash.h"
 #include <string.h>
 
-#define minof2(a, b) ((a) < (b) ? (a) : (b))
+/**
+ * Where a missing child goes, as found by nametree_child_find().
+ */
+typedef struct nametree_slot{
+  /** The previous sibling. #NDN_INVALID_ID if it goes first. */
+  ndn_table_id_t prev;
+  /** The position in the array block. */
+  ndn_table_id_t pos;
+} nametree_slot_t;
+
+static inline ndn_table_id_t*
+nametree_block(ndn_nametree_t *nametree, ndn_table_id_t block)
+{
+  return &nametree->blocks[(size_t)block * NDN_NAMETREE_ARRAY_MAX];
+}
+
+static inline nametree_component_t*
+nametree_comp_at(ndn_nametree_t *nametree, uint32_t handle)
+{
+  return (nametree_component_t*)&nametree->arena[handle];
+}
+
+/** Get the size class of a component block of @c size bytes.
+ * @return The size class. #NDN_NAMETREE_SIZE_CLASSES if it's too large.
+ */
+static inline uint8_t
+nametree_size_class(size_t size)
+{
+  uint8_t cls = 8;
+  size_t class_size = 128;
+
+  if (size <= 64) {
+    return (size + 7) / 8 - 1;
+  }
+  while (class_size < size && cls < NDN_NAMETREE_SIZE_CLASSES) {
+    class_size <<= 1;
+    cls++;
+  }
+  return cls;
+}
+
+static inline size_t
+nametree_class_size(uint8_t cls)
+{
+  return (cls < 8) ? 8 * ((size_t)cls + 1) : (size_t)128 << (cls - 8);
+}
+
+/** Find an interned component.
+ * @return The handle. #NDN_NAMETREE_NO_COMPONENT if it's not interned.
+ */
+static uint32_t
+nametree_comp_find(ndn_nametree_t *nametree, const uint8_t *value, size_t length, uint32_t hash)
+{
+  uint32_t handle = nametree->comp_buckets[hash & nametree->comp_bucket_mask];
+  nametree_component_t *comp;
+
+  while (handle != NDN_NAMETREE_NO_COMPONENT) {
+    comp = nametree_comp_at(nametree, handle);
+    if (comp->hash == hash && comp->length == length && memcmp(comp->value, value, length) == 0) {
+      return handle;
+    }
+    handle = comp->next;
+  }
+  return NDN_NAMETREE_NO_COMPONENT;
+}
+
+/** Give bytes of the arena back, as free blocks of the largest size classes which fit.
+ *
+ * Bytes at the end of the allocated region go back to it instead.
+ * A free block keeps its size in @c hash.
+ * @pre @c size is a multiple of 8.
+ */
+static void
+nametree_arena_free(ndn_nametree_t *nametree, uint32_t handle, uint32_t size)
+{
+  nametree_component_t *block;
+  uint32_t block_size;
+  uint8_t cls;
+
+  if (handle + size == nametree->arena_used) {
+    nametree->arena_used = handle;
+    return;
+  }
+  nametree->arena_free += size;
+  while (size > 0) {
+    cls = NDN_NAMETREE_SIZE_CLASSES - 1;
+    while (nametree_class_size(cls) > size) {
+      cls--;
+    }
+    block_size = (uint32_t)nametree_class_size(cls);
+    block = nametree_comp_at(nametree, handle);
+    block->hash = block_size;
+    block->next = nametree->free_comps[cls];
+    nametree->free_comps[cls] = handle;
+    handle += block_size;
+    size -= block_size;
+  }
+}
+
+/** Sort a list of @c count free blocks by address.
+ * @return The head of the sorted list.
+ */
+static uint32_t
+nametree_arena_sort(ndn_nametree_t *nametree, uint32_t head, uint32_t count)
+{
+  uint32_t left, right, result, i;
+  uint32_t *tail;
+
+  if (count <= 1) {
+    return head;
+  }
+  left = head;
+  for (i = 1; i < count / 2; ++i) {
+    head = nametree_comp_at(nametree, head)->next;
+  }
+  right = nametree_comp_at(nametree, head)->next;
+  nametree_comp_at(nametree, head)->next = NDN_NAMETREE_NO_COMPONENT;
+  left = nametree_arena_sort(nametree, left, count / 2);
+  right = nametree_arena_sort(nametree, right, count - count / 2);
+
+  tail = &result;
+  while (left != NDN_NAMETREE_NO_COMPONENT && right != NDN_NAMETREE_NO_COMPONENT) {
+    if (left < right) {
+      *tail = left;
+      tail = &nametree_comp_at(nametree, left)->next;
+      left = *tail;
+    }
+    else {
+      *tail = right;
+      tail = &nametree_comp_at(nametree, right)->next;
+      right = *tail;
+    }
+  }
+  *tail = (left != NDN_NAMETREE_NO_COMPONENT) ? left : right;
+  return result;
+}
 
+/** Merge adjacent free blocks, and give those at the end back to the allocated region.
+ */
 static void
-nametree_refresh(ndn_nametree_t *nametree, int num)
+nametree_arena_coalesce(ndn_nametree_t *nametree)
 {
-  (*nametree)[num].left_child = NDN_INVALID_ID;
-  (*nametree)[num].pit_id = NDN_INVALID_ID;
-  (*nametree)[num].fib_id = NDN_INVALID_ID;
+  uint32_t head = NDN_NAMETREE_NO_COMPONENT, count = 0;
+  uint32_t handle, next, start, end;
+  uint8_t cls;
+
+  // Gather the free blocks of all classes into one list
+  for (cls = 0; cls < NDN_NAMETREE_SIZE_CLASSES; ++cls) {
+    for (handle = nametree->free_comps[cls]; handle != NDN_NAMETREE_NO_COMPONENT; handle = next) {
+      next = nametree_comp_at(nametree, handle)->next;
+      nametree_comp_at(nametree, handle)->next = head;
+      head = handle;
+      count++;
+    }
+    nametree->free_comps[cls] = NDN_NAMETREE_NO_COMPONENT;
+  }
+  nametree->arena_free = 0;
 
-  (*nametree)[num].right_bro = (*nametree)[0].right_bro;
-  (*nametree)[0].right_bro = num;
+  handle = nametree_arena_sort(nametree, head, count);
+  while (handle != NDN_NAMETREE_NO_COMPONENT) {
+    start = handle;
+    end = handle;
+    while (handle == end) {
+      end += nametree_comp_at(nametree, handle)->hash;
+      handle = nametree_comp_at(nametree, handle)->next;
+    }
+    nametree_arena_free(nametree, start, end - start);
+  }
 }
 
-static int
-nametree_clean(ndn_nametree_t *nametree, int num)
+/** Allocate a block of a size class: a free one of the class, then the unallocated region,
+ * then a part of a larger free block. If none fits, free blocks are merged and it's retried.
+ * @return The handle. #NDN_NAMETREE_NO_COMPONENT if the arena is full.
+ */
+static uint32_t
+nametree_arena_alloc(ndn_nametree_t *nametree, uint8_t cls)
 {
-  int ret = 0;
-  if (num == NDN_INVALID_ID) {
+  uint32_t size = (uint32_t)nametree_class_size(cls);
+  uint32_t handle;
+  uint8_t larger;
+  int round;
+
+  for (round = 0; round < 2; ++round) {
+    handle = nametree->free_comps[cls];
+    if (handle != NDN_NAMETREE_NO_COMPONENT) {
+      nametree->free_comps[cls] = nametree_comp_at(nametree, handle)->next;
+      nametree->arena_free -= size;
+      return handle;
+    }
+    if (nametree->arena_size - nametree->arena_used >= size) {
+      handle = nametree->arena_used;
+      nametree->arena_used += size;
+      return handle;
+    }
+    for (larger = cls + 1; larger < NDN_NAMETREE_SIZE_CLASSES; ++larger) {
+      handle = nametree->free_comps[larger];
+      if (handle != NDN_NAMETREE_NO_COMPONENT) {
+        nametree->free_comps[larger] = nametree_comp_at(nametree, handle)->next;
+        nametree->arena_free -= (uint32_t)nametree_class_size(larger);
+        nametree_arena_free(nametree, handle + size, (uint32_t)nametree_class_size(larger) - size);
+        return handle;
+      }
+    }
+    // Merging can't help if the free bytes are too few anyway
+    if (nametree->arena_free + (nametree->arena_size - nametree->arena_used) < size) {
+      break;
+    }
+    nametree_arena_coalesce(nametree);
+  }
+  return NDN_NAMETREE_NO_COMPONENT;
+}
+
+/** Intern a component which is not interned yet. Its reference count starts at 0.
+ * @return The handle. #NDN_NAMETREE_NO_COMPONENT if the arena is full or it's too long.
+ */
+static uint32_t
+nametree_comp_add(ndn_nametree_t *nametree, const uint8_t *value, size_t length, uint32_t hash)
+{
+  uint8_t cls = nametree_size_class(sizeof(nametree_component_t) + length);
+  uint32_t handle, *bucket;
+  nametree_component_t *comp;
+
+  if (cls >= NDN_NAMETREE_SIZE_CLASSES) {
+    return NDN_NAMETREE_NO_COMPONENT;
+  }
+  handle = nametree_arena_alloc(nametree, cls);
+  if (handle == NDN_NAMETREE_NO_COMPONENT) {
+    return NDN_NAMETREE_NO_COMPONENT;
+  }
+
+  comp = nametree_comp_at(nametree, handle);
+  bucket = &nametree->comp_buckets[hash & nametree->comp_bucket_mask];
+  comp->hash = hash;
+  comp->next = *bucket;
+  comp->refs = 0;
+  comp->length = length;
+  memcpy(comp->value, value, length);
+  *bucket = handle;
+  return handle;
+}
+
+/** Drop a reference to a component, and free it if that was the last one.
+ */
+static void
+nametree_comp_unref(ndn_nametree_t *nametree, uint32_t handle)
+{
+  nametree_component_t *comp = nametree_comp_at(nametree, handle);
+  uint32_t *prev;
+  uint8_t cls;
+
+  if (comp->refs > 0 && --comp->refs > 0) {
+    return;
+  }
+  prev = &nametree->comp_buckets[comp->hash & nametree->comp_bucket_mask];
+  while (*prev != handle) {
+    prev = &nametree_comp_at(nametree, *prev)->next;
+  }
+  *prev = comp->next;
+  cls = nametree_size_class(sizeof(nametree_component_t) + comp->length);
+  nametree_arena_free(nametree, handle, (uint32_t)nametree_class_size(cls));
+}
+
+static inline uint32_t
+nametree_child_hash(ndn_table_id_t parent, uint32_t comp)
+{
+  uint32_t hash = ((uint32_t)parent * 0x9E3779B1u) ^ comp;
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+static void
+nametree_hash_insert(ndn_nametree_t *nametree, ndn_table_id_t parent, ndn_table_id_t child)
+{
+  nametree_bucket_t *buckets = nametree->buckets;
+  uint32_t mask = nametree->bucket_mask;
+  uint32_t j = nametree_child_hash(parent, nametree->nodes[child].comp) & mask;
+
+  // There are more buckets than nodes, so an empty one is always found
+  while (buckets[j].child != NDN_INVALID_ID) {
+    j = (j + 1) & mask;
+  }
+  buckets[j].parent = parent;
+  buckets[j].child = child;
+}
+
+static void
+nametree_hash_remove(ndn_nametree_t *nametree, ndn_table_id_t child)
+{
+  nametree_bucket_t *buckets = nametree->buckets;
+  uint32_t mask = nametree->bucket_mask;
+  uint32_t i = nametree_child_hash(nametree->nodes[child].parent, nametree->nodes[child].comp) & mask;
+  uint32_t j, home;
+
+  while (buckets[i].child != child) {
+    i = (i + 1) & mask;
+  }
+  // Backward-shift deletion: no tombstones, so probe lengths don't grow over time
+  for (j = (i + 1) & mask; buckets[j].child != NDN_INVALID_ID; j = (j + 1) & mask) {
+    home = nametree_child_hash(buckets[j].parent, nametree->nodes[buckets[j].child].comp) & mask;
+    // Move j into the hole at i unless its home lies cyclically in (i, j]
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      buckets[i] = buckets[j];
+      i = j;
+    }
+  }
+  buckets[i].child = NDN_INVALID_ID;
+}
+
+/** Find a child by its component handle.
+ * @param[out] slot Where the child should be inserted if it's not found.
+ * @return The ID of the child. #NDN_INVALID_ID if not found.
+ */
+static ndn_table_id_t
+nametree_child_find(ndn_nametree_t *nametree, ndn_table_id_t father, uint32_t comp,
+                    nametree_slot_t *slot)
+{
+  nametree_entry_t *entry = &nametree->nodes[father];
+  ndn_table_id_t now_node, last_node = NDN_INVALID_ID, lo, hi, mid;
+  ndn_table_id_t *block;
+  nametree_bucket_t *buckets;
+  uint32_t j;
+
+  switch (entry->child_kind) {
+  case NDN_NAMETREE_CHILD_ARRAY:
+    block = nametree_block(nametree, entry->child_block);
+    lo = 0;
+    hi = entry->child_count;
+    while (lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      if (nametree->nodes[block[mid]].comp == comp) {
+        slot->pos = mid;
+        return block[mid];
+      }
+      if (comp < nametree->nodes[block[mid]].comp) hi = mid; else lo = mid + 1;
+    }
+    slot->pos = lo;
+    slot->prev = (lo > 0) ? block[lo - 1] : NDN_INVALID_ID;
     return NDN_INVALID_ID;
+
+  case NDN_NAMETREE_CHILD_HASH:
+    buckets = nametree->buckets;
+    for (j = nametree_child_hash(father, comp) & nametree->bucket_mask;
+         buckets[j].child != NDN_INVALID_ID;
+         j = (j + 1) & nametree->bucket_mask) {
+      if (buckets[j].parent == father && nametree->nodes[buckets[j].child].comp == comp) {
+        return buckets[j].child;
+      }
+    }
+    // The sibling list is not sorted, so a new child goes first
+    slot->prev = NDN_INVALID_ID;
+    return NDN_INVALID_ID;
+
+  default:
+    for (now_node = entry->left_child;
+         now_node != NDN_INVALID_ID && nametree->nodes[now_node].comp < comp;
+         now_node = nametree->nodes[now_node].right_bro) {
+      last_node = now_node;
+    }
+    if (now_node != NDN_INVALID_ID && nametree->nodes[now_node].comp == comp) return now_node;
+    slot->prev = last_node;
+    return NDN_INVALID_ID;
+  }
+}
+
+static void
+nametree_block_free(ndn_nametree_t *nametree, nametree_entry_t *entry)
+{
+  nametree_block(nametree, entry->child_block)[0] = nametree->free_block;
+  nametree->free_block = entry->child_block;
+  entry->child_block = NDN_INVALID_ID;
+}
+
+/** Move the children of a node from its sibling list to the hash table.
+ */
+static void
+nametree_promote_to_hash(ndn_nametree_t *nametree, ndn_table_id_t father)
+{
+  nametree_entry_t *entry = &nametree->nodes[father];
+  ndn_table_id_t child;
+
+  if (entry->child_block != NDN_INVALID_ID) {
+    nametree_block_free(nametree, entry);
+  }
+  for (child = entry->left_child; child != NDN_INVALID_ID; child = nametree->nodes[child].right_bro) {
+    nametree_hash_insert(nametree, father, child);
+  }
+  entry->child_kind = NDN_NAMETREE_CHILD_HASH;
+}
+
+/** Index the children of a node by a sorted array, or the hash table if no block is free.
+ * @pre The sibling list is sorted and has at most #NDN_NAMETREE_ARRAY_MAX children.
+ */
+static void
+nametree_promote(ndn_nametree_t *nametree, ndn_table_id_t father)
+{
+  nametree_entry_t *entry = &nametree->nodes[father];
+  ndn_table_id_t child, *block, i = 0;
+
+  if (nametree->free_block == NDN_INVALID_ID) {
+    nametree_promote_to_hash(nametree, father);
+    return;
+  }
+  entry->child_block = nametree->free_block;
+  block = nametree_block(nametree, entry->child_block);
+  nametree->free_block = block[0];
+  for (child = entry->left_child; child != NDN_INVALID_ID; child = nametree->nodes[child].right_bro) {
+    block[i++] = child;
+  }
+  entry->child_kind = NDN_NAMETREE_CHILD_ARRAY;
+}
+
+/** Take the children of a hashed node out of the hash table, and sort its sibling list.
+ * @pre It has at most #NDN_NAMETREE_ARRAY_MAX children.
+ */
+static void
+nametree_demote_from_hash(ndn_nametree_t *nametree, ndn_table_id_t father)
+{
+  nametree_entry_t *entry = &nametree->nodes[father];
+  ndn_table_id_t ids[NDN_NAMETREE_ARRAY_MAX];
+  ndn_table_id_t child, i = 0, j;
+
+  for (child = entry->left_child; child != NDN_INVALID_ID; child = nametree->nodes[child].right_bro) {
+    nametree_hash_remove(nametree, child);
+    for (j = i; j > 0 && nametree->nodes[child].comp < nametree->nodes[ids[j - 1]].comp; --j) {
+      ids[j] = ids[j - 1];
+    }
+    ids[j] = child;
+    i++;
+  }
+  entry->left_child = ids[0];
+  for (i = 0; i < entry->child_count; ++i) {
+    nametree->nodes[ids[i]].left_bro = (i > 0) ? ids[i - 1] : NDN_INVALID_ID;
+    nametree->nodes[ids[i]].right_bro = (i + 1 < entry->child_count) ? ids[i + 1] : NDN_INVALID_ID;
+  }
+  entry->child_kind = NDN_NAMETREE_CHILD_LIST;
+}
+
+/** Insert a node as a child, after it was not found by nametree_child_find().
+ */
+static void
+nametree_child_insert(ndn_nametree_t *nametree, ndn_table_id_t father,
+                      ndn_table_id_t child, const nametree_slot_t *slot)
+{
+  nametree_entry_t *entry = &nametree->nodes[father];
+  ndn_table_id_t next, *block;
+
+  next = (slot->prev == NDN_INVALID_ID) ? entry->left_child : nametree->nodes[slot->prev].right_bro;
+  nametree->nodes[child].parent = father;
+  nametree->nodes[child].left_bro = slot->prev;
+  nametree->nodes[child].right_bro = next;
+  if (slot->prev == NDN_INVALID_ID) {
+    entry->left_child = child;
   }
   else {
-    (*nametree)[num].left_child = nametree_clean(nametree, (*nametree)[num].left_child);
-    (*nametree)[num].right_bro = nametree_clean(nametree, (*nametree)[num].right_bro);
-    if ((*nametree)[num].fib_id == NDN_INVALID_ID &&
-        (*nametree)[num].pit_id == NDN_INVALID_ID &&
-        (*nametree)[num].left_child == NDN_INVALID_ID) {
-      ret = (*nametree)[num].right_bro;
-      nametree_refresh(nametree, num);
-      return ret;
+    nametree->nodes[slot->prev].right_bro = child;
+  }
+  if (next != NDN_INVALID_ID) {
+    nametree->nodes[next].left_bro = child;
+  }
+  entry->child_count++;
+
+  switch (entry->child_kind) {
+  case NDN_NAMETREE_CHILD_ARRAY:
+    if (entry->child_count > NDN_NAMETREE_ARRAY_MAX) {
+      nametree_promote_to_hash(nametree, father);
+      break;
     }
-    else {
-      return num;
+    block = nametree_block(nametree, entry->child_block);
+    memmove(&block[slot->pos + 1], &block[slot->pos],
+            sizeof(ndn_table_id_t) * (entry->child_count - 1 - slot->pos));
+    block[slot->pos] = child;
+    break;
+
+  case NDN_NAMETREE_CHILD_HASH:
+    nametree_hash_insert(nametree, father, child);
+    break;
+
+  default:
+    if (entry->child_count > NDN_NAMETREE_LIST_MAX) {
+      nametree_promote(nametree, father);
     }
+    break;
   }
 }
 
+/** Remove a child from its parent.
+ * A node is demoted when it has half the children of the limit of its kind,
+ * so that a node around a limit is not promoted and demoted back and forth.
+ */
 static void
-nametree_cleanup(ndn_nametree_t *nametree)
+nametree_child_remove(ndn_nametree_t *nametree, ndn_table_id_t child)
 {
-  (*nametree)[0].left_child = nametree_clean(nametree, (*nametree)[0].left_child);
+  nametree_entry_t *node = &nametree->nodes[child];
+  ndn_table_id_t father = node->parent;
+  nametree_entry_t *entry = &nametree->nodes[father];
+  nametree_slot_t slot;
+  ndn_table_id_t *block;
+
+  switch (entry->child_kind) {
+  case NDN_NAMETREE_CHILD_ARRAY:
+    nametree_child_find(nametree, father, node->comp, &slot);
+    block = nametree_block(nametree, entry->child_block);
+    memmove(&block[slot.pos], &block[slot.pos + 1],
+            sizeof(ndn_table_id_t) * (entry->child_count - 1 - slot.pos));
+    break;
+
+  case NDN_NAMETREE_CHILD_HASH:
+    nametree_hash_remove(nametree, child);
+    break;
+
+  default:
+    break;
+  }
+
+  if (node->left_bro == NDN_INVALID_ID) {
+    entry->left_child = node->right_bro;
+  }
+  else {
+    nametree->nodes[node->left_bro].right_bro = node->right_bro;
+  }
+  if (node->right_bro != NDN_INVALID_ID) {
+    nametree->nodes[node->right_bro].left_bro = node->left_bro;
+  }
+  entry->child_count--;
+
+  if (entry->child_kind == NDN_NAMETREE_CHILD_ARRAY &&
+      entry->child_count <= NDN_NAMETREE_LIST_MAX / 2) {
+    nametree_block_free(nametree, entry);
+    entry->child_kind = NDN_NAMETREE_CHILD_LIST;
+  }
+  else if (entry->child_kind == NDN_NAMETREE_CHILD_HASH &&
+           entry->child_count <= NDN_NAMETREE_ARRAY_MAX / 2) {
+    nametree_demote_from_hash(nametree, father);
+    if (entry->child_count > NDN_NAMETREE_LIST_MAX) {
+      nametree_promote(nametree, father);
+    }
+  }
+}
+
+static void
+nametree_free_node(ndn_nametree_t *nametree, ndn_table_id_t num)
+{
+  nametree_comp_unref(nametree, nametree->nodes[num].comp);
+  nametree->nodes[num].comp = NDN_NAMETREE_NO_COMPONENT;
+  nametree->nodes[num].right_bro = nametree->nodes[0].right_bro;
+  nametree->nodes[0].right_bro = num;
+}
+
+void
+ndn_nametree_release(ndn_nametree_t *nametree, nametree_entry_t* entry)
+{
+  ndn_table_id_t num = ndn_nametree_getid(nametree, entry);
+  ndn_table_id_t father;
+
+  while (num != 0 &&
+         nametree->nodes[num].pit_id == NDN_INVALID_ID &&
+         nametree->nodes[num].fib_id == NDN_INVALID_ID &&
+         nametree->nodes[num].child_count == 0) {
+    father = nametree->nodes[num].parent;
+    nametree_child_remove(nametree, num);
+    nametree_free_node(nametree, num);
+    num = father;
+  }
 }
 
 void
 ndn_nametree_init(void* memory, ndn_table_id_t capacity)
 {
   ndn_nametree_t *nametree = (ndn_nametree_t*)memory;
-  //all free entries are linked as right_bro of (*nametree)[0], the root of the tree.
-  for (int i = 0; i < capacity; ++i) {
-    (*nametree)[i].left_child = (*nametree)[i].pit_id = (*nametree)[i].fib_id = NDN_INVALID_ID;
-    (*nametree)[i].right_bro = i + 1;
+  uint32_t bucket_count, j;
+  ndn_table_id_t b;
+
+  //all free entries are linked as right_bro of nametree->nodes[0], the root of the tree.
+  for (ndn_table_id_t i = 0; i < capacity; ++i) {
+    nametree->nodes[i].comp = NDN_NAMETREE_NO_COMPONENT;
+    nametree->nodes[i].left_child = nametree->nodes[i].pit_id = nametree->nodes[i].fib_id = NDN_INVALID_ID;
+    nametree->nodes[i].right_bro = i + 1;
+    nametree->nodes[i].left_bro = nametree->nodes[i].parent = NDN_INVALID_ID;
+    nametree->nodes[i].child_count = 0;
+    nametree->nodes[i].child_block = NDN_INVALID_ID;
+    nametree->nodes[i].child_kind = NDN_NAMETREE_CHILD_LIST;
+  }
+  nametree->nodes[capacity - 1].right_bro = NDN_INVALID_ID;
+  nametree->capacity = capacity;
+
+  // No more intern buckets than nodes; 2 * capacity are reserved for the rounding up
+  bucket_count = 1;
+  while (bucket_count < (uint32_t)capacity) {
+    bucket_count <<= 1;
+  }
+  nametree->comp_bucket_mask = bucket_count - 1;
+  nametree->comp_buckets = (uint32_t*)&nametree->nodes[capacity];
+  for (j = 0; j < bucket_count; ++j) {
+    nametree->comp_buckets[j] = NDN_NAMETREE_NO_COMPONENT;
+  }
+
+  // Blocks of the arena are multiples of 8 bytes, so all stay aligned
+  nametree->arena = (uint8_t*)&nametree->comp_buckets[2 * (uint32_t)capacity];
+  nametree->arena_size = (uint32_t)(NDN_NAMETREE_ARENA_BYTES_PER_ENTRY * capacity) & ~(uint32_t)7;
+  nametree->arena_used = 0;
+  nametree->arena_free = 0;
+  for (j = 0; j < NDN_NAMETREE_SIZE_CLASSES; ++j) {
+    nametree->free_comps[j] = NDN_NAMETREE_NO_COMPONENT;
+  }
+
+  nametree->blocks = (ndn_table_id_t*)&nametree->arena[NDN_NAMETREE_ARENA_BYTES_PER_ENTRY * (size_t)capacity];
+  nametree->block_count = NDN_NAMETREE_BLOCK_COUNT(capacity);
+  for (b = 0; b < nametree->block_count; ++b) {
+    nametree_block(nametree, b)[0] = (b + 1 < nametree->block_count) ? b + 1 : NDN_INVALID_ID;
+  }
+  nametree->free_block = 0;
+
+  // At least twice as many buckets as nodes keeps probe sequences short
+  nametree->buckets = (nametree_bucket_t*)nametree_block(nametree, nametree->block_count);
+  bucket_count = 2;
+  while (bucket_count < 2 * (uint32_t)capacity) {
+    bucket_count <<= 1;
+  }
+  nametree->bucket_mask = bucket_count - 1;
+  for (j = 0; j < bucket_count; ++j) {
+    nametree->buckets[j].child = NDN_INVALID_ID;
   }
-  (*nametree)[capacity - 1].right_bro = NDN_INVALID_ID;
 }
 
-static int
-nametree_create_node(ndn_nametree_t *nametree, uint8_t name[], size_t len)
+static ndn_table_id_t
+nametree_create_node(ndn_nametree_t *nametree, uint32_t comp)
 {
-  int output = (*nametree)[0].right_bro;
+  ndn_table_id_t output = nametree->nodes[0].right_bro;
   if (output == NDN_INVALID_ID) return NDN_INVALID_ID;
-  (*nametree)[0].right_bro = (*nametree)[output].right_bro;
-  (*nametree)[output].left_child  = (*nametree)[output].right_bro = NDN_INVALID_ID;
-  (*nametree)[output].pit_id = (*nametree)[output].fib_id = NDN_INVALID_ID;
-  memcpy((*nametree)[output].val, name, len);
+  nametree->nodes[0].right_bro = nametree->nodes[output].right_bro;
+  nametree->nodes[output].left_child  = nametree->nodes[output].right_bro = NDN_INVALID_ID;
+  nametree->nodes[output].pit_id = nametree->nodes[output].fib_id = NDN_INVALID_ID;
+  nametree->nodes[output].child_count = 0;
+  nametree->nodes[output].child_block = NDN_INVALID_ID;
+  nametree->nodes[output].child_kind = NDN_NAMETREE_CHILD_LIST;
+  nametree->nodes[output].comp = comp;
+  nametree_comp_at(nametree, comp)->refs++;
   return output;
 }
 
-nametree_entry_t*
-ndn_nametree_find(ndn_nametree_t *nametree, uint8_t name[], size_t len)
+/** Get the offset of the first component of a Name.
+ * @return The offset. 0 if @c name is too short.
+ */
+static size_t
+nametree_name_start(const uint8_t name[], size_t len)
 {
-  int now_node, father = 0 , tmp;
-  size_t component_len, eqiv_component_len, offset = 0;
   // TODO: Put it into decoder
-  if (len < 2) return NULL;
-  if (name[1] < 253) offset = 2; else offset = 4;
-  while (offset < len) {
-    component_len = name[offset + 1] + 2;
-    eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
-    now_node = (*nametree)[father].left_child;
-    tmp = -2;
-    while (now_node != NDN_INVALID_ID) {
-      tmp = memcmp(name+offset, (*nametree)[now_node].val , eqiv_component_len);
-      if (tmp <= 0) break;
-      now_node = (*nametree)[now_node].right_bro;
-    }
-    if (tmp != 0) {
-      return NULL;
-    }
-    offset += component_len;
-    father = now_node;
+  if (len < 2) return 0;
+  return (name[1] < 253) ? 2 : 4;
+}
+
+/** Get the length of the TLV encoded component at @c offset.
+ * @return The length. 0 if the component is malformed or truncated.
+ */
+static size_t
+nametree_component_len(uint8_t name[], size_t len, size_t offset)
+{
+  uint32_t type, value_len;
+  uint8_t *value = tlv_get_type_length(name + offset, len - offset, &type, &value_len);
+  if (value == NULL || value_len > len - (size_t)(value - name)) {
+    return 0;
   }
-  return &(*nametree)[father];
+  return (value - (name + offset)) + value_len;
 }
 
-static nametree_entry_t*
-nametree_find_or_insert_try(ndn_nametree_t *nametree, uint8_t name[], size_t len)
+nametree_entry_t*
+ndn_nametree_find(ndn_nametree_t *nametree, uint8_t name[], size_t len)
 {
-  int now_node, last_node, father = 0 , tmp , new_node_number;
-  size_t component_len, eqiv_component_len, offset = 0;
-  // TODO: Put it into decoder
-  if (len < 2) return NULL;
-  if (name[1] < 253) offset = 2; else offset = 4;
+  ndn_table_id_t now_node, father = 0;
+  size_t component_len, offset = nametree_name_start(name, len);
+  uint32_t comp;
+  nametree_slot_t slot;
+  if (offset == 0) return NULL;
   while (offset < len) {
-    component_len = name[offset + 1] + 2;
-    eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
-    now_node = (*nametree)[father].left_child;
-    last_node = NDN_INVALID_ID;
-    tmp = -2;
-    while (now_node != NDN_INVALID_ID) {
-      tmp = memcmp(name+offset, (*nametree)[now_node].val , eqiv_component_len);
-      if (tmp <= 0) break;
-      last_node = now_node;
-      now_node = (*nametree)[now_node].right_bro;
-    }
-    if (tmp != 0) {
-      new_node_number = nametree_create_node(nametree, name + offset , eqiv_component_len);
-      if (new_node_number == NDN_INVALID_ID) return NULL;
-      if(last_node == NDN_INVALID_ID){
-        (*nametree)[father].left_child = new_node_number;
-      }else{
-        (*nametree)[last_node].right_bro = new_node_number;
-      }
-      (*nametree)[new_node_number].right_bro = now_node;
-      now_node = new_node_number;
-    }
+    component_len = nametree_component_len(name, len, offset);
+    if (component_len == 0) return NULL;
+    comp = nametree_comp_find(nametree, name + offset, component_len, ndn_hash(name + offset, component_len));
+    if (comp == NDN_NAMETREE_NO_COMPONENT) return NULL;
+    now_node = nametree_child_find(nametree, father, comp, &slot);
+    if (now_node == NDN_INVALID_ID) return NULL;
     offset += component_len;
     father = now_node;
   }
-  return &(*nametree)[father];
+  return &nametree->nodes[father];
 }
 
 nametree_entry_t*
 ndn_nametree_find_or_insert(ndn_nametree_t *nametree, uint8_t name[], size_t len)
 {
-  nametree_entry_t* p = nametree_find_or_insert_try(nametree, name , len);
-  if (p == NULL) {
-    nametree_cleanup(nametree);
-    p = nametree_find_or_insert_try(nametree, name , len);
+  ndn_table_id_t now_node, father = 0;
+  size_t component_len, offset = nametree_name_start(name, len);
+  uint32_t comp, hash;
+  nametree_slot_t slot;
+  if (offset == 0) return NULL;
+  while (offset < len) {
+    now_node = NDN_INVALID_ID;
+    component_len = nametree_component_len(name, len, offset);
+    comp = NDN_NAMETREE_NO_COMPONENT;
+    if (component_len > 0) {
+      hash = ndn_hash(name + offset, component_len);
+      comp = nametree_comp_find(nametree, name + offset, component_len, hash);
+      if (comp == NDN_NAMETREE_NO_COMPONENT) {
+        comp = nametree_comp_add(nametree, name + offset, component_len, hash);
+      }
+    }
+    if (comp != NDN_NAMETREE_NO_COMPONENT) {
+      now_node = nametree_child_find(nametree, father, comp, &slot);
+      if (now_node == NDN_INVALID_ID) {
+        now_node = nametree_create_node(nametree, comp);
+        if (now_node != NDN_INVALID_ID) {
+          nametree_child_insert(nametree, father, now_node, &slot);
+        }
+        else if (nametree_comp_at(nametree, comp)->refs == 0) {
+          // Just interned
+          nametree_comp_unref(nametree, comp);
+        }
+      }
+    }
+    if (now_node == NDN_INVALID_ID) {
+      // Give back the ancestors created so far
+      ndn_nametree_release(nametree, &nametree->nodes[father]);
+      return NULL;
+    }
+    offset += component_len;
+    father = now_node;
   }
-  return p;
+  return &nametree->nodes[father];
 }
 
 nametree_entry_t*
@@ -159,36 +751,79 @@ ndn_nametree_prefix_match(
                           size_t len,
                           enum NDN_NAMETREE_ENTRY_TYPE type)
 {
-  int now_node, last_node = NDN_INVALID_ID , father = 0 , tmp;
-  size_t component_len, eqiv_component_len, offset = 0;
-  if (len < 2) return NULL;
-  if (name[1] < 253) offset = 2; else offset = 4;
+  ndn_table_id_t now_node, last_node = NDN_INVALID_ID, father = 0;
+  size_t component_len, offset = nametree_name_start(name, len);
+  uint32_t comp;
+  nametree_slot_t slot;
+  if (offset == 0) return NULL;
   while (offset < len) {
-    component_len = name[offset + 1] + 2;
-    eqiv_component_len = minof2(component_len, NDN_NAME_COMPONENT_BUFFER_SIZE);
-    now_node = (*nametree)[father].left_child;
-    tmp = -2;
-    while (now_node != NDN_INVALID_ID) {
-      tmp = memcmp(name+offset,(*nametree)[now_node].val , eqiv_component_len);
-      if (tmp <= 0) break;
-      now_node = (*nametree)[now_node].right_bro;
-    }
-    if (tmp == 0) {
-      if ((*nametree)[now_node].fib_id != NDN_INVALID_ID && type == NDN_NAMETREE_FIB_TYPE) last_node = now_node;
-      if ((*nametree)[now_node].pit_id != NDN_INVALID_ID && type == NDN_NAMETREE_PIT_TYPE) last_node = now_node;
+    component_len = nametree_component_len(name, len, offset);
+    if (component_len == 0) break;
+    comp = nametree_comp_find(nametree, name + offset, component_len, ndn_hash(name + offset, component_len));
+    if (comp == NDN_NAMETREE_NO_COMPONENT) break;
+    now_node = nametree_child_find(nametree, father, comp, &slot);
+    if (now_node != NDN_INVALID_ID) {
+      if (nametree->nodes[now_node].fib_id != NDN_INVALID_ID && type == NDN_NAMETREE_FIB_TYPE) last_node = now_node;
+      if (nametree->nodes[now_node].pit_id != NDN_INVALID_ID && type == NDN_NAMETREE_PIT_TYPE) last_node = now_node;
     } else break;
     offset += component_len;
     father = now_node;
   }
-  if (last_node == NDN_INVALID_ID) return NULL; else return &(*nametree)[last_node];
+  if (last_node == NDN_INVALID_ID) return NULL; else return &nametree->nodes[last_node];
+}
+
+size_t
+ndn_nametree_collect_prefixes(
+                              ndn_nametree_t* nametree,
+                              uint8_t name[],
+                              size_t len,
+                              enum NDN_NAMETREE_ENTRY_TYPE type,
+                              nametree_entry_t** entries,
+                              size_t max_count,
+                              bool* exact)
+{
+  ndn_table_id_t now_node, father = 0;
+  size_t component_len, count = 0, offset = nametree_name_start(name, len);
+  uint32_t comp;
+  nametree_slot_t slot;
+  *exact = false;
+  if (offset == 0) return 0;
+  while (offset < len && count < max_count) {
+    component_len = nametree_component_len(name, len, offset);
+    if (component_len == 0) break;
+    comp = nametree_comp_find(nametree, name + offset, component_len, ndn_hash(name + offset, component_len));
+    if (comp == NDN_NAMETREE_NO_COMPONENT) break;
+    now_node = nametree_child_find(nametree, father, comp, &slot);
+    if (now_node == NDN_INVALID_ID) break;
+    offset += component_len;
+    father = now_node;
+    if ((type == NDN_NAMETREE_FIB_TYPE && nametree->nodes[now_node].fib_id != NDN_INVALID_ID) ||
+        (type == NDN_NAMETREE_PIT_TYPE && nametree->nodes[now_node].pit_id != NDN_INVALID_ID)) {
+      entries[count++] = &nametree->nodes[now_node];
+      *exact = (offset >= len);
+    }
+  }
+  return count;
 }
 
 nametree_entry_t*
 ndn_nametree_at(ndn_nametree_t *self, ndn_table_id_t id){
-  return &(*self)[id];
+  return &self->nodes[id];
 }
 
 ndn_table_id_t
 ndn_nametree_getid(ndn_nametree_t *self, nametree_entry_t* entry){
-  return entry - &(*self)[0];
+  return entry - &self->nodes[0];
+}
+
+const uint8_t*
+ndn_nametree_component(ndn_nametree_t *self, nametree_entry_t* entry, size_t* length){
+  nametree_component_t *comp;
+  if (entry->comp == NDN_NAMETREE_NO_COMPONENT) {
+    *length = 0;
+    return NULL;
+  }
+  comp = nametree_comp_at(self, entry->comp);
+  *length = comp->length;
+  return comp->value;
 }
@@ -14,6 +14,7 @@
 #include "../ndn-constants.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 /** @defgroup NDNFwdNameTree Name Tree
  * @brief Name Tree
@@ -28,14 +29,60 @@ enum NDN_NAMETREE_ENTRY_TYPE{
   NDN_NAMETREE_ENTRY_TYPE_CNT
 };
 
+/**
+ * How the children of a node are indexed.
+ * A node is promoted when its children grow, and demoted when they shrink to half the limit.
+ */
+enum NDN_NAMETREE_CHILD_KIND{
+  /** Sibling list sorted by component handle, scanned linearly. */
+  NDN_NAMETREE_CHILD_LIST,
+  /** Array of child IDs sorted by component handle, searched by bisection. */
+  NDN_NAMETREE_CHILD_ARRAY,
+  /** The shared hash table, keyed by parent and component handle. */
+  NDN_NAMETREE_CHILD_HASH,
+};
+
+/** Max children of a node indexed by its sibling list.
+ */
+#define NDN_NAMETREE_LIST_MAX 8
+
+/** Max children of a node indexed by a sorted array, which is the size of an array block.
+ */
+#define NDN_NAMETREE_ARRAY_MAX 64
+
+/** Number of array blocks of a NameTree.
+ * Nodes which don't get a block go to the hash table instead.
+ */
+#define NDN_NAMETREE_BLOCK_COUNT(entry_count) ((entry_count) / 32 + 1)
+
+/** Bytes of the component arena per node.
+ * A component takes a header and its TLV rounded up to 8 bytes,
+ * so the default fits a 32-byte digest on every node even if no component is shared.
+ * Shorter components leave room for longer ones elsewhere.
+ */
+#ifndef NDN_NAMETREE_ARENA_BYTES_PER_ENTRY
+#define NDN_NAMETREE_ARENA_BYTES_PER_ENTRY \
+  ((sizeof(nametree_component_t) + 2 + 32 + 7) & ~(size_t)7)
+#endif
+
+/** Number of size classes of the component arena.
+ * Classes are multiples of 8 up to 64 bytes, then powers of 2 up to 1024 bytes.
+ */
+#define NDN_NAMETREE_SIZE_CLASSES 12
+
+/** The handle of no component.
+ */
+#define NDN_NAMETREE_NO_COMPONENT 0xFFFFFFFF
+
 /**
  * NameTree node.
  */
 typedef struct nametree_entry{
   /**
-   * Name component of this node.
+   * Handle of the name component of this node in the component arena.
+   * Nodes with equal components have equal handles.
    */
-  uint8_t val[NDN_NAME_COMPONENT_BLOCK_SIZE];
+  uint32_t comp;
 
   /**
    * First child of this node.
@@ -51,6 +98,18 @@ typedef struct nametree_entry{
    */
   ndn_table_id_t right_bro;
 
+  /**
+   * Left brother of this node.
+   * #NDN_INVALID_ID if none.
+   */
+  ndn_table_id_t left_bro;
+
+  /**
+   * Parent of this node.
+   * #NDN_INVALID_ID for the root.
+   */
+  ndn_table_id_t parent;
+
   /**
    * Corresponding PIT entry's id.
    * #NDN_INVALID_ID if none.
@@ -62,18 +121,149 @@ typedef struct nametree_entry{
    * #NDN_INVALID_ID if none.
    */
   ndn_table_id_t fib_id;
+
+  /**
+   * Number of children.
+   * With #pit_id and #fib_id, this is the reference count of the node:
+   * it's freed by ndn_nametree_release() when all are gone.
+   */
+  ndn_table_id_t child_count;
+
+  /**
+   * Array block of the children if #child_kind is #NDN_NAMETREE_CHILD_ARRAY.
+   * #NDN_INVALID_ID otherwise.
+   */
+  ndn_table_id_t child_block;
+
+  /**
+   * How the children are indexed, an #NDN_NAMETREE_CHILD_KIND.
+   * Children are also in the sibling list, which is not sorted for #NDN_NAMETREE_CHILD_HASH.
+   */
+  uint8_t child_kind;
 } nametree_entry_t;
 
-typedef nametree_entry_t ndn_nametree_t[];
+/**
+ * A bucket of the NameTree child hash table.
+ */
+typedef struct nametree_bucket{
+  ndn_table_id_t parent;
+
+  /**
+   * #NDN_INVALID_ID if the bucket is empty.
+   */
+  ndn_table_id_t child;
+} nametree_bucket_t;
 
-#define NDN_NAMETREE_RESERVE_SIZE(entry_count) (sizeof(nametree_entry_t) * (entry_count))
+/**
+ * An interned name component in the component arena.
+ */
+typedef struct nametree_component{
+  /**
+   * Hash of the component. For a free block, its size in bytes.
+   */
+  uint32_t hash;
+
+  /**
+   * Next component of the same intern bucket.
+   * For a free block, next free block of the same size class.
+   * #NDN_NAMETREE_NO_COMPONENT if none.
+   */
+  uint32_t next;
+
+  /**
+   * Number of nodes using this component.
+   */
+  ndn_table_id_t refs;
+
+  /**
+   * Length of the TLV encoded component.
+   */
+  uint16_t length;
+
+  /**
+   * The TLV encoded component.
+   */
+  uint8_t value[];
+} nametree_component_t;
+
+/**
+ * NameTree.
+ *
+ * The memory is this header and the nodes, followed by the intern buckets,
+ * the component arena, the array blocks and the child hash buckets.
+ * A node refers to its component by a handle, so matching a child is an integer comparison,
+ * and components of any length are stored once however many nodes share them.
+ */
+typedef struct ndn_nametree{
+  ndn_table_id_t capacity;
+  ndn_table_id_t block_count;
+
+  /** First free array block. Free blocks are linked through their first slot.
+   */
+  ndn_table_id_t free_block;
+
+  /** Number of child hash buckets minus one. The number of buckets is a power of 2.
+   */
+  uint32_t bucket_mask;
+
+  /** Number of intern buckets minus one. The number of buckets is a power of 2.
+   */
+  uint32_t comp_bucket_mask;
+
+  uint32_t arena_size;
+
+  /** Bytes at the beginning of the arena which are allocated or in free blocks.
+   * The rest is allocated from the end of this region.
+   */
+  uint32_t arena_used;
+
+  /** Bytes of the free blocks.
+   */
+  uint32_t arena_free;
+
+  /** First free block of every size class.
+   * A larger block is split when a class has none, and adjacent ones are merged when nothing fits.
+   */
+  uint32_t free_comps[NDN_NAMETREE_SIZE_CLASSES];
+
+  uint32_t* comp_buckets;
+  uint8_t* arena;
+  ndn_table_id_t* blocks;
+  nametree_bucket_t* buckets;
+
+  nametree_entry_t nodes[];
+} ndn_nametree_t;
+
+#define NDN_NAMETREE_RESERVE_SIZE(entry_count) \
+  (sizeof(ndn_nametree_t) + \
+   sizeof(nametree_entry_t) * (entry_count) + \
+   sizeof(uint32_t) * 2 * (entry_count) + \
+   NDN_NAMETREE_ARENA_BYTES_PER_ENTRY * (entry_count) + \
+   sizeof(ndn_table_id_t) * NDN_NAMETREE_ARRAY_MAX * NDN_NAMETREE_BLOCK_COUNT(entry_count) + \
+   sizeof(nametree_bucket_t) * 4 * (entry_count))
 
 void
 ndn_nametree_init(void* memory, ndn_table_id_t capacity);
 
+/** Find a node, or create it and its missing ancestors.
+ *
+ * A created node is not referenced. The caller must set its @c pit_id or @c fib_id,
+ * or give it back with ndn_nametree_release().
+ * @return The node. @c NULL if there are not enough free nodes or arena bytes,
+ *         or @c name is malformed.
+ */
 nametree_entry_t*
 ndn_nametree_find_or_insert(ndn_nametree_t* nametree, uint8_t name[], size_t len);
 
+/** Free a node if it has no PIT entry, FIB entry or child,
+ * and then its ancestors which are left unreferenced.
+ *
+ * Call it after clearing @c pit_id or @c fib_id of a node.
+ * It takes O(depth) time, so nodes are reclaimed as soon as they are unused.
+ */
+void
+ndn_nametree_release(ndn_nametree_t* nametree, nametree_entry_t* entry);
+
 nametree_entry_t*
 ndn_nametree_prefix_match(
   ndn_nametree_t* nametree,
@@ -90,6 +280,31 @@ ndn_nametree_at(ndn_nametree_t *self, ndn_table_id_t id);
 ndn_table_id_t
 ndn_nametree_getid(ndn_nametree_t *self, nametree_entry_t* entry);
 
+/** Collect the nodes which are prefixes of a name and have an entry of a type, shortest first.
+ *
+ * The name is walked once. Deeper nodes are left out when @c entries is full.
+ * @param[out] entries The nodes.
+ * @param[in] max_count The size of @c entries.
+ * @param[out] exact Whether the last node collected is the whole name.
+ * @return The number of nodes collected.
+ */
+size_t
+ndn_nametree_collect_prefixes(
+  ndn_nametree_t* nametree,
+  uint8_t name[],
+  size_t len,
+  enum NDN_NAMETREE_ENTRY_TYPE type,
+  nametree_entry_t** entries,
+  size_t max_count,
+  bool* exact);
+
+/** Get the component of a node.
+ * @param[out] length The length of the TLV encoded component.
+ * @return The TLV encoded component. @c NULL for the root.
+ */
+const uint8_t*
+ndn_nametree_component(ndn_nametree_t *self, nametree_entry_t* entry, size_t* length);
+
 /*@}*/
 
 #endif // FORWARDER_NAME_TREE_H
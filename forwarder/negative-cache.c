@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+#include "negative-cache.h"
+#include <string.h>
+
+#if (NDN_NEGATIVE_CACHE_SIZE & (NDN_NEGATIVE_CACHE_SIZE - 1)) != 0
+#error "NDN_NEGATIVE_CACHE_SIZE must be a power of 2"
+#endif
+
+void
+ndn_negative_cache_clear(ndn_negative_cache_t* self)
+{
+  memset(self->records, 0, sizeof(self->records));
+}
+
+void
+ndn_negative_cache_add(ndn_negative_cache_t* self, uint32_t name_hash, uint8_t reason,
+                       ndn_time_ms_t now)
+{
+  ndn_negative_record_t* record = &self->records[name_hash & (NDN_NEGATIVE_CACHE_SIZE - 1)];
+  record->name_hash = name_hash;
+  record->reason = reason;
+  record->expiry = now + NDN_NEGATIVE_CACHE_LIFETIME;
+}
+
+int
+ndn_negative_cache_find(const ndn_negative_cache_t* self, uint32_t name_hash, ndn_time_ms_t now)
+{
+  const ndn_negative_record_t* record = &self->records[name_hash & (NDN_NEGATIVE_CACHE_SIZE - 1)];
+  if(record->name_hash != name_hash || record->expiry <= now){
+    return -1;
+  }
+  return record->reason;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_NEGATIVE_CACHE_H_
+#define FORWARDER_NEGATIVE_CACHE_H_
+
+#include "../ndn-constants.h"
+#include "../util/uniform-time.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdNegativeCache Negative Cache
+ * @brief Names which recently had no route or no answer
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * A record of the negative cache.
+ */
+typedef struct ndn_negative_record {
+  /** The hash of the name, as ndn_parsed_name#hash.
+   */
+  uint32_t name_hash;
+
+  /** The Nack reason to answer with.
+   */
+  uint8_t reason;
+
+  /** The time the record is dropped. 0 if the record is empty.
+   */
+  ndn_time_ms_t expiry;
+} ndn_negative_record_t;
+
+/**
+ * Negative cache.
+ *
+ * A direct-mapped table: a name has one slot chosen by its hash,
+ * and a newer record takes the slot of an older one.
+ * So a lookup costs one comparison, and a miss only means the Interest is forwarded.
+ */
+typedef struct ndn_negative_cache {
+  ndn_negative_record_t records[NDN_NEGATIVE_CACHE_SIZE];
+} ndn_negative_cache_t;
+
+/** Drop all records.
+ */
+void
+ndn_negative_cache_clear(ndn_negative_cache_t* self);
+
+/** Remember that a name had no route or no answer.
+ * @param[in] name_hash The hash of the name, as ndn_parsed_name#hash.
+ * @param[in] reason The Nack reason to answer with.
+ * @param[in] now The current time. The record expires #NDN_NEGATIVE_CACHE_LIFETIME after it.
+ */
+void
+ndn_negative_cache_add(ndn_negative_cache_t* self, uint32_t name_hash, uint8_t reason,
+                       ndn_time_ms_t now);
+
+/** Look up a name.
+ * @param[in] name_hash The hash of the name, as ndn_parsed_name#hash.
+ * @param[in] now The current time.
+ * @return The Nack reason. -1 if the name has no record which is not expired.
+ */
+int
+ndn_negative_cache_find(const ndn_negative_cache_t* self, uint32_t name_hash, ndn_time_ms_t now);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_NEGATIVE_CACHE_H_
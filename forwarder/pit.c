@@ -11,88 +11,545 @@
 #define ENABLE_NDN_LOG_DEBUG 0
 #define ENABLE_NDN_LOG_ERROR 1
 #include "pit.h"
-#include "../util/msg-queue.h"
+#include "strategy.h"
+#include "../encode/tlv.h"
+#include "../ndn-error-code.h"
+#include "../ndn-enums.h"
+#include "../util/hash.h"
 #include "../util/logger.h"
+#include <string.h>
 
 static inline void
 ndn_pit_entry_reset(ndn_pit_entry_t* self){
+#if NDN_PIT_HASH_ENGINE
+  self->in_use = false;
+  self->name_len = 0;
+#else
   self->nametree_id = NDN_INVALID_ID;
+#endif
+  self->name_hash = 0;
   self->last_time = 0;
   self->express_time = 0;
-  self->incoming_faces = 0;
-  self->outgoing_faces = 0;
+  ndn_faceset_clear(&self->incoming_faces);
+  ndn_faceset_clear(&self->outgoing_faces);
+  self->in_records = NDN_INVALID_ID;
+  self->out_records = NDN_INVALID_ID;
   self->on_data = NULL;
   self->on_timeout = NULL;
+  self->on_nack = NULL;
   self->userdata = NULL;
-  // Don't reset options.nonce here
+  self->strategy = NULL;
 }
 
-static void ndn_pit_timeout(void *selfptr, size_t param_len, void *param){
-  ndn_pit_t* self = (ndn_pit_t*)selfptr;
+void
+ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_table_id_t face_count, ndn_nametree_t* nametree){
   ndn_table_id_t i;
-  ndn_time_ms_t now = ndn_time_now_ms();
-  ndn_on_timeout_func on_timeout = NULL;
-  void* userdata = NULL;
+  uint32_t record_count = NDN_PIT_RECORD_COUNT((uint32_t)capacity), k;
+  ndn_pit_t* self = (ndn_pit_t*)memory;
+  self->capacity = capacity;
+  self->nametree = nametree;
+  for(i = 0; i < capacity; i ++){
+    ndn_pit_entry_reset(&self->slots[i]);
+    self->slots[i].options.nonce = 0;
+    self->slots[i].next_free = (i + 1 < capacity) ? i + 1 : NDN_INVALID_ID;
+    self->slots[i].heap_index = NDN_INVALID_ID;
+    self->slots[i].face_links = NDN_INVALID_ID;
+    self->slots[i].lru_prev = NDN_INVALID_ID;
+    self->slots[i].lru_next = NDN_INVALID_ID;
+  }
+  self->free_head = (capacity > 0) ? 0 : NDN_INVALID_ID;
+  self->heap_size = 0;
+  self->lru_head = NDN_INVALID_ID;
+  self->lru_tail = NDN_INVALID_ID;
+
+  // The last ID is reserved for NDN_INVALID_ID
+  self->records = (ndn_pit_record_t*)&self->slots[capacity];
+  if(record_count > NDN_INVALID_ID){
+    record_count = NDN_INVALID_ID;
+  }
+  for(k = 0; k < record_count; k ++){
+    self->records[k].next = (k + 1 < record_count) ? k + 1 : NDN_INVALID_ID;
+  }
+  self->free_record = (record_count > 0) ? 0 : NDN_INVALID_ID;
+  ndn_dead_nonce_list_init(&self->dead_nonces);
+  ndn_negative_cache_clear(&self->negative_cache);
+
+#if NDN_PIT_HASH_ENGINE
+  // At least twice as many buckets as entries keeps probe sequences short
+  uint32_t bucket_count = 2, j;
+  while(bucket_count < 2 * (uint32_t)capacity){
+    bucket_count <<= 1;
+  }
+  self->bucket_mask = bucket_count - 1;
+  self->buckets = (ndn_pit_bucket_t*)&self->records[NDN_PIT_RECORD_COUNT((uint32_t)capacity)];
+  for(j = 0; j < bucket_count; j ++){
+    self->buckets[j].hash = 0;
+    self->buckets[j].entry_id = NDN_INVALID_ID;
+  }
+  self->names = (uint8_t*)&self->buckets[NDN_PIT_BUCKET_RESERVE((uint32_t)capacity)];
+  self->expiry_heap = (ndn_table_id_t*)(self->names + (size_t)capacity * NDN_NAME_MAX_BLOCK_SIZE);
+#else
+  self->expiry_heap = (ndn_table_id_t*)&self->records[NDN_PIT_RECORD_COUNT((uint32_t)capacity)];
+#endif
+  ndn_face_index_init(&self->face_index, &self->expiry_heap[capacity], capacity, face_count);
+  self->face_count = face_count;
+  self->face_entries = &self->face_index.heads[face_count];
+  memset(self->face_entries, 0, sizeof(ndn_table_id_t) * face_count);
+}
+
+static inline bool
+ndn_pit_heap_less(ndn_pit_t* self, ndn_table_id_t a, ndn_table_id_t b){
+  return self->slots[self->expiry_heap[a]].expiry < self->slots[self->expiry_heap[b]].expiry;
+}
+
+static inline void
+ndn_pit_heap_swap(ndn_pit_t* self, ndn_table_id_t a, ndn_table_id_t b){
+  ndn_table_id_t id = self->expiry_heap[a];
+  self->expiry_heap[a] = self->expiry_heap[b];
+  self->expiry_heap[b] = id;
+  self->slots[self->expiry_heap[a]].heap_index = a;
+  self->slots[self->expiry_heap[b]].heap_index = b;
+}
+
+static void
+ndn_pit_heap_sift_up(ndn_pit_t* self, ndn_table_id_t i){
+  ndn_table_id_t parent;
+  while(i > 0){
+    parent = (i - 1) / 2;
+    if(!ndn_pit_heap_less(self, i, parent)){
+      break;
+    }
+    ndn_pit_heap_swap(self, i, parent);
+    i = parent;
+  }
+}
+
+static void
+ndn_pit_heap_sift_down(ndn_pit_t* self, ndn_table_id_t i){
+  uint32_t child;
+  ndn_table_id_t smallest;
+  while(true){
+    smallest = i;
+    child = 2 * (uint32_t)i + 1;
+    if(child < self->heap_size && ndn_pit_heap_less(self, child, smallest)){
+      smallest = child;
+    }
+    if(child + 1 < self->heap_size && ndn_pit_heap_less(self, child + 1, smallest)){
+      smallest = child + 1;
+    }
+    if(smallest == i){
+      break;
+    }
+    ndn_pit_heap_swap(self, i, smallest);
+    i = smallest;
+  }
+}
+
+static void
+ndn_pit_heap_remove(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  ndn_table_id_t i = entry->heap_index;
+  ndn_table_id_t last = self->heap_size - 1;
+
+  entry->heap_index = NDN_INVALID_ID;
+  self->heap_size --;
+  if(i == last){
+    return;
+  }
+  self->expiry_heap[i] = self->expiry_heap[last];
+  self->slots[self->expiry_heap[i]].heap_index = i;
+  ndn_pit_heap_sift_up(self, i);
+  ndn_pit_heap_sift_down(self, self->slots[self->expiry_heap[i]].heap_index);
+}
+
+static void
+ndn_pit_lru_unlink(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  ndn_table_id_t id = entry - &self->slots[0];
 
-  for(i = 0; i < self->capacity; i ++){
-    if(self->slots[i].nametree_id == NDN_INVALID_ID){
+  if(entry->lru_prev == NDN_INVALID_ID && self->lru_head != id){
+    return;
+  }
+  if(entry->lru_prev != NDN_INVALID_ID){
+    self->slots[entry->lru_prev].lru_next = entry->lru_next;
+  }
+  else{
+    self->lru_head = entry->lru_next;
+  }
+  if(entry->lru_next != NDN_INVALID_ID){
+    self->slots[entry->lru_next].lru_prev = entry->lru_prev;
+  }
+  else{
+    self->lru_tail = entry->lru_prev;
+  }
+  entry->lru_prev = NDN_INVALID_ID;
+  entry->lru_next = NDN_INVALID_ID;
+}
+
+static void
+ndn_pit_lru_append(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  ndn_table_id_t id = entry - &self->slots[0];
+
+  entry->lru_prev = self->lru_tail;
+  entry->lru_next = NDN_INVALID_ID;
+  if(self->lru_tail != NDN_INVALID_ID){
+    self->slots[self->lru_tail].lru_next = id;
+  }
+  else{
+    self->lru_head = id;
+  }
+  self->lru_tail = id;
+}
+
+ndn_pit_record_t*
+ndn_pit_find_record(ndn_pit_t* self, ndn_table_id_t records, ndn_table_id_t face_id){
+  ndn_table_id_t id;
+  for(id = records; id != NDN_INVALID_ID; id = self->records[id].next){
+    if(self->records[id].face_id == face_id){
+      return &self->records[id];
+    }
+  }
+  return NULL;
+}
+
+static ndn_pit_record_t*
+ndn_pit_record_update(ndn_pit_t* self, ndn_table_id_t* records, ndn_table_id_t face_id,
+                      const interest_options_t* options, ndn_time_ms_t now){
+  ndn_pit_record_t* record = ndn_pit_find_record(self, *records, face_id);
+  ndn_table_id_t id;
+
+  if(record == NULL){
+    id = self->free_record;
+    if(id == NDN_INVALID_ID){
+      return NULL;
+    }
+    record = &self->records[id];
+    self->free_record = record->next;
+    record->face_id = face_id;
+    record->next = *records;
+    *records = id;
+  }
+  record->nonce = options->nonce;
+  record->hop_limit = options->hop_limit;
+  record->nacked = false;
+  record->nack_reason = NDN_NACK_REASON_NONE;
+  record->last_time = now;
+  record->expiry = now + options->lifetime;
+  return record;
+}
+
+/** Link an entry to a face in ndn_pit#face_index before the face joins
+ * ndn_pit_entry#incoming_faces or ndn_pit_entry#outgoing_faces.
+ */
+static inline void
+ndn_pit_link_face(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id){
+  if(!ndn_faceset_contains(&entry->incoming_faces, face_id) &&
+     !ndn_faceset_contains(&entry->outgoing_faces, face_id)){
+    ndn_face_index_add(&self->face_index, &entry->face_links, entry - &self->slots[0], face_id);
+  }
+}
+
+/** Unlink an entry from a face after the face left both face sets of the entry.
+ */
+static inline void
+ndn_pit_unlink_face(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id){
+  if(!ndn_faceset_contains(&entry->incoming_faces, face_id) &&
+     !ndn_faceset_contains(&entry->outgoing_faces, face_id)){
+    ndn_face_index_remove(&self->face_index, &entry->face_links, face_id);
+  }
+}
+
+/** Free the records of a face, or of all faces if @c face_id is #NDN_INVALID_ID,
+ * which expire by @c deadline.
+ * Freed out-records leave ndn_pit_entry#outgoing_faces, and their nonces go to the Dead Nonce List.
+ */
+static void
+ndn_pit_free_records(ndn_pit_t* self, ndn_pit_entry_t* entry, bool out,
+                     ndn_table_id_t face_id, ndn_time_ms_t deadline){
+  ndn_table_id_t* link = out ? &entry->out_records : &entry->in_records;
+  ndn_table_id_t id;
+  ndn_pit_record_t* record;
+
+  while((id = *link) != NDN_INVALID_ID){
+    record = &self->records[id];
+    if((face_id != NDN_INVALID_ID && record->face_id != face_id) || record->expiry > deadline){
+      link = &record->next;
       continue;
     }
+    if(out){
+      ndn_faceset_remove(&entry->outgoing_faces, record->face_id);
+      ndn_pit_unlink_face(self, entry, record->face_id);
+      ndn_dead_nonce_list_add(&self->dead_nonces, ndn_dead_nonce_key(entry->name_hash, record->nonce),
+                              record->last_time);
+    }
+    *link = record->next;
+    record->next = self->free_record;
+    self->free_record = id;
+  }
+}
+
+ndn_pit_record_t*
+ndn_pit_insert_in_record(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id,
+                         const interest_options_t* options, ndn_time_ms_t now){
+  ndn_pit_add_incoming_face(self, entry, face_id);
+  return ndn_pit_record_update(self, &entry->in_records, face_id, options, now);
+}
+
+ndn_pit_record_t*
+ndn_pit_insert_out_record(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id,
+                          const interest_options_t* options, ndn_time_ms_t now){
+  ndn_pit_link_face(self, entry, face_id);
+  ndn_faceset_add(&entry->outgoing_faces, face_id);
+  return ndn_pit_record_update(self, &entry->out_records, face_id, options, now);
+}
+
+void
+ndn_pit_expire_out_records(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_time_ms_t now){
+  ndn_pit_free_records(self, entry, true, NDN_INVALID_ID, now);
+}
+
+int
+ndn_pit_check_nonce(ndn_pit_t* self, const ndn_pit_entry_t* entry,
+                    ndn_table_id_t face_id, uint32_t nonce){
+  ndn_table_id_t id;
+  int ret = NDN_PIT_NONCE_NEW;
+
+  for(id = entry->in_records; id != NDN_INVALID_ID; id = self->records[id].next){
+    if(self->records[id].nonce == nonce){
+      if(self->records[id].face_id != face_id){
+        return NDN_PIT_NONCE_LOOP;
+      }
+      ret = NDN_PIT_NONCE_SAME_FACE;
+    }
+  }
+  for(id = entry->out_records; id != NDN_INVALID_ID; id = self->records[id].next){
+    if(self->records[id].nonce == nonce){
+      return NDN_PIT_NONCE_LOOP;
+    }
+  }
+  return ret;
+}
+
+int
+ndn_pit_nack_reason(ndn_pit_t* self, const ndn_pit_entry_t* entry){
+  ndn_table_id_t id;
+  int reason = -1;
+  uint8_t cur;
+
+  for(id = entry->out_records; id != NDN_INVALID_ID; id = self->records[id].next){
+    if(!self->records[id].nacked){
+      return -1;
+    }
+    // NONE is the most severe
+    cur = self->records[id].nack_reason;
+    if(reason == -1 || (cur != NDN_NACK_REASON_NONE && (reason == NDN_NACK_REASON_NONE || cur < reason))){
+      reason = cur;
+    }
+  }
+  return reason;
+}
+
+void
+ndn_pit_refresh_expiry(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  ndn_table_id_t i = entry->heap_index;
+
+  if(entry->on_data != NULL){
+    entry->expiry = entry->express_time + entry->options.lifetime;
+  }
+  else{
+    entry->expiry = entry->last_time + entry->options.lifetime;
+  }
+  if(i == NDN_INVALID_ID){
+    i = self->heap_size ++;
+    self->expiry_heap[i] = entry - &self->slots[0];
+    entry->heap_index = i;
+    ndn_pit_lru_append(self, entry);
+  }
+  ndn_pit_heap_sift_up(self, i);
+  ndn_pit_heap_sift_down(self, entry->heap_index);
+}
+
+void
+ndn_pit_touch(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_time_ms_t now){
+  entry->last_time = now;
+  if(entry->heap_index != NDN_INVALID_ID){
+    ndn_pit_lru_unlink(self, entry);
+    ndn_pit_lru_append(self, entry);
+  }
+  ndn_pit_refresh_expiry(self, entry);
+}
+
+static void
+ndn_pit_strategy_timeout(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_time_ms_t now){
+  ndn_strategy_context_t ctx;
+
+  if(entry->strategy == NULL || entry->strategy->on_timeout == NULL){
+    return;
+  }
+  ctx.pit = self;
+  ctx.fib = NULL;
+  ctx.pit_entry = entry;
+  ctx.fib_entry = NULL;
+  ctx.face_id = NDN_INVALID_ID;
+  ctx.retransmission = false;
+  ctx.congestion_mark = 0;
+  ctx.now = now;
+  entry->strategy->on_timeout(&ctx);
+}
+
+void
+ndn_pit_process_timeouts(ndn_pit_t* self, ndn_time_ms_t now){
+  ndn_pit_entry_t* entry;
+  ndn_on_timeout_func on_timeout;
+  void* userdata;
+  bool user_timeout;
+
+  while(self->heap_size > 0 && self->slots[self->expiry_heap[0]].expiry <= now){
+    entry = &self->slots[self->expiry_heap[0]];
+    user_timeout = entry->on_data != NULL && entry->express_time + entry->options.lifetime <= now;
+    if(user_timeout || entry->last_time + entry->options.lifetime <= now){
+      ndn_pit_strategy_timeout(self, entry, now);
+    }
 
     // User timeout
-    if(self->slots[i].on_data != NULL){
-      if(now - self->slots[i].express_time > self->slots[i].options.lifetime){
-        on_timeout = self->slots[i].on_timeout;
-        userdata = self->slots[i].userdata;
-        
-        self->slots[i].on_timeout = NULL;
-        self->slots[i].on_data = NULL;
-        self->slots[i].userdata = NULL;
-        self->slots[i].express_time = 0;
-        self->slots[i].outgoing_faces = 0;
-
-        if(on_timeout){
-          on_timeout(userdata);
-        }
+    if(user_timeout){
+      on_timeout = entry->on_timeout;
+      userdata = entry->userdata;
+
+      entry->on_timeout = NULL;
+      entry->on_nack = NULL;
+      entry->on_data = NULL;
+      entry->userdata = NULL;
+      entry->express_time = 0;
+      ndn_pit_free_records(self, entry, true, NDN_INVALID_ID, NDN_PIT_NO_EXPIRY);
+
+      // The callback may express the Interest again, which reschedules the entry
+      if(on_timeout){
+        on_timeout(userdata);
+      }
+      if(ndn_pit_entry_is_empty(entry)){
+        continue;
       }
     }
     // PIT timeout
-    if((now > self->slots[i].last_time) &&
-       (now - self->slots[i].last_time > self->slots[i].options.lifetime))
-    {
-      ndn_pit_remove_entry(self, &self->slots[i]);
+    if(entry->last_time + entry->options.lifetime <= now){
+      // Forwarded upstream but never answered
+      if(entry->out_records != NDN_INVALID_ID){
+        ndn_negative_cache_add(&self->negative_cache, entry->name_hash, NDN_NACK_REASON_NONE, now);
+      }
+      ndn_pit_remove_entry(self, entry);
+    }
+    else{
+      ndn_pit_refresh_expiry(self, entry);
     }
   }
+}
 
-  ndn_msgqueue_post(self, ndn_pit_timeout, 0, NULL);
+static ndn_table_id_t
+ndn_pit_alloc_entry(ndn_pit_t* self){
+  ndn_table_id_t id = self->free_head;
+  if(id == NDN_INVALID_ID){
+    return NDN_INVALID_ID;
+  }
+  self->free_head = self->slots[id].next_free;
+  ndn_pit_entry_reset(&self->slots[id]);
+  self->slots[id].heap_index = NDN_INVALID_ID;
+  return id;
 }
 
-void
-ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree){
-  ndn_table_id_t i;
-  ndn_pit_t* self = (ndn_pit_t*)memory;
-  self->capacity = capacity;
-  self->nametree = nametree;
-  for(i = 0; i < capacity; i ++){
-    ndn_pit_entry_reset(&self->slots[i]);
-    self->slots[i].options.nonce = 0;
+static void
+ndn_pit_free_entry(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  ndn_table_id_t id;
+
+  if(entry->heap_index != NDN_INVALID_ID){
+    ndn_pit_heap_remove(self, entry);
   }
+  ndn_pit_lru_unlink(self, entry);
+  NDN_FACESET_FOREACH(&entry->incoming_faces, id){
+    if(id < self->face_count){
+      self->face_entries[id] --;
+    }
+  }
+  ndn_face_index_remove_all(&self->face_index, &entry->face_links);
+  ndn_pit_free_records(self, entry, false, NDN_INVALID_ID, NDN_PIT_NO_EXPIRY);
+  ndn_pit_free_records(self, entry, true, NDN_INVALID_ID, NDN_PIT_NO_EXPIRY);
+  ndn_pit_entry_reset(entry);
+  entry->next_free = self->free_head;
+  self->free_head = entry - &self->slots[0];
+}
+
+#if NDN_PIT_HASH_ENGINE
 
-  ndn_msgqueue_post(self, ndn_pit_timeout, 0, NULL);
+static inline uint8_t*
+ndn_pit_name_at(ndn_pit_t* self, ndn_table_id_t id){
+  return self->names + (size_t)id * NDN_NAME_MAX_BLOCK_SIZE;
+}
+
+/** Look up a name in the hash index.
+ * Returns the entry's ID, or #NDN_INVALID_ID with @c pos set to the empty bucket to insert into.
+ */
+static ndn_table_id_t
+ndn_pit_index_lookup(ndn_pit_t* self, uint32_t hash, const uint8_t* comps, size_t comp_len, uint32_t* pos){
+  uint32_t i = hash & self->bucket_mask;
+  ndn_table_id_t id;
+  while((id = self->buckets[i].entry_id) != NDN_INVALID_ID){
+    if(self->buckets[i].hash == hash &&
+       self->slots[id].name_len == comp_len &&
+       memcmp(ndn_pit_name_at(self, id), comps, comp_len) == 0)
+    {
+      break;
+    }
+    i = (i + 1) & self->bucket_mask;
+  }
+  if(pos != NULL){
+    *pos = i;
+  }
+  return id;
+}
+
+static void
+ndn_pit_index_remove(ndn_pit_t* self, ndn_table_id_t id){
+  uint32_t mask = self->bucket_mask;
+  uint32_t i = self->slots[id].name_hash & mask;
+  uint32_t j, home;
+
+  while(self->buckets[i].entry_id != id){
+    i = (i + 1) & mask;
+  }
+  // Backward-shift deletion: no tombstones, so probe lengths don't grow over time
+  for(j = (i + 1) & mask; self->buckets[j].entry_id != NDN_INVALID_ID; j = (j + 1) & mask){
+    home = self->buckets[j].hash & mask;
+    // Move j into the hole at i unless its home lies cyclically in (i, j]
+    if(((j - home) & mask) >= ((j - i) & mask)){
+      self->buckets[i] = self->buckets[j];
+      i = j;
+    }
+  }
+  self->buckets[i].entry_id = NDN_INVALID_ID;
 }
 
 void
 ndn_pit_remove_entry(ndn_pit_t* self, ndn_pit_entry_t* entry){
-  ndn_nametree_at(self->nametree, entry->nametree_id)->pit_id = NDN_INVALID_ID;
-  ndn_pit_entry_reset(entry);
+  ndn_pit_index_remove(self, entry - &self->slots[0]);
+  ndn_pit_free_entry(self, entry);
+}
+
+#else
+
+void
+ndn_pit_remove_entry(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  nametree_entry_t* node = ndn_nametree_at(self->nametree, entry->nametree_id);
+  node->pit_id = NDN_INVALID_ID;
+  ndn_nametree_release(self->nametree, node);
+  ndn_pit_free_entry(self, entry);
 }
 
+#endif
+
 static inline void
 ndn_pit_remove_entry_if_empty(ndn_pit_t* self, ndn_pit_entry_t* entry){
-  if(entry->nametree_id == NDN_INVALID_ID){
+  if(ndn_pit_entry_is_empty(entry)){
     return;
   }
-  if(entry->incoming_faces == 0 &&
+  if(ndn_faceset_is_empty(&entry->incoming_faces) &&
      entry->on_data == NULL &&
      entry->on_timeout == NULL)
   {
@@ -100,43 +557,258 @@ ndn_pit_remove_entry_if_empty(ndn_pit_t* self, ndn_pit_entry_t* entry){
   }
 }
 
+void
+ndn_pit_remove_downstream(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id){
+  if(ndn_faceset_contains(&entry->incoming_faces, face_id) && face_id < self->face_count){
+    self->face_entries[face_id] --;
+  }
+  ndn_faceset_remove(&entry->incoming_faces, face_id);
+  ndn_pit_free_records(self, entry, false, face_id, NDN_PIT_NO_EXPIRY);
+  ndn_pit_free_records(self, entry, true, face_id, NDN_PIT_NO_EXPIRY);
+  // The face may be an upstream without an out-record
+  ndn_faceset_remove(&entry->outgoing_faces, face_id);
+  ndn_face_index_remove(&self->face_index, &entry->face_links, face_id);
+  ndn_pit_remove_entry_if_empty(self, entry);
+}
+
+void
+ndn_pit_remove_application(ndn_pit_t* self, ndn_pit_entry_t* entry){
+  entry->on_data = NULL;
+  entry->on_timeout = NULL;
+  entry->on_nack = NULL;
+  entry->userdata = NULL;
+  entry->express_time = 0;
+  ndn_pit_remove_entry_if_empty(self, entry);
+  if(!ndn_pit_entry_is_empty(entry)){
+    ndn_pit_refresh_expiry(self, entry);
+  }
+}
+
+void
+ndn_pit_add_incoming_face(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id){
+  if(!ndn_faceset_contains(&entry->incoming_faces, face_id)){
+    ndn_pit_link_face(self, entry, face_id);
+    ndn_faceset_add(&entry->incoming_faces, face_id);
+    if(face_id < self->face_count){
+      self->face_entries[face_id] ++;
+    }
+  }
+}
+
+static inline bool
+ndn_pit_entry_is_evictable(const ndn_pit_entry_t* entry){
+  return entry->on_data == NULL && entry->on_timeout == NULL;
+}
+
+bool
+ndn_pit_evict(ndn_pit_t* self, int policy){
+  ndn_pit_entry_t* entry;
+  ndn_pit_entry_t* victim = NULL;
+  ndn_table_id_t id;
+  // A path from the root of the heap has at most 32 nodes, each leaving one sibling behind
+  ndn_table_id_t stack[33];
+  uint32_t top = 0, child;
+
+  if(policy == NDN_PIT_EVICT_OLDEST){
+    for(id = self->lru_head; id != NDN_INVALID_ID; id = self->slots[id].lru_next){
+      if(ndn_pit_entry_is_evictable(&self->slots[id])){
+        victim = &self->slots[id];
+        break;
+      }
+    }
+  }
+  else if(policy == NDN_PIT_EVICT_NEAREST_EXPIRY && self->heap_size > 0){
+    // Every node expires no earlier than its parent, so the search stops at the first
+    // evictable entry of each path and never goes below an entry that expires later
+    stack[top ++] = 0;
+    while(top > 0){
+      entry = &self->slots[self->expiry_heap[stack[-- top]]];
+      if(victim != NULL && entry->expiry >= victim->expiry){
+        continue;
+      }
+      if(ndn_pit_entry_is_evictable(entry)){
+        victim = entry;
+        continue;
+      }
+      child = 2 * (uint32_t)entry->heap_index + 1;
+      if(child + 1 < self->heap_size){
+        stack[top ++] = child + 1;
+      }
+      if(child < self->heap_size){
+        stack[top ++] = child;
+      }
+    }
+  }
+  if(victim == NULL){
+    return false;
+  }
+  NDN_LOG_DEBUG("[PIT] Evict a PIT entry\n");
+  ndn_pit_remove_entry(self, victim);
+  return true;
+}
+
 void
 ndn_pit_unregister_face(ndn_pit_t* self, ndn_table_id_t face_id){
-  for (ndn_table_id_t i = 0; i < self->capacity; ++i){
-    self->slots[i].incoming_faces = bitset_unset(self->slots[i].incoming_faces, face_id);
-    ndn_pit_remove_entry_if_empty(self, &self->slots[i]);
+  ndn_table_id_t id;
+  ndn_pit_entry_t* entry;
+
+  if(ndn_faceset_contains(&self->face_index.overflow, face_id)){
+    // Some entries are not linked
+    ndn_faceset_remove(&self->face_index.overflow, face_id);
+    for(id = 0; id < self->capacity; id ++){
+      entry = &self->slots[id];
+      if(ndn_pit_entry_is_empty(entry)){
+        continue;
+      }
+      ndn_pit_remove_downstream(self, entry, face_id);
+    }
+    return;
+  }
+  while((id = ndn_face_index_first(&self->face_index, face_id)) != NDN_INVALID_ID){
+    ndn_pit_remove_downstream(self, &self->slots[id], face_id);
   }
 }
 
-static ndn_table_id_t
-ndn_pit_add_new_entry(ndn_pit_t* pit , int nametree_id){
-  ndn_table_id_t i;
-  for (i = 0; i < pit->capacity; ++i) {
-    if (pit->slots[i].nametree_id == NDN_INVALID_ID) {
-      ndn_pit_entry_reset(&pit->slots[i]);
-      pit->slots[i].nametree_id = nametree_id;
-      return i;
+#if NDN_PIT_HASH_ENGINE
+
+ndn_pit_entry_t*
+ndn_pit_find_or_insert_parsed(ndn_pit_t* self, const ndn_parsed_name_t* name){
+  uint32_t pos;
+  ndn_table_id_t id;
+
+  if(name->comp_len > NDN_NAME_MAX_BLOCK_SIZE){
+    return NULL;
+  }
+  id = ndn_pit_index_lookup(self, name->hash, name->comps, name->comp_len, &pos);
+  if(id == NDN_INVALID_ID){
+    id = ndn_pit_alloc_entry(self);
+    if(id == NDN_INVALID_ID){
+      return NULL;
     }
+    self->slots[id].in_use = true;
+    self->slots[id].name_hash = name->hash;
+    self->slots[id].name_len = name->comp_len;
+    memcpy(ndn_pit_name_at(self, id), name->comps, name->comp_len);
+    self->buckets[pos].hash = name->hash;
+    self->buckets[pos].entry_id = id;
+    NDN_LOG_DEBUG("[PIT] Add a new PIT entry\n");
   }
-  return NDN_INVALID_ID;
+  return &self->slots[id];
 }
 
 ndn_pit_entry_t*
 ndn_pit_find_or_insert(ndn_pit_t* self, uint8_t* name, size_t length){
-  nametree_entry_t* entry = ndn_nametree_find_or_insert(self->nametree, name, length);
+  ndn_parsed_name_t parsed;
+  if(tlv_name_parse(name, length, &parsed) != NDN_SUCCESS){
+    return NULL;
+  }
+  return ndn_pit_find_or_insert_parsed(self, &parsed);
+}
+
+ndn_pit_entry_t*
+ndn_pit_find_parsed(ndn_pit_t* self, const ndn_parsed_name_t* name)
+{
+  ndn_table_id_t id = ndn_pit_index_lookup(self, name->hash, name->comps, name->comp_len, NULL);
+  if(id == NDN_INVALID_ID){
+    return NULL;
+  }
+  return &self->slots[id];
+}
+
+ndn_pit_entry_t*
+ndn_pit_find(ndn_pit_t* self, uint8_t* prefix, size_t length)
+{
+  ndn_parsed_name_t parsed;
+
+  if(tlv_name_parse(prefix, length, &parsed) != NDN_SUCCESS){
+    return NULL;
+  }
+  return ndn_pit_find_parsed(self, &parsed);
+}
+
+ndn_pit_entry_t*
+ndn_pit_prefix_match(ndn_pit_t* self, uint8_t* prefix, size_t length)
+{
+  ndn_parsed_name_t parsed;
+  uint32_t depth;
+  ndn_table_id_t id;
+  int i;
+
+  if(tlv_name_parse(prefix, length, &parsed) != NDN_SUCCESS){
+    return NULL;
+  }
+  // Prefixes beyond the hashed ones can only match as a whole
+  depth = ndn_parsed_name_depth(&parsed);
+  if(parsed.count > depth){
+    id = ndn_pit_index_lookup(self, parsed.hash, parsed.comps, parsed.comp_len, NULL);
+    if(id != NDN_INVALID_ID){
+      return &self->slots[id];
+    }
+  }
+  for(i = depth; i >= 0; i --){
+    id = ndn_pit_index_lookup(self, parsed.hashes[i], parsed.comps, parsed.lens[i], NULL);
+    if(id != NDN_INVALID_ID){
+      return &self->slots[id];
+    }
+  }
+  return NULL;
+}
+
+size_t
+ndn_pit_match_data(ndn_pit_t* self, const ndn_parsed_name_t* name,
+                   ndn_pit_entry_t** entries, size_t max_count)
+{
+  uint32_t depth = ndn_parsed_name_depth(name);
+  uint32_t i;
+  size_t count = 0;
+  ndn_table_id_t id;
+
+  for(i = 0; i <= depth && count < max_count; i ++){
+    id = ndn_pit_index_lookup(self, name->hashes[i], name->comps, name->lens[i], NULL);
+    if(id != NDN_INVALID_ID && (i == name->count || self->slots[id].options.can_be_prefix)){
+      entries[count ++] = &self->slots[id];
+    }
+  }
+  // Prefixes beyond the hashed ones can only match as a whole
+  if(name->count > depth && count < max_count){
+    id = ndn_pit_index_lookup(self, name->hash, name->comps, name->comp_len, NULL);
+    if(id != NDN_INVALID_ID){
+      entries[count ++] = &self->slots[id];
+    }
+  }
+  return count;
+}
+
+#else
+
+ndn_pit_entry_t*
+ndn_pit_find_or_insert_parsed(ndn_pit_t* self, const ndn_parsed_name_t* name){
+  nametree_entry_t* entry = ndn_nametree_find_or_insert(self->nametree, name->name, name->name_len);
   if(entry == NULL){
     return NULL;
   }
   if(entry->pit_id == NDN_INVALID_ID){
-    entry->pit_id = ndn_pit_add_new_entry(self, ndn_nametree_getid(self->nametree, entry));
-    NDN_LOG_DEBUG("[PIT] Add a new PIT entry\n");
+    entry->pit_id = ndn_pit_alloc_entry(self);
     if(entry->pit_id == NDN_INVALID_ID){
+      ndn_nametree_release(self->nametree, entry);
       return NULL;
     }
+    self->slots[entry->pit_id].nametree_id = ndn_nametree_getid(self->nametree, entry);
+    self->slots[entry->pit_id].name_hash = name->hash;
+    NDN_LOG_DEBUG("[PIT] Add a new PIT entry\n");
   }
   return &self->slots[entry->pit_id];
 }
 
+ndn_pit_entry_t*
+ndn_pit_find_or_insert(ndn_pit_t* self, uint8_t* name, size_t length){
+  ndn_parsed_name_t parsed;
+  if(tlv_name_parse(name, length, &parsed) != NDN_SUCCESS){
+    return NULL;
+  }
+  return ndn_pit_find_or_insert_parsed(self, &parsed);
+}
+
 ndn_pit_entry_t*
 ndn_pit_find(ndn_pit_t* self, uint8_t* prefix, size_t length)
 {
@@ -147,6 +819,12 @@ ndn_pit_find(ndn_pit_t* self, uint8_t* prefix, size_t length)
   return &self->slots[entry->pit_id];
 }
 
+ndn_pit_entry_t*
+ndn_pit_find_parsed(ndn_pit_t* self, const ndn_parsed_name_t* name)
+{
+  return ndn_pit_find(self, name->name, name->name_len);
+}
+
 ndn_pit_entry_t*
 ndn_pit_prefix_match(ndn_pit_t* self, uint8_t* prefix, size_t length)
 {
@@ -156,3 +834,28 @@ ndn_pit_prefix_match(ndn_pit_t* self, uint8_t* prefix, size_t length)
   }
   return &self->slots[entry->pit_id];
 }
+
+size_t
+ndn_pit_match_data(ndn_pit_t* self, const ndn_parsed_name_t* name,
+                   ndn_pit_entry_t** entries, size_t max_count)
+{
+  nametree_entry_t* nodes[NDN_PIT_MAX_MATCHES];
+  ndn_pit_entry_t* entry;
+  size_t node_count, i, count = 0;
+  bool exact;
+
+  if(max_count > NDN_PIT_MAX_MATCHES){
+    max_count = NDN_PIT_MAX_MATCHES;
+  }
+  node_count = ndn_nametree_collect_prefixes(self->nametree, name->name, name->name_len,
+                                             NDN_NAMETREE_PIT_TYPE, nodes, max_count, &exact);
+  for(i = 0; i < node_count; i ++){
+    entry = &self->slots[nodes[i]->pit_id];
+    if(entry->options.can_be_prefix || (exact && i + 1 == node_count)){
+      entries[count ++] = entry;
+    }
+  }
+  return count;
+}
+
+#endif
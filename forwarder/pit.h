@@ -11,8 +11,11 @@
 #ifndef FORWARDER_PIT_H_
 #define FORWARDER_PIT_H_
 #include "../encode/forwarder-helper.h"
-#include "../util/bit-operations.h"
 #include "face.h"
+#include "faceset.h"
+#include "face-index.h"
+#include "dead-nonce-list.h"
+#include "negative-cache.h"
 #include "name-tree.h"
 #include "callback-funcs.h"
 #include "../util/uniform-time.h"
@@ -27,6 +30,43 @@ extern "C" {
  * @{
  */
 
+/**
+ * A record of a face which an Interest of a PIT entry was received from or sent to.
+ */
+typedef struct ndn_pit_record {
+  /** Timestamp for last time the Interest was received from or sent to the face.
+   */
+  ndn_time_ms_t last_time;
+
+  /** The time the Interest expires on the face.
+   */
+  ndn_time_ms_t expiry;
+
+  /** The nonce of the Interest last received or sent.
+   */
+  uint32_t nonce;
+
+  ndn_table_id_t face_id;
+
+  /** Next record of the same entry and direction. Next free record if the record is not used.
+   */
+  ndn_table_id_t next;
+
+  /** The HopLimit of the Interest last received or sent.
+   */
+  uint8_t hop_limit;
+
+  /** Whether an out-record's upstream returned a Nack for @c nonce.
+   */
+  bool nacked;
+
+  /** The reason of the Nack if @c nacked.
+   */
+  uint8_t nack_reason;
+} ndn_pit_record_t;
+
+struct ndn_strategy;
+
 /**
  * PIT entry.
  */
@@ -38,12 +78,25 @@ typedef struct ndn_pit_entry {
   /** Faces received this Interest.
    * Used to forward corresponding Data.
    */
-  uint64_t incoming_faces;
+  ndn_faceset_t incoming_faces;
+
+  /** Head of the links of @c incoming_faces and @c outgoing_faces in ndn_pit#face_index.
+   */
+  ndn_table_id_t face_links;
 
   /** Faces sent out this Interest.
    * Used to suppress Interest forwarding.
    */
-  uint64_t outgoing_faces;
+  ndn_faceset_t outgoing_faces;
+
+  /** Head of the in-records in ndn_pit#records, one for each face of @c incoming_faces.
+   * A face has no record if the pool ran out.
+   */
+  ndn_table_id_t in_records;
+
+  /** Head of the out-records in ndn_pit#records, one for each face of @c outgoing_faces.
+   */
+  ndn_table_id_t out_records;
 
   /** Timestamp for last time the forwarder received this Interest.
    */
@@ -62,46 +115,416 @@ typedef struct ndn_pit_entry {
    */
   ndn_on_timeout_func on_timeout;
 
+  /** OnNack callback if the application expressed this Interest.
+   * If @c NULL, the application waits for @c on_timeout instead.
+   */
+  ndn_on_nack_func on_nack;
+
   /** User defined data.
    */
   void* userdata;
 
+  /** The strategy which forwarded the Interest.
+   * @c NULL if it was not forwarded.
+   */
+  const struct ndn_strategy* strategy;
+
+  /** Hash of the name components.
+   * @sa ndn_parsed_name#hash
+   */
+  uint32_t name_hash;
+
+#if NDN_PIT_HASH_ENGINE
+  /** Length of the name components stored in ndn_pit#names.
+   */
+  uint16_t name_len;
+
+  /** Whether the entry is in use.
+   */
+  bool in_use;
+#else
   /** NameTree entry's ID.
    * #NDN_INVALID_ID if the entry is empty.
    */
   ndn_table_id_t nametree_id;
+#endif
+
+  /** Next entry in the free list.
+   * Only meaningful when the entry is empty.
+   */
+  ndn_table_id_t next_free;
+
+  /** Position in ndn_pit#expiry_heap.
+   * #NDN_INVALID_ID if the entry is not scheduled.
+   */
+  ndn_table_id_t heap_index;
+
+  /** The time the entry needs attention: the application's deadline if @c on_data is set,
+   * otherwise the time the entry expires.
+   */
+  ndn_time_ms_t expiry;
+
+  /** Previous and next entries in ndn_pit#lru_head, ordered by @c last_time.
+   * #NDN_INVALID_ID at either end of the list.
+   */
+  ndn_table_id_t lru_prev;
+  ndn_table_id_t lru_next;
 } ndn_pit_entry_t;
 
+/** Returned by ndn_pit_next_expiry() when no entry is scheduled.
+ */
+#define NDN_PIT_NO_EXPIRY ((ndn_time_ms_t)-1)
+
+#if NDN_PIT_HASH_ENGINE
+/**
+ * A bucket of the PIT hash index.
+ */
+typedef struct ndn_pit_bucket {
+  /** Hash of the name of the entry.
+   */
+  uint32_t hash;
+
+  /** Index of the entry.
+   * #NDN_INVALID_ID if the bucket is empty.
+   */
+  ndn_table_id_t entry_id;
+} ndn_pit_bucket_t;
+#endif
+
 /**
-* Forwarding Information Base (FIB).
-*/
+ * Pending Interest Table (PIT).
+ *
+ * By default, entries are indexed by the NameTree.
+ * If #NDN_PIT_HASH_ENGINE is set, they are indexed by an open-addressing hash table
+ * keyed by the hash of the whole name instead, and the NameTree is not used.
+ */
 typedef struct ndn_pit{
   ndn_nametree_t* nametree;
   ndn_table_id_t capacity;
+
+  /** Head of the free entry list.
+   * #NDN_INVALID_ID if the PIT is full.
+   */
+  ndn_table_id_t free_head;
+
+  /** Number of entries in @c expiry_heap.
+   */
+  ndn_table_id_t heap_size;
+
+  /** Binary min-heap of entry IDs ordered by ndn_pit_entry#expiry.
+   */
+  ndn_table_id_t* expiry_heap;
+
+  /** Oldest and newest scheduled entries, linked by ndn_pit_entry#lru_next in order of
+   * ndn_pit_entry#last_time.
+   */
+  ndn_table_id_t lru_head;
+  ndn_table_id_t lru_tail;
+
+  /** Entries of every incoming and outgoing face.
+   */
+  ndn_face_index_t face_index;
+
+  /** Head of the free record list.
+   */
+  ndn_table_id_t free_record;
+
+  /** In-records and out-records of all entries.
+   */
+  ndn_pit_record_t* records;
+
+  /** Nonces forwarded by removed entries.
+   */
+  ndn_dead_nonce_list_t dead_nonces;
+
+  /** Names which recently had no route, were Nacked by all upstreams, or expired unanswered.
+   */
+  ndn_negative_cache_t negative_cache;
+
+  /** Number of faces in @c face_entries.
+   */
+  ndn_table_id_t face_count;
+
+  /** Number of entries each face is a downstream of, for the quotas of faces.
+   */
+  ndn_table_id_t* face_entries;
+
+#if NDN_PIT_HASH_ENGINE
+  /** Number of buckets minus one. The number of buckets is a power of 2.
+   */
+  uint32_t bucket_mask;
+
+  /** Hash index, linear probing.
+   */
+  ndn_pit_bucket_t* buckets;
+
+  /** Name components of entries, #NDN_NAME_MAX_BLOCK_SIZE bytes per entry.
+   */
+  uint8_t* names;
+#endif
+
   ndn_pit_entry_t slots[];
 }ndn_pit_t;
 
-#define NDN_PIT_RESERVE_SIZE(entry_count) \
-  (sizeof(ndn_pit_t) + sizeof(ndn_pit_entry_t) * (entry_count))
+/** The number of in-records and out-records for @c entry_count entries,
+ * which is enough if entries have #NDN_MAX_FACE_PER_PIT_ENTRY faces each way on average.
+ */
+#define NDN_PIT_RECORD_COUNT(entry_count) (2 * NDN_MAX_FACE_PER_PIT_ENTRY * (entry_count))
+
+#if NDN_PIT_HASH_ENGINE
+/** The number of hash buckets reserved for @c entry_count entries,
+ * room for the smallest power of 2 which is at least twice @c entry_count and at least 2.
+ */
+#define NDN_PIT_BUCKET_RESERVE(entry_count) ((entry_count) > 0 ? 4 * (entry_count) : 2)
+
+#define NDN_PIT_RESERVE_SIZE(entry_count, face_count) \
+  (sizeof(ndn_pit_t) + sizeof(ndn_pit_entry_t) * (entry_count) + \
+   sizeof(ndn_pit_record_t) * NDN_PIT_RECORD_COUNT(entry_count) + \
+   sizeof(ndn_pit_bucket_t) * NDN_PIT_BUCKET_RESERVE(entry_count) + \
+   NDN_NAME_MAX_BLOCK_SIZE * (entry_count) + \
+   sizeof(ndn_table_id_t) * (entry_count) + \
+   NDN_FACE_INDEX_RESERVE_SIZE(entry_count, face_count) + \
+   sizeof(ndn_table_id_t) * (face_count))
+#else
+#define NDN_PIT_RESERVE_SIZE(entry_count, face_count) \
+  (sizeof(ndn_pit_t) + sizeof(ndn_pit_entry_t) * (entry_count) + \
+   sizeof(ndn_pit_record_t) * NDN_PIT_RECORD_COUNT(entry_count) + \
+   sizeof(ndn_table_id_t) * (entry_count) + \
+   NDN_FACE_INDEX_RESERVE_SIZE(entry_count, face_count) + \
+   sizeof(ndn_table_id_t) * (face_count))
+#endif
+
+/** Check whether a PIT entry is empty.
+ * @param[in] entry The PIT entry.
+ * @return Whether @c entry is not in use.
+ */
+static inline bool
+ndn_pit_entry_is_empty(const ndn_pit_entry_t* entry)
+{
+#if NDN_PIT_HASH_ENGINE
+  return !entry->in_use;
+#else
+  return entry->nametree_id == NDN_INVALID_ID;
+#endif
+}
 
+/** Initialize a PIT.
+ * @param[in] memory Memory of #NDN_PIT_RESERVE_SIZE.
+ * @param[in] capacity The number of entries.
+ * @param[in] face_count The number of faces, at most #NDN_FACESET_CAPACITY.
+ *                       Faces with larger IDs have no quota count, and their removal scans the table.
+ * @param[in] nametree The NameTree indexing the entries.
+ */
 void
-ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_nametree_t* nametree);
+ndn_pit_init(void* memory, ndn_table_id_t capacity, ndn_table_id_t face_count, ndn_nametree_t* nametree);
 
+/** Remove a face from all entries as a downstream and an upstream,
+ * and remove entries left with nothing to wait for.
+ *
+ * Only the entries of the face are visited.
+ */
 void
 ndn_pit_unregister_face(ndn_pit_t* self, ndn_table_id_t face_id);
 
+/** Add an incoming face to an entry.
+ *
+ * ndn_pit_entry#incoming_faces must only be changed through this,
+ * so that ndn_pit_unregister_face() can find the entry.
+ */
+void
+ndn_pit_add_incoming_face(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id);
+
+/** How the nonce of an incoming Interest relates to a PIT entry.
+ * @sa ndn_pit_check_nonce
+ */
+enum NDN_PIT_NONCE_CHECK {
+  /** No record has the nonce. */
+  NDN_PIT_NONCE_NEW,
+  /** Only the in-record of the same face has it, so it's a retransmission. */
+  NDN_PIT_NONCE_SAME_FACE,
+  /** Another face's in-record or an out-record has it, so the Interest looped. */
+  NDN_PIT_NONCE_LOOP,
+};
+
+/** Which entry to evict when the PIT is full.
+ * @sa ndn_pit_evict
+ */
+enum NDN_PIT_EVICTION {
+  /** Reject new entries instead. */
+  NDN_PIT_EVICT_NONE,
+  /** The entry whose Interest was received the longest time ago. */
+  NDN_PIT_EVICT_OLDEST,
+  /** The entry which expires first. */
+  NDN_PIT_EVICT_NEAREST_EXPIRY,
+};
+
+/** Remove an entry to make room for a new one.
+ *
+ * Only entries of Interests forwarded for downstreams can be evicted,
+ * never one the application expressed. Their downstreams are not told.
+ * The victim is taken from the front of ndn_pit#lru_head or the top of ndn_pit#expiry_heap,
+ * passing over only the application's entries.
+ * @param[in] policy An #NDN_PIT_EVICTION.
+ * @return Whether an entry was removed.
+ */
+bool
+ndn_pit_evict(ndn_pit_t* self, int policy);
+
+/** Get the number of entries a face is a downstream of.
+ */
+static inline ndn_table_id_t
+ndn_pit_face_entry_count(const ndn_pit_t* self, ndn_table_id_t face_id)
+{
+  return (face_id < self->face_count) ? self->face_entries[face_id] : 0;
+}
+
+/** Record an Interest received from a face.
+ *
+ * The face is added to ndn_pit_entry#incoming_faces as ndn_pit_add_incoming_face() does,
+ * and its in-record is created or updated.
+ * @param[in] options The options of the Interest.
+ * @param[in] now The current time.
+ * @return The in-record. @c NULL if the record pool ran out.
+ */
+ndn_pit_record_t*
+ndn_pit_insert_in_record(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id,
+                         const interest_options_t* options, ndn_time_ms_t now);
+
+/** Record an Interest sent to a face, and add it to ndn_pit_entry#outgoing_faces.
+ * @param[in] options The options of the Interest.
+ * @param[in] now The current time.
+ * @return The out-record. @c NULL if the record pool ran out.
+ */
+ndn_pit_record_t*
+ndn_pit_insert_out_record(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id,
+                          const interest_options_t* options, ndn_time_ms_t now);
+
+/** Get the record of a face.
+ * @param[in] records ndn_pit_entry#in_records or ndn_pit_entry#out_records.
+ * @return The record. @c NULL if the face has none.
+ */
+ndn_pit_record_t*
+ndn_pit_find_record(ndn_pit_t* self, ndn_table_id_t records, ndn_table_id_t face_id);
+
+/** Remove a face from an entry with its in-record and out-record,
+ * and remove the entry if it's left with no downstream.
+ */
+void
+ndn_pit_remove_downstream(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_table_id_t face_id);
+
+/** Drop the callbacks of the application which expressed an entry's Interest,
+ * and remove the entry if it's left with nothing to wait for.
+ */
+void
+ndn_pit_remove_application(ndn_pit_t* self, ndn_pit_entry_t* entry);
+
+/** Get the reason to Nack the downstreams of an entry.
+ * @return The least severe reason of the Nacks of the out-records,
+ *         if there are out-records and all of them are Nacked. -1 otherwise.
+ */
+int
+ndn_pit_nack_reason(ndn_pit_t* self, const ndn_pit_entry_t* entry);
+
+/** Remove expired out-records, so their faces can be forwarded to again.
+ * Their nonces go to the Dead Nonce List.
+ */
+void
+ndn_pit_expire_out_records(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_time_ms_t now);
+
+/** Check the nonce of an Interest received from a face against the records of an entry.
+ * @return An #NDN_PIT_NONCE_CHECK.
+ */
+int
+ndn_pit_check_nonce(ndn_pit_t* self, const ndn_pit_entry_t* entry,
+                    ndn_table_id_t face_id, uint32_t nonce);
+
+/** Check whether a nonce was forwarded for a name by an entry which is gone.
+ * @param[in] name_hash The hash of the name, as ndn_parsed_name#hash.
+ */
+static inline bool
+ndn_pit_is_dead_nonce(const ndn_pit_t* self, uint32_t name_hash, uint32_t nonce, ndn_time_ms_t now)
+{
+  return ndn_dead_nonce_list_has(&self->dead_nonces, ndn_dead_nonce_key(name_hash, nonce), now);
+}
+
 ndn_pit_entry_t*
 ndn_pit_find_or_insert(ndn_pit_t* self, uint8_t* name, size_t length);
 
 ndn_pit_entry_t*
 ndn_pit_find(ndn_pit_t* self, uint8_t* prefix, size_t length);
 
+/** Same as ndn_pit_find(), with a name parsed by tlv_name_parse().
+ */
+ndn_pit_entry_t*
+ndn_pit_find_parsed(ndn_pit_t* self, const ndn_parsed_name_t* name);
+
 ndn_pit_entry_t*
 ndn_pit_prefix_match(ndn_pit_t* self, uint8_t* prefix, size_t length);
 
+/** Same as ndn_pit_find_or_insert(), with a name parsed by tlv_name_parse().
+ */
+ndn_pit_entry_t*
+ndn_pit_find_or_insert_parsed(ndn_pit_t* self, const ndn_parsed_name_t* name);
+
+/** The most entries a Data packet can satisfy in one call of ndn_pit_match_data().
+ */
+#define NDN_PIT_MAX_MATCHES (NDN_FWD_NAME_MAX_COMPONENTS + 1)
+
+/** Find every entry a Data packet satisfies.
+ *
+ * These are the entries with CanBePrefix whose names are prefixes of the Data name,
+ * and the entry whose name equals the Data name. The name is walked once.
+ * @param[in] self The PIT.
+ * @param[in] name The parsed name of the Data packet.
+ * @param[out] entries The entries, shortest name first.
+ * @param[in] max_count The size of @c entries, at most #NDN_PIT_MAX_MATCHES.
+ * @return The number of entries. 0 if the Data is unsolicited.
+ */
+size_t
+ndn_pit_match_data(ndn_pit_t* self, const ndn_parsed_name_t* name,
+                   ndn_pit_entry_t** entries, size_t max_count);
+
+/** Remove an entry. The nonces of its out-records go to the Dead Nonce List.
+ */
 void
 ndn_pit_remove_entry(ndn_pit_t* self, ndn_pit_entry_t* entry);
 
+/** Reschedule an entry after its timestamps, lifetime or callbacks changed.
+ * @param[in] self The PIT.
+ * @param[in] entry The PIT entry.
+ */
+void
+ndn_pit_refresh_expiry(ndn_pit_t* self, ndn_pit_entry_t* entry);
+
+/** Record that the Interest of an entry was received or expressed again, and reschedule it.
+ * @param[in] self The PIT.
+ * @param[in] entry The PIT entry.
+ * @param[in] now The time the Interest arrived. Not before that of any other entry.
+ */
+void
+ndn_pit_touch(ndn_pit_t* self, ndn_pit_entry_t* entry, ndn_time_ms_t now);
+
+/** Fire expired application timeouts and remove expired entries.
+ * Only entries whose expiry has passed are visited.
+ * @param[in] self The PIT.
+ * @param[in] now The current time.
+ */
+void
+ndn_pit_process_timeouts(ndn_pit_t* self, ndn_time_ms_t now);
+
+/** Get the earliest expiry of all entries.
+ * @param[in] self The PIT.
+ * @return The earliest expiry, or #NDN_PIT_NO_EXPIRY if the PIT is empty.
+ */
+static inline ndn_time_ms_t
+ndn_pit_next_expiry(const ndn_pit_t* self)
+{
+  if(self->heap_size == 0){
+    return NDN_PIT_NO_EXPIRY;
+  }
+  return self->slots[self->expiry_heap[0]].expiry;
+}
+
 /*@}*/
 
 #ifdef __cplusplus
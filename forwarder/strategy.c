@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include "strategy.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+static void
+ndn_strategy_multicast_after_receive_interest(const ndn_strategy_context_t* ctx,
+                                              const ndn_faceset_t* eligible,
+                                              ndn_faceset_t* out)
+{
+  (void)ctx;
+  *out = *eligible;
+}
+
+const ndn_strategy_t ndn_strategy_multicast = {
+  .after_receive_interest = ndn_strategy_multicast_after_receive_interest,
+  .on_data = NULL,
+  .on_timeout = NULL,
+  .on_nack = NULL,
+  .retx_timeout = NULL,
+};
+
+/** Whether an Interest should wait for the upstreams it was sent to.
+ */
+static inline bool
+ndn_strategy_is_pending(const ndn_strategy_context_t* ctx)
+{
+  return !ctx->retransmission && !ndn_faceset_is_empty(&ctx->pit_entry->outgoing_faces);
+}
+
+static ndn_table_id_t
+ndn_strategy_cheapest(const ndn_fib_entry_t* fib_entry, const ndn_faceset_t* eligible)
+{
+  ndn_table_id_t id, best = NDN_INVALID_ID;
+  uint16_t cost, best_cost = 0;
+
+  NDN_FACESET_FOREACH(eligible, id){
+    cost = ndn_fib_get_cost(fib_entry, id);
+    if(best == NDN_INVALID_ID || cost < best_cost){
+      best = id;
+      best_cost = cost;
+    }
+  }
+  return best;
+}
+
+static void
+ndn_strategy_best_route_after_receive_interest(const ndn_strategy_context_t* ctx,
+                                               const ndn_faceset_t* eligible,
+                                               ndn_faceset_t* out)
+{
+  ndn_table_id_t id;
+
+  if(ndn_strategy_is_pending(ctx)){
+    return;
+  }
+  id = ndn_strategy_cheapest(ctx->fib_entry, eligible);
+  if(id != NDN_INVALID_ID){
+    ndn_faceset_add(out, id);
+  }
+}
+
+static void
+ndn_strategy_best_route_on_nack(const ndn_strategy_context_t* ctx,
+                                uint8_t reason,
+                                const ndn_faceset_t* eligible,
+                                ndn_faceset_t* retry)
+{
+  ndn_table_id_t id;
+
+  (void)reason;
+  if(ctx->fib_entry == NULL){
+    return;
+  }
+  id = ndn_strategy_cheapest(ctx->fib_entry, eligible);
+  if(id != NDN_INVALID_ID){
+    ndn_faceset_add(retry, id);
+  }
+}
+
+const ndn_strategy_t ndn_strategy_best_route = {
+  .after_receive_interest = ndn_strategy_best_route_after_receive_interest,
+  .on_data = NULL,
+  .on_timeout = NULL,
+  .on_nack = ndn_strategy_best_route_on_nack,
+  .retx_timeout = NULL,
+};
+
+static inline uint32_t
+ndn_strategy_weight(uint16_t cost, uint16_t max_cost)
+{
+  uint32_t weight = (cost > 0) ? max_cost / cost : max_cost;
+  return (weight > 0) ? weight : 1;
+}
+
+/** Pick a face in weighted round-robin order, advancing the FIB entry's position.
+ */
+static ndn_table_id_t
+ndn_strategy_weighted_pick(ndn_fib_entry_t* fib_entry, const ndn_faceset_t* eligible)
+{
+  ndn_table_id_t id;
+  uint16_t cost, max_cost = 0;
+  uint32_t weight, total = 0, turn;
+
+  NDN_FACESET_FOREACH(eligible, id){
+    cost = ndn_fib_get_cost(fib_entry, id);
+    max_cost = (cost > max_cost) ? cost : max_cost;
+  }
+  NDN_FACESET_FOREACH(eligible, id){
+    total += ndn_strategy_weight(ndn_fib_get_cost(fib_entry, id), max_cost);
+  }
+  if(total == 0){
+    return NDN_INVALID_ID;
+  }
+
+  turn = fib_entry->rr_counter % total;
+  fib_entry->rr_counter ++;
+  NDN_FACESET_FOREACH(eligible, id){
+    weight = ndn_strategy_weight(ndn_fib_get_cost(fib_entry, id), max_cost);
+    if(turn < weight){
+      break;
+    }
+    turn -= weight;
+  }
+  return id;
+}
+
+static void
+ndn_strategy_load_balance_after_receive_interest(const ndn_strategy_context_t* ctx,
+                                                 const ndn_faceset_t* eligible,
+                                                 ndn_faceset_t* out)
+{
+  ndn_table_id_t id;
+
+  if(ndn_strategy_is_pending(ctx)){
+    return;
+  }
+  id = ndn_strategy_weighted_pick(ctx->fib_entry, eligible);
+  if(id != NDN_INVALID_ID){
+    ndn_faceset_add(out, id);
+  }
+}
+
+static void
+ndn_strategy_load_balance_on_nack(const ndn_strategy_context_t* ctx,
+                                  uint8_t reason,
+                                  const ndn_faceset_t* eligible,
+                                  ndn_faceset_t* retry)
+{
+  ndn_table_id_t id;
+
+  (void)reason;
+  if(ctx->fib_entry == NULL){
+    return;
+  }
+  id = ndn_strategy_weighted_pick(ctx->fib_entry, eligible);
+  if(id != NDN_INVALID_ID){
+    ndn_faceset_add(retry, id);
+  }
+}
+
+const ndn_strategy_t ndn_strategy_load_balance = {
+  .after_receive_interest = ndn_strategy_load_balance_after_receive_interest,
+  .on_data = NULL,
+  .on_timeout = NULL,
+  .on_nack = ndn_strategy_load_balance_on_nack,
+  .retx_timeout = NULL,
+};
+
+/** The eligible face of the lowest SRTT, or the cheapest if none is measured.
+ */
+static ndn_table_id_t
+ndn_strategy_fastest(const ndn_strategy_context_t* ctx, const ndn_faceset_t* eligible)
+{
+  const ndn_measurement_t* record;
+  ndn_table_id_t id, best = NDN_INVALID_ID;
+  uint32_t best_rtt = NDN_MEASUREMENTS_NO_RTT;
+
+  NDN_FACESET_FOREACH(eligible, id){
+    record = ndn_measurements_find(&ctx->fib->measurements, ctx->fib_entry->measurements, id);
+    if(record != NULL && record->srtt < best_rtt){
+      best = id;
+      best_rtt = record->srtt;
+    }
+  }
+  if(best == NDN_INVALID_ID){
+    best = ndn_strategy_cheapest(ctx->fib_entry, eligible);
+  }
+  return best;
+}
+
+/** An eligible face other than @c best which is not measured for #NDN_STRATEGY_PROBE_INTERVAL.
+ */
+static ndn_table_id_t
+ndn_strategy_probe(const ndn_strategy_context_t* ctx, const ndn_faceset_t* eligible, ndn_table_id_t best)
+{
+  ndn_measurement_t* record;
+  ndn_table_id_t id;
+
+  NDN_FACESET_FOREACH(eligible, id){
+    if(id == best){
+      continue;
+    }
+    record = ndn_measurements_find(&ctx->fib->measurements, ctx->fib_entry->measurements, id);
+    if(record != NULL && record->last_time + NDN_STRATEGY_PROBE_INTERVAL > ctx->now){
+      continue;
+    }
+    // Without a record, the face would be probed for every Interest
+    record = ndn_measurements_find_or_insert(&ctx->fib->measurements, &ctx->fib_entry->measurements, id);
+    if(record == NULL){
+      return NDN_INVALID_ID;
+    }
+    record->last_time = ctx->now;
+    return id;
+  }
+  return NDN_INVALID_ID;
+}
+
+static void
+ndn_strategy_adaptive_after_receive_interest(const ndn_strategy_context_t* ctx,
+                                             const ndn_faceset_t* eligible,
+                                             ndn_faceset_t* out)
+{
+  ndn_table_id_t id;
+
+  if(ndn_strategy_is_pending(ctx)){
+    return;
+  }
+  id = ndn_strategy_fastest(ctx, eligible);
+  if(id == NDN_INVALID_ID){
+    return;
+  }
+  ndn_faceset_add(out, id);
+  id = ndn_strategy_probe(ctx, eligible, id);
+  if(id != NDN_INVALID_ID){
+    ndn_faceset_add(out, id);
+  }
+}
+
+static void
+ndn_strategy_adaptive_on_data(const ndn_strategy_context_t* ctx)
+{
+  ndn_pit_record_t* out_record;
+  ndn_measurement_t* record;
+
+  if(ctx->fib_entry == NULL){
+    return;
+  }
+  out_record = ndn_pit_find_record(ctx->pit, ctx->pit_entry->out_records, ctx->face_id);
+  if(out_record == NULL || !ndn_faceset_contains(&ctx->fib_entry->nexthop, ctx->face_id)){
+    return;
+  }
+  record = ndn_measurements_find_or_insert(&ctx->fib->measurements, &ctx->fib_entry->measurements,
+                                           ctx->face_id);
+  if(record != NULL){
+    ndn_measurement_add_sample(record, (uint32_t)(ctx->now - out_record->last_time), ctx->now);
+  }
+}
+
+static void
+ndn_strategy_adaptive_on_timeout(const ndn_strategy_context_t* ctx)
+{
+  ndn_pit_record_t* out_record;
+  ndn_measurement_t* record;
+  ndn_table_id_t id;
+
+  if(ctx->fib_entry == NULL){
+    return;
+  }
+  // Upstreams which had their RTO to answer
+  for(id = ctx->pit_entry->out_records; id != NDN_INVALID_ID; id = out_record->next){
+    out_record = &ctx->pit->records[id];
+    record = ndn_measurements_find(&ctx->fib->measurements, ctx->fib_entry->measurements,
+                                   out_record->face_id);
+    if(record != NULL && !out_record->nacked &&
+       out_record->last_time + ndn_measurement_rto(record) <= ctx->now){
+      ndn_measurement_backoff(record);
+    }
+  }
+}
+
+static void
+ndn_strategy_adaptive_on_nack(const ndn_strategy_context_t* ctx,
+                              uint8_t reason,
+                              const ndn_faceset_t* eligible,
+                              ndn_faceset_t* retry)
+{
+  ndn_table_id_t id;
+
+  (void)reason;
+  if(ctx->fib_entry == NULL){
+    return;
+  }
+  id = ndn_strategy_fastest(ctx, eligible);
+  if(id != NDN_INVALID_ID){
+    ndn_faceset_add(retry, id);
+  }
+}
+
+static uint32_t
+ndn_strategy_adaptive_retx_timeout(const ndn_strategy_context_t* ctx, const ndn_faceset_t* out)
+{
+  const ndn_measurement_t* record;
+  ndn_table_id_t id;
+  uint32_t rto, ret = 0;
+
+  // Wait for the slowest upstream
+  NDN_FACESET_FOREACH(out, id){
+    record = ndn_measurements_find(&ctx->fib->measurements, ctx->fib_entry->measurements, id);
+    rto = ndn_measurement_rto(record);
+    ret = (rto > ret) ? rto : ret;
+  }
+  return ret;
+}
+
+const ndn_strategy_t ndn_strategy_adaptive = {
+  .after_receive_interest = ndn_strategy_adaptive_after_receive_interest,
+  .on_data = ndn_strategy_adaptive_on_data,
+  .on_timeout = ndn_strategy_adaptive_on_timeout,
+  .on_nack = ndn_strategy_adaptive_on_nack,
+  .retx_timeout = ndn_strategy_adaptive_retx_timeout,
+};
+
+void
+ndn_strategy_choice_init(ndn_strategy_choice_t* self, const ndn_strategy_t* root)
+{
+  int i;
+  self->root = (root != NULL) ? root : &ndn_strategy_multicast;
+  self->count = 0;
+  for(i = 0; i < NDN_STRATEGY_CHOICE_MAX_SIZE; i ++){
+    self->entries[i].strategy = NULL;
+  }
+}
+
+int
+ndn_strategy_choice_set(ndn_strategy_choice_t* self, uint8_t* prefix, size_t length,
+                        const ndn_strategy_t* strategy)
+{
+  ndn_parsed_name_t name;
+  ndn_strategy_choice_entry_t* entry;
+  int i, slot = -1;
+  int ret = tlv_name_parse(prefix, length, &name);
+
+  if(ret != NDN_SUCCESS){
+    return ret;
+  }
+  if(name.count == 0){
+    self->root = (strategy != NULL) ? strategy : &ndn_strategy_multicast;
+    return NDN_SUCCESS;
+  }
+  if(name.count > NDN_FWD_NAME_MAX_COMPONENTS || name.comp_len > NDN_STRATEGY_CHOICE_NAME_SIZE){
+    return NDN_OVERSIZE;
+  }
+
+  for(i = 0; i < NDN_STRATEGY_CHOICE_MAX_SIZE; i ++){
+    entry = &self->entries[i];
+    if(entry->strategy == NULL){
+      slot = (slot < 0) ? i : slot;
+    }
+    else if(entry->depth == name.count && entry->comp_len == name.comp_len &&
+            memcmp(entry->comps, name.comps, name.comp_len) == 0){
+      if(strategy == NULL){
+        self->count --;
+      }
+      entry->strategy = strategy;
+      return NDN_SUCCESS;
+    }
+  }
+  if(strategy == NULL){
+    return NDN_SUCCESS;
+  }
+  if(slot < 0){
+    return NDN_FWD_STRATEGY_CHOICE_FULL;
+  }
+
+  entry = &self->entries[slot];
+  entry->strategy = strategy;
+  entry->hash = name.hash;
+  entry->depth = (uint8_t)name.count;
+  entry->comp_len = (uint8_t)name.comp_len;
+  memcpy(entry->comps, name.comps, name.comp_len);
+  self->count ++;
+  return NDN_SUCCESS;
+}
+
+const ndn_strategy_t*
+ndn_strategy_choice_find(const ndn_strategy_choice_t* self, const ndn_parsed_name_t* name)
+{
+  const ndn_strategy_choice_entry_t* entry;
+  const ndn_strategy_t* ret = self->root;
+  uint32_t depth, best = 0;
+  int i;
+
+  if(self->count == 0){
+    return ret;
+  }
+  depth = ndn_parsed_name_depth(name);
+  for(i = 0; i < NDN_STRATEGY_CHOICE_MAX_SIZE; i ++){
+    entry = &self->entries[i];
+    if(entry->strategy != NULL && entry->depth <= depth && entry->depth > best &&
+       name->hashes[entry->depth] == entry->hash &&
+       name->lens[entry->depth] == entry->comp_len &&
+       memcmp(name->comps, entry->comps, entry->comp_len) == 0)
+    {
+      ret = entry->strategy;
+      best = entry->depth;
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef FORWARDER_STRATEGY_H_
+#define FORWARDER_STRATEGY_H_
+
+#include "pit.h"
+#include "fib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdStrategy Strategy
+ * @brief Forwarding strategies and the strategy choice table
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * The state a strategy is given with an event.
+ */
+typedef struct ndn_strategy_context {
+  ndn_pit_t* pit;
+
+  /** The FIB, whose ndn_fib#measurements keep the RTTs of next hops.
+   * @c NULL for a PIT timeout.
+   */
+  ndn_fib_t* fib;
+
+  /** The PIT entry of the event.
+   */
+  ndn_pit_entry_t* pit_entry;
+
+  /** The FIB entry matching the name, of the Data for a Data.
+   * @c NULL if there is none, or for a PIT timeout.
+   */
+  ndn_fib_entry_t* fib_entry;
+
+  /** The face the packet came from.
+   * #NDN_INVALID_ID for the application or a timer.
+   */
+  ndn_table_id_t face_id;
+
+  /** Whether the downstream sent the Interest before, so another upstream may be tried.
+   * Only meaningful for an Interest.
+   */
+  bool retransmission;
+
+  /** The NDNLPv2 CongestionMark of the Data, so the strategy can send less to a congested upstream.
+   * 0 if there is none, or for other events.
+   */
+  uint64_t congestion_mark;
+
+  ndn_time_ms_t now;
+} ndn_strategy_context_t;
+
+/**
+ * A forwarding strategy.
+ *
+ * Hooks which are @c NULL are not called.
+ * The PIT entry must not be removed by a hook.
+ */
+typedef struct ndn_strategy {
+  /** Choose the upstreams of an Interest.
+   * @param[in] eligible Next hops which are neither the downstream nor waiting for the Interest.
+   * @param[out] out The faces to send the Interest to, a subset of @c eligible. Empty on call.
+   */
+  void (*after_receive_interest)(const ndn_strategy_context_t* ctx,
+                                 const ndn_faceset_t* eligible,
+                                 ndn_faceset_t* out);
+
+  /** Called when an upstream brings the Data, before the PIT entry is satisfied.
+   */
+  void (*on_data)(const ndn_strategy_context_t* ctx);
+
+  /** Called when the PIT entry or the application's Interest expires unsatisfied,
+   * or the retransmission timer fires.
+   */
+  void (*on_timeout)(const ndn_strategy_context_t* ctx);
+
+  /** Called when an upstream returns a Nack for the Interest last sent to it.
+   * @param[in] reason The Nack reason.
+   * @param[in] eligible Next hops which have neither sent nor been sent the Interest.
+   * @param[out] retry The faces to send the Interest to instead. Empty on call.
+   *                   The downstreams are Nacked once all upstreams have Nacked.
+   */
+  void (*on_nack)(const ndn_strategy_context_t* ctx,
+                  uint8_t reason,
+                  const ndn_faceset_t* eligible,
+                  ndn_faceset_t* retry);
+
+  /** Get how long to wait for the upstreams an Interest was just sent to.
+   *
+   * When the time is up, the forwarder keeps the Interest if it has room,
+   * calls @c on_timeout, then @c after_receive_interest as for a retransmission.
+   * @param[in] out The upstreams.
+   * @return The timeout in milliseconds. 0 not to retransmit.
+   */
+  uint32_t (*retx_timeout)(const ndn_strategy_context_t* ctx, const ndn_faceset_t* out);
+} ndn_strategy_t;
+
+/** Send an Interest to every next hop.
+ */
+extern const ndn_strategy_t ndn_strategy_multicast;
+
+/** Send an Interest to the next hop of the lowest cost, the lowest face ID on a tie.
+ * Another one is tried when the downstream retransmits or the upstream Nacks.
+ */
+extern const ndn_strategy_t ndn_strategy_best_route;
+
+/** Send an Interest to one next hop in weighted round-robin order.
+ * A next hop's weight is the highest cost of the next hops divided by its cost, at least 1,
+ * so a next hop of half the cost gets twice the Interests.
+ * Another one is tried when the downstream retransmits or the upstream Nacks.
+ */
+extern const ndn_strategy_t ndn_strategy_load_balance;
+
+/** Send an Interest to the next hop of the lowest SRTT, or of the lowest cost if none is measured.
+ * Every #NDN_STRATEGY_PROBE_INTERVAL, another next hop is sent the Interest too, to measure it.
+ * If the upstreams don't answer within their RTO, another next hop is tried.
+ */
+extern const ndn_strategy_t ndn_strategy_adaptive;
+
+/**
+ * A prefix with a strategy.
+ */
+typedef struct ndn_strategy_choice_entry {
+  /** The strategy. @c NULL if the entry is empty.
+   */
+  const ndn_strategy_t* strategy;
+
+  /** Hash of the prefix components.
+   * @sa ndn_parsed_name#hashes
+   */
+  uint32_t hash;
+
+  /** Number of components.
+   */
+  uint8_t depth;
+
+  /** Length of @c comps.
+   */
+  uint8_t comp_len;
+
+  /** The encoded components.
+   */
+  uint8_t comps[NDN_STRATEGY_CHOICE_NAME_SIZE];
+} ndn_strategy_choice_entry_t;
+
+/**
+ * Strategy Choice table.
+ *
+ * A name is forwarded by the strategy of its longest prefix in the table,
+ * or the strategy of "/" if none matches.
+ * The table is small, so a lookup scans it, comparing prefix hashes of the parsed name.
+ */
+typedef struct ndn_strategy_choice {
+  /** The strategy of "/".
+   */
+  const ndn_strategy_t* root;
+
+  /** Number of used entries.
+   */
+  uint8_t count;
+
+  ndn_strategy_choice_entry_t entries[NDN_STRATEGY_CHOICE_MAX_SIZE];
+} ndn_strategy_choice_t;
+
+/** Initialize a strategy choice table.
+ * @param[in] root The strategy of "/".
+ */
+void
+ndn_strategy_choice_init(ndn_strategy_choice_t* self, const ndn_strategy_t* root);
+
+/** Set the strategy of a prefix.
+ * @param[in] prefix The Name TLV of the prefix.
+ * @param[in] strategy The strategy. @c NULL to use the one of the parent prefix,
+ *                     or #ndn_strategy_multicast for "/".
+ * @return #NDN_SUCCESS if the strategy is set.
+ *         #NDN_OVERSIZE if the prefix is longer than #NDN_STRATEGY_CHOICE_NAME_SIZE
+ *         or #NDN_FWD_NAME_MAX_COMPONENTS.
+ *         #NDN_FWD_STRATEGY_CHOICE_FULL if the table is full.
+ */
+int
+ndn_strategy_choice_set(ndn_strategy_choice_t* self, uint8_t* prefix, size_t length,
+                        const ndn_strategy_t* strategy);
+
+/** Find the strategy of a name.
+ */
+const ndn_strategy_t*
+ndn_strategy_choice_find(const ndn_strategy_choice_t* self, const ndn_parsed_name_t* name);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_STRATEGY_H_
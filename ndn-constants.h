@@ -38,17 +38,113 @@
 #define NDN_SIGNATURE_BUFFER_SIZE 128
 
 // forwarder
+// 32-bit table IDs allow tables of more than 65534 entries, e.g. on a gateway
+#ifndef NDN_TABLE_ID_32BIT
+#define NDN_TABLE_ID_32BIT 0
+#endif
+#if NDN_TABLE_ID_32BIT
+typedef uint32_t ndn_table_id_t;
+#define NDN_INVALID_ID 0xFFFFFFFF
+#else
 typedef uint16_t ndn_table_id_t;
-
 #define NDN_INVALID_ID 0xFFFF
+#endif
+
+// default table sizes, see also ndn_forwarder_init_with_config()
 #define NDN_NAMETREE_MAX_SIZE 64
 #define NDN_FIB_MAX_SIZE 20
 #define NDN_PIT_MAX_SIZE 32
-#define NDN_CS_MAX_SIZE 10
+// content store capacity in bytes; 0, the default, leaves the content store out
+#ifndef NDN_CS_MAX_SIZE
+#define NDN_CS_MAX_SIZE 0
+#endif
 #define NDN_FACE_TABLE_MAX_SIZE 10
+// face IDs a PIT or FIB entry can record; every 64 faces add 8 bytes per face set,
+// which is 16 bytes per PIT entry and 8 per FIB entry: 1024 faces grow the default tables by 10 KB
+#ifndef NDN_FACESET_CAPACITY
+#define NDN_FACESET_CAPACITY 64
+#endif
 #define NDN_FACE_DEFAULT_COST 1
+// the share of the PIT in percent a face can be a downstream of by default
+#ifndef NDN_PIT_FACE_QUOTA
+#define NDN_PIT_FACE_QUOTA 75
+#endif
+// next hops of a FIB entry which can have a cost other than NDN_FACE_DEFAULT_COST
+#ifndef NDN_MAX_COST_PER_FIB_ENTRY
+#define NDN_MAX_COST_PER_FIB_ENTRY 4
+#endif
+// prefixes with a forwarding strategy other than the one of "/"
+#ifndef NDN_STRATEGY_CHOICE_MAX_SIZE
+#define NDN_STRATEGY_CHOICE_MAX_SIZE 8
+#endif
+// max length of the components of a strategy choice prefix
+#define NDN_STRATEGY_CHOICE_NAME_SIZE 64
+// retransmission timeouts of next hops in milliseconds
+#define NDN_RTO_INITIAL 1000
+#define NDN_RTO_MIN 100
+#define NDN_RTO_MAX 4000
+// how often the adaptive strategy tries a next hop other than the fastest, in milliseconds
+#ifndef NDN_STRATEGY_PROBE_INTERVAL
+#define NDN_STRATEGY_PROBE_INTERVAL 5000
+#endif
+// Interests kept to retransmit when the upstreams are too slow, and their max size
+#ifndef NDN_FWD_RETX_SLOTS
+#define NDN_FWD_RETX_SLOTS 4
+#endif
+#define NDN_FWD_RETX_PACKET_SIZE 256
 #define NDN_AES_BLOCK_SIZE 16
 #define NDN_MAX_FACE_PER_PIT_ENTRY 3
+#define NDN_FWD_NAME_MAX_COMPONENTS 32
+// nonces remembered after their PIT entries are gone, a power of 2
+#ifndef NDN_DEAD_NONCE_LIST_SIZE
+#define NDN_DEAD_NONCE_LIST_SIZE 64
+#endif
+// how long a dead nonce is remembered in milliseconds
+#ifndef NDN_DEAD_NONCE_LIFETIME
+#define NDN_DEAD_NONCE_LIFETIME 6000
+#endif
+
+// names with no route or no answer remembered by the PIT, a power of 2
+#ifndef NDN_NEGATIVE_CACHE_SIZE
+#define NDN_NEGATIVE_CACHE_SIZE 16
+#endif
+// how long an Interest for such a name is Nacked at once in milliseconds
+#ifndef NDN_NEGATIVE_CACHE_LIFETIME
+#define NDN_NEGATIVE_CACHE_LIFETIME 1000
+#endif
+
+// packets and bytes a face transmit queue holds
+#ifndef NDN_FACE_QUEUE_SIZE
+#define NDN_FACE_QUEUE_SIZE 16
+#endif
+#ifndef NDN_FACE_QUEUE_BYTES
+#define NDN_FACE_QUEUE_BYTES 4096
+#endif
+// bytes kept before each queued Data for the NDNLPv2 header of a CongestionMark
+#define NDN_FACE_QUEUE_MARK_HEADROOM 16
+// CoDel target wait and interval of face queues in milliseconds
+#ifndef NDN_CODEL_TARGET
+#define NDN_CODEL_TARGET 5
+#endif
+#ifndef NDN_CODEL_INTERVAL
+#define NDN_CODEL_INTERVAL 100
+#endif
+// how long a face refusing to send is left before its queue is retried,
+// and before the packet at the head is dropped, in milliseconds
+#ifndef NDN_FACE_QUEUE_RETRY_INTERVAL
+#define NDN_FACE_QUEUE_RETRY_INTERVAL 1
+#endif
+#ifndef NDN_FACE_QUEUE_SEND_TIMEOUT
+#define NDN_FACE_QUEUE_SEND_TIMEOUT 500
+#endif
+
+// forwarder engines, selected at build time
+#ifndef NDN_PIT_HASH_ENGINE
+#define NDN_PIT_HASH_ENGINE 0
+#endif
+#ifndef NDN_FIB_HASH_ENGINE
+#define NDN_FIB_HASH_ENGINE 0
+#endif
 
 // fragmentation support
 #define NDN_FRAG_HDR_LEN 3 // Size of the NDN L2 fragmentation header
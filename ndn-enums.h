@@ -25,12 +25,21 @@ enum {
   NDN_FACE_TYPE_NET = 2,
 };
 
-// forward strategy
+// forward strategy, returned by on_interest
+// MULTICAST lets the Interest through to the strategy of its name, see ndn_forwarder_set_strategy()
 enum {
   NDN_FWD_STRATEGY_SUPPRESS = 0,
   NDN_FWD_STRATEGY_MULTICAST = 1,
 };
 
+// Nack reasons, a less severe reason has a smaller value except for NONE
+enum {
+  NDN_NACK_REASON_NONE = 0,
+  NDN_NACK_REASON_CONGESTION = 50,
+  NDN_NACK_REASON_DUPLICATE = 100,
+  NDN_NACK_REASON_NO_ROUTE = 150,
+};
+
 // content type values
 enum {
   NDN_CONTENT_TYPE_BLOB = 0,
@@ -125,7 +125,7 @@
  */
 #define NDN_FWD_FACE_TABLE_FULL -51
 
-/** The PIT is full.
+/** The PIT is full, or the face of the Interest is at its quota.
  */
 #define NDN_FWD_PIT_FULL -52
 
@@ -139,10 +139,14 @@
 
 /** The Interest is rejected.
  *
- * - The Interest has a same nonce as previous one, indicating a routing loop.
+ * - The Interest's nonce is in the in-record of another face or in an out-record
+ *   of its PIT entry, indicating a routing loop.
+ * - The Interest's nonce is in the Dead Nonce List, i.e. it was forwarded
+ *   for the same name by a PIT entry which is gone.
  * - The Interest's hop limit comes to 0.
- * @note Different from NFD, NDN-Lite only records one nonce.
- *       Thus, not all routing loop can be avoided.
+ * - The face of the Interest exceeds its rate limit.
+ * @note Like NFD, a nonce is recorded per face, so a retransmission through
+ *       the same face is not a loop.
  */
 #define NDN_FWD_INTEREST_REJECTED -55
 
@@ -155,6 +159,14 @@
 /** The message queue is full.
  */
 #define NDN_FWD_MSGQUEUE_FULL -57
+
+/** The memory of the forwarder tables can't be allocated.
+ */
+#define NDN_FWD_NO_MEMORY -58
+
+/** The Strategy Choice table is full.
+ */
+#define NDN_FWD_STRATEGY_CHOICE_FULL -59
 /* @} */
 
 /** @defgroup NDNErrorCodeFace Face Errors
@@ -0,0 +1,18 @@
+set(DIR_BENCHMARKS "${PROJECT_SOURCE_DIR}/benchmarks")
+
+add_executable(pit-bench "${DIR_BENCHMARKS}/pit-bench.c")
+target_link_libraries(pit-bench ndn-lite)
+
+add_executable(fib-bench "${DIR_BENCHMARKS}/fib-bench.c")
+target_link_libraries(fib-bench ndn-lite)
+
+add_executable(cs-bench "${DIR_BENCHMARKS}/cs-bench.c")
+target_link_libraries(cs-bench ndn-lite)
+
+add_executable(churn-bench "${DIR_BENCHMARKS}/churn-bench.c")
+target_link_libraries(churn-bench ndn-lite)
+
+add_executable(nametree-bench "${DIR_BENCHMARKS}/nametree-bench.c")
+target_link_libraries(nametree-bench ndn-lite)
+
+unset(DIR_BENCHMARKS)
@@ -1,18 +1,35 @@
 set(DIR_FORWARDER "${DIR_NDN_LITE}/forwarder")
 target_sources(ndn-lite PUBLIC
+  ${DIR_FORWARDER}/admission.h
   ${DIR_FORWARDER}/callback-funcs.h
+  ${DIR_FORWARDER}/cs.h
+  ${DIR_FORWARDER}/dead-nonce-list.h
+  ${DIR_FORWARDER}/face-index.h
+  ${DIR_FORWARDER}/face-queue.h
   ${DIR_FORWARDER}/face-table.h
   ${DIR_FORWARDER}/face.h
+  ${DIR_FORWARDER}/faceset.h
   ${DIR_FORWARDER}/fib.h
   ${DIR_FORWARDER}/forwarder.h
+  ${DIR_FORWARDER}/measurements.h
   ${DIR_FORWARDER}/name-tree.h
+  ${DIR_FORWARDER}/negative-cache.h
   ${DIR_FORWARDER}/pit.h
+  ${DIR_FORWARDER}/strategy.h
 )
 target_sources(ndn-lite PRIVATE
+  ${DIR_FORWARDER}/admission.c
+  ${DIR_FORWARDER}/cs.c
+  ${DIR_FORWARDER}/dead-nonce-list.c
+  ${DIR_FORWARDER}/face-index.c
+  ${DIR_FORWARDER}/face-queue.c
   ${DIR_FORWARDER}/face-table.c
   ${DIR_FORWARDER}/fib.c
   ${DIR_FORWARDER}/forwarder.c
+  ${DIR_FORWARDER}/measurements.c
   ${DIR_FORWARDER}/name-tree.c
+  ${DIR_FORWARDER}/negative-cache.c
   ${DIR_FORWARDER}/pit.c
+  ${DIR_FORWARDER}/strategy.c
 )
 unset(DIR_FORWARDER)
@@ -106,6 +106,12 @@ unset(LIST_TESTS)
 target_sources(unittest PRIVATE
   "${DIR_UNITTESTS}/fib/fib-tests.h"
   "${DIR_UNITTESTS}/fib/fib-tests.c"
+  "${DIR_UNITTESTS}/pit/pit-tests.h"
+  "${DIR_UNITTESTS}/pit/pit-tests.c"
+  "${DIR_UNITTESTS}/cs/cs-tests.h"
+  "${DIR_UNITTESTS}/cs/cs-tests.c"
+  "${DIR_UNITTESTS}/faceset/faceset-tests.h"
+  "${DIR_UNITTESTS}/faceset/faceset-tests.c"
 )
 
 target_sources(unittest PRIVATE
@@ -4,6 +4,7 @@ target_sources(ndn-lite PUBLIC
   ${DIR_UTIL}/msg-queue.h
   ${DIR_UTIL}/uniform-time.h
   ${DIR_UTIL}/bit-operations.h
+  ${DIR_UTIL}/hash.h
   ${DIR_UTIL}/re.h
   ${DIR_UTIL}/logger.h
 )
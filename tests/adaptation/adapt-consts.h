@@ -10,6 +10,10 @@
 
 #define NDN_UDP_FACE_SOCKET_ERROR 1
 #define NDN_UNIX_FACE_SOCKET_ERROR 2
+#define NDN_DISK_CS_IO_ERROR 3
+#define NDN_EVENT_LOOP_ERROR 4
+#define NDN_URING_ERROR 5
+#define NDN_UDP_FACE_SOCKET_BUSY 6
 
 #define NDN_NFD_DEFAULT_ADDR "/var/run/nfd.sock"
 
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include "disk-cs.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/encode/forwarder-helper.h"
+#include "ndn-lite/encode/tlv.h"
+#include "ndn-lite/util/hash.h"
+
+#define NDN_DISK_CS_MAGIC 0x5343444E // "NDCS"
+#define NDN_DISK_CS_VERSION 1
+
+static size_t
+ndn_disk_cs_match(ndn_cs_tier_t* tier, uint8_t* name, size_t name_len,
+                  bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now,
+                  const uint8_t** data);
+
+static void
+ndn_disk_cs_insert(ndn_cs_tier_t* tier, uint8_t* data, size_t length,
+                   uint8_t* name, size_t name_len, ndn_time_ms_t now);
+
+static inline uint8_t*
+ndn_disk_cs_record(ndn_disk_cs_t* self, const ndn_disk_cs_bucket_t* bucket)
+{
+  return self->log + bucket->offset % self->header->log_size;
+}
+
+/** Whether the packet of a bucket has not been overwritten.
+ */
+static inline bool
+ndn_disk_cs_bucket_valid(ndn_disk_cs_t* self, const ndn_disk_cs_bucket_t* bucket)
+{
+  return bucket->length != 0 && bucket->offset + self->header->log_size >= self->header->tail;
+}
+
+static inline bool
+ndn_disk_cs_bucket_equal(ndn_disk_cs_t* self, const ndn_disk_cs_bucket_t* bucket,
+                         uint32_t hash, const uint8_t* comps, size_t comp_len)
+{
+  return bucket->hash == hash && bucket->comp_len == comp_len &&
+         ndn_disk_cs_bucket_valid(self, bucket) &&
+         memcmp(ndn_disk_cs_record(self, bucket) + bucket->comp_offset, comps, comp_len) == 0;
+}
+
+ndn_disk_cs_t*
+ndn_disk_cs_open(const char* path, uint64_t log_size)
+{
+  ndn_disk_cs_t* self;
+  ndn_disk_cs_header_t* header;
+  struct stat st;
+  uint32_t bucket_count = 2;
+  size_t index_size, map_size;
+  uint8_t* map;
+  bool reset;
+  int fd;
+
+  log_size -= log_size % NDN_DISK_CS_ALIGN;
+  if(log_size == 0){
+    return NULL;
+  }
+  while(bucket_count < log_size / NDN_DISK_CS_BYTES_PER_BUCKET){
+    bucket_count <<= 1;
+  }
+  index_size = sizeof(ndn_disk_cs_header_t) + sizeof(ndn_disk_cs_bucket_t) * bucket_count;
+  map_size = index_size + log_size;
+
+  fd = open(path, O_RDWR | O_CREAT, 0644);
+  if(fd < 0){
+    return NULL;
+  }
+  if(fstat(fd, &st) < 0){
+    close(fd);
+    return NULL;
+  }
+  reset = ((size_t)st.st_size != map_size);
+  if(reset && ftruncate(fd, map_size) < 0){
+    close(fd);
+    return NULL;
+  }
+  map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(map == MAP_FAILED){
+    close(fd);
+    return NULL;
+  }
+
+  header = (ndn_disk_cs_header_t*)map;
+  if(reset || header->magic != NDN_DISK_CS_MAGIC || header->version != NDN_DISK_CS_VERSION ||
+     header->log_size != log_size || header->bucket_mask != bucket_count - 1)
+  {
+    // Only the index needs to be cleared; the log is garbage without it
+    memset(map, 0, index_size);
+    header->magic = NDN_DISK_CS_MAGIC;
+    header->version = NDN_DISK_CS_VERSION;
+    header->log_size = log_size;
+    header->tail = 0;
+    header->bucket_mask = bucket_count - 1;
+  }
+  // Hits are scattered over the log, so readahead only evicts useful pages
+  madvise(map + index_size, log_size, MADV_RANDOM);
+
+  self = (ndn_disk_cs_t*)malloc(sizeof(ndn_disk_cs_t));
+  if(self == NULL){
+    munmap(map, map_size);
+    close(fd);
+    return NULL;
+  }
+  self->tier.match = ndn_disk_cs_match;
+  self->tier.insert = ndn_disk_cs_insert;
+  self->header = header;
+  self->buckets = (ndn_disk_cs_bucket_t*)(map + sizeof(ndn_disk_cs_header_t));
+  self->log = map + index_size;
+  self->map_size = map_size;
+  self->fd = fd;
+  return self;
+}
+
+int
+ndn_disk_cs_sync(ndn_disk_cs_t* self)
+{
+  if(msync(self->header, self->map_size, MS_SYNC) < 0){
+    return NDN_DISK_CS_IO_ERROR;
+  }
+  return NDN_SUCCESS;
+}
+
+void
+ndn_disk_cs_close(ndn_disk_cs_t* self)
+{
+  munmap(self->header, self->map_size);
+  close(self->fd);
+  free(self);
+}
+
+static size_t
+ndn_disk_cs_match(ndn_cs_tier_t* tier, uint8_t* name, size_t name_len,
+                  bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now,
+                  const uint8_t** data)
+{
+  ndn_disk_cs_t* self = container_of(tier, ndn_disk_cs_t, tier);
+  ndn_disk_cs_bucket_t* bucket;
+  uint32_t type, comp_len, hash, i, n;
+  uint8_t* comps;
+  (void)can_be_prefix;
+
+  comps = tlv_get_type_length(name, name_len, &type, &comp_len);
+  if(comps == NULL || type != TLV_Name || comps + comp_len > name + name_len){
+    return 0;
+  }
+  hash = ndn_hash(comps, comp_len);
+  i = hash & self->header->bucket_mask;
+  for(n = 0; n < NDN_DISK_CS_MAX_PROBE; n ++){
+    bucket = &self->buckets[(i + n) & self->header->bucket_mask];
+    if(bucket->length == 0){
+      break;
+    }
+    if(ndn_disk_cs_bucket_equal(self, bucket, hash, comps, comp_len)){
+      if(must_be_fresh && now >= bucket->fresh_until){
+        break;
+      }
+      *data = ndn_disk_cs_record(self, bucket);
+      return bucket->length;
+    }
+  }
+  return 0;
+}
+
+static void
+ndn_disk_cs_insert(ndn_cs_tier_t* tier, uint8_t* data, size_t length,
+                   uint8_t* name, size_t name_len, ndn_time_ms_t now)
+{
+  ndn_disk_cs_t* self = container_of(tier, ndn_disk_cs_t, tier);
+  ndn_disk_cs_header_t* header = self->header;
+  ndn_disk_cs_bucket_t *bucket, *target = NULL, *unused = NULL, *oldest = NULL;
+  uint32_t type, comp_len, hash, i, n;
+  uint64_t freshness_period, offset;
+  uint8_t* comps;
+
+  if(length > header->log_size || length > UINT32_MAX ||
+     name < data || name + name_len > data + length){
+    return;
+  }
+  comps = tlv_get_type_length(name, name_len, &type, &comp_len);
+  if(comps == NULL || type != TLV_Name || comps + comp_len > data + length ||
+     comps - data > UINT16_MAX || comp_len > UINT16_MAX){
+    return;
+  }
+  if(tlv_data_get_freshness_period(data, length, &freshness_period) != NDN_SUCCESS){
+    return;
+  }
+
+  // Records never wrap around the end of the log
+  offset = header->tail;
+  if(offset % header->log_size + length > header->log_size){
+    offset += header->log_size - offset % header->log_size;
+  }
+  // Advance the tail first, so buckets of overwritten packets are invalid before the copy
+  header->tail = offset + (length + NDN_DISK_CS_ALIGN - 1) / NDN_DISK_CS_ALIGN * NDN_DISK_CS_ALIGN;
+  memcpy(self->log + offset % header->log_size, data, length);
+
+  // Buckets are never emptied, so probing needs no backward shift.
+  // Reuse the bucket of the same name, else an empty or invalid one, else the oldest.
+  hash = ndn_hash(comps, comp_len);
+  i = hash & header->bucket_mask;
+  for(n = 0; n < NDN_DISK_CS_MAX_PROBE; n ++){
+    bucket = &self->buckets[(i + n) & header->bucket_mask];
+    if(bucket->length == 0 || !ndn_disk_cs_bucket_valid(self, bucket)){
+      if(unused == NULL){
+        unused = bucket;
+      }
+      if(bucket->length == 0){
+        break;
+      }
+    }
+    else if(ndn_disk_cs_bucket_equal(self, bucket, hash, comps, comp_len)){
+      target = bucket;
+      break;
+    }
+    else if(oldest == NULL || bucket->offset < oldest->offset){
+      oldest = bucket;
+    }
+  }
+  if(target == NULL){
+    target = (unused != NULL ? unused : oldest);
+  }
+
+  target->hash = hash;
+  target->offset = offset;
+  target->fresh_until = now + freshness_period;
+  target->comp_offset = comps - data;
+  target->comp_len = comp_len;
+  target->length = length;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_DISK_CS_H_
+#define NDN_DISK_CS_H_
+
+#include "ndn-lite/forwarder/forwarder.h"
+#include "../adapt-consts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Log bytes per index bucket. The index takes a quarter of the log size.
+ */
+#define NDN_DISK_CS_BYTES_PER_BUCKET 128
+
+/** Number of buckets probed by a lookup.
+ */
+#define NDN_DISK_CS_MAX_PROBE 16
+
+/** Records in the log are aligned to this.
+ */
+#define NDN_DISK_CS_ALIGN 8
+
+/**
+ * Header of a disk CS file.
+ *
+ * The file is the header, followed by the index buckets and the log.
+ * Offsets grow forever and wrap around the log, so a record is intact
+ * as long as less than a log size of bytes has been appended after it.
+ */
+typedef struct ndn_disk_cs_header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t log_size;
+
+  /** Offset of the next record.
+   */
+  uint64_t tail;
+
+  /** Number of buckets minus one. The number of buckets is a power of 2.
+   */
+  uint32_t bucket_mask;
+  uint32_t reserved;
+} ndn_disk_cs_header_t;
+
+/**
+ * A bucket of the on-disk index.
+ */
+typedef struct ndn_disk_cs_bucket {
+  /** Offset of the Data packet, before wrapping around the log.
+   */
+  uint64_t offset;
+
+  /** The time the Data stops being fresh, in ndn_time_now_ms() units.
+   */
+  ndn_time_ms_t fresh_until;
+
+  /** Hash of the name components.
+   */
+  uint32_t hash;
+
+  /** Length of the Data packet. 0 if the bucket is empty.
+   */
+  uint32_t length;
+
+  /** Offset of the name components in the Data packet.
+   */
+  uint16_t comp_offset;
+
+  /** Length of the name components.
+   */
+  uint16_t comp_len;
+} ndn_disk_cs_bucket_t;
+
+/**
+ * Disk-backed content store tier.
+ *
+ * Data packets are appended to a circular log in a memory-mapped file,
+ * and the oldest ones are overwritten when the log is full.
+ * The file survives restarts of the application. Hits are sent straight from the mapping.
+ * Only exact name matches are supported.
+ */
+typedef struct ndn_disk_cs {
+  /**
+   * The inherited interface.
+   */
+  ndn_cs_tier_t tier;
+
+  ndn_disk_cs_header_t* header;
+  ndn_disk_cs_bucket_t* buckets;
+  uint8_t* log;
+  size_t map_size;
+  int fd;
+} ndn_disk_cs_t;
+
+/** Open a disk CS file, creating it if necessary.
+ *
+ * Packets of an existing file are kept if it was created with the same @c log_size.
+ * @param[in] path The path of the file.
+ * @param[in] log_size Bytes of Data packets to store.
+ * @return The disk CS. @c NULL if the file can't be opened or mapped.
+ */
+ndn_disk_cs_t*
+ndn_disk_cs_open(const char* path, uint64_t log_size);
+
+/** Flush the file to the disk.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_DISK_CS_IO_ERROR otherwise.
+ */
+int
+ndn_disk_cs_sync(ndn_disk_cs_t* self);
+
+/** Unmap and close the file.
+ * @pre @c self is not attached to the forwarder.
+ */
+void
+ndn_disk_cs_close(ndn_disk_cs_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_DISK_CS_H_
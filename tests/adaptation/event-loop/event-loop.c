@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <sys/epoll.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include "event-loop.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/util/msg-queue.h"
+#include "ndn-lite/util/uniform-time.h"
+
+/**
+ * A watched file descriptor.
+ */
+typedef struct ndn_event_loop_entry {
+  ndn_event_loop_callback callback;
+
+  /** Called when the file descriptor is writable. NULL if it is not watched for writing.
+   */
+  ndn_event_loop_callback on_writable;
+  void* self;
+  int fd;
+
+  /** Increased each time the entry is freed,
+   * so events of a removed file descriptor already waited for are ignored.
+   */
+  uint32_t generation;
+} ndn_event_loop_entry_t;
+
+static int epoll_fd = -1;
+static bool stopped;
+static ndn_event_loop_entry_t entries[NDN_EVENT_LOOP_MAX_FDS];
+
+int
+ndn_event_loop_init(void){
+  int i;
+
+  if(epoll_fd != -1){
+    return NDN_SUCCESS;
+  }
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if(epoll_fd == -1){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  for(i = 0; i < NDN_EVENT_LOOP_MAX_FDS; i ++){
+    entries[i].callback = NULL;
+    entries[i].on_writable = NULL;
+    entries[i].fd = -1;
+  }
+  stopped = false;
+  return NDN_SUCCESS;
+}
+
+void
+ndn_event_loop_close(void){
+  int i;
+
+  if(epoll_fd == -1){
+    return;
+  }
+  for(i = 0; i < NDN_EVENT_LOOP_MAX_FDS; i ++){
+    entries[i].callback = NULL;
+    entries[i].on_writable = NULL;
+    entries[i].fd = -1;
+    entries[i].generation ++;
+  }
+  close(epoll_fd);
+  epoll_fd = -1;
+}
+
+int
+ndn_event_loop_fd(void){
+  return epoll_fd;
+}
+
+int
+ndn_event_loop_add(int fd, ndn_event_loop_callback callback, void* self){
+  struct epoll_event event;
+  ndn_event_loop_entry_t* entry = NULL;
+  int i;
+
+  if(epoll_fd == -1 || fd < 0 || callback == NULL){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  for(i = 0; i < NDN_EVENT_LOOP_MAX_FDS; i ++){
+    if(entries[i].callback == NULL){
+      entry = &entries[i];
+      break;
+    }
+  }
+  if(entry == NULL){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+
+  // Level-triggered, so a callback may leave packets for the next round
+  event.events = EPOLLIN;
+  event.data.u64 = ((uint64_t)entry->generation << 32) | (uint32_t)i;
+  if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  entry->callback = callback;
+  entry->on_writable = NULL;
+  entry->self = self;
+  entry->fd = fd;
+  return NDN_SUCCESS;
+}
+
+int
+ndn_event_loop_set_writable(int fd, ndn_event_loop_callback callback){
+  struct epoll_event event;
+  int i;
+
+  if(epoll_fd == -1 || fd < 0){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  for(i = 0; i < NDN_EVENT_LOOP_MAX_FDS; i ++){
+    if(entries[i].callback != NULL && entries[i].fd == fd){
+      break;
+    }
+  }
+  if(i == NDN_EVENT_LOOP_MAX_FDS){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  if((entries[i].on_writable != NULL) == (callback != NULL)){
+    entries[i].on_writable = callback;
+    return NDN_SUCCESS;
+  }
+
+  // Level-triggered: the owner stops watching for writing once it has nothing left to send
+  event.events = (callback != NULL) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+  event.data.u64 = ((uint64_t)entries[i].generation << 32) | (uint32_t)i;
+  if(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) == -1){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  entries[i].on_writable = callback;
+  return NDN_SUCCESS;
+}
+
+void
+ndn_event_loop_remove(int fd){
+  int i;
+
+  if(epoll_fd == -1 || fd < 0){
+    return;
+  }
+  for(i = 0; i < NDN_EVENT_LOOP_MAX_FDS; i ++){
+    if(entries[i].callback != NULL && entries[i].fd == fd){
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+      entries[i].callback = NULL;
+      entries[i].on_writable = NULL;
+      entries[i].fd = -1;
+      entries[i].generation ++;
+      return;
+    }
+  }
+}
+
+int
+ndn_event_loop_timeout(void){
+  ndn_time_ms_t deadline, now;
+
+  if(!ndn_msgqueue_empty()){
+    return 0;
+  }
+  deadline = ndn_forwarder_next_deadline();
+  if(deadline == NDN_PIT_NO_EXPIRY){
+    return -1;
+  }
+  now = ndn_time_now_ms();
+  if(deadline <= now){
+    return 0;
+  }
+  return (deadline - now < INT_MAX) ? (int)(deadline - now) : INT_MAX;
+}
+
+int
+ndn_event_loop_run_once(int max_wait){
+  struct epoll_event events[NDN_EVENT_LOOP_BATCH];
+  ndn_event_loop_entry_t* entry;
+  int timeout = ndn_event_loop_timeout();
+  uint32_t generation;
+  int count, i;
+
+  if(epoll_fd == -1){
+    return NDN_EVENT_LOOP_ERROR;
+  }
+  if(max_wait >= 0 && (timeout < 0 || timeout > max_wait)){
+    timeout = max_wait;
+  }
+  count = epoll_wait(epoll_fd, events, NDN_EVENT_LOOP_BATCH, timeout);
+  if(count == -1){
+    if(errno != EINTR){
+      return NDN_EVENT_LOOP_ERROR;
+    }
+    count = 0;
+  }
+
+  for(i = 0; i < count; i ++){
+    entry = &entries[(uint32_t)events[i].data.u64];
+    generation = (uint32_t)(events[i].data.u64 >> 32);
+    // An earlier callback may have removed it, e.g. by bringing its face down
+    if((events[i].events & EPOLLOUT) && entry->on_writable != NULL &&
+       entry->generation == generation){
+      entry->on_writable(entry->self);
+    }
+    // Errors and hang-ups are left to the read, which finds them
+    if((events[i].events & ~(uint32_t)EPOLLOUT) && entry->callback != NULL &&
+       entry->generation == generation){
+      entry->callback(entry->self);
+    }
+  }
+  ndn_forwarder_process();
+  return NDN_SUCCESS;
+}
+
+void
+ndn_event_loop_run(void){
+  stopped = false;
+  while(!stopped){
+    if(ndn_event_loop_run_once(-1) != NDN_SUCCESS){
+      break;
+    }
+  }
+}
+
+void
+ndn_event_loop_stop(void){
+  stopped = true;
+}
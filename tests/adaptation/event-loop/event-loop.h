@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_EVENT_LOOP_H_
+#define NDN_EVENT_LOOP_H_
+
+#include <stdbool.h>
+#include "ndn-lite/forwarder/forwarder.h"
+#include "../adapt-consts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The most file descriptors watched at the same time.
+ */
+#define NDN_EVENT_LOOP_MAX_FDS 64
+
+/** The most events handled per wait.
+ */
+#define NDN_EVENT_LOOP_BATCH 16
+
+/** Called when a watched file descriptor is readable, or writable.
+ * @param[in, out] self The object given to ndn_event_loop_add().
+ */
+typedef void(*ndn_event_loop_callback)(void* self);
+
+/** Start the event loop.
+ *
+ * Faces brought up afterwards register their sockets with the loop
+ * instead of polling them through the message queue.
+ * Call this before constructing faces.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_EVENT_LOOP_ERROR otherwise.
+ */
+int
+ndn_event_loop_init(void);
+
+/** Stop watching all file descriptors and release the loop.
+ */
+void
+ndn_event_loop_close(void);
+
+/** Get the file descriptor of the loop, to embed it in another event loop.
+ *
+ * It is readable when a watched file descriptor is.
+ * Then, or at ndn_event_loop_timeout(), call ndn_event_loop_run_once() with 0.
+ * @return The epoll file descriptor. -1 if the loop is not started.
+ */
+int
+ndn_event_loop_fd(void);
+
+/** Watch a file descriptor for reading.
+ * @param[in] fd The file descriptor.
+ * @param[in] callback Called each time @c fd is readable.
+ * @param[in] self Given to @c callback.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_EVENT_LOOP_ERROR if the loop is not started
+ *         or full, in which case the caller should poll @c fd itself.
+ */
+int
+ndn_event_loop_add(int fd, ndn_event_loop_callback callback, void* self);
+
+/** Also watch a file descriptor for writing, or stop it.
+ *
+ * A face whose socket is full calls this to learn when to send again.
+ * @param[in] fd The file descriptor, added by ndn_event_loop_add().
+ * @param[in] callback Called each time @c fd is writable. NULL to stop watching for writing.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_EVENT_LOOP_ERROR if @c fd is not watched.
+ */
+int
+ndn_event_loop_set_writable(int fd, ndn_event_loop_callback callback);
+
+/** Stop watching a file descriptor. No effect if it is not watched.
+ * @note Call this before closing @c fd. It is safe to call from a callback.
+ */
+void
+ndn_event_loop_remove(int fd);
+
+/** Get how long the loop may sleep.
+ * @return Milliseconds until ndn_forwarder_next_deadline(), 0 if messages are pending,
+ *         or -1 if there is nothing to wait for but I/O.
+ */
+int
+ndn_event_loop_timeout(void);
+
+/** Wait for I/O or the next deadline, handle what is ready, and run ndn_forwarder_process().
+ * @param[in] max_wait The most milliseconds to wait. -1 for no limit.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_EVENT_LOOP_ERROR if the loop is not started
+ *         or waiting failed.
+ */
+int
+ndn_event_loop_run_once(int max_wait);
+
+/** Run ndn_event_loop_run_once() until ndn_event_loop_stop() is called.
+ */
+void
+ndn_event_loop_run(void);
+
+/** Make ndn_event_loop_run() return. It is safe to call from a callback.
+ */
+void
+ndn_event_loop_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_EVENT_LOOP_H_
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <sys/mman.h>
+#include "posix-alloc.h"
+
+static inline size_t
+ndn_posix_alloc_size(size_t size, bool hugepage)
+{
+  if(hugepage){
+    return (size + NDN_POSIX_HUGEPAGE_SIZE - 1) / NDN_POSIX_HUGEPAGE_SIZE * NDN_POSIX_HUGEPAGE_SIZE;
+  }
+  return size;
+}
+
+void*
+ndn_posix_alloc(size_t size, bool hugepage, void* userdata)
+{
+  void* ret = MAP_FAILED;
+  (void)userdata;
+
+  size = ndn_posix_alloc_size(size, hugepage);
+#ifdef MAP_HUGETLB
+  if(hugepage){
+    ret = mmap(NULL, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+  if(ret == MAP_FAILED){
+    ret = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ret == MAP_FAILED){
+      return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    // No huge pages reserved; ask for transparent ones before the pages are touched
+    if(hugepage){
+      madvise(ret, size, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  return ret;
+}
+
+void
+ndn_posix_free(void* memory, size_t size, bool hugepage, void* userdata)
+{
+  (void)userdata;
+  munmap(memory, ndn_posix_alloc_size(size, hugepage));
+}
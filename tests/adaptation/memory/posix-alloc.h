@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_POSIX_ALLOC_H_
+#define NDN_POSIX_ALLOC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of a huge page. Huge page allocations are rounded up to it.
+ */
+#define NDN_POSIX_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/** Allocate memory for the forwarder tables with mmap.
+ *
+ * With @c hugepage, explicit huge pages are tried first, then transparent huge pages.
+ * @sa ndn_forwarder_alloc_func
+ */
+void*
+ndn_posix_alloc(size_t size, bool hugepage, void* userdata);
+
+/** Free memory from ndn_posix_alloc().
+ * @sa ndn_forwarder_free_func
+ */
+void
+ndn_posix_free(void* memory, size_t size, bool hugepage, void* userdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_POSIX_ALLOC_H_
@@ -7,15 +7,30 @@
  */
 
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/udp.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
 #include "udp-face.h"
+#include "../event-loop/event-loop.h"
 #include "ndn-lite/ndn-error-code.h"
 #include "ndn-lite/ndn-constants.h"
 
+// UDP GSO and GRO, used if the kernel supports them
+#ifndef NDN_UDP_OFFLOAD
+#if defined(__linux__) && defined(UDP_SEGMENT) && defined(UDP_GRO)
+#define NDN_UDP_OFFLOAD 1
+#else
+#define NDN_UDP_OFFLOAD 0
+#endif
+#endif
+
+// The largest UDP payload over IPv4
+#define NDN_UDP_MAX_PAYLOAD 65507
+
 static int
 ndn_udp_face_up(struct ndn_face_intf* self);
 
@@ -39,6 +54,26 @@ ndn_udp_face_construct(
 static void
 ndn_udp_face_recv(void *self, size_t param_len, void *param);
 
+static void
+ndn_udp_face_on_readable(void *self);
+
+static bool
+ndn_udp_face_read(ndn_udp_face_t* ptr);
+
+static void
+ndn_udp_face_flush(void *self, size_t param_len, void *param);
+
+static void
+ndn_udp_face_write(ndn_udp_face_t* ptr);
+
+static void
+ndn_udp_face_on_writable(void *self);
+
+#if NDN_UDP_OFFLOAD
+static int
+ndn_udp_face_recv_gro(ndn_udp_face_t* ptr, uint8_t** packets, size_t* lengths);
+#endif
+
 /////////////////////////// /////////////////////////// ///////////////////////////
 
 static int
@@ -72,6 +107,15 @@ ndn_udp_face_up(struct ndn_face_intf* self){
     return NDN_UDP_FACE_SOCKET_ERROR;
   }
 
+  ndn_udp_tx_batch_init(&ptr->tx, ptr->sock);
+  // A coalesced datagram must fit in the receive buffers
+  ptr->gro = false;
+#if NDN_UDP_OFFLOAD
+  if(sizeof(ptr->rx_buf) > NDN_UDP_MAX_PAYLOAD){
+    ptr->gro = (setsockopt(ptr->sock, SOL_UDP, UDP_GRO, &iyes, sizeof(int)) == 0);
+  }
+#endif
+
   if(ptr->multicast){
     setsockopt(ptr->sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
 
@@ -83,10 +127,13 @@ ndn_udp_face_up(struct ndn_face_intf* self){
     }
   }
 
-  ptr->process_event = ndn_msgqueue_post(ptr, ndn_udp_face_recv, 0, NULL);
-  if(ptr->process_event == NULL){
-    ndn_face_down(self);
-    return NDN_FWD_MSGQUEUE_FULL;
+  // Poll the socket through the message queue only if there is no event loop
+  if(ndn_event_loop_add(ptr->sock, ndn_udp_face_on_readable, ptr) != NDN_SUCCESS){
+    ptr->process_event = ndn_msgqueue_post(ptr, ndn_udp_face_recv, 0, NULL);
+    if(ptr->process_event == NULL){
+      ndn_face_down(self);
+      return NDN_FWD_MSGQUEUE_FULL;
+    }
   }
 
   self->state = NDN_FACE_STATE_UP;
@@ -99,6 +146,7 @@ ndn_udp_face_down(struct ndn_face_intf* self){
   self->state = NDN_FACE_STATE_DOWN;
 
   if(ptr->sock != -1){
+    ndn_event_loop_remove(ptr->sock);
     close(ptr->sock);
     ptr->sock = -1;
   }
@@ -108,6 +156,14 @@ ndn_udp_face_down(struct ndn_face_intf* self){
     ptr->process_event = NULL;
   }
 
+  // Datagrams not written yet are lost with the socket, and so are the packets waiting for it
+  if(ptr->flush_event != NULL){
+    ndn_msgqueue_cancel(ptr->flush_event);
+    ptr->flush_event = NULL;
+  }
+  ptr->tx.count = 0;
+  ndn_forwarder_set_face_queue(self, &ptr->queue);
+
   return NDN_SUCCESS;
 }
 
@@ -121,13 +177,204 @@ ndn_udp_face_destroy(ndn_face_intf_t* self){
 static int
 ndn_udp_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size){
   ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
-  ssize_t ret;
-  ret = sendto(ptr->sock, packet, size, 0,
-               (struct sockaddr*)&ptr->remote_addr, sizeof(ptr->remote_addr));
-  if(ret != size){
+
+  if(ptr->sock == -1 || size > NDN_UDP_BUFFER_SIZE){
     return NDN_UDP_FACE_SOCKET_ERROR;
-  }else{
-    return NDN_SUCCESS;
+  }
+  if(ptr->tx.count == NDN_UDP_BATCH_SIZE){
+    ndn_udp_face_write(ptr);
+    if(ptr->tx.count == NDN_UDP_BATCH_SIZE){
+      // The socket is full: the forwarder queues the packet until it is writable
+      return NDN_UDP_FACE_SOCKET_BUSY;
+    }
+  }
+  ndn_udp_tx_batch_add(&ptr->tx, packet, size, &ptr->remote_addr);
+
+  // Written once the current messages are dispatched, with the other datagrams sent meanwhile
+  if(ptr->flush_event == NULL){
+    ptr->flush_event = ndn_msgqueue_post(ptr, ndn_udp_face_flush, 0, NULL);
+    if(ptr->flush_event == NULL){
+      ndn_udp_face_write(ptr);
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+void
+ndn_udp_tx_batch_init(ndn_udp_tx_batch_t* self, int sock){
+#if NDN_UDP_OFFLOAD
+  int value;
+  socklen_t len = sizeof(value);
+
+  // Kernels which don't know the option would send a GSO batch as one datagram
+  self->gso = (getsockopt(sock, SOL_UDP, UDP_SEGMENT, &value, &len) == 0);
+#else
+  self->gso = false;
+#endif
+  self->count = 0;
+}
+
+void
+ndn_udp_tx_batch_add(ndn_udp_tx_batch_t* self, const uint8_t* packet, uint32_t size,
+                     const struct sockaddr_in* addr){
+  memcpy(self->buf[self->count], packet, size);
+  self->len[self->count] = size;
+  self->addr[self->count] = *addr;
+  self->count ++;
+}
+
+/** Get how many datagrams from @c first on can be sent as one with GSO.
+ *
+ * They go to the same peer, and are as long as the first one, except the last one which may be shorter.
+ */
+static uint32_t
+ndn_udp_tx_batch_segments(const ndn_udp_tx_batch_t* self, uint32_t first){
+  uint32_t i, total = self->len[first];
+
+  if(!self->gso){
+    return 1;
+  }
+  for(i = first + 1; i < self->count && i - first < NDN_UDP_MAX_SEGMENTS; i ++){
+    if(self->len[i - 1] != self->len[first] || self->len[i] > self->len[first] ||
+       total + self->len[i] > NDN_UDP_MAX_PAYLOAD ||
+       self->addr[i].sin_addr.s_addr != self->addr[first].sin_addr.s_addr ||
+       self->addr[i].sin_port != self->addr[first].sin_port){
+      break;
+    }
+    total += self->len[i];
+  }
+  return i - first;
+}
+
+/** Move the datagrams from @c first on to the front of a batch.
+ */
+static void
+ndn_udp_tx_batch_keep(ndn_udp_tx_batch_t* self, uint32_t first){
+  uint32_t i;
+
+  if(first == 0){
+    return;
+  }
+  for(i = first; i < self->count; i ++){
+    memcpy(self->buf[i - first], self->buf[i], self->len[i]);
+    self->len[i - first] = self->len[i];
+    self->addr[i - first] = self->addr[i];
+  }
+  self->count -= first;
+}
+
+bool
+ndn_udp_tx_batch_flush(ndn_udp_tx_batch_t* self, int sock){
+#ifdef __linux__
+  struct mmsghdr msgs[NDN_UDP_BATCH_SIZE];
+  struct iovec iovs[NDN_UDP_BATCH_SIZE];
+  uint32_t firsts[NDN_UDP_BATCH_SIZE];
+#if NDN_UDP_OFFLOAD
+  union {
+    char buf[CMSG_SPACE(sizeof(uint16_t))];
+    struct cmsghdr align;
+  } controls[NDN_UDP_BATCH_SIZE];
+  struct cmsghdr* cmsg;
+  uint16_t segment;
+#endif
+  uint32_t count = 0, done = 0, n, j;
+  int ret;
+#endif
+  uint32_t i;
+
+#ifdef __linux__
+  for(i = 0; i < self->count; i += n){
+    n = ndn_udp_tx_batch_segments(self, i);
+    for(j = i; j < i + n; j ++){
+      iovs[j].iov_base = self->buf[j];
+      iovs[j].iov_len = self->len[j];
+    }
+    memset(&msgs[count], 0, sizeof(msgs[count]));
+    msgs[count].msg_hdr.msg_name = &self->addr[i];
+    msgs[count].msg_hdr.msg_namelen = sizeof(self->addr[i]);
+    msgs[count].msg_hdr.msg_iov = &iovs[i];
+    msgs[count].msg_hdr.msg_iovlen = n;
+#if NDN_UDP_OFFLOAD
+    if(n > 1){
+      msgs[count].msg_hdr.msg_control = controls[count].buf;
+      msgs[count].msg_hdr.msg_controllen = sizeof(controls[count].buf);
+      cmsg = CMSG_FIRSTHDR(&msgs[count].msg_hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      segment = (uint16_t)self->len[i];
+      memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+    }
+#endif
+    firsts[count] = i;
+    count ++;
+  }
+  while(done < count){
+    ret = sendmmsg(sock, &msgs[done], count - done, 0);
+    if(ret > 0){
+      done += ret;
+      continue;
+    }
+    if(errno == EAGAIN || errno == EWOULDBLOCK){
+      // The socket is full: the rest wait for it
+      ndn_udp_tx_batch_keep(self, firsts[done]);
+      return false;
+    }
+    if(msgs[done].msg_hdr.msg_iovlen > 1){
+      // The device can't segment, or a segment is too long for it: send them one by one
+      if(errno == EIO){
+        self->gso = false;
+      }
+      for(j = firsts[done]; j < firsts[done] + msgs[done].msg_hdr.msg_iovlen; j ++){
+        sendto(sock, self->buf[j], self->len[j], 0,
+               (struct sockaddr*)&self->addr[j], sizeof(self->addr[j]));
+      }
+    }
+    done ++;
+  }
+#else
+  for(i = 0; i < self->count; i ++){
+    if(sendto(sock, self->buf[i], self->len[i], 0,
+              (struct sockaddr*)&self->addr[i], sizeof(self->addr[i])) == -1 &&
+       (errno == EAGAIN || errno == EWOULDBLOCK)){
+      ndn_udp_tx_batch_keep(self, i);
+      return false;
+    }
+  }
+#endif
+  self->count = 0;
+  return true;
+}
+
+/** Write the batch, and if the socket is full, wait until it is writable.
+ */
+static void
+ndn_udp_face_write(ndn_udp_face_t* ptr){
+  if(ndn_udp_tx_batch_flush(&ptr->tx, ptr->sock)){
+    return;
+  }
+  // Without an event loop, try again in the next round
+  if(ndn_event_loop_set_writable(ptr->sock, ndn_udp_face_on_writable) != NDN_SUCCESS &&
+     ptr->flush_event == NULL){
+    ptr->flush_event = ndn_msgqueue_post(ptr, ndn_udp_face_flush, 0, NULL);
+  }
+}
+
+static void
+ndn_udp_face_flush(void *self, size_t param_len, void *param){
+  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+
+  ptr->flush_event = NULL;
+  ndn_udp_face_write(ptr);
+}
+
+static void
+ndn_udp_face_on_writable(void *self){
+  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+
+  // The forwarder sends its queued packets after this
+  if(ndn_udp_tx_batch_flush(&ptr->tx, ptr->sock)){
+    ndn_event_loop_set_writable(ptr->sock, NULL);
   }
 }
 
@@ -154,6 +401,8 @@ ndn_udp_face_construct(
     return NULL;
   }
 
+  ndn_forwarder_set_face_queue(&ret->intf, &ret->queue);
+
   ret->intf.type = NDN_FACE_TYPE_NET;
   ret->intf.state = NDN_FACE_STATE_DOWN;
   ret->intf.up = ndn_udp_face_up;
@@ -174,6 +423,10 @@ ndn_udp_face_construct(
   ret->sock = -1;
   ret->multicast = multicast;
   ret->process_event = NULL;
+  ret->tx.count = 0;
+  ret->tx.gso = false;
+  ret->gro = false;
+  ret->flush_event = NULL;
   ndn_face_up(&ret->intf);
 
   return ret;
@@ -198,28 +451,149 @@ ndn_udp_multicast_face_construct(
   return ndn_udp_face_construct(local_addr, port, group_addr, port, true);
 }
 
-static void
-ndn_udp_face_recv(void *self, size_t param_len, void *param){
-  struct sockaddr_in client_addr;
+int
+ndn_udp_recv_batch(int sock, uint8_t (*bufs)[NDN_UDP_BUFFER_SIZE], size_t* lengths,
+                   struct sockaddr_in* addrs){
+#ifdef __linux__
+  struct mmsghdr msgs[NDN_UDP_BATCH_SIZE];
+  struct iovec iovs[NDN_UDP_BATCH_SIZE];
+  int i, count;
+
+  memset(msgs, 0, sizeof(msgs));
+  for(i = 0; i < NDN_UDP_BATCH_SIZE; i ++){
+    iovs[i].iov_base = bufs[i];
+    iovs[i].iov_len = NDN_UDP_BUFFER_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    if(addrs != NULL){
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    }
+  }
+  count = recvmmsg(sock, msgs, NDN_UDP_BATCH_SIZE, MSG_DONTWAIT, NULL);
+  for(i = 0; i < count; i ++){
+    lengths[i] = msgs[i].msg_len;
+  }
+  return count;
+#else
   socklen_t addr_len;
   ssize_t size;
-  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+  int count;
+
+  for(count = 0; count < NDN_UDP_BATCH_SIZE; count ++){
+    addr_len = sizeof(struct sockaddr_in);
+    size = recvfrom(sock, bufs[count], NDN_UDP_BUFFER_SIZE, 0,
+                    (struct sockaddr*)(addrs != NULL ? &addrs[count] : NULL),
+                    (addrs != NULL ? &addr_len : NULL));
+    if(size < 0){
+      break;
+    }
+    lengths[count] = size;
+  }
+  return (count > 0) ? count : -1;
+#endif
+}
+
+#if NDN_UDP_OFFLOAD
+/** Receive a datagram, which GRO may have coalesced, and split it into packets.
+ * @return The number of packets. -1 with @c errno set if none was received.
+ */
+static int
+ndn_udp_face_recv_gro(ndn_udp_face_t* ptr, uint8_t** packets, size_t* lengths){
+  struct msghdr msg;
+  struct iovec iov;
+  union {
+    char buf[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  struct cmsghdr* cmsg;
+  ssize_t size;
+  size_t offset, segment = 0;
+  int value, count = 0;
+
+  iov.iov_base = ptr->rx_buf;
+  iov.iov_len = sizeof(ptr->rx_buf);
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  size = recvmsg(ptr->sock, &msg, MSG_DONTWAIT);
+  if(size < 0){
+    return -1;
+  }
+  for(cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)){
+    if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO){
+      memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+      segment = value;
+    }
+  }
+  if(segment == 0){
+    // Not coalesced
+    segment = size;
+  }
+  for(offset = 0; offset < (size_t)size && count < NDN_UDP_MAX_SEGMENTS; offset += segment){
+    packets[count] = (uint8_t*)ptr->rx_buf + offset;
+    lengths[count] = ((size_t)size - offset < segment) ? (size_t)size - offset : segment;
+    count ++;
+  }
+  return count;
+}
+#endif
+
+/** Receive until the socket is drained.
+ * @return false if the face went down.
+ */
+static bool
+ndn_udp_face_read(ndn_udp_face_t* ptr){
+  uint8_t* packets[NDN_UDP_MAX_SEGMENTS];
+  size_t lengths[NDN_UDP_MAX_SEGMENTS];
+  int count, i;
 
   while(true){
-    size = recvfrom(ptr->sock, ptr->buf, sizeof(ptr->buf), 0,
-                    (struct sockaddr*)&client_addr, &addr_len);
-    if(size >= 0){
-      // A packet recved
+#if NDN_UDP_OFFLOAD
+    if(ptr->gro){
+      count = ndn_udp_face_recv_gro(ptr, packets, lengths);
+    }
+    else
+#endif
+    {
+      for(i = 0; i < NDN_UDP_BATCH_SIZE; i ++){
+        packets[i] = ptr->rx_buf[i];
+      }
+      count = ndn_udp_recv_batch(ptr->sock, ptr->rx_buf, lengths, NULL);
+    }
+    if(count > 0){
       // @TODO check return status
-      ndn_forwarder_receive(&ptr->intf, ptr->buf, size);
-    }else if(size == -1 && (errno == EWOULDBLOCK || errno == EAGAIN)){
+      ndn_forwarder_receive_batch(&ptr->intf, packets, lengths, count);
+      // A GRO read is a single datagram, so only EAGAIN tells the socket is drained
+      if((!ptr->gro && count < NDN_UDP_BATCH_SIZE) || ptr->sock == -1){
+        // Drained, or the face went down meanwhile
+        break;
+      }
+    }else if(count == 0 || errno == EWOULDBLOCK || errno == EAGAIN){
       // No more packet
       break;
     }else{
       ndn_face_down(&ptr->intf);
-      return;
+      return false;
     }
   }
+  return ptr->sock != -1;
+}
 
-  ptr->process_event = ndn_msgqueue_post(self, ndn_udp_face_recv, param_len, param);
+static void
+ndn_udp_face_recv(void *self, size_t param_len, void *param){
+  ndn_udp_face_t* ptr = (ndn_udp_face_t*)self;
+
+  // The message is used, so ndn_face_down won't cancel it
+  ptr->process_event = NULL;
+  if(ndn_udp_face_read(ptr)){
+    ptr->process_event = ndn_msgqueue_post(self, ndn_udp_face_recv, param_len, param);
+  }
+}
+
+static void
+ndn_udp_face_on_readable(void *self){
+  ndn_udp_face_read((ndn_udp_face_t*)self);
 }
\ No newline at end of file
@@ -24,6 +24,30 @@ extern "C" {
 // Given that we don't cache
 #define NDN_UDP_BUFFER_SIZE 4096
 
+// Datagrams read or written per system call
+#ifndef NDN_UDP_BATCH_SIZE
+#define NDN_UDP_BATCH_SIZE 16
+#endif
+
+// Most datagrams the kernel coalesces into one with GSO or GRO
+#define NDN_UDP_MAX_SEGMENTS 64
+
+/**
+ * Datagrams to send, written together at the end of the dispatch round.
+ */
+typedef struct ndn_udp_tx_batch {
+  uint8_t buf[NDN_UDP_BATCH_SIZE][NDN_UDP_BUFFER_SIZE];
+  uint32_t len[NDN_UDP_BATCH_SIZE];
+  struct sockaddr_in addr[NDN_UDP_BATCH_SIZE];
+  uint32_t count;
+
+  /**
+   * Whether consecutive datagrams to the same peer are sent as one, segmented by the kernel (UDP GSO).
+   * Cleared if the kernel turns it down.
+   */
+  bool gso;
+} ndn_udp_tx_batch_t;
+
 /**
  * Udp face
  */
@@ -38,7 +62,29 @@ typedef struct ndn_udp_face {
   struct ndn_msg* process_event;
   int sock;
   bool multicast;
-  uint8_t buf[NDN_UDP_BUFFER_SIZE];
+
+  /**
+   * Buffers of received datagrams, refilled by each batch.
+   * With GRO, one coalesced datagram takes all of them.
+   */
+  uint8_t rx_buf[NDN_UDP_BATCH_SIZE][NDN_UDP_BUFFER_SIZE];
+
+  /**
+   * Whether the kernel may coalesce datagrams of the peer into one (UDP GRO).
+   */
+  bool gro;
+
+  ndn_udp_tx_batch_t tx;
+
+  /**
+   * The message which writes the datagrams to send. NULL if there are none.
+   */
+  struct ndn_msg* flush_event;
+
+  /**
+   * Packets the socket could not take, which the forwarder sends once it can.
+   */
+  ndn_face_queue_t queue;
 } ndn_udp_face_t;
 
 ndn_udp_face_t*
@@ -54,6 +100,35 @@ ndn_udp_multicast_face_construct(
   in_addr_t group_addr,
   in_port_t port);
 
+/** Receive up to #NDN_UDP_BATCH_SIZE datagrams without blocking.
+ * @param[out] bufs The buffers of the datagrams.
+ * @param[out] lengths The length of each datagram.
+ * @param[out] addrs [Optional] The source address of each datagram.
+ * @return The number of datagrams. -1 with @c errno set if none was received.
+ */
+int
+ndn_udp_recv_batch(int sock, uint8_t (*bufs)[NDN_UDP_BUFFER_SIZE], size_t* lengths,
+                   struct sockaddr_in* addrs);
+
+/** Empty a batch, and turn GSO on if the kernel supports it for @c sock.
+ */
+void
+ndn_udp_tx_batch_init(ndn_udp_tx_batch_t* self, int sock);
+
+/** Add a datagram to a batch. The batch must not be full.
+ */
+void
+ndn_udp_tx_batch_add(ndn_udp_tx_batch_t* self, const uint8_t* packet, uint32_t size,
+                     const struct sockaddr_in* addr);
+
+/** Write the datagrams of a batch.
+ *
+ * Those the socket can't take now are kept in the batch, in order, for the next flush.
+ * @return Whether the batch is empty.
+ */
+bool
+ndn_udp_tx_batch_flush(ndn_udp_tx_batch_t* self, int sock);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,427 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include "udp-listener.h"
+#include "../event-loop/event-loop.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/ndn-constants.h"
+
+#if (NDN_UDP_LISTENER_BUCKETS & (NDN_UDP_LISTENER_BUCKETS - 1)) != 0
+#error NDN_UDP_LISTENER_BUCKETS must be a power of 2
+#endif
+
+static int
+ndn_udp_subface_up(struct ndn_face_intf* self);
+
+static int
+ndn_udp_subface_down(struct ndn_face_intf* self);
+
+static void
+ndn_udp_subface_destroy(ndn_face_intf_t* self);
+
+static int
+ndn_udp_subface_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size);
+
+static ndn_udp_subface_t*
+ndn_udp_subface_construct(ndn_udp_listener_t* self, const struct sockaddr_in* addr);
+
+static int
+ndn_udp_listener_open(ndn_udp_listener_socket_t* sock, const struct sockaddr_in* addr, bool reuse_port);
+
+static void
+ndn_udp_listener_close(ndn_udp_listener_socket_t* sock);
+
+static bool
+ndn_udp_listener_read(ndn_udp_listener_socket_t* sock);
+
+static void
+ndn_udp_listener_recv(void *self, size_t param_len, void *param);
+
+static void
+ndn_udp_listener_on_readable(void *self);
+
+static void
+ndn_udp_listener_flush(void *self, size_t param_len, void *param);
+
+static void
+ndn_udp_listener_write(ndn_udp_listener_t* self);
+
+static void
+ndn_udp_listener_on_writable(void *self);
+
+/////////////////////////// /////////////////////////// ///////////////////////////
+
+static inline uint32_t
+ndn_udp_listener_hash(const struct sockaddr_in* addr){
+  uint32_t hash = (uint32_t)addr->sin_addr.s_addr ^ ((uint32_t)addr->sin_port << 16);
+  return ((hash * 2654435761u) >> 16) & (NDN_UDP_LISTENER_BUCKETS - 1);
+}
+
+static inline bool
+ndn_udp_listener_same_peer(const struct sockaddr_in* a, const struct sockaddr_in* b){
+  return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+ndn_udp_subface_t*
+ndn_udp_listener_find(ndn_udp_listener_t* self, const struct sockaddr_in* addr){
+  int16_t id;
+
+  for(id = self->buckets[ndn_udp_listener_hash(addr)]; id != -1; id = self->subfaces[id].next){
+    if(ndn_udp_listener_same_peer(&self->subfaces[id].remote_addr, addr)){
+      return &self->subfaces[id];
+    }
+  }
+  return NULL;
+}
+
+static ndn_udp_subface_t*
+ndn_udp_subface_construct(ndn_udp_listener_t* self, const struct sockaddr_in* addr){
+  ndn_udp_subface_t* ret = NULL;
+  uint32_t bucket;
+  int16_t i;
+
+  for(i = 0; i < NDN_UDP_LISTENER_MAX_PEERS; i ++){
+    if(self->subfaces[i].intf.state != NDN_FACE_STATE_UP){
+      ret = &self->subfaces[i];
+      break;
+    }
+  }
+  if(ret == NULL){
+    return NULL;
+  }
+  ret->intf.face_id = NDN_INVALID_ID;
+  if(ndn_forwarder_register_face(&ret->intf) != NDN_SUCCESS){
+    return NULL;
+  }
+  ndn_forwarder_set_face_queue(&ret->intf, &ret->queue);
+
+  ret->intf.type = NDN_FACE_TYPE_NET;
+  ret->intf.state = NDN_FACE_STATE_UP;
+  ret->intf.up = ndn_udp_subface_up;
+  ret->intf.down = ndn_udp_subface_down;
+  ret->intf.send = ndn_udp_subface_send;
+  ret->intf.destroy = ndn_udp_subface_destroy;
+  ret->listener = self;
+  ret->remote_addr = *addr;
+
+  bucket = ndn_udp_listener_hash(addr);
+  ret->next = self->buckets[bucket];
+  self->buckets[bucket] = i;
+
+  if(self->on_peer != NULL){
+    self->on_peer(ret, self->userdata);
+  }
+  return ret;
+}
+
+static int
+ndn_udp_subface_up(struct ndn_face_intf* self){
+  // A removed subface comes back only with a datagram from its peer
+  return NDN_UDP_FACE_SOCKET_ERROR;
+}
+
+static int
+ndn_udp_subface_down(struct ndn_face_intf* self){
+  ndn_udp_subface_t* ptr = container_of(self, ndn_udp_subface_t, intf);
+  ndn_udp_listener_t* listener = ptr->listener;
+  int16_t* link;
+  int16_t id = (int16_t)(ptr - listener->subfaces);
+
+  if(self->state != NDN_FACE_STATE_UP){
+    return NDN_SUCCESS;
+  }
+  for(link = &listener->buckets[ndn_udp_listener_hash(&ptr->remote_addr)]; *link != -1;
+      link = &listener->subfaces[*link].next){
+    if(*link == id){
+      *link = ptr->next;
+      break;
+    }
+  }
+  self->state = NDN_FACE_STATE_DOWN;
+  ndn_forwarder_unregister_face(self);
+  return NDN_SUCCESS;
+}
+
+static void
+ndn_udp_subface_destroy(ndn_face_intf_t* self){
+  // The subface is part of the listener
+  ndn_udp_subface_down(self);
+}
+
+static int
+ndn_udp_subface_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size){
+  ndn_udp_subface_t* ptr = container_of(self, ndn_udp_subface_t, intf);
+  ndn_udp_listener_t* listener = ptr->listener;
+  // Any socket bound to the port can reach any peer
+  int sock = listener->sockets[0].sock;
+
+  if(self->state != NDN_FACE_STATE_UP || sock == -1 || size > NDN_UDP_BUFFER_SIZE){
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  if(listener->tx.count == NDN_UDP_BATCH_SIZE){
+    ndn_udp_listener_write(listener);
+    if(listener->tx.count == NDN_UDP_BATCH_SIZE){
+      // The socket is full: the forwarder queues the packet until it is writable
+      return NDN_UDP_FACE_SOCKET_BUSY;
+    }
+  }
+  ndn_udp_tx_batch_add(&listener->tx, packet, size, &ptr->remote_addr);
+
+  if(listener->flush_event == NULL){
+    listener->flush_event = ndn_msgqueue_post(listener, ndn_udp_listener_flush, 0, NULL);
+    if(listener->flush_event == NULL){
+      ndn_udp_listener_write(listener);
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+/** Write the batch, and if the socket is full, wait until it is writable.
+ */
+static void
+ndn_udp_listener_write(ndn_udp_listener_t* self){
+  if(ndn_udp_tx_batch_flush(&self->tx, self->sockets[0].sock)){
+    return;
+  }
+  // Without an event loop, try again in the next round
+  if(ndn_event_loop_set_writable(self->sockets[0].sock, ndn_udp_listener_on_writable) != NDN_SUCCESS &&
+     self->flush_event == NULL){
+    self->flush_event = ndn_msgqueue_post(self, ndn_udp_listener_flush, 0, NULL);
+  }
+}
+
+static void
+ndn_udp_listener_flush(void *self, size_t param_len, void *param){
+  ndn_udp_listener_t* ptr = (ndn_udp_listener_t*)self;
+
+  ptr->flush_event = NULL;
+  ndn_udp_listener_write(ptr);
+}
+
+static void
+ndn_udp_listener_on_writable(void *self){
+  ndn_udp_listener_socket_t* sock = (ndn_udp_listener_socket_t*)self;
+
+  // The forwarder sends the queued packets of the subfaces after this
+  if(ndn_udp_tx_batch_flush(&sock->listener->tx, sock->sock)){
+    ndn_event_loop_set_writable(sock->sock, NULL);
+  }
+}
+
+void
+ndn_udp_listener_reap(ndn_udp_listener_t* self, ndn_time_ms_t now){
+  ndn_udp_subface_t* subface;
+  int i;
+
+  self->last_reap = now;
+  for(i = 0; i < NDN_UDP_LISTENER_MAX_PEERS; i ++){
+    subface = &self->subfaces[i];
+    if(subface->intf.state == NDN_FACE_STATE_UP &&
+       now - subface->last_time >= NDN_UDP_SUBFACE_IDLE_TIMEOUT){
+      ndn_udp_subface_down(&subface->intf);
+    }
+  }
+}
+
+/** Receive until the socket is drained, and pass each datagram to the subface of its peer.
+ * @return false if the socket failed.
+ */
+static bool
+ndn_udp_listener_read(ndn_udp_listener_socket_t* sock){
+  ndn_udp_listener_t* self = sock->listener;
+  struct sockaddr_in addrs[NDN_UDP_BATCH_SIZE];
+  size_t lengths[NDN_UDP_BATCH_SIZE];
+  ndn_udp_subface_t* subface;
+  ndn_time_ms_t now;
+  int count, i;
+
+  while(true){
+    count = ndn_udp_recv_batch(sock->sock, self->rx_buf, lengths, addrs);
+    if(count > 0){
+      now = ndn_time_now_ms();
+      if(now - self->last_reap >= NDN_UDP_SUBFACE_IDLE_TIMEOUT / 4){
+        ndn_udp_listener_reap(self, now);
+      }
+      for(i = 0; i < count; i ++){
+        subface = ndn_udp_listener_find(self, &addrs[i]);
+        if(subface == NULL){
+          subface = ndn_udp_subface_construct(self, &addrs[i]);
+        }
+        else if(subface->intf.face_id == NDN_INVALID_ID){
+          if(ndn_forwarder_register_face(&subface->intf) != NDN_SUCCESS){
+            // Unregistered by the application, and no room to come back
+            continue;
+          }
+          ndn_forwarder_set_face_queue(&subface->intf, &subface->queue);
+        }
+        if(subface == NULL){
+          // No room for another peer
+          continue;
+        }
+        subface->last_time = now;
+        // @TODO check return status
+        ndn_forwarder_receive(&subface->intf, self->rx_buf[i], lengths[i]);
+      }
+      if(count < NDN_UDP_BATCH_SIZE){
+        break;
+      }
+    }else if(count == 0 || errno == EWOULDBLOCK || errno == EAGAIN){
+      // No more packet
+      break;
+    }else{
+      return false;
+    }
+  }
+  return true;
+}
+
+static void
+ndn_udp_listener_recv(void *self, size_t param_len, void *param){
+  ndn_udp_listener_socket_t* sock = (ndn_udp_listener_socket_t*)self;
+
+  sock->process_event = NULL;
+  if(ndn_udp_listener_read(sock)){
+    sock->process_event = ndn_msgqueue_post(self, ndn_udp_listener_recv, param_len, param);
+  }
+}
+
+static void
+ndn_udp_listener_on_readable(void *self){
+  ndn_udp_listener_socket_t* sock = (ndn_udp_listener_socket_t*)self;
+
+  if(!ndn_udp_listener_read(sock)){
+    // Stop the failed socket from waking the loop up again
+    ndn_event_loop_remove(sock->sock);
+  }
+}
+
+static int
+ndn_udp_listener_open(ndn_udp_listener_socket_t* sock, const struct sockaddr_in* addr, bool reuse_port){
+  int iyes = 1, iflags;
+
+  sock->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if(sock->sock == -1){
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  setsockopt(sock->sock, SOL_SOCKET, SO_REUSEADDR, &iyes, sizeof(int));
+  if(reuse_port && setsockopt(sock->sock, SOL_SOCKET, SO_REUSEPORT, &iyes, sizeof(int)) == -1){
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  iflags = fcntl(sock->sock, F_GETFL, 0);
+  if(iflags == -1 || fcntl(sock->sock, F_SETFL, iflags | O_NONBLOCK) == -1){
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  if(bind(sock->sock, (struct sockaddr*)addr, sizeof(*addr)) == -1){
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  // Replies go out through the first socket
+  if(sock == &sock->listener->sockets[0]){
+    ndn_udp_tx_batch_init(&sock->listener->tx, sock->sock);
+  }
+
+  // Poll the socket through the message queue only if there is no event loop
+  if(ndn_event_loop_add(sock->sock, ndn_udp_listener_on_readable, sock) != NDN_SUCCESS){
+    sock->process_event = ndn_msgqueue_post(sock, ndn_udp_listener_recv, 0, NULL);
+    if(sock->process_event == NULL){
+      return NDN_FWD_MSGQUEUE_FULL;
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+static void
+ndn_udp_listener_close(ndn_udp_listener_socket_t* sock){
+  if(sock->sock != -1){
+    ndn_event_loop_remove(sock->sock);
+    close(sock->sock);
+    sock->sock = -1;
+  }
+  if(sock->process_event != NULL){
+    ndn_msgqueue_cancel(sock->process_event);
+    sock->process_event = NULL;
+  }
+}
+
+ndn_udp_listener_t*
+ndn_udp_listener_construct(
+  in_addr_t local_addr,
+  in_port_t local_port,
+  uint8_t socket_count,
+  ndn_udp_listener_on_peer on_peer,
+  void* userdata)
+{
+  ndn_udp_listener_t* ret;
+  int i;
+
+  if(socket_count == 0 || socket_count > NDN_UDP_LISTENER_MAX_SOCKETS){
+    return NULL;
+  }
+  ret = (ndn_udp_listener_t*)malloc(sizeof(ndn_udp_listener_t));
+  if(!ret){
+    return NULL;
+  }
+
+  ret->local_addr.sin_family = AF_INET;
+  ret->local_addr.sin_port = local_port;
+  ret->local_addr.sin_addr.s_addr = local_addr;
+  memset(ret->local_addr.sin_zero, 0, sizeof(ret->local_addr.sin_zero));
+
+  for(i = 0; i < NDN_UDP_LISTENER_MAX_PEERS; i ++){
+    ret->subfaces[i].intf.face_id = NDN_INVALID_ID;
+    ret->subfaces[i].intf.state = NDN_FACE_STATE_DOWN;
+    ret->subfaces[i].listener = ret;
+  }
+  for(i = 0; i < NDN_UDP_LISTENER_BUCKETS; i ++){
+    ret->buckets[i] = -1;
+  }
+  ret->last_reap = ndn_time_now_ms();
+  ret->on_peer = on_peer;
+  ret->userdata = userdata;
+  ret->tx.count = 0;
+  ret->tx.gso = false;
+  ret->flush_event = NULL;
+
+  ret->socket_count = socket_count;
+  for(i = 0; i < NDN_UDP_LISTENER_MAX_SOCKETS; i ++){
+    ret->sockets[i].listener = ret;
+    ret->sockets[i].process_event = NULL;
+    ret->sockets[i].sock = -1;
+  }
+  for(i = 0; i < socket_count; i ++){
+    if(ndn_udp_listener_open(&ret->sockets[i], &ret->local_addr, socket_count > 1) != NDN_SUCCESS){
+      ndn_udp_listener_destroy(ret);
+      return NULL;
+    }
+  }
+  return ret;
+}
+
+void
+ndn_udp_listener_destroy(ndn_udp_listener_t* self){
+  int i;
+
+  for(i = 0; i < NDN_UDP_LISTENER_MAX_PEERS; i ++){
+    ndn_udp_subface_down(&self->subfaces[i].intf);
+  }
+  if(self->flush_event != NULL){
+    ndn_msgqueue_cancel(self->flush_event);
+    self->flush_event = NULL;
+  }
+  for(i = 0; i < NDN_UDP_LISTENER_MAX_SOCKETS; i ++){
+    ndn_udp_listener_close(&self->sockets[i]);
+  }
+  free(self);
+}
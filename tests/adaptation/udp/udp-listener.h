@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_UDP_LISTENER_H_
+#define NDN_UDP_LISTENER_H_
+
+#include "udp-face.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sockets sharing the port of a listener with SO_REUSEPORT
+#define NDN_UDP_LISTENER_MAX_SOCKETS 4
+
+// Peers a listener talks to at the same time
+#ifndef NDN_UDP_LISTENER_MAX_PEERS
+#define NDN_UDP_LISTENER_MAX_PEERS 32
+#endif
+
+// Buckets of the peer table, a power of 2
+#define NDN_UDP_LISTENER_BUCKETS 64
+
+// Milliseconds without a datagram from a peer before its subface is removed
+#ifndef NDN_UDP_SUBFACE_IDLE_TIMEOUT
+#define NDN_UDP_SUBFACE_IDLE_TIMEOUT 300000
+#endif
+
+struct ndn_udp_listener;
+
+/**
+ * The face of a peer of a UDP listener.
+ *
+ * It has no socket or buffers of its own, and sends through the listener.
+ */
+typedef struct ndn_udp_subface {
+  /**
+   * The inherited interface. Its state is #NDN_FACE_STATE_DOWN if the subface is not used.
+   */
+  ndn_face_intf_t intf;
+
+  struct ndn_udp_listener* listener;
+  struct sockaddr_in remote_addr;
+
+  /**
+   * The time of the last datagram from the peer.
+   */
+  ndn_time_ms_t last_time;
+
+  /**
+   * Next subface in the same bucket. -1 if none.
+   */
+  int16_t next;
+
+  /**
+   * Packets the socket of the listener could not take, which the forwarder sends once it can.
+   */
+  ndn_face_queue_t queue;
+} ndn_udp_subface_t;
+
+/** Called when a peer contacts a listener for the first time, e.g. to add routes through it.
+ */
+typedef void(*ndn_udp_listener_on_peer)(ndn_udp_subface_t* face, void* userdata);
+
+/**
+ * A socket of a listener.
+ */
+typedef struct ndn_udp_listener_socket {
+  struct ndn_udp_listener* listener;
+  struct ndn_msg* process_event;
+  int sock;
+} ndn_udp_listener_socket_t;
+
+/**
+ * UDP listener.
+ *
+ * It receives datagrams of all peers on one port,
+ * and gives each peer a subface on its first datagram.
+ * Subfaces idle for #NDN_UDP_SUBFACE_IDLE_TIMEOUT are removed,
+ * so their face table slots can go to other peers.
+ */
+typedef struct ndn_udp_listener {
+  struct sockaddr_in local_addr;
+  ndn_udp_listener_socket_t sockets[NDN_UDP_LISTENER_MAX_SOCKETS];
+  uint8_t socket_count;
+
+  ndn_udp_subface_t subfaces[NDN_UDP_LISTENER_MAX_PEERS];
+
+  /**
+   * First subface of each bucket, by the hash of the peer address. -1 if none.
+   */
+  int16_t buckets[NDN_UDP_LISTENER_BUCKETS];
+
+  /**
+   * The last time idle subfaces were looked for.
+   */
+  ndn_time_ms_t last_reap;
+
+  ndn_udp_listener_on_peer on_peer;
+  void* userdata;
+
+  ndn_udp_tx_batch_t tx;
+  struct ndn_msg* flush_event;
+  uint8_t rx_buf[NDN_UDP_BATCH_SIZE][NDN_UDP_BUFFER_SIZE];
+} ndn_udp_listener_t;
+
+/** Create a listener and open its sockets.
+ * @param[in] local_addr The address to listen on.
+ * @param[in] local_port The port to listen on.
+ * @param[in] socket_count The number of sockets, which the kernel spreads the peers over.
+ *                         More than 1 needs SO_REUSEPORT.
+ * @param[in] on_peer [Optional] Called when a subface is created.
+ * @param[in] userdata Given to @c on_peer.
+ * @return The listener. NULL if a socket could not be opened.
+ */
+ndn_udp_listener_t*
+ndn_udp_listener_construct(
+  in_addr_t local_addr,
+  in_port_t local_port,
+  uint8_t socket_count,
+  ndn_udp_listener_on_peer on_peer,
+  void* userdata);
+
+/** Remove all subfaces, close the sockets and free the listener.
+ */
+void
+ndn_udp_listener_destroy(ndn_udp_listener_t* self);
+
+/** Find the subface of a peer.
+ * @return The subface. NULL if the peer has none.
+ */
+ndn_udp_subface_t*
+ndn_udp_listener_find(ndn_udp_listener_t* self, const struct sockaddr_in* addr);
+
+/** Remove subfaces idle for #NDN_UDP_SUBFACE_IDLE_TIMEOUT.
+ *
+ * Receiving calls this every quarter of the timeout.
+ */
+void
+ndn_udp_listener_reap(ndn_udp_listener_t* self, ndn_time_ms_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_UDP_LISTENER_H_
@@ -14,6 +14,7 @@
 #include <fcntl.h>
 #include <string.h>
 #include "unix-face.h"
+#include "../event-loop/event-loop.h"
 #include "ndn-lite/ndn-error-code.h"
 #include "ndn-lite/ndn-constants.h"
 #include "ndn-lite/encode/forwarder-helper.h"
@@ -45,6 +46,21 @@ ndn_unix_face_recv(void *self, size_t param_len, void *param);
 static void
 ndn_unix_face_accept(void *self, size_t param_len, void *param);
 
+static bool
+ndn_unix_face_read(ndn_unix_face_t* ptr);
+
+static bool
+ndn_unix_face_accept_one(ndn_unix_face_t* ptr);
+
+static void
+ndn_unix_face_on_readable(void *self);
+
+static void
+ndn_unix_face_on_acceptable(void *self);
+
+static int
+ndn_unix_face_watch(ndn_unix_face_t* ptr, bool listening);
+
 static ndn_unix_face_t*
 ndn_unix_slave_face_construct(int sock);
 
@@ -91,10 +107,10 @@ ndn_unix_client_face_up(struct ndn_face_intf* self){
     return NDN_UNIX_FACE_SOCKET_ERROR;
   }
 
-  ptr->process_event = ndn_msgqueue_post(ptr, ndn_unix_face_recv, 0, NULL);
-  if(ptr->process_event == NULL){
+  ret = ndn_unix_face_watch(ptr, false);
+  if(ret != NDN_SUCCESS){
     ndn_face_down(self);
-    return NDN_FWD_MSGQUEUE_FULL;
+    return ret;
   }
 
   self->state = NDN_FACE_STATE_UP;
@@ -129,10 +145,10 @@ ndn_unix_server_face_up(struct ndn_face_intf* self){
 
   chmod(ptr->addr.sun_path, 0666);
 
-  ptr->process_event = ndn_msgqueue_post(ptr, ndn_unix_face_accept, 0, NULL);
-  if(ptr->process_event == NULL){
+  ret = ndn_unix_face_watch(ptr, true);
+  if(ret != NDN_SUCCESS){
     ndn_face_down(self);
-    return NDN_FWD_MSGQUEUE_FULL;
+    return ret;
   }
 
   self->state = NDN_FACE_STATE_UP;
@@ -145,6 +161,7 @@ ndn_unix_face_down(struct ndn_face_intf* self){
   self->state = NDN_FACE_STATE_DOWN;
 
   if(ptr->sock != -1){
+    ndn_event_loop_remove(ptr->sock);
     close(ptr->sock);
     ptr->sock = -1;
   }
@@ -251,8 +268,10 @@ ndn_unix_slave_face_construct(int sock){
   ret->client = false;
   ret->sock = sock;
   ret->offset = 0;
-  ret->process_event = ndn_msgqueue_post(ret, ndn_unix_face_recv, 0, NULL);
-  if(ret->process_event == NULL){
+  ret->process_event = NULL;
+  if(ndn_unix_face_watch(ret, false) != NDN_SUCCESS){
+    // The caller closes the socket
+    ret->sock = -1;
     ndn_face_down(&ret->intf);
     return NULL;
   }
@@ -269,16 +288,56 @@ ndn_unix_slave_face_down(struct ndn_face_intf* self){
   return NDN_SUCCESS;
 }
 
-static void
-ndn_unix_face_recv(void *self, size_t param_len, void *param){
-  ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
-  ssize_t size;
+/** Watch the socket with the event loop, or poll it through the message queue if there is none.
+ * @param[in] listening Whether the socket accepts connections instead of receiving packets.
+ */
+static int
+ndn_unix_face_watch(ndn_unix_face_t* ptr, bool listening){
+  if(ndn_event_loop_add(ptr->sock,
+                        listening ? ndn_unix_face_on_acceptable : ndn_unix_face_on_readable,
+                        ptr) == NDN_SUCCESS){
+    return NDN_SUCCESS;
+  }
+  ptr->process_event = ndn_msgqueue_post(ptr, listening ? ndn_unix_face_accept : ndn_unix_face_recv,
+                                         0, NULL);
+  if(ptr->process_event == NULL){
+    return NDN_FWD_MSGQUEUE_FULL;
+  }
+  return NDN_SUCCESS;
+}
+
+/** Receive once and pass on the complete packets.
+ * @return false if the face went down, and may have been freed.
+ */
+void
+ndn_unix_face_parse(ndn_unix_face_t* self, uint32_t size){
   uint8_t *buf, *valptr;
   uint32_t cur_type, cur_size;
 
-  // It works without this line but I think adding is better, following the logic.
-  // So ndn_face_down won't cancel a not existing event.
-  ptr->process_event = NULL;
+  size += self->offset;
+  for(buf = self->buf; buf < self->buf + size; buf += cur_size){
+    valptr = tlv_get_type_length(buf, self->buf + size - buf, &cur_type, &cur_size);
+    if(valptr == NULL){
+      break;
+    }
+    cur_size += valptr - buf;
+    if(buf + cur_size > self->buf + size){
+      break;
+    }
+    ndn_forwarder_receive(&self->intf, buf, cur_size);
+  }
+  if(buf < self->buf + size){
+    // TODO: Too large packets will block the receive.
+    memmove(self->buf, buf, self->buf + size - buf);
+    self->offset = self->buf + size - buf;
+  }else{
+    self->offset = 0;
+  }
+}
+
+static bool
+ndn_unix_face_read(ndn_unix_face_t* ptr){
+  ssize_t size;
 
   size = recv(ptr->sock,
               ptr->buf + ptr->offset,
@@ -286,43 +345,42 @@ ndn_unix_face_recv(void *self, size_t param_len, void *param){
               0);
   if(size > 0){
     // Some packets recved
-    size += ptr->offset;
-    for(buf = ptr->buf; buf < ptr->buf + size; buf += cur_size){
-      valptr = tlv_get_type_length(buf, ptr->buf + size - buf, &cur_type, &cur_size);
-      if(valptr == NULL){
-        break;
-      }
-      cur_size += valptr - buf;
-      if(buf + cur_size > ptr->buf + size){
-        break;
-      }
-      ndn_forwarder_receive(&ptr->intf, buf, cur_size);
-    }
-    if(buf < ptr->buf + size){
-      // TODO: Too large packets will block the receive.
-      memcpy(ptr->buf, buf, ptr->buf + size - buf);
-      ptr->offset = ptr->buf + size - buf;
-    }else{
-      ptr->offset = 0;
-    }
+    ndn_unix_face_parse(ptr, size);
   }else if(size == -1 && errno == EWOULDBLOCK){
     // No more packet
   }else{
     // size == 0 means a shutdown
     ndn_face_down(&ptr->intf);
-    return;
+    return false;
   }
-
-  ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_recv, param_len, param);
+  return true;
 }
 
 static void
-ndn_unix_face_accept(void *self, size_t param_len, void *param){
+ndn_unix_face_recv(void *self, size_t param_len, void *param){
   ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
-  int ret = 0;
 
+  // It works without this line but I think adding is better, following the logic.
+  // So ndn_face_down won't cancel a not existing event.
   ptr->process_event = NULL;
 
+  if(ndn_unix_face_read(ptr)){
+    ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_recv, param_len, param);
+  }
+}
+
+static void
+ndn_unix_face_on_readable(void *self){
+  ndn_unix_face_read((ndn_unix_face_t*)self);
+}
+
+/** Accept a connection, if any, as a new face.
+ * @return false if the face went down.
+ */
+static bool
+ndn_unix_face_accept_one(ndn_unix_face_t* ptr){
+  int ret = 0;
+
   ret = accept(ptr->sock, NULL, NULL);
   if(ret >= 0){
     //printf("New face created %d\n", ret);
@@ -333,8 +391,23 @@ ndn_unix_face_accept(void *self, size_t param_len, void *param){
     //No more connections
   }else{
     ndn_face_down(&ptr->intf);
-    return;
+    return false;
   }
+  return true;
+}
 
-  ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_accept, param_len, param);
+static void
+ndn_unix_face_accept(void *self, size_t param_len, void *param){
+  ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
+
+  ptr->process_event = NULL;
+
+  if(ndn_unix_face_accept_one(ptr)){
+    ptr->process_event = ndn_msgqueue_post(self, ndn_unix_face_accept, param_len, param);
+  }
+}
+
+static void
+ndn_unix_face_on_acceptable(void *self){
+  ndn_unix_face_accept_one((ndn_unix_face_t*)self);
 }
@@ -45,6 +45,12 @@ typedef struct ndn_unix_face {
 ndn_unix_face_t*
 ndn_unix_face_construct(const char* addr, bool client);
 
+/** Pass on the complete packets in the buffer, after @c size bytes were received at its offset,
+ * and keep the incomplete rest at its beginning.
+ */
+void
+ndn_unix_face_parse(ndn_unix_face_t* self, uint32_t size);
+
 #ifdef __cplusplus
 }
 #endif
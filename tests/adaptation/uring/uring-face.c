@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <sys/socket.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "uring-face.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/ndn-constants.h"
+
+static int
+ndn_uring_udp_face_up(struct ndn_face_intf* self);
+
+static int
+ndn_uring_udp_face_down(struct ndn_face_intf* self);
+
+static void
+ndn_uring_udp_face_destroy(ndn_face_intf_t* self);
+
+static int
+ndn_uring_udp_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size);
+
+static void
+ndn_uring_udp_face_recv(void* self, const uint8_t* data, int size);
+
+static int
+ndn_uring_unix_face_up(struct ndn_face_intf* self);
+
+static int
+ndn_uring_unix_face_down(struct ndn_face_intf* self);
+
+static void
+ndn_uring_unix_face_destroy(ndn_face_intf_t* self);
+
+static int
+ndn_uring_unix_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size);
+
+static void
+ndn_uring_unix_face_recv(void* self, const uint8_t* data, int size);
+
+/////////////////////////// /////////////////////////// ///////////////////////////
+
+static int
+ndn_uring_udp_face_up(struct ndn_face_intf* self){
+  ndn_uring_udp_face_t* ptr = container_of(self, ndn_uring_udp_face_t, intf);
+  int iyes = 1;
+
+  if(self->state == NDN_FACE_STATE_UP){
+    return NDN_SUCCESS;
+  }
+  // Blocking: the ring waits for the socket
+  ptr->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if(ptr->sock == -1){
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  setsockopt(ptr->sock, SOL_SOCKET, SO_REUSEADDR, &iyes, sizeof(int));
+
+  if(bind(ptr->sock, (struct sockaddr*)&ptr->local_addr, sizeof(ptr->local_addr)) == -1){
+    ndn_face_down(self);
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+  // So sends need no address
+  if(connect(ptr->sock, (struct sockaddr*)&ptr->remote_addr, sizeof(ptr->remote_addr)) == -1){
+    ndn_face_down(self);
+    return NDN_UDP_FACE_SOCKET_ERROR;
+  }
+
+  if(ndn_uring_add(ptr->sock, false, ndn_uring_udp_face_recv, ptr) != NDN_SUCCESS){
+    ndn_face_down(self);
+    return NDN_URING_ERROR;
+  }
+
+  self->state = NDN_FACE_STATE_UP;
+  return NDN_SUCCESS;
+}
+
+static int
+ndn_uring_udp_face_down(struct ndn_face_intf* self){
+  ndn_uring_udp_face_t* ptr = container_of(self, ndn_uring_udp_face_t, intf);
+  self->state = NDN_FACE_STATE_DOWN;
+
+  if(ptr->sock != -1){
+    ndn_uring_remove(ptr->sock);
+    close(ptr->sock);
+    ptr->sock = -1;
+  }
+
+  return NDN_SUCCESS;
+}
+
+static void
+ndn_uring_udp_face_destroy(ndn_face_intf_t* self){
+  ndn_face_down(self);
+  ndn_forwarder_unregister_face(self);
+  free(self);
+}
+
+static int
+ndn_uring_udp_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size){
+  ndn_uring_udp_face_t* ptr = container_of(self, ndn_uring_udp_face_t, intf);
+
+  return ndn_uring_send(ptr->sock, packet, size);
+}
+
+static void
+ndn_uring_udp_face_recv(void* self, const uint8_t* data, int size){
+  ndn_uring_udp_face_t* ptr = (ndn_uring_udp_face_t*)self;
+
+  // @TODO check return status
+  ndn_forwarder_receive(&ptr->intf, (uint8_t*)data, size);
+}
+
+ndn_face_intf_t*
+ndn_uring_udp_face_construct(
+  in_addr_t local_addr,
+  in_port_t local_port,
+  in_addr_t remote_addr,
+  in_port_t remote_port)
+{
+  ndn_uring_udp_face_t* ret;
+  ndn_udp_face_t* fallback;
+  int iret;
+
+  if(ndn_uring_init() != NDN_SUCCESS){
+    fallback = ndn_udp_unicast_face_construct(local_addr, local_port, remote_addr, remote_port);
+    return fallback != NULL ? &fallback->intf : NULL;
+  }
+
+  ret = (ndn_uring_udp_face_t*)malloc(sizeof(ndn_uring_udp_face_t));
+  if(!ret){
+    return NULL;
+  }
+
+  ret->intf.face_id = NDN_INVALID_ID;
+  iret = ndn_forwarder_register_face(&ret->intf);
+  if(iret != NDN_SUCCESS){
+    free(ret);
+    return NULL;
+  }
+
+  ret->intf.type = NDN_FACE_TYPE_NET;
+  ret->intf.state = NDN_FACE_STATE_DOWN;
+  ret->intf.up = ndn_uring_udp_face_up;
+  ret->intf.down = ndn_uring_udp_face_down;
+  ret->intf.send = ndn_uring_udp_face_send;
+  ret->intf.destroy = ndn_uring_udp_face_destroy;
+
+  ret->local_addr.sin_family = AF_INET;
+  ret->local_addr.sin_port = local_port;
+  ret->local_addr.sin_addr.s_addr = local_addr;
+  memset(ret->local_addr.sin_zero, 0, sizeof(ret->local_addr.sin_zero));
+
+  ret->remote_addr.sin_family = AF_INET;
+  ret->remote_addr.sin_port = remote_port;
+  ret->remote_addr.sin_addr.s_addr = remote_addr;
+  memset(ret->remote_addr.sin_zero, 0, sizeof(ret->remote_addr.sin_zero));
+
+  ret->sock = -1;
+  ndn_face_up(&ret->intf);
+
+  return &ret->intf;
+}
+
+static int
+ndn_uring_unix_face_up(struct ndn_face_intf* self){
+  ndn_unix_face_t* ptr = container_of(self, ndn_unix_face_t, intf);
+
+  if(self->state == NDN_FACE_STATE_UP){
+    return NDN_SUCCESS;
+  }
+  // Blocking: the ring waits for the socket
+  ptr->sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(ptr->sock == -1){
+    return NDN_UNIX_FACE_SOCKET_ERROR;
+  }
+
+  if(connect(ptr->sock, (struct sockaddr*)&ptr->addr, sizeof(ptr->addr)) == -1){
+    ndn_face_down(self);
+    return NDN_UNIX_FACE_SOCKET_ERROR;
+  }
+
+  if(ndn_uring_add(ptr->sock, true, ndn_uring_unix_face_recv, ptr) != NDN_SUCCESS){
+    ndn_face_down(self);
+    return NDN_URING_ERROR;
+  }
+
+  ptr->offset = 0;
+  self->state = NDN_FACE_STATE_UP;
+  return NDN_SUCCESS;
+}
+
+static int
+ndn_uring_unix_face_down(struct ndn_face_intf* self){
+  ndn_unix_face_t* ptr = container_of(self, ndn_unix_face_t, intf);
+  self->state = NDN_FACE_STATE_DOWN;
+
+  if(ptr->sock != -1){
+    ndn_uring_remove(ptr->sock);
+    close(ptr->sock);
+    ptr->sock = -1;
+  }
+
+  return NDN_SUCCESS;
+}
+
+static void
+ndn_uring_unix_face_destroy(ndn_face_intf_t* self){
+  ndn_face_down(self);
+  ndn_forwarder_unregister_face(self);
+  free(container_of(self, ndn_unix_face_t, intf));
+}
+
+static int
+ndn_uring_unix_face_send(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size){
+  ndn_unix_face_t* ptr = container_of(self, ndn_unix_face_t, intf);
+
+  return ndn_uring_send(ptr->sock, packet, size);
+}
+
+static void
+ndn_uring_unix_face_recv(void* self, const uint8_t* data, int size){
+  ndn_unix_face_t* ptr = (ndn_unix_face_t*)self;
+  uint32_t len;
+
+  if(size <= 0){
+    // Shut down, or failed
+    ndn_face_down(&ptr->intf);
+    return;
+  }
+  while(size > 0){
+    len = sizeof(ptr->buf) - ptr->offset;
+    if(len == 0){
+      // A packet larger than the buffer: the stream can't be parsed any more
+      ndn_face_down(&ptr->intf);
+      return;
+    }
+    if(len > (uint32_t)size){
+      len = size;
+    }
+    memcpy(ptr->buf + ptr->offset, data, len);
+    ndn_unix_face_parse(ptr, len);
+    data += len;
+    size -= len;
+  }
+}
+
+ndn_face_intf_t*
+ndn_uring_unix_face_construct(const char* addr, bool client){
+  ndn_unix_face_t* ret;
+  int iret;
+
+  if(!client || ndn_uring_init() != NDN_SUCCESS){
+    ret = ndn_unix_face_construct(addr, client);
+    return ret != NULL ? &ret->intf : NULL;
+  }
+
+  ret = (ndn_unix_face_t*)malloc(sizeof(ndn_unix_face_t));
+  if(!ret){
+    return NULL;
+  }
+
+  ret->intf.face_id = NDN_INVALID_ID;
+  iret = ndn_forwarder_register_face(&ret->intf);
+  if(iret != NDN_SUCCESS){
+    free(ret);
+    return NULL;
+  }
+
+  ret->intf.type = NDN_FACE_TYPE_APP;
+  ret->intf.state = NDN_FACE_STATE_DOWN;
+  ret->intf.up = ndn_uring_unix_face_up;
+  ret->intf.down = ndn_uring_unix_face_down;
+  ret->intf.send = ndn_uring_unix_face_send;
+  ret->intf.destroy = ndn_uring_unix_face_destroy;
+
+  ret->addr.sun_family = AF_UNIX;
+  if (addr[0] == '\0') {
+    // Hidden path
+    ret->addr.sun_path[0] = '\0';
+    strncpy(ret->addr.sun_path + 1, addr + 1, sizeof(ret->addr.sun_path) - 2);
+  } else {
+    strncpy(ret->addr.sun_path, addr, sizeof(ret->addr.sun_path) - 1);
+  }
+
+  ret->client = true;
+  ret->sock = -1;
+  ret->offset = 0;
+  ret->process_event = NULL;
+  ndn_face_up(&ret->intf);
+
+  return &ret->intf;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_URING_FACE_H_
+#define NDN_URING_FACE_H_
+
+#include <netinet/in.h>
+#include "uring.h"
+#include "../udp/udp-face.h"
+#include "../unix-socket/unix-face.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * UDP unicast face receiving and sending through io_uring.
+ */
+typedef struct ndn_uring_udp_face {
+  /**
+   * The inherited interface.
+   */
+  ndn_face_intf_t intf;
+
+  struct sockaddr_in local_addr;
+  struct sockaddr_in remote_addr;
+  int sock;
+} ndn_uring_udp_face_t;
+
+/** Create a UDP unicast face on io_uring.
+ *
+ * If ndn_uring_init() fails, e.g. on kernels before Linux 6.0,
+ * this falls back to ndn_udp_unicast_face_construct().
+ * @return The interface of the face. NULL if it could not be created.
+ */
+ndn_face_intf_t*
+ndn_uring_udp_face_construct(
+  in_addr_t local_addr,
+  in_port_t local_port,
+  in_addr_t remote_addr,
+  in_port_t remote_port);
+
+/** Create a Unix socket face on io_uring.
+ *
+ * Only client faces use io_uring. A server face, and the faces of the clients it accepts,
+ * are made by ndn_unix_face_construct(), which is also the fallback if ndn_uring_init() fails.
+ * @return The interface of the face. NULL if it could not be created.
+ */
+ndn_face_intf_t*
+ndn_uring_unix_face_construct(const char* addr, bool client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_URING_FACE_H_
@@ -0,0 +1,740 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "uring.h"
+#include "../event-loop/event-loop.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/util/msg-queue.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+// Multishot receives are needed, which came after provided buffer rings
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+
+// Kinds of requests, in bits 16-31 of their user_data
+#define NDN_URING_RECV 1
+#define NDN_URING_SEND 2
+#define NDN_URING_CANCEL 3
+#define NDN_URING_SEND_STREAM 4
+
+// Packets of a stream socket written by one request
+#define NDN_URING_STREAM_BATCH 16
+
+// The group of the receive buffers
+#define NDN_URING_BGID 0
+
+/**
+ * A socket added to the ring.
+ */
+typedef struct ndn_uring_entry {
+  ndn_uring_callback callback;
+  void* self;
+  int fd;
+  bool stream;
+
+  /** Increased each time the entry is freed,
+   * so completions of a removed socket are ignored.
+   */
+  uint32_t generation;
+
+  /** Whether the multishot receive is armed.
+   */
+  bool armed;
+
+  /** Whether receiving failed for good, e.g. a stream was shut down.
+   */
+  bool stopped;
+
+  /** Whether a write of a stream socket is in flight. Only one is, to keep the order.
+   * It outlives the removal of the socket, so the entry is not reused meanwhile.
+   */
+  bool sending;
+  uint32_t sending_len;
+  struct msghdr msg;
+  struct iovec iovs[NDN_URING_STREAM_BATCH];
+
+  /** Packets of a stream socket waiting for the next write, as a list of tx buffers.
+   * -1 if none.
+   */
+  int16_t pending_head;
+  int16_t pending_tail;
+} ndn_uring_entry_t;
+
+/**
+ * A buffer of a packet being sent.
+ */
+typedef struct ndn_uring_tx {
+  uint8_t buf[NDN_URING_BUFFER_SIZE];
+  uint32_t len;
+  int16_t entry;
+
+  /** The next free buffer, or the next packet of the same stream socket. -1 if none.
+   */
+  int16_t next;
+} ndn_uring_tx_t;
+
+static int ring_fd = -1;
+static void* ring_mem;
+static size_t ring_size;
+static struct io_uring_sqe* sqes;
+static size_t sqes_size;
+static uint32_t *sq_head, *sq_tail, *sq_flags;
+static uint32_t sq_mask, sq_local_tail;
+static uint32_t *cq_head, *cq_tail;
+static uint32_t cq_mask;
+static struct io_uring_cqe* cqes;
+
+static struct io_uring_buf_ring* buf_ring;
+static uint16_t buf_tail;
+static uint8_t* rx_bufs;
+static ndn_uring_tx_t* tx_bufs;
+static int16_t tx_free;
+
+static ndn_uring_entry_t entries[NDN_URING_MAX_SOCKETS];
+
+/** The message polling completions, if the event loop is not used.
+ */
+static struct ndn_msg* reap_event;
+
+/** The message submitting the queued requests. NULL if there are none.
+ */
+static struct ndn_msg* submit_event;
+
+static void
+ndn_uring_on_submit(void *self, size_t param_len, void *param);
+
+static void
+ndn_uring_on_reap(void *self, size_t param_len, void *param);
+
+/////////////////////////// /////////////////////////// ///////////////////////////
+
+static uint64_t
+ndn_uring_user_data(uint16_t kind, uint16_t index, uint32_t generation){
+  return ((uint64_t)generation << 32) | ((uint32_t)kind << 16) | index;
+}
+
+static int
+ndn_uring_enter(uint32_t to_submit, uint32_t flags){
+  return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, 0, flags, NULL, 0);
+}
+
+/** Check that the kernel knows the operations used.
+ *
+ * Multishot receives can't be asked for,
+ * but came in Linux 6.0 with zero-copy sends which can.
+ */
+static bool
+ndn_uring_probe(void){
+  static const uint8_t ops[] = {
+    IORING_OP_RECV, IORING_OP_SEND, IORING_OP_ASYNC_CANCEL, IORING_OP_SEND_ZC
+  };
+  struct io_uring_probe* probe;
+  bool ret = true;
+  size_t i;
+
+  probe = (struct io_uring_probe*)calloc(1, sizeof(struct io_uring_probe) +
+                                            IORING_OP_LAST * sizeof(struct io_uring_probe_op));
+  if(probe == NULL){
+    return false;
+  }
+  if(syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) != 0){
+    free(probe);
+    return false;
+  }
+  for(i = 0; i < sizeof(ops); i ++){
+    if(ops[i] > probe->last_op || !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)){
+      ret = false;
+    }
+  }
+  free(probe);
+  return ret;
+}
+
+/** Post the message submitting the queued requests, if it is not already.
+ */
+static void
+ndn_uring_schedule(void){
+  if(submit_event == NULL){
+    submit_event = ndn_msgqueue_post(NULL, ndn_uring_on_submit, 0, NULL);
+  }
+}
+
+/** Hand the queued requests to the kernel.
+ */
+static void
+ndn_uring_submit(void){
+  uint32_t pending;
+  int ret;
+
+  __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+  pending = sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+  while(pending > 0){
+    ret = ndn_uring_enter(pending, 0);
+    if(ret > 0){
+      pending -= ret;
+    }else if(ret == -1 && errno == EINTR){
+      continue;
+    }else{
+      // E.g. EBUSY when completions overflow: retry in the next round
+      ndn_uring_schedule();
+      break;
+    }
+  }
+}
+
+static void
+ndn_uring_issue_stream(uint16_t index);
+
+static void
+ndn_uring_on_submit(void *self, size_t param_len, void *param){
+  int i;
+
+  submit_event = NULL;
+  // The packets queued on a stream socket this round go in one write
+  for(i = 0; i < NDN_URING_MAX_SOCKETS; i ++){
+    if(entries[i].callback != NULL && entries[i].stream){
+      ndn_uring_issue_stream(i);
+    }
+  }
+  ndn_uring_submit();
+}
+
+/** Get an empty submission queue entry, submitting the queued ones if it is full.
+ * @return The entry. NULL if the queue stays full.
+ */
+static struct io_uring_sqe*
+ndn_uring_get_sqe(void){
+  struct io_uring_sqe* sqe;
+
+  if(sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) > sq_mask){
+    ndn_uring_submit();
+    if(sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) > sq_mask){
+      return NULL;
+    }
+  }
+  sqe = &sqes[sq_local_tail & sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_local_tail ++;
+  ndn_uring_schedule();
+  return sqe;
+}
+
+/** Give a receive buffer back to the kernel. It sees it after the next publication.
+ */
+static void
+ndn_uring_recycle(uint16_t bid){
+  struct io_uring_buf* buf = &buf_ring->bufs[buf_tail & (NDN_URING_RX_BUFFERS - 1)];
+
+  // Not the whole struct: the tail of the ring overlays the first one
+  buf->addr = (uintptr_t)(rx_bufs + (size_t)bid * NDN_URING_BUFFER_SIZE);
+  buf->len = NDN_URING_BUFFER_SIZE;
+  buf->bid = bid;
+  buf_tail ++;
+}
+
+static void
+ndn_uring_free_tx(int16_t slot){
+  tx_bufs[slot].next = tx_free;
+  tx_free = slot;
+}
+
+static bool
+ndn_uring_arm(uint16_t index){
+  ndn_uring_entry_t* entry = &entries[index];
+  struct io_uring_sqe* sqe = ndn_uring_get_sqe();
+
+  if(sqe == NULL){
+    return false;
+  }
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = entry->fd;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = NDN_URING_BGID;
+  sqe->user_data = ndn_uring_user_data(NDN_URING_RECV, index, entry->generation);
+  entry->armed = true;
+  return true;
+}
+
+static bool
+ndn_uring_issue(int16_t slot){
+  ndn_uring_tx_t* tx = &tx_bufs[slot];
+  ndn_uring_entry_t* entry = &entries[tx->entry];
+  struct io_uring_sqe* sqe = ndn_uring_get_sqe();
+
+  if(sqe == NULL){
+    return false;
+  }
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = entry->fd;
+  sqe->addr = (uintptr_t)tx->buf;
+  sqe->len = tx->len;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = ndn_uring_user_data(NDN_URING_SEND, slot, entry->generation);
+  return true;
+}
+
+/** Write the packets waiting on a stream socket, if no write is in flight.
+ */
+static void
+ndn_uring_issue_stream(uint16_t index){
+  ndn_uring_entry_t* entry = &entries[index];
+  struct io_uring_sqe* sqe;
+  int16_t head, last = -1, slot;
+  uint32_t count = 0;
+
+  if(entry->sending || entry->pending_head == -1){
+    return;
+  }
+  sqe = ndn_uring_get_sqe();
+  if(sqe == NULL){
+    return;
+  }
+
+  head = entry->pending_head;
+  entry->sending_len = 0;
+  for(slot = head; slot != -1 && count < NDN_URING_STREAM_BATCH; slot = tx_bufs[slot].next){
+    entry->iovs[count].iov_base = tx_bufs[slot].buf;
+    entry->iovs[count].iov_len = tx_bufs[slot].len;
+    entry->sending_len += tx_bufs[slot].len;
+    last = slot;
+    count ++;
+  }
+  entry->pending_head = tx_bufs[last].next;
+  tx_bufs[last].next = -1;
+
+  memset(&entry->msg, 0, sizeof(entry->msg));
+  entry->msg.msg_iov = entry->iovs;
+  entry->msg.msg_iovlen = count;
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = entry->fd;
+  sqe->addr = (uintptr_t)&entry->msg;
+  sqe->len = 1;
+  // A short write would break the framing of the stream
+  sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+  sqe->user_data = ndn_uring_user_data(NDN_URING_SEND_STREAM, head, entry->generation);
+  entry->sending = true;
+}
+
+static int
+ndn_uring_find(int sock){
+  int i;
+
+  for(i = 0; i < NDN_URING_MAX_SOCKETS; i ++){
+    if(entries[i].callback != NULL && entries[i].fd == sock){
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void
+ndn_uring_complete_recv(uint16_t index, uint32_t generation, int32_t res, uint32_t flags){
+  ndn_uring_entry_t* entry = &entries[index];
+  bool valid = (entry->callback != NULL && entry->generation == generation);
+  const uint8_t* data = NULL;
+  uint16_t bid = 0;
+
+  if(flags & IORING_CQE_F_BUFFER){
+    bid = flags >> IORING_CQE_BUFFER_SHIFT;
+    data = rx_bufs + (size_t)bid * NDN_URING_BUFFER_SIZE;
+  }
+  if(valid){
+    if(!(flags & IORING_CQE_F_MORE)){
+      entry->armed = false;
+    }
+    if(res > 0){
+      entry->callback(entry->self, data, res);
+    }else if(entry->stream && res != -ENOBUFS){
+      entry->stopped = true;
+      entry->callback(entry->self, NULL, res);
+    }
+    // Errors of datagram sockets, e.g. ECONNREFUSED after an ICMP, only interrupt receiving
+  }
+  if(data != NULL){
+    ndn_uring_recycle(bid);
+  }
+}
+
+static void
+ndn_uring_complete_send(uint16_t slot){
+  // A datagram which failed is a packet lost
+  ndn_uring_free_tx(slot);
+}
+
+static void
+ndn_uring_complete_stream(uint16_t head, uint32_t generation, int32_t res){
+  uint16_t index = tx_bufs[head].entry;
+  ndn_uring_entry_t* entry = &entries[index];
+  int16_t slot, next;
+
+  for(slot = head; slot != -1; slot = next){
+    next = tx_bufs[slot].next;
+    ndn_uring_free_tx(slot);
+  }
+  entry->sending = false;
+  if(entry->callback == NULL || entry->generation != generation){
+    return;
+  }
+  if(res < 0 || (uint32_t)res != entry->sending_len){
+    entry->stopped = true;
+    entry->callback(entry->self, NULL, res < 0 ? res : -EIO);
+    return;
+  }
+  ndn_uring_issue_stream(index);
+}
+
+/** Handle the completions, and re-arm the receives which ended.
+ */
+static void
+ndn_uring_reap(void){
+  struct io_uring_cqe* cqe;
+  uint32_t head, tail, generation;
+  uint16_t kind, index;
+  int i;
+
+  while(true){
+    head = *cq_head;
+    tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for(; head != tail; head ++){
+      cqe = &cqes[head & cq_mask];
+      generation = (uint32_t)(cqe->user_data >> 32);
+      kind = (uint16_t)(cqe->user_data >> 16);
+      index = (uint16_t)cqe->user_data;
+      if(kind == NDN_URING_RECV){
+        ndn_uring_complete_recv(index, generation, cqe->res, cqe->flags);
+      }else if(kind == NDN_URING_SEND){
+        ndn_uring_complete_send(index);
+      }else if(kind == NDN_URING_SEND_STREAM){
+        ndn_uring_complete_stream(index, generation, cqe->res);
+      }
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    __atomic_store_n(&buf_ring->tail, buf_tail, __ATOMIC_RELEASE);
+
+    // Completions which did not fit wait in the kernel until asked for
+    if(!(__atomic_load_n(sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW)){
+      break;
+    }
+    ndn_uring_enter(0, IORING_ENTER_GETEVENTS);
+  }
+
+  for(i = 0; i < NDN_URING_MAX_SOCKETS; i ++){
+    if(entries[i].callback != NULL && !entries[i].armed && !entries[i].stopped){
+      ndn_uring_arm(i);
+    }
+  }
+}
+
+static void
+ndn_uring_on_ready(void *self){
+  ndn_uring_reap();
+}
+
+static void
+ndn_uring_on_reap(void *self, size_t param_len, void *param){
+  reap_event = NULL;
+  ndn_uring_reap();
+  reap_event = ndn_msgqueue_post(NULL, ndn_uring_on_reap, param_len, param);
+}
+
+int
+ndn_uring_init(void){
+  struct io_uring_params params;
+  struct io_uring_buf_reg reg;
+  uint32_t* sq_array;
+  size_t cq_size;
+  int i;
+
+  if(ring_fd != -1){
+    return NDN_SUCCESS;
+  }
+
+  memset(&params, 0, sizeof(params));
+  // A multishot receive completes many times per submission
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = NDN_URING_ENTRIES * 4;
+  ring_fd = (int)syscall(__NR_io_uring_setup, NDN_URING_ENTRIES, &params);
+  if(ring_fd < 0){
+    ring_fd = -1;
+    return NDN_URING_ERROR;
+  }
+  if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP) ||
+     !ndn_uring_probe()){
+    ndn_uring_close();
+    return NDN_URING_ERROR;
+  }
+
+  ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if(cq_size > ring_size){
+    ring_size = cq_size;
+  }
+  ring_mem = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd, IORING_OFF_SQ_RING);
+  sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes = (struct io_uring_sqe*)mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  buf_ring = (struct io_uring_buf_ring*)mmap(NULL, NDN_URING_RX_BUFFERS * sizeof(struct io_uring_buf),
+                                             PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(ring_mem == MAP_FAILED){
+    ring_mem = NULL;
+  }
+  if(sqes == MAP_FAILED){
+    sqes = NULL;
+  }
+  if(buf_ring == MAP_FAILED){
+    buf_ring = NULL;
+  }
+  rx_bufs = (uint8_t*)malloc((size_t)NDN_URING_RX_BUFFERS * NDN_URING_BUFFER_SIZE);
+  tx_bufs = (ndn_uring_tx_t*)malloc(NDN_URING_TX_BUFFERS * sizeof(ndn_uring_tx_t));
+  if(ring_mem == NULL || sqes == NULL || buf_ring == NULL || rx_bufs == NULL || tx_bufs == NULL){
+    ndn_uring_close();
+    return NDN_URING_ERROR;
+  }
+
+  sq_head = (uint32_t*)((uint8_t*)ring_mem + params.sq_off.head);
+  sq_tail = (uint32_t*)((uint8_t*)ring_mem + params.sq_off.tail);
+  sq_flags = (uint32_t*)((uint8_t*)ring_mem + params.sq_off.flags);
+  sq_mask = *(uint32_t*)((uint8_t*)ring_mem + params.sq_off.ring_mask);
+  sq_array = (uint32_t*)((uint8_t*)ring_mem + params.sq_off.array);
+  for(i = 0; i < (int)params.sq_entries; i ++){
+    sq_array[i] = i;
+  }
+  sq_local_tail = *sq_tail;
+  cq_head = (uint32_t*)((uint8_t*)ring_mem + params.cq_off.head);
+  cq_tail = (uint32_t*)((uint8_t*)ring_mem + params.cq_off.tail);
+  cq_mask = *(uint32_t*)((uint8_t*)ring_mem + params.cq_off.ring_mask);
+  cqes = (struct io_uring_cqe*)((uint8_t*)ring_mem + params.cq_off.cqes);
+
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uintptr_t)buf_ring;
+  reg.ring_entries = NDN_URING_RX_BUFFERS;
+  reg.bgid = NDN_URING_BGID;
+  if(syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0){
+    ndn_uring_close();
+    return NDN_URING_ERROR;
+  }
+  buf_tail = 0;
+  for(i = 0; i < NDN_URING_RX_BUFFERS; i ++){
+    ndn_uring_recycle(i);
+  }
+  __atomic_store_n(&buf_ring->tail, buf_tail, __ATOMIC_RELEASE);
+
+  tx_free = -1;
+  for(i = NDN_URING_TX_BUFFERS - 1; i >= 0; i --){
+    ndn_uring_free_tx(i);
+  }
+  for(i = 0; i < NDN_URING_MAX_SOCKETS; i ++){
+    entries[i].callback = NULL;
+    entries[i].fd = -1;
+    entries[i].sending = false;
+  }
+
+  // The event loop wakes up when completions arrive. Without it, they are polled each round.
+  if(ndn_event_loop_add(ring_fd, ndn_uring_on_ready, NULL) != NDN_SUCCESS){
+    reap_event = ndn_msgqueue_post(NULL, ndn_uring_on_reap, 0, NULL);
+    if(reap_event == NULL){
+      ndn_uring_close();
+      return NDN_URING_ERROR;
+    }
+  }
+  return NDN_SUCCESS;
+}
+
+void
+ndn_uring_close(void){
+  int i;
+
+  if(ring_fd == -1){
+    return;
+  }
+  ndn_event_loop_remove(ring_fd);
+  if(reap_event != NULL){
+    ndn_msgqueue_cancel(reap_event);
+    reap_event = NULL;
+  }
+  if(submit_event != NULL){
+    ndn_msgqueue_cancel(submit_event);
+    submit_event = NULL;
+  }
+  for(i = 0; i < NDN_URING_MAX_SOCKETS; i ++){
+    entries[i].callback = NULL;
+    entries[i].fd = -1;
+    entries[i].generation ++;
+  }
+
+  // Closing the ring cancels the requests in flight and unregisters the buffers
+  close(ring_fd);
+  ring_fd = -1;
+  if(sqes != NULL){
+    munmap(sqes, sqes_size);
+    sqes = NULL;
+  }
+  if(ring_mem != NULL){
+    munmap(ring_mem, ring_size);
+    ring_mem = NULL;
+  }
+  if(buf_ring != NULL){
+    munmap(buf_ring, NDN_URING_RX_BUFFERS * sizeof(struct io_uring_buf));
+    buf_ring = NULL;
+  }
+  free(rx_bufs);
+  rx_bufs = NULL;
+  free(tx_bufs);
+  tx_bufs = NULL;
+}
+
+int
+ndn_uring_add(int sock, bool stream, ndn_uring_callback callback, void* self){
+  ndn_uring_entry_t* entry;
+  int i;
+
+  if(ring_fd == -1 || sock < 0 || callback == NULL){
+    return NDN_URING_ERROR;
+  }
+  for(i = 0; i < NDN_URING_MAX_SOCKETS; i ++){
+    if(entries[i].callback == NULL && !entries[i].sending){
+      break;
+    }
+  }
+  if(i == NDN_URING_MAX_SOCKETS){
+    return NDN_URING_ERROR;
+  }
+
+  entry = &entries[i];
+  entry->fd = sock;
+  entry->stream = stream;
+  entry->armed = false;
+  entry->stopped = false;
+  entry->pending_head = -1;
+  entry->pending_tail = -1;
+  if(!ndn_uring_arm(i)){
+    entry->fd = -1;
+    return NDN_URING_ERROR;
+  }
+  entry->callback = callback;
+  entry->self = self;
+  return NDN_SUCCESS;
+}
+
+void
+ndn_uring_remove(int sock){
+  ndn_uring_entry_t* entry;
+  struct io_uring_sqe* sqe;
+  int16_t slot;
+  int i;
+
+  if(ring_fd == -1 || sock < 0){
+    return;
+  }
+  i = ndn_uring_find(sock);
+  if(i == -1){
+    return;
+  }
+  entry = &entries[i];
+
+  sqe = ndn_uring_get_sqe();
+  if(sqe != NULL){
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = ndn_uring_user_data(NDN_URING_RECV, i, entry->generation);
+    sqe->user_data = ndn_uring_user_data(NDN_URING_CANCEL, i, 0);
+  }
+  while(entry->pending_head != -1){
+    slot = entry->pending_head;
+    entry->pending_head = tx_bufs[slot].next;
+    ndn_uring_free_tx(slot);
+  }
+  entry->callback = NULL;
+  entry->fd = -1;
+  entry->generation ++;
+
+  // The receive keeps the socket open until it is cancelled
+  ndn_uring_submit();
+}
+
+int
+ndn_uring_send(int sock, const uint8_t* packet, uint32_t size){
+  ndn_uring_entry_t* entry;
+  ndn_uring_tx_t* tx;
+  int16_t slot;
+  int i;
+
+  if(ring_fd == -1 || size > NDN_URING_BUFFER_SIZE || tx_free == -1){
+    return NDN_URING_ERROR;
+  }
+  i = ndn_uring_find(sock);
+  if(i == -1){
+    return NDN_URING_ERROR;
+  }
+  entry = &entries[i];
+
+  slot = tx_free;
+  tx = &tx_bufs[slot];
+  tx_free = tx->next;
+  memcpy(tx->buf, packet, size);
+  tx->len = size;
+  tx->entry = i;
+  tx->next = -1;
+
+  if(entry->stream){
+    if(entry->pending_head == -1){
+      entry->pending_head = slot;
+    }else{
+      tx_bufs[entry->pending_tail].next = slot;
+    }
+    entry->pending_tail = slot;
+    ndn_uring_schedule();
+    return NDN_SUCCESS;
+  }
+  if(!ndn_uring_issue(slot)){
+    ndn_uring_free_tx(slot);
+    return NDN_URING_ERROR;
+  }
+  return NDN_SUCCESS;
+}
+
+#else
+
+int
+ndn_uring_init(void){
+  return NDN_URING_ERROR;
+}
+
+void
+ndn_uring_close(void){
+}
+
+int
+ndn_uring_add(int sock, bool stream, ndn_uring_callback callback, void* self){
+  return NDN_URING_ERROR;
+}
+
+void
+ndn_uring_remove(int sock){
+}
+
+int
+ndn_uring_send(int sock, const uint8_t* packet, uint32_t size){
+  return NDN_URING_ERROR;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef NDN_URING_H_
+#define NDN_URING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ndn-lite/forwarder/forwarder.h"
+#include "../adapt-consts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Submission queue entries. Sends beyond this in one round take an extra syscall.
+ */
+#ifndef NDN_URING_ENTRIES
+#define NDN_URING_ENTRIES 256
+#endif
+
+/** The most sockets receiving through the ring at the same time.
+ */
+#define NDN_URING_MAX_SOCKETS 16
+
+/** Buffers the kernel receives into, a power of 2, shared by all sockets.
+ */
+#ifndef NDN_URING_RX_BUFFERS
+#define NDN_URING_RX_BUFFERS 256
+#endif
+
+/** Buffers of packets being sent, shared by all sockets.
+ */
+#ifndef NDN_URING_TX_BUFFERS
+#define NDN_URING_TX_BUFFERS 256
+#endif
+
+// Generally MTU < 2048
+#define NDN_URING_BUFFER_SIZE 4096
+
+/** Called with the data received from a socket.
+ * @param[in, out] self The object given to ndn_uring_add().
+ * @param[in] data The data received. NULL if the socket failed.
+ * @param[in] size The size of @c data. 0 if a stream socket was shut down,
+ *                 and a negative errno if the socket failed.
+ *                 Receiving stops in both cases.
+ */
+typedef void(*ndn_uring_callback)(void* self, const uint8_t* data, int size);
+
+/** Start the io_uring ring, if it was not already.
+ *
+ * The kernel must support multishot receives and provided buffer rings (Linux 6.0).
+ * Faces use the plain sockets if this fails.
+ * If the event loop is started, the ring is watched by it, so call ndn_event_loop_init() first.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_URING_ERROR otherwise.
+ */
+int
+ndn_uring_init(void);
+
+/** Release the ring. Call this after bringing down the faces using it.
+ */
+void
+ndn_uring_close(void);
+
+/** Keep a multishot receive armed on a socket.
+ *
+ * The socket should be blocking; the ring waits for it.
+ * Completions are handled inside ndn_forwarder_process(), or by the event loop.
+ * @param[in] sock The socket.
+ * @param[in] stream Whether @c sock is a stream socket, whose sends are kept in order.
+ * @param[in] callback Called with each data received.
+ * @param[in] self Given to @c callback.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_URING_ERROR if the ring is not started or full.
+ */
+int
+ndn_uring_add(int sock, bool stream, ndn_uring_callback callback, void* self);
+
+/** Stop receiving from a socket, and drop what it has not sent yet. No effect if it is not added.
+ * @note Call this before closing @c sock. It is safe to call from a callback.
+ */
+void
+ndn_uring_remove(int sock);
+
+/** Queue a packet to send on a socket added to the ring.
+ *
+ * The packet is copied. Queued packets are submitted together once per round,
+ * and those of a stream socket in one write.
+ * @return #NDN_SUCCESS if the call succeeded. #NDN_URING_ERROR if @c sock is not added,
+ *         the packet is too large or no buffer is left.
+ */
+int
+ndn_uring_send(int sock, const uint8_t* packet, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_URING_H_
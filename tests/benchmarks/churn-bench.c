@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ndn-lite/forwarder/pit.h"
+#include "ndn-lite/forwarder/fib.h"
+
+// Measures face removal as a function of table size.
+// Each round fills a PIT and a FIB with /bench/churn/<seq>. Entry 0 is on face 0,
+// and the others are spread over faces 1 to BENCH_FACES - 1.
+// Removing face 0 touches one entry, removing face 1 touches size / (BENCH_FACES - 1) entries.
+
+#define BENCH_NAME_SIZE 22
+#define BENCH_FACES 16
+#define BENCH_ROUNDS 5
+
+static const ndn_table_id_t bench_sizes[] = {64, 256, 1024, 4096, 8192};
+
+static uint64_t
+bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+bench_make_name(uint8_t* buf, uint32_t seq)
+{
+  static const uint8_t head[] = {
+    0x07, BENCH_NAME_SIZE - 2,
+    0x08, 0x05, 'b', 'e', 'n', 'c', 'h',
+    0x08, 0x05, 'c', 'h', 'u', 'r', 'n',
+    0x08, 0x04
+  };
+  for(size_t i = 0; i < sizeof(head); i ++){
+    buf[i] = head[i];
+  }
+  buf[18] = seq >> 24;
+  buf[19] = seq >> 16;
+  buf[20] = seq >> 8;
+  buf[21] = seq;
+}
+
+static ndn_table_id_t
+bench_face_of(ndn_table_id_t seq)
+{
+  return seq == 0 ? 0 : 1 + (seq - 1) % (BENCH_FACES - 1);
+}
+
+static void
+bench_churn(ndn_table_id_t size)
+{
+  uint8_t* names = malloc((size_t)size * BENCH_NAME_SIZE);
+  uint8_t* nametree = malloc(NDN_NAMETREE_RESERVE_SIZE(size + 4));
+  ndn_pit_t* pit = malloc(NDN_PIT_RESERVE_SIZE(size, BENCH_FACES));
+  ndn_fib_t* fib = malloc(NDN_FIB_RESERVE_SIZE(size, BENCH_FACES));
+  uint64_t t_pit_one = 0, t_pit_many = 0, t_fib_one = 0, t_fib_many = 0, start;
+  ndn_pit_entry_t* pit_entry;
+  ndn_fib_entry_t* fib_entry;
+  uint8_t* name;
+  ndn_table_id_t i;
+  int round;
+
+  if(names == NULL || nametree == NULL || pit == NULL || fib == NULL){
+    printf("%8u  out of memory\n", size);
+    goto cleanup;
+  }
+  for(i = 0; i < size; i ++){
+    bench_make_name(&names[(size_t)i * BENCH_NAME_SIZE], i);
+  }
+
+  for(round = 0; round < BENCH_ROUNDS; round ++){
+    ndn_nametree_init(nametree, size + 4);
+    ndn_pit_init(pit, size, BENCH_FACES, (ndn_nametree_t*)nametree);
+    ndn_fib_init(fib, size, BENCH_FACES, (ndn_nametree_t*)nametree);
+
+    for(i = 0; i < size; i ++){
+      name = &names[(size_t)i * BENCH_NAME_SIZE];
+      pit_entry = ndn_pit_find_or_insert(pit, name, BENCH_NAME_SIZE);
+      if(pit_entry != NULL){
+        ndn_pit_add_incoming_face(pit, pit_entry, bench_face_of(i));
+      }
+      fib_entry = ndn_fib_find_or_insert(fib, name, BENCH_NAME_SIZE);
+      if(fib_entry != NULL){
+        ndn_fib_add_nexthop(fib, fib_entry, bench_face_of(i));
+      }
+    }
+
+    start = bench_now_ns();
+    ndn_pit_unregister_face(pit, 0);
+    t_pit_one += bench_now_ns() - start;
+    start = bench_now_ns();
+    ndn_pit_unregister_face(pit, 1);
+    t_pit_many += bench_now_ns() - start;
+
+    start = bench_now_ns();
+    ndn_fib_unregister_face(fib, 0);
+    t_fib_one += bench_now_ns() - start;
+    start = bench_now_ns();
+    ndn_fib_unregister_face(fib, 1);
+    t_fib_many += bench_now_ns() - start;
+  }
+
+  printf("%8u %14.1f %14.1f %14.1f %14.1f\n", size,
+         (double)t_pit_one / BENCH_ROUNDS,
+         (double)t_pit_many / BENCH_ROUNDS,
+         (double)t_fib_one / BENCH_ROUNDS,
+         (double)t_fib_many / BENCH_ROUNDS);
+
+cleanup:
+  free(names);
+  free(nametree);
+  free(pit);
+  free(fib);
+}
+
+int
+main(void)
+{
+  printf("PIT engine: %s, FIB engine: %s\n",
+         NDN_PIT_HASH_ENGINE ? "hash" : "nametree",
+         NDN_FIB_HASH_ENGINE ? "hash" : "nametree");
+  printf("%8s %14s %14s %14s %14s\n", "size", "pit-one(ns)", "pit-many(ns)", "fib-one(ns)", "fib-many(ns)");
+  for(size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i ++){
+    bench_churn(bench_sizes[i]);
+  }
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "ndn-lite/forwarder/cs.h"
+#include "adaptation/disk-cs/disk-cs.h"
+
+// Measures CS hit latency of the in-memory CS against the disk tier.
+// Data packets /bench/cs/<seq> carry 160 bytes of content.
+// The disk tier is closed and reopened before its lookups, as after a restart.
+
+#define BENCH_DATA_SIZE 189
+#define BENCH_NAME_SIZE 19
+#define BENCH_NAME_OFFSET 2
+#define BENCH_ROUNDS 5
+#define BENCH_FILE "/tmp/ndn-lite-cs-bench.db"
+
+static const uint32_t bench_sizes[] = {1024, 4096, 16384};
+
+static uint64_t
+bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+bench_make_data(uint8_t* buf, uint32_t seq)
+{
+  static const uint8_t head[] = {
+    0x06, BENCH_DATA_SIZE - 2,
+    0x07, BENCH_NAME_SIZE - 2,
+    0x08, 0x05, 'b', 'e', 'n', 'c', 'h',
+    0x08, 0x02, 'c', 's',
+    0x08, 0x04, 0, 0, 0, 0,
+    0x14, 0x04, 0x19, 0x02, 0x27, 0x10,
+    0x15, BENCH_DATA_SIZE - 29
+  };
+  size_t i;
+  for(i = 0; i < sizeof(head); i ++){
+    buf[i] = head[i];
+  }
+  buf[17] = seq >> 24;
+  buf[18] = seq >> 16;
+  buf[19] = seq >> 8;
+  buf[20] = seq;
+  for(; i < BENCH_DATA_SIZE; i ++){
+    buf[i] = (uint8_t)(seq + i);
+  }
+}
+
+static void
+bench_cs(uint32_t size)
+{
+  uint8_t* packets = malloc((size_t)size * BENCH_DATA_SIZE);
+  ndn_cs_t* cs = malloc(NDN_CS_RESERVE_SIZE(size * 256));
+  ndn_disk_cs_t* disk;
+  uint64_t t_ram = 0, t_disk = 0, t_insert = 0, start;
+  uint32_t misses = 0, i;
+  volatile uint32_t sum = 0;
+  ndn_cs_entry_t* entry;
+  const uint8_t* data;
+  size_t length;
+  uint8_t* packet;
+  int round;
+
+  if(packets == NULL || cs == NULL){
+    printf("%8u  out of memory\n", size);
+    goto cleanup;
+  }
+  for(i = 0; i < size; i ++){
+    bench_make_data(&packets[(size_t)i * BENCH_DATA_SIZE], i);
+  }
+
+  ndn_cs_init(cs, size * 256, &ndn_cs_policy_lru);
+  for(i = 0; i < size; i ++){
+    packet = &packets[(size_t)i * BENCH_DATA_SIZE];
+    ndn_cs_insert(cs, packet, BENCH_DATA_SIZE, packet + BENCH_NAME_OFFSET, BENCH_NAME_SIZE, 0);
+  }
+
+  unlink(BENCH_FILE);
+  disk = ndn_disk_cs_open(BENCH_FILE, (uint64_t)size * 256);
+  if(disk == NULL){
+    printf("%8u  cannot open %s\n", size, BENCH_FILE);
+    goto cleanup;
+  }
+  start = bench_now_ns();
+  for(i = 0; i < size; i ++){
+    packet = &packets[(size_t)i * BENCH_DATA_SIZE];
+    disk->tier.insert(&disk->tier, packet, BENCH_DATA_SIZE, packet + BENCH_NAME_OFFSET, BENCH_NAME_SIZE, 0);
+  }
+  t_insert = bench_now_ns() - start;
+  ndn_disk_cs_close(disk);
+  disk = ndn_disk_cs_open(BENCH_FILE, (uint64_t)size * 256);
+  if(disk == NULL){
+    printf("%8u  cannot reopen %s\n", size, BENCH_FILE);
+    goto cleanup;
+  }
+
+  // Touch the last byte of every hit, as sending it would
+  for(round = 0; round < BENCH_ROUNDS; round ++){
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      packet = &packets[(size_t)i * BENCH_DATA_SIZE];
+      entry = ndn_cs_match(cs, packet + BENCH_NAME_OFFSET, BENCH_NAME_SIZE, false, false, 0);
+      if(entry == NULL){
+        misses ++;
+        continue;
+      }
+      sum += ndn_cs_entry_data(cs, entry)[entry->length - 1];
+    }
+    t_ram += bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      packet = &packets[(size_t)i * BENCH_DATA_SIZE];
+      length = disk->tier.match(&disk->tier, packet + BENCH_NAME_OFFSET, BENCH_NAME_SIZE,
+                                false, false, 0, &data);
+      if(length == 0){
+        misses ++;
+        continue;
+      }
+      sum += data[length - 1];
+    }
+    t_disk += bench_now_ns() - start;
+  }
+
+  printf("%8u %12.1f %12.1f %12.1f %8u\n", size,
+         (double)t_ram / BENCH_ROUNDS / size,
+         (double)t_disk / BENCH_ROUNDS / size,
+         (double)t_insert / size,
+         misses);
+  ndn_disk_cs_close(disk);
+  unlink(BENCH_FILE);
+
+cleanup:
+  free(packets);
+  free(cs);
+}
+
+int
+main(void)
+{
+  printf("%8s %12s %12s %12s %8s\n", "size", "ram(ns)", "disk(ns)", "insert(ns)", "misses");
+  for(size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i ++){
+    bench_cs(bench_sizes[i]);
+  }
+  return 0;
+}
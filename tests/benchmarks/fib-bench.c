@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ndn-lite/forwarder/fib.h"
+
+// Measures FIB longest prefix match as a function of the number of routes.
+// All routes /bench/fib/<seq> share one root, which is the worst case of the
+// NameTree sibling scan. Lookups use /bench/fib/<seq>/data/<seq>.
+
+#define BENCH_ROUTE_SIZE 20
+#define BENCH_NAME_SIZE 30
+#define BENCH_ROUNDS 5
+#define BENCH_FACES 1
+
+static const ndn_table_id_t bench_sizes[] = {16, 64, 256, 1024, 4096};
+
+static uint64_t
+bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+bench_make_name(uint8_t* buf, uint32_t seq, bool with_suffix)
+{
+  static const uint8_t head[] = {
+    0x07, 0,
+    0x08, 0x05, 'b', 'e', 'n', 'c', 'h',
+    0x08, 0x03, 'f', 'i', 'b',
+    0x08, 0x04
+  };
+  static const uint8_t tail[] = {
+    0x08, 0x04, 'd', 'a', 't', 'a',
+    0x08, 0x02
+  };
+  size_t i;
+  for(i = 0; i < sizeof(head); i ++){
+    buf[i] = head[i];
+  }
+  buf[1] = (with_suffix ? BENCH_NAME_SIZE : BENCH_ROUTE_SIZE) - 2;
+  buf[16] = seq >> 24;
+  buf[17] = seq >> 16;
+  buf[18] = seq >> 8;
+  buf[19] = seq;
+  if(with_suffix){
+    for(i = 0; i < sizeof(tail); i ++){
+      buf[BENCH_ROUTE_SIZE + i] = tail[i];
+    }
+    buf[28] = seq >> 8;
+    buf[29] = seq;
+  }
+}
+
+static void
+bench_fib(ndn_table_id_t size)
+{
+  uint8_t* routes = malloc((size_t)size * BENCH_ROUTE_SIZE);
+  uint8_t* names = malloc((size_t)size * BENCH_NAME_SIZE);
+  uint8_t* nametree = malloc(NDN_NAMETREE_RESERVE_SIZE(size + 3));
+  ndn_fib_t* fib = malloc(NDN_FIB_RESERVE_SIZE(size, BENCH_FACES));
+  ndn_fib_entry_t** entries = malloc(sizeof(ndn_fib_entry_t*) * size);
+  uint64_t t_insert = 0, t_match = 0, start;
+  uint32_t misses = 0;
+  ndn_table_id_t i;
+  int round;
+
+  if(routes == NULL || names == NULL || nametree == NULL || fib == NULL || entries == NULL){
+    printf("%8u  out of memory\n", size);
+    goto cleanup;
+  }
+  for(i = 0; i < size; i ++){
+    bench_make_name(&routes[(size_t)i * BENCH_ROUTE_SIZE], i, false);
+    bench_make_name(&names[(size_t)i * BENCH_NAME_SIZE], i, true);
+  }
+
+  for(round = 0; round < BENCH_ROUNDS; round ++){
+    ndn_nametree_init(nametree, size + 3);
+    ndn_fib_init(fib, size, BENCH_FACES, (ndn_nametree_t*)nametree);
+
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      entries[i] = ndn_fib_find_or_insert(fib, &routes[(size_t)i * BENCH_ROUTE_SIZE], BENCH_ROUTE_SIZE);
+      if(entries[i] != NULL){
+        ndn_fib_add_nexthop(fib, entries[i], 0);
+      }
+    }
+    t_insert += bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      if(ndn_fib_prefix_match(fib, &names[(size_t)i * BENCH_NAME_SIZE], BENCH_NAME_SIZE) != entries[i]){
+        misses ++;
+      }
+    }
+    t_match += bench_now_ns() - start;
+  }
+
+  printf("%8u %12.1f %12.1f %8u\n", size,
+         (double)t_insert / BENCH_ROUNDS / size,
+         (double)t_match / BENCH_ROUNDS / size,
+         misses);
+
+cleanup:
+  free(routes);
+  free(names);
+  free(nametree);
+  free(fib);
+  free(entries);
+}
+
+int
+main(void)
+{
+  printf("FIB engine: %s\n", NDN_FIB_HASH_ENGINE ? "hash" : "nametree");
+  printf("%8s %12s %12s %8s\n", "size", "insert(ns)", "match(ns)", "misses");
+  for(size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i ++){
+    bench_fib(bench_sizes[i]);
+  }
+  return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ndn-lite/forwarder/name-tree.h"
+
+// Measures NameTree insert and find as a function of the fan-out of one node.
+// All names are /bench/tree/<seq> under the same parent, inserted in a scrambled order.
+// Fan-outs beyond 65533 need -DTABLE_ID_32BIT=ON.
+
+#define BENCH_NAME_SIZE 21
+#define BENCH_ROUNDS 5
+
+static const uint32_t bench_fanouts[] = {1, 4, 16, 64, 256, 1024, 4096, 16384, 65536, 100000};
+
+static uint64_t
+bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+bench_make_name(uint8_t* buf, uint32_t seq)
+{
+  static const uint8_t head[] = {
+    0x07, BENCH_NAME_SIZE - 2,
+    0x08, 0x05, 'b', 'e', 'n', 'c', 'h',
+    0x08, 0x04, 't', 'r', 'e', 'e',
+    0x08, 0x04
+  };
+  for(size_t i = 0; i < sizeof(head); i ++){
+    buf[i] = head[i];
+  }
+  buf[17] = seq >> 24;
+  buf[18] = seq >> 16;
+  buf[19] = seq >> 8;
+  buf[20] = seq;
+}
+
+static void
+bench_nametree(uint32_t fanout)
+{
+  uint32_t capacity = fanout + 3;
+  uint8_t* names;
+  uint8_t* nametree;
+  uint64_t t_insert = 0, t_find = 0, start;
+  uint32_t misses = 0, i;
+  int round;
+
+  if(capacity >= NDN_INVALID_ID){
+    printf("%8u  needs 32-bit table IDs\n", fanout);
+    return;
+  }
+  names = malloc((size_t)fanout * BENCH_NAME_SIZE);
+  nametree = malloc(NDN_NAMETREE_RESERVE_SIZE(capacity));
+  if(names == NULL || nametree == NULL){
+    printf("%8u  out of memory\n", fanout);
+    goto cleanup;
+  }
+  // 7919 is a prime, so this visits every seq once
+  for(i = 0; i < fanout; i ++){
+    bench_make_name(&names[(size_t)i * BENCH_NAME_SIZE], (uint32_t)(((uint64_t)i * 7919) % fanout));
+  }
+
+  for(round = 0; round < BENCH_ROUNDS; round ++){
+    ndn_nametree_init(nametree, capacity);
+
+    start = bench_now_ns();
+    for(i = 0; i < fanout; i ++){
+      if(ndn_nametree_find_or_insert((ndn_nametree_t*)nametree, &names[(size_t)i * BENCH_NAME_SIZE],
+                                     BENCH_NAME_SIZE) == NULL){
+        misses ++;
+      }
+    }
+    t_insert += bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for(i = 0; i < fanout; i ++){
+      if(ndn_nametree_find((ndn_nametree_t*)nametree, &names[(size_t)i * BENCH_NAME_SIZE],
+                           BENCH_NAME_SIZE) == NULL){
+        misses ++;
+      }
+    }
+    t_find += bench_now_ns() - start;
+  }
+
+  printf("%8u %12.1f %12.1f %8u\n", fanout,
+         (double)t_insert / BENCH_ROUNDS / fanout,
+         (double)t_find / BENCH_ROUNDS / fanout,
+         misses);
+
+cleanup:
+  free(names);
+  free(nametree);
+}
+
+int
+main(void)
+{
+  printf("%8s %12s %12s %8s\n", "fanout", "insert(ns)", "find(ns)", "misses");
+  for(size_t i = 0; i < sizeof(bench_fanouts) / sizeof(bench_fanouts[0]); i ++){
+    bench_nametree(bench_fanouts[i]);
+  }
+  return 0;
+}
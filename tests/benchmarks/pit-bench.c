@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ndn-lite/forwarder/pit.h"
+
+// Measures the cost of PIT insert, find and remove as a function of PIT size.
+// Each round fills a PIT of the given size with /bench/pit/<seq>, looks up every
+// name once, then removes every entry.
+
+#define BENCH_NAME_SIZE 20
+#define BENCH_ROUNDS 5
+#define BENCH_FACES 1
+
+static const ndn_table_id_t bench_sizes[] = {64, 256, 1024, 4096, 16384, 60000};
+
+static uint64_t
+bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+bench_make_name(uint8_t* buf, uint32_t seq)
+{
+  static const uint8_t head[] = {
+    0x07, BENCH_NAME_SIZE - 2,
+    0x08, 0x05, 'b', 'e', 'n', 'c', 'h',
+    0x08, 0x03, 'p', 'i', 't',
+    0x08, 0x04
+  };
+  for(size_t i = 0; i < sizeof(head); i ++){
+    buf[i] = head[i];
+  }
+  buf[16] = seq >> 24;
+  buf[17] = seq >> 16;
+  buf[18] = seq >> 8;
+  buf[19] = seq;
+}
+
+static void
+bench_pit(ndn_table_id_t size)
+{
+  uint8_t* names = malloc((size_t)size * BENCH_NAME_SIZE);
+  uint8_t* nametree = malloc(NDN_NAMETREE_RESERVE_SIZE(size + 3));
+  ndn_pit_t* pit = malloc(NDN_PIT_RESERVE_SIZE(size, BENCH_FACES));
+  ndn_pit_entry_t** entries = malloc(sizeof(ndn_pit_entry_t*) * size);
+  uint64_t t_insert = 0, t_find = 0, t_remove = 0, start;
+  uint32_t misses = 0;
+  ndn_table_id_t i;
+  int round;
+
+  if(names == NULL || nametree == NULL || pit == NULL || entries == NULL){
+    printf("%8u  out of memory\n", size);
+    goto cleanup;
+  }
+  for(i = 0; i < size; i ++){
+    bench_make_name(&names[(size_t)i * BENCH_NAME_SIZE], i);
+  }
+
+  for(round = 0; round < BENCH_ROUNDS; round ++){
+    ndn_nametree_init(nametree, size + 3);
+    ndn_pit_init(pit, size, BENCH_FACES, (ndn_nametree_t*)nametree);
+
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      entries[i] = ndn_pit_find_or_insert(pit, &names[(size_t)i * BENCH_NAME_SIZE], BENCH_NAME_SIZE);
+    }
+    t_insert += bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      if(ndn_pit_find(pit, &names[(size_t)i * BENCH_NAME_SIZE], BENCH_NAME_SIZE) != entries[i]){
+        misses ++;
+      }
+    }
+    t_find += bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for(i = 0; i < size; i ++){
+      if(entries[i] != NULL){
+        ndn_pit_remove_entry(pit, entries[i]);
+      }
+    }
+    t_remove += bench_now_ns() - start;
+  }
+
+  printf("%8u %12.1f %12.1f %12.1f %8u\n", size,
+         (double)t_insert / BENCH_ROUNDS / size,
+         (double)t_find / BENCH_ROUNDS / size,
+         (double)t_remove / BENCH_ROUNDS / size,
+         misses);
+
+cleanup:
+  free(names);
+  free(nametree);
+  free(pit);
+  free(entries);
+}
+
+int
+main(void)
+{
+  printf("PIT engine: %s\n", NDN_PIT_HASH_ENGINE ? "hash" : "nametree");
+  printf("%8s %12s %12s %12s %8s\n", "size", "insert(ns)", "find(ns)", "remove(ns)", "misses");
+  for(size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i ++){
+    bench_pit(bench_sizes[i]);
+  }
+  return 0;
+}
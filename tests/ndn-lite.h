@@ -16,8 +16,13 @@
 #include "ndn-lite/forwarder/forwarder.h"
 #include "ndn-lite/encode/wrapper-api.h"
 #include "adaptation/adapt-consts.h"
+#include "adaptation/event-loop/event-loop.h"
 #include "adaptation/udp/udp-face.h"
+#include "adaptation/udp/udp-listener.h"
 #include "adaptation/unix-socket/unix-face.h"
+#include "adaptation/uring/uring-face.h"
+#include "adaptation/disk-cs/disk-cs.h"
+#include "adaptation/memory/posix-alloc.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2018 Zhiyi Zhang, Tianyuan Yu, Edward Lu, Hanwen Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "cs-tests.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "../CUnit/CUnit.h"
+
+#include "ndn-lite/ndn-constants.h"
+#include "ndn-lite/encode/name.h"
+#include "ndn-lite/encode/tlv.h"
+#include "ndn-lite/encode/forwarder-helper.h"
+#include "ndn-lite/forwarder/cs.h"
+
+#define CS_TEST_SIZE (2 * NDN_CS_PAGE_SIZE)
+
+static uint8_t cs_test_memory[NDN_CS_RESERVE_SIZE(CS_TEST_SIZE)];
+
+static size_t
+cs_test_encode_name(const char* str, uint8_t* buf, size_t buflen)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  int ret_val = ndn_name_from_string(&name, str, strlen(str));
+  CU_ASSERT_EQUAL(ret_val, 0);
+  encoder_init(&encoder, buf, buflen);
+  ndn_name_tlv_encode(&encoder, &name);
+  return encoder.offset;
+}
+
+// An unsigned Data packet: Name, MetaInfo with FreshnessPeriod if not 0, Content
+static size_t
+cs_test_make_data(const char* str, uint16_t freshness_period, size_t content_len, uint8_t* buf, size_t buflen)
+{
+  uint8_t inner[2500];
+  ndn_encoder_t encoder;
+
+  encoder_init(&encoder, inner, sizeof(inner));
+  encoder.offset = cs_test_encode_name(str, inner, sizeof(inner));
+  if(freshness_period > 0){
+    encoder_append_type(&encoder, TLV_MetaInfo);
+    encoder_append_length(&encoder, 4);
+    encoder_append_type(&encoder, TLV_FreshnessPeriod);
+    encoder_append_length(&encoder, 2);
+    encoder_append_uint16_value(&encoder, freshness_period);
+  }
+  encoder_append_type(&encoder, TLV_Content);
+  encoder_append_length(&encoder, content_len);
+  for(size_t i = 0; i < content_len; i ++){
+    encoder_append_byte_value(&encoder, 0xCD);
+  }
+
+  size_t inner_len = encoder.offset;
+  encoder_init(&encoder, buf, buflen);
+  encoder_append_type(&encoder, TLV_Data);
+  encoder_append_length(&encoder, inner_len);
+  encoder_append_raw_buffer_value(&encoder, inner, inner_len);
+  return encoder.offset;
+}
+
+static ndn_cs_entry_t*
+cs_test_insert(ndn_cs_t* cs, const char* str, uint16_t freshness_period, size_t content_len, ndn_time_ms_t now)
+{
+  uint8_t data[2500];
+  size_t len = cs_test_make_data(str, freshness_period, content_len, data, sizeof(data));
+  uint32_t type, val_len;
+  uint8_t* name = tlv_get_type_length(data, len, &type, &val_len);
+  tlv_get_type_length(name, len - (name - data), &type, &val_len);
+  return ndn_cs_insert(cs, data, len, name, val_len + 2, now);
+}
+
+static ndn_cs_entry_t*
+cs_test_match(ndn_cs_t* cs, const char* str, bool can_be_prefix, bool must_be_fresh, ndn_time_ms_t now)
+{
+  uint8_t name[128];
+  size_t len = cs_test_encode_name(str, name, sizeof(name));
+  return ndn_cs_match(cs, name, len, can_be_prefix, must_be_fresh, now);
+}
+
+void run_cs_test_1(void) {
+  uint8_t data[256];
+  size_t len;
+  ndn_cs_entry_t *entry;
+
+  ndn_cs_init(cs_test_memory, CS_TEST_SIZE, &ndn_cs_policy_lru);
+  ndn_cs_t *cs = (ndn_cs_t*)cs_test_memory;
+
+  // exact and prefix match
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/ucla/cs/1", false, false, 0));
+  entry = cs_test_insert(cs, "/ucla/cs/1", 1000, 20, 0);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  len = cs_test_make_data("/ucla/cs/1", 1000, 20, data, sizeof(data));
+  CU_ASSERT_EQUAL(entry->length, len);
+  CU_ASSERT_EQUAL(memcmp(ndn_cs_entry_data(cs, entry), data, len), 0);
+  CU_ASSERT_PTR_EQUAL(cs_test_match(cs, "/ucla/cs/1", false, false, 0), entry);
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/ucla/cs", false, false, 0));
+  CU_ASSERT_PTR_EQUAL(cs_test_match(cs, "/ucla/cs", true, false, 0), entry);
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/ucla/ee", true, false, 0));
+
+  // freshness
+  CU_ASSERT_PTR_EQUAL(cs_test_match(cs, "/ucla/cs/1", false, true, 999), entry);
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/ucla/cs/1", false, true, 1000));
+  CU_ASSERT_PTR_EQUAL(cs_test_match(cs, "/ucla/cs/1", false, false, 5000), entry);
+  CU_ASSERT_PTR_NOT_NULL(cs_test_insert(cs, "/ucla/cs/2", 0, 20, 0));
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/ucla/cs/2", false, true, 0));
+
+  // the same name is replaced
+  entry = cs_test_insert(cs, "/ucla/cs/1", 1000, 40, 2000);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+  CU_ASSERT_PTR_EQUAL(cs_test_match(cs, "/ucla/cs/1", false, true, 2999), entry);
+  ndn_cs_remove_entry(cs, entry);
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/ucla/cs/1", false, false, 0));
+
+  // too large to cache
+  CU_ASSERT_PTR_NULL(cs_test_insert(cs, "/ucla/cs/huge", 0, NDN_CS_PAGE_SIZE, 0));
+}
+
+void run_cs_test_lru(void) {
+  char name[32];
+  int i, count = CS_TEST_SIZE / NDN_CS_MIN_CHUNK_SIZE;
+
+  ndn_cs_init(cs_test_memory, CS_TEST_SIZE, &ndn_cs_policy_lru);
+  ndn_cs_t *cs = (ndn_cs_t*)cs_test_memory;
+
+  for(i = 0; i < count; i ++){
+    sprintf(name, "/lru/%d", i);
+    CU_ASSERT_PTR_NOT_NULL(cs_test_insert(cs, name, 0, 20, 0));
+  }
+  CU_ASSERT_PTR_NOT_NULL(cs_test_match(cs, "/lru/0", false, false, 0));
+  CU_ASSERT_PTR_NOT_NULL(cs_test_insert(cs, "/lru/new", 0, 20, 0));
+  CU_ASSERT_PTR_NOT_NULL(cs_test_match(cs, "/lru/0", false, false, 0));
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/lru/1", false, false, 0));
+  CU_ASSERT_PTR_NOT_NULL(cs_test_match(cs, "/lru/2", false, false, 0));
+
+  // A large packet takes a page back from the small ones
+  CU_ASSERT_PTR_NOT_NULL(cs_test_insert(cs, "/lru/large", 0, 1500, 0));
+  CU_ASSERT_PTR_NOT_NULL(cs_test_match(cs, "/lru/large", false, false, 0));
+  CU_ASSERT_PTR_NOT_NULL(cs_test_match(cs, "/lru/0", false, false, 0));
+}
+
+void run_cs_test_lfu(void) {
+  char name[32];
+  int i, count = CS_TEST_SIZE / NDN_CS_MIN_CHUNK_SIZE;
+
+  ndn_cs_init(cs_test_memory, CS_TEST_SIZE, &ndn_cs_policy_lfu);
+  ndn_cs_t *cs = (ndn_cs_t*)cs_test_memory;
+
+  for(i = 0; i < count; i ++){
+    sprintf(name, "/lfu/%d", i);
+    CU_ASSERT_PTR_NOT_NULL(cs_test_insert(cs, name, 0, 20, 0));
+  }
+  // /lfu/0 is popular but the least recently used
+  for(i = 0; i < 3; i ++){
+    cs_test_match(cs, "/lfu/0", false, false, 0);
+  }
+  for(i = 1; i < count; i ++){
+    sprintf(name, "/lfu/%d", i);
+    cs_test_match(cs, name, false, false, 0);
+  }
+  CU_ASSERT_PTR_NOT_NULL(cs_test_insert(cs, "/lfu/new", 0, 20, 0));
+  CU_ASSERT_PTR_NOT_NULL(cs_test_match(cs, "/lfu/0", false, false, 0));
+  CU_ASSERT_PTR_NULL(cs_test_match(cs, "/lfu/1", false, false, 0));
+}
+
+void add_cs_test_suite()
+{
+  CU_pSuite pSuite = NULL;
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("CS Test", NULL, NULL);
+  if (NULL == pSuite)
+  {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "cs_test_1", run_cs_test_1) ||
+      NULL == CU_add_test(pSuite, "cs_test_lru", run_cs_test_lru) ||
+      NULL == CU_add_test(pSuite, "cs_test_lfu", run_cs_test_lfu)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+}
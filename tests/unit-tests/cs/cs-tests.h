@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2020 Hanwen Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef CS_TESTS_H
+#define CS_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// add CS test suite to CUnit registry
+void add_cs_test_suite(void);
+
+#endif // CS_TESTS_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 Hanwen Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "faceset-tests.h"
+
+#include "../CUnit/CUnit.h"
+#include "ndn-lite/forwarder/faceset.h"
+
+#define FACESET_TEST_LAST (NDN_FACESET_CAPACITY - 1)
+
+void run_faceset_test_1()
+{
+  ndn_faceset_t set, other, diff;
+  ndn_table_id_t id, expected[] = {0, 31, 32, 63, FACESET_TEST_LAST};
+  // 63 is the last face with a single word
+  size_t count = 0, expected_count = (FACESET_TEST_LAST == 63 ? 4 : 5);
+
+  ndn_faceset_clear(&set);
+  CU_ASSERT_TRUE(ndn_faceset_is_empty(&set));
+  CU_ASSERT_EQUAL(ndn_faceset_next(&set, 0), NDN_INVALID_ID);
+
+  // Faces above 31 need 64-bit shifts
+  ndn_faceset_add(&set, FACESET_TEST_LAST);
+  ndn_faceset_add(&set, 63);
+  ndn_faceset_add(&set, 32);
+  ndn_faceset_add(&set, 31);
+  ndn_faceset_add(&set, 0);
+  CU_ASSERT_FALSE(ndn_faceset_is_empty(&set));
+  CU_ASSERT_TRUE(ndn_faceset_contains(&set, 32));
+  CU_ASSERT_FALSE(ndn_faceset_contains(&set, 33));
+  NDN_FACESET_FOREACH(&set, id){
+    CU_ASSERT_TRUE(count < expected_count);
+    if(count < expected_count){
+      CU_ASSERT_EQUAL(id, expected[count]);
+    }
+    count ++;
+  }
+  CU_ASSERT_EQUAL(count, expected_count);
+  CU_ASSERT_EQUAL(ndn_faceset_next(&set, 33), 63);
+
+  // nexthop & ~outgoing
+  ndn_faceset_clear(&other);
+  ndn_faceset_add(&other, 31);
+  ndn_faceset_add(&other, FACESET_TEST_LAST);
+  ndn_faceset_difference(&diff, &set, &other);
+  CU_ASSERT_FALSE(ndn_faceset_contains(&diff, 31));
+  CU_ASSERT_FALSE(ndn_faceset_contains(&diff, FACESET_TEST_LAST));
+  CU_ASSERT_TRUE(ndn_faceset_contains(&diff, 32));
+  ndn_faceset_union(&diff, &other);
+  CU_ASSERT_TRUE(ndn_faceset_contains(&diff, 31));
+
+  ndn_faceset_remove(&set, 0);
+  ndn_faceset_remove(&set, 31);
+  ndn_faceset_remove(&set, 32);
+  ndn_faceset_remove(&set, 63);
+  ndn_faceset_remove(&set, FACESET_TEST_LAST);
+  CU_ASSERT_TRUE(ndn_faceset_is_empty(&set));
+}
+
+void add_faceset_test_suite()
+{
+  CU_pSuite pSuite = NULL;
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("FaceSet Test", NULL, NULL);
+  if (NULL == pSuite)
+  {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "faceset_test_1", run_faceset_test_1)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+}
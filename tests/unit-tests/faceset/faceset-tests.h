@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2020 Hanwen Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FACESET_TESTS_H
+#define FACESET_TESTS_H
+
+// add FaceSet test suite to CUnit registry
+void add_faceset_test_suite(void);
+
+#endif // FACESET_TESTS_H
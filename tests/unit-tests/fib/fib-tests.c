@@ -22,8 +22,24 @@
 #include "ndn-lite/forwarder/face-table.h"
 #include "ndn-lite/face/dummy-face.h"
 
+static uint8_t fib_test_memory[NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE) +
+                               NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE) +
+                               NDN_FIB_RESERVE_SIZE(NDN_FIB_MAX_SIZE, NDN_FACE_TABLE_MAX_SIZE)];
+
+static size_t
+fib_test_encode_name(const char* str, uint8_t* buf, size_t buflen)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  int ret_val = ndn_name_from_string(&name, str, strlen(str));
+  CU_ASSERT_EQUAL(ret_val, 0);
+  encoder_init(&encoder, buf, buflen);
+  ndn_name_tlv_encode(&encoder, &name);
+  return encoder.offset;
+}
+
 void run_fib_test_1(void) {
-  uint8_t memory[6264];
+  uint8_t *memory = fib_test_memory;
   uint8_t *ptr = (uint8_t *)memory;
   ndn_nametree_init(ptr, NDN_NAMETREE_MAX_SIZE);
   ndn_nametree_t * nametree = (ndn_nametree_t *)ptr;
@@ -31,7 +47,7 @@ void run_fib_test_1(void) {
   ndn_facetab_init(ptr, NDN_FACE_TABLE_MAX_SIZE);
   // ndn_face_table_t *facetab = (ndn_face_table_t *)ptr;
   ptr += NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE);
-  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, nametree);
+  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, NDN_FACE_TABLE_MAX_SIZE, nametree);
   ndn_fib_t *fib = (ndn_fib_t *)ptr;
 
   // ndn_dummy_face_t *dummy_face;
@@ -62,6 +78,108 @@ void run_fib_test_1(void) {
   CU_ASSERT_PTR_NOT_NULL(ret_entry);
 }
 
+void run_fib_test_lpm(void) {
+  uint8_t name[128];
+  size_t len;
+  ndn_fib_entry_t *short_entry, *long_entry, *ret_entry;
+  int i;
+
+  ndn_nametree_init(fib_test_memory, NDN_NAMETREE_MAX_SIZE);
+  uint8_t *ptr = fib_test_memory + NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE);
+  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t *)fib_test_memory);
+  ndn_fib_t *fib = (ndn_fib_t *)ptr;
+
+  len = fib_test_encode_name("/a", name, sizeof(name));
+  short_entry = ndn_fib_find_or_insert(fib, name, len);
+  CU_ASSERT_PTR_NOT_NULL(short_entry);
+  ndn_fib_add_nexthop(fib, short_entry, 0);
+  len = fib_test_encode_name("/a/b/c/d/e/f/g", name, sizeof(name));
+  long_entry = ndn_fib_find_or_insert(fib, name, len);
+  CU_ASSERT_PTR_NOT_NULL(long_entry);
+  CU_ASSERT_PTR_NOT_EQUAL(long_entry, short_entry);
+  ndn_fib_add_nexthop(fib, long_entry, 0);
+
+  // prefixes between the two routes are not routes themselves
+  len = fib_test_encode_name("/a/b/c", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_fib_find(fib, name, len));
+  CU_ASSERT_PTR_EQUAL(ndn_fib_prefix_match(fib, name, len), short_entry);
+  len = fib_test_encode_name("/a/b/c/d/e/f/x", name, sizeof(name));
+  CU_ASSERT_PTR_EQUAL(ndn_fib_prefix_match(fib, name, len), short_entry);
+  len = fib_test_encode_name("/a/b/c/d/e/f/g/h/i", name, sizeof(name));
+  CU_ASSERT_PTR_EQUAL(ndn_fib_prefix_match(fib, name, len), long_entry);
+  len = fib_test_encode_name("/b/c", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_fib_prefix_match(fib, name, len));
+
+  // removing the shorter route keeps the longer one reachable
+  ndn_fib_clear_nexthops(fib, short_entry);
+  ndn_fib_remove_entry_if_empty(fib, short_entry);
+  CU_ASSERT_TRUE(ndn_fib_entry_is_empty(short_entry));
+  len = fib_test_encode_name("/a/b/c", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_fib_prefix_match(fib, name, len));
+  len = fib_test_encode_name("/a/b/c/d/e/f/g/h", name, sizeof(name));
+  CU_ASSERT_PTR_EQUAL(ndn_fib_prefix_match(fib, name, len), long_entry);
+
+  // add and remove routes repeatedly: nothing leaks
+  for(i = 0; i < 4 * NDN_FIB_MAX_SIZE; i ++){
+    len = fib_test_encode_name("/x/y/z/w", name, sizeof(name));
+    ret_entry = ndn_fib_find_or_insert(fib, name, len);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(ret_entry);
+    ndn_fib_remove_entry_if_empty(fib, ret_entry);
+    CU_ASSERT_PTR_NULL(ndn_fib_find(fib, name, len));
+  }
+  len = fib_test_encode_name("/a/b/c/d/e/f/g", name, sizeof(name));
+  CU_ASSERT_PTR_EQUAL(ndn_fib_find(fib, name, len), long_entry);
+}
+
+void run_fib_test_unregister_face(void) {
+  uint8_t name[128];
+  size_t len;
+  ndn_fib_entry_t *a_entry, *ab_entry, *abc_entry, *d_entry;
+
+  ndn_nametree_init(fib_test_memory, NDN_NAMETREE_MAX_SIZE);
+  uint8_t *ptr = fib_test_memory + NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE);
+  ndn_fib_init(ptr, NDN_FIB_MAX_SIZE, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t *)fib_test_memory);
+  ndn_fib_t *fib = (ndn_fib_t *)ptr;
+
+  // /a: {1}, /a/b: {1, 2}, /a/b/c: {1}, /d: {2}
+  len = fib_test_encode_name("/a", name, sizeof(name));
+  a_entry = ndn_fib_find_or_insert(fib, name, len);
+  ndn_fib_add_nexthop(fib, a_entry, 1);
+  len = fib_test_encode_name("/a/b", name, sizeof(name));
+  ab_entry = ndn_fib_find_or_insert(fib, name, len);
+  ndn_fib_add_nexthop(fib, ab_entry, 1);
+  ndn_fib_add_nexthop(fib, ab_entry, 2);
+  len = fib_test_encode_name("/a/b/c", name, sizeof(name));
+  abc_entry = ndn_fib_find_or_insert(fib, name, len);
+  ndn_fib_add_nexthop(fib, abc_entry, 1);
+  len = fib_test_encode_name("/d", name, sizeof(name));
+  d_entry = ndn_fib_find_or_insert(fib, name, len);
+  ndn_fib_add_nexthop(fib, d_entry, 2);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a_entry);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ab_entry);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(abc_entry);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(d_entry);
+
+  // several routes go away at once, and lookups fall back to the remaining ones
+  ndn_fib_unregister_face(fib, 1);
+  CU_ASSERT_TRUE(ndn_fib_entry_is_empty(a_entry));
+  CU_ASSERT_TRUE(ndn_fib_entry_is_empty(abc_entry));
+  CU_ASSERT_FALSE(ndn_faceset_contains(&ab_entry->nexthop, 1));
+  CU_ASSERT_TRUE(ndn_faceset_contains(&ab_entry->nexthop, 2));
+  len = fib_test_encode_name("/a/b/c/x", name, sizeof(name));
+  CU_ASSERT_PTR_EQUAL(ndn_fib_prefix_match(fib, name, len), ab_entry);
+  len = fib_test_encode_name("/a/x", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_fib_prefix_match(fib, name, len));
+
+  ndn_fib_unregister_face(fib, 2);
+  CU_ASSERT_TRUE(ndn_fib_entry_is_empty(ab_entry));
+  CU_ASSERT_TRUE(ndn_fib_entry_is_empty(d_entry));
+  len = fib_test_encode_name("/a/b/c/x", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_fib_prefix_match(fib, name, len));
+  len = fib_test_encode_name("/d/x", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_fib_prefix_match(fib, name, len));
+}
+
 void add_fib_test_suite()
 {
   CU_pSuite pSuite = NULL;
@@ -74,7 +192,9 @@ void add_fib_test_suite()
     // return CU_get_error();
     return;
   }
-  if (NULL == CU_add_test(pSuite, "fib_test_1", run_fib_test_1)) {
+  if (NULL == CU_add_test(pSuite, "fib_test_1", run_fib_test_1) ||
+      NULL == CU_add_test(pSuite, "fib_test_lpm", run_fib_test_lpm) ||
+      NULL == CU_add_test(pSuite, "fib_test_unregister_face", run_fib_test_unregister_face)) {
     CU_cleanup_registry();
     // return CU_get_error();
     return;
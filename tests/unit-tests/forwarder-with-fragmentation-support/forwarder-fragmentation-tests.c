@@ -27,7 +27,7 @@
 // how many microseconds are in a second
 #define MICROSECONDS_PER_SECOND 1000000
 
-const char *_current_test_name;
+static const char *_current_test_name;
 static bool _current_forwarder_test_app_received_interest = false;
 // static bool _current_forwarder_test_app_received_data = false;
 // static bool _current_forwarder_test_all_calls_succeeded = false;
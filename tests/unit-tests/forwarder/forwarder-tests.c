@@ -18,11 +18,15 @@
 #include "../print-helpers.h"
 
 #include "ndn-lite/ndn-constants.h"
+#include "ndn-lite/ndn-enums.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/encode/forwarder-helper.h"
 #include "ndn-lite/encode/interest.h"
 #include "ndn-lite/encode/data.h"
 #include "ndn-lite/forwarder/fib.h"
 #include "ndn-lite/forwarder/forwarder.h"
 #include "ndn-lite/face/dummy-face.h"
+#include "adaptation/memory/posix-alloc.h"
 
 // five seconds
 #define FORWARDER_TEST_WAIT_TIME_U_SEC 5000000
@@ -508,6 +512,801 @@ void forwarder_pointer_test()
   return;
 }
 
+static int forwarder_config_test_frees = 0;
+
+static void
+forwarder_config_test_free(void* memory, size_t size, bool hugepage, void* userdata)
+{
+  forwarder_config_test_frees ++;
+  ndn_posix_free(memory, size, hugepage, userdata);
+}
+
+void forwarder_config_test()
+{
+  ndn_forwarder_config_t config;
+  const ndn_forwarder_t* forwarder;
+  uint8_t name[] = {0x07, 0x0C, 0x08, 0x06, 'c', 'o', 'n', 'f', 'i', 'g', 0x08, 0x02, 0, 0};
+  ndn_table_id_t i;
+
+  ndn_forwarder_config_default(&config);
+  config.nametree_size = 1100;
+  config.pit_size = 1000;
+  // Too large for the built-in memory
+  CU_ASSERT_EQUAL(ndn_forwarder_init_with_config(&config), NDN_FWD_NO_MEMORY);
+  config.facetab_size = NDN_FACESET_CAPACITY + 1;
+  CU_ASSERT_EQUAL(ndn_forwarder_init_with_config(&config), NDN_OVERSIZE);
+  config.facetab_size = NDN_FACE_TABLE_MAX_SIZE;
+
+  config.alloc = ndn_posix_alloc;
+  config.free = forwarder_config_test_free;
+  config.hugepage = true;
+  CU_ASSERT_EQUAL(ndn_forwarder_init_with_config(&config), NDN_SUCCESS);
+  forwarder = ndn_forwarder_get();
+  CU_ASSERT_EQUAL(forwarder->pit->capacity, 1000);
+  for(i = 0; i < 1000; i ++){
+    name[12] = i >> 8;
+    name[13] = i;
+    CU_ASSERT_PTR_NOT_NULL(ndn_pit_find_or_insert(forwarder->pit, name, sizeof(name)));
+  }
+
+  // Going back to the built-in memory releases the region
+  ndn_forwarder_init();
+  CU_ASSERT_EQUAL(forwarder_config_test_frees, 1);
+  CU_ASSERT_EQUAL(forwarder->pit->capacity, NDN_PIT_MAX_SIZE);
+}
+
+/** A face keeping the last packet sent through it.
+ */
+typedef struct forwarder_nack_test_face {
+  ndn_face_intf_t intf;
+  uint8_t packet[512];
+  size_t length;
+} forwarder_nack_test_face_t;
+
+static int forwarder_nack_test_reason = -1;
+
+static int
+forwarder_nack_test_face_send(struct ndn_face_intf* self, const uint8_t* packet, uint32_t size)
+{
+  forwarder_nack_test_face_t* face = (forwarder_nack_test_face_t*)self;
+  memcpy(face->packet, packet, size);
+  face->length = size;
+  return NDN_SUCCESS;
+}
+
+static void
+forwarder_nack_test_face_init(forwarder_nack_test_face_t* face)
+{
+  memset(face, 0, sizeof(*face));
+  face->intf.send = forwarder_nack_test_face_send;
+  face->intf.face_id = NDN_INVALID_ID;
+  face->intf.state = NDN_FACE_STATE_UP;
+  face->intf.type = NDN_FACE_TYPE_NET;
+  CU_ASSERT_EQUAL(ndn_forwarder_register_face(&face->intf), NDN_SUCCESS);
+}
+
+static size_t
+forwarder_nack_test_interest(const char* name, uint32_t nonce, uint8_t* buf, size_t buflen)
+{
+  ndn_interest_t interest;
+  ndn_encoder_t encoder;
+  ndn_interest_init(&interest);
+  CU_ASSERT_EQUAL(ndn_name_from_string(&interest.name, name, strlen(name)), 0);
+  interest.nonce = nonce;
+  encoder_init(&encoder, buf, buflen);
+  CU_ASSERT_EQUAL(ndn_interest_tlv_encode(&encoder, &interest), 0);
+  return encoder.offset;
+}
+
+/** Check the last packet of a face is a Nack with a reason and a nonce.
+ */
+static void
+forwarder_nack_test_check(forwarder_nack_test_face_t* face, uint8_t reason, uint32_t nonce)
+{
+  uint8_t *fragment, got_reason;
+  size_t fragment_len;
+  bool nack;
+  interest_options_t options;
+  ndn_parsed_name_t name;
+  uint8_t* name_ptr;
+  size_t name_len;
+
+  CU_ASSERT_EQUAL_FATAL(tlv_lp_packet_parse(face->packet, face->length, &fragment, &fragment_len,
+                                            &nack, &got_reason), NDN_SUCCESS);
+  CU_ASSERT_TRUE(nack);
+  CU_ASSERT_EQUAL(got_reason, reason);
+  CU_ASSERT_EQUAL(tlv_interest_get_header_parsed(fragment, fragment_len, &options, &name), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(options.nonce, nonce);
+  CU_ASSERT_EQUAL(tlv_interest_get_header(fragment, fragment_len, NULL, &name_ptr, &name_len), NDN_SUCCESS);
+  CU_ASSERT_PTR_EQUAL(name_ptr, name.name);
+  CU_ASSERT_EQUAL(name_len, name.name_len);
+}
+
+static void
+forwarder_nack_test_on_nack(const uint8_t* interest, uint32_t interest_size, uint8_t reason, void* userdata)
+{
+  forwarder_nack_test_reason = reason;
+}
+
+static void
+forwarder_nack_test_on_timeout(void* userdata)
+{
+  forwarder_nack_test_reason = -2;
+}
+
+/*
+ *  +----+       +---------+ -- /nack upstream
+ *  |app | ----- |forwarder|
+ *  +----+       +---------+ -- downstream
+ */
+void forwarder_nack_test()
+{
+  forwarder_nack_test_face_t upstream, downstream;
+  uint8_t interest[256], nack[300], params[128];
+  size_t interest_len, nack_len;
+  interest_options_t options;
+  ndn_parsed_name_t name;
+  const ndn_forwarder_t* forwarder;
+  ndn_interest_t large;
+  ndn_encoder_t encoder;
+
+  ndn_forwarder_init();
+  forwarder = ndn_forwarder_get();
+  forwarder_nack_test_face_init(&upstream);
+  forwarder_nack_test_face_init(&downstream);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&upstream.intf, "/nack", strlen("/nack")), 0);
+
+  // An application gets the Nack of its upstream instead of waiting for the timeout
+  interest_len = forwarder_nack_test_interest("/nack/a", 0x11111111, interest, sizeof(interest));
+  CU_ASSERT_EQUAL(ndn_forwarder_express_interest_with_nack(interest, interest_len, on_data_callback2,
+                                                           forwarder_nack_test_on_timeout,
+                                                           forwarder_nack_test_on_nack, NULL), 0);
+  CU_ASSERT_EQUAL(upstream.length, interest_len);
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, sizeof(nack), upstream.packet, upstream.length,
+                                NDN_NACK_REASON_NO_ROUTE, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&downstream.intf, nack, nack_len), NDN_FWD_NO_EFFECT);
+  CU_ASSERT_EQUAL(forwarder_nack_test_reason, -1);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&upstream.intf, nack, nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_nack_test_reason, NDN_NACK_REASON_NO_ROUTE);
+  tlv_interest_get_header_parsed(interest, interest_len, &options, &name);
+  CU_ASSERT_PTR_NULL(ndn_pit_find_parsed(forwarder->pit, &name));
+
+  // Without a route, the downstream is Nacked at once
+  interest_len = forwarder_nack_test_interest("/none/a", 0x22222222, interest, sizeof(interest));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&downstream.intf, interest, interest_len), NDN_FWD_NO_ROUTE);
+  forwarder_nack_test_check(&downstream, NDN_NACK_REASON_NO_ROUTE, 0x22222222);
+  tlv_interest_get_header_parsed(interest, interest_len, &options, &name);
+  CU_ASSERT_PTR_NULL(ndn_pit_find_parsed(forwarder->pit, &name));
+
+  // The Interest coming back from the upstream is a duplicate
+  interest_len = forwarder_nack_test_interest("/nack/b", 0x33333333, interest, sizeof(interest));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&downstream.intf, interest, interest_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(upstream.length, interest_len);
+  memcpy(nack, upstream.packet, upstream.length);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&upstream.intf, nack, interest_len), NDN_FWD_INTEREST_REJECTED);
+  forwarder_nack_test_check(&upstream, NDN_NACK_REASON_DUPLICATE, 0x33333333);
+
+  // Nacks go back to the downstreams
+  memcpy(interest, nack, interest_len);
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, sizeof(nack), interest, interest_len,
+                                NDN_NACK_REASON_CONGESTION, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&upstream.intf, nack, nack_len), NDN_SUCCESS);
+  forwarder_nack_test_check(&downstream, NDN_NACK_REASON_CONGESTION, 0x33333333);
+  tlv_interest_get_header_parsed(interest, interest_len, &options, &name);
+  CU_ASSERT_PTR_NULL(ndn_pit_find_parsed(forwarder->pit, &name));
+
+  // An Interest too large for the buffer is Nacked without its parameters
+  ndn_interest_init(&large);
+  CU_ASSERT_EQUAL(ndn_name_from_string(&large.name, "/nack/c", strlen("/nack/c")), 0);
+  large.nonce = 0x44444444;
+  memset(params, 0xAB, sizeof(params));
+  CU_ASSERT_EQUAL(ndn_interest_set_Parameters(&large, params, sizeof(params)), 0);
+  encoder_init(&encoder, interest, sizeof(interest));
+  CU_ASSERT_EQUAL(ndn_interest_tlv_encode(&encoder, &large), 0);
+  interest_len = encoder.offset;
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, interest_len, interest, interest_len,
+                                NDN_NACK_REASON_CONGESTION, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_TRUE(nack_len < interest_len);
+  memcpy(downstream.packet, nack, nack_len);
+  downstream.length = nack_len;
+  forwarder_nack_test_check(&downstream, NDN_NACK_REASON_CONGESTION, 0x44444444);
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, 16, interest, interest_len,
+                                NDN_NACK_REASON_CONGESTION, &nack_len), NDN_OVERSIZE);
+
+  ndn_forwarder_unregister_face(&upstream.intf);
+  ndn_forwarder_unregister_face(&downstream.intf);
+}
+
+/** Send an Interest from a downstream, and tell which upstreams got it.
+ */
+static void
+forwarder_strategy_test_send(const char* name, uint32_t nonce, forwarder_nack_test_face_t* downstream,
+                             forwarder_nack_test_face_t* up1, forwarder_nack_test_face_t* up2,
+                             bool* sent1, bool* sent2)
+{
+  uint8_t interest[256];
+  size_t interest_len = forwarder_nack_test_interest(name, nonce, interest, sizeof(interest));
+  up1->length = up2->length = 0;
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&downstream->intf, interest, interest_len), NDN_SUCCESS);
+  *sent1 = (up1->length == interest_len);
+  *sent2 = (up2->length == interest_len);
+}
+
+/*
+ *                             +-- cost 3 -- up1
+ *  downstream -- forwarder -- +
+ *                             +-- cost 1 -- up2
+ */
+void forwarder_strategy_test()
+{
+  forwarder_nack_test_face_t up1, up2, downstream;
+  uint8_t prefix[64], nack[300];
+  size_t prefix_len, nack_len;
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  char interest_name[16];
+  bool sent1, sent2;
+  int i, count1 = 0, count2 = 0;
+
+  ndn_forwarder_init();
+  forwarder_nack_test_face_init(&up1);
+  forwarder_nack_test_face_init(&up2);
+  forwarder_nack_test_face_init(&downstream);
+  ndn_name_from_string(&name, "/s", strlen("/s"));
+  encoder_init(&encoder, prefix, sizeof(prefix));
+  ndn_name_tlv_encode(&encoder, &name);
+  prefix_len = encoder.offset;
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_with_cost(&up1.intf, prefix, prefix_len, 3), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route(&up2.intf, prefix, prefix_len), NDN_SUCCESS);
+
+  // Multicast by default
+  forwarder_strategy_test_send("/s/m", 1, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(sent1 && sent2);
+
+  // Best route sends to the cheaper upstream, and tries the other one on a Nack
+  CU_ASSERT_EQUAL(ndn_forwarder_set_strategy(prefix, prefix_len, &ndn_strategy_best_route), NDN_SUCCESS);
+  forwarder_strategy_test_send("/s/b", 0x44444444, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(!sent1 && sent2);
+  downstream.length = 0;
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, sizeof(nack), up2.packet, up2.length,
+                                NDN_NACK_REASON_CONGESTION, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up2.intf, nack, nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(up1.length, up2.length);
+  CU_ASSERT_EQUAL(downstream.length, 0);
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, sizeof(nack), up1.packet, up1.length,
+                                NDN_NACK_REASON_NO_ROUTE, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up1.intf, nack, nack_len), NDN_SUCCESS);
+  forwarder_nack_test_check(&downstream, NDN_NACK_REASON_CONGESTION, 0x44444444);
+
+  // Load balance sends 3 times more Interests to the upstream of 1/3 the cost
+  CU_ASSERT_EQUAL(ndn_forwarder_set_strategy(prefix, prefix_len, &ndn_strategy_load_balance), NDN_SUCCESS);
+  for(i = 0; i < 8; i ++){
+    sprintf(interest_name, "/s/l%d", i);
+    forwarder_strategy_test_send(interest_name, 10 + i, &downstream, &up1, &up2, &sent1, &sent2);
+    CU_ASSERT_TRUE(sent1 != sent2);
+    count1 += sent1;
+    count2 += sent2;
+  }
+  CU_ASSERT_EQUAL(count1, 2);
+  CU_ASSERT_EQUAL(count2, 6);
+
+  // A longer prefix takes precedence, and unsetting it goes back to the parent's strategy
+  ndn_name_from_string(&name, "/", strlen("/"));
+  encoder_init(&encoder, nack, sizeof(nack));
+  ndn_name_tlv_encode(&encoder, &name);
+  CU_ASSERT_EQUAL(ndn_forwarder_set_strategy(nack, encoder.offset, &ndn_strategy_best_route), NDN_SUCCESS);
+  forwarder_strategy_test_send("/s/p", 20, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(sent1 != sent2);
+  CU_ASSERT_EQUAL(ndn_forwarder_set_strategy(prefix, prefix_len, NULL), NDN_SUCCESS);
+  forwarder_strategy_test_send("/s/q", 21, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(!sent1 && sent2);
+
+  ndn_forwarder_unregister_face(&up1.intf);
+  ndn_forwarder_unregister_face(&up2.intf);
+  ndn_forwarder_unregister_face(&downstream.intf);
+}
+
+/*
+ *                             +-- up1
+ *  downstream -- forwarder -- +
+ *                             +-- up2 (measured)
+ */
+void forwarder_adaptive_test()
+{
+  forwarder_nack_test_face_t up1, up2, downstream;
+  uint8_t prefix[64], data_buf[256];
+  size_t prefix_len;
+  ndn_name_t name;
+  ndn_data_t data;
+  ndn_encoder_t encoder;
+  ndn_measurement_t measurement;
+  const ndn_measurement_t* found;
+  const ndn_forwarder_t* forwarder;
+  ndn_fib_entry_t* fib_entry;
+  bool sent1, sent2;
+
+  // RFC 6298 estimation
+  measurement.srtt = NDN_MEASUREMENTS_NO_RTT;
+  CU_ASSERT_EQUAL(ndn_measurement_rto(NULL), NDN_RTO_INITIAL);
+  ndn_measurement_add_sample(&measurement, 100, 0);
+  CU_ASSERT_EQUAL(measurement.srtt, 100);
+  CU_ASSERT_EQUAL(measurement.rttvar, 50);
+  CU_ASSERT_EQUAL(ndn_measurement_rto(&measurement), 300);
+  ndn_measurement_add_sample(&measurement, 200, 0);
+  CU_ASSERT_EQUAL(measurement.srtt, 112);
+  CU_ASSERT_EQUAL(measurement.rttvar, 62);
+  ndn_measurement_backoff(&measurement);
+  CU_ASSERT_EQUAL(measurement.srtt, 224);
+  CU_ASSERT_EQUAL(ndn_measurement_rto(&measurement), 720);
+
+  ndn_forwarder_init();
+  forwarder = ndn_forwarder_get();
+  forwarder_nack_test_face_init(&up1);
+  forwarder_nack_test_face_init(&up2);
+  forwarder_nack_test_face_init(&downstream);
+  ndn_name_from_string(&name, "/a", strlen("/a"));
+  encoder_init(&encoder, prefix, sizeof(prefix));
+  ndn_name_tlv_encode(&encoder, &name);
+  prefix_len = encoder.offset;
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route(&up1.intf, prefix, prefix_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route(&up2.intf, prefix, prefix_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_set_strategy(prefix, prefix_len, &ndn_strategy_adaptive), NDN_SUCCESS);
+  fib_entry = ndn_fib_find(forwarder->fib, prefix, prefix_len);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(fib_entry);
+
+  // Without measurements, the cheapest face is used and the other one is probed
+  forwarder_strategy_test_send("/a/1", 0x01010101, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(sent1 && sent2);
+
+  // The Data of up2 gives it an RTT
+  memset(&data, 0, sizeof(data));
+  ndn_data_init(&data);
+  ndn_name_from_string(&data.name, "/a/1", strlen("/a/1"));
+  encoder_init(&encoder, data_buf, sizeof(data_buf));
+  CU_ASSERT_EQUAL(ndn_data_tlv_encode_digest_sign(&encoder, &data), 0);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up2.intf, data_buf, encoder.offset), NDN_SUCCESS);
+  found = ndn_measurements_find(&forwarder->fib->measurements, fib_entry->measurements, up2.intf.face_id);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(found);
+  CU_ASSERT_NOT_EQUAL(found->srtt, NDN_MEASUREMENTS_NO_RTT);
+  found = ndn_measurements_find(&forwarder->fib->measurements, fib_entry->measurements, up1.intf.face_id);
+  CU_ASSERT_PTR_NULL(found);
+
+  // The measured face is preferred; up1 is probed once, then left alone
+  forwarder_strategy_test_send("/a/2", 0x02020202, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(sent1 && sent2);
+  forwarder_strategy_test_send("/a/3", 0x03030303, &downstream, &up1, &up2, &sent1, &sent2);
+  CU_ASSERT_TRUE(!sent1 && sent2);
+
+  // up2 doesn't answer within its RTO, so the forwarder tries up1
+  up1.length = 0;
+  CU_ASSERT_TRUE(ndn_forwarder_next_deadline() <= ndn_time_now_ms() + NDN_RTO_MIN);
+  ndn_time_delay(NDN_RTO_MIN + 10);
+  ndn_forwarder_process();
+  CU_ASSERT_TRUE(up1.length > 0);
+
+  ndn_forwarder_unregister_face(&up1.intf);
+  ndn_forwarder_unregister_face(&up2.intf);
+  ndn_forwarder_unregister_face(&downstream.intf);
+}
+
+/** Send an Interest from a face, and get the result.
+ */
+static int
+forwarder_admission_test_send(forwarder_nack_test_face_t* face, const char* name, uint32_t nonce)
+{
+  uint8_t interest[256];
+  size_t interest_len = forwarder_nack_test_interest(name, nonce, interest, sizeof(interest));
+  return ndn_forwarder_receive(&face->intf, interest, interest_len);
+}
+
+/*
+ *  down1 --+
+ *          +-- forwarder (PIT of 4) -- up
+ *  down2 --+      |
+ *                app
+ */
+void forwarder_admission_test()
+{
+  forwarder_nack_test_face_t up, down1, down2;
+  ndn_forwarder_config_t config;
+  ndn_token_bucket_t bucket;
+  uint8_t interest[256];
+  size_t interest_len;
+  interest_options_t options;
+  ndn_parsed_name_t app_name;
+  const ndn_forwarder_t* forwarder;
+  char interest_name[16];
+  int i;
+
+  // 1 token per ms, 2 at most
+  ndn_token_bucket_init(&bucket, 1000, 2, 0);
+  CU_ASSERT_TRUE(ndn_token_bucket_consume(&bucket, 0));
+  CU_ASSERT_TRUE(ndn_token_bucket_consume(&bucket, 0));
+  CU_ASSERT_FALSE(ndn_token_bucket_consume(&bucket, 0));
+  CU_ASSERT_TRUE(ndn_token_bucket_consume(&bucket, 1));
+  CU_ASSERT_TRUE(ndn_token_bucket_consume(&bucket, 100));
+  CU_ASSERT_TRUE(ndn_token_bucket_consume(&bucket, 100));
+  CU_ASSERT_FALSE(ndn_token_bucket_consume(&bucket, 100));
+
+  ndn_forwarder_config_default(&config);
+  config.pit_size = 4;
+  config.pit_face_quota = 50;
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_init_with_config(&config), NDN_SUCCESS);
+  forwarder = ndn_forwarder_get();
+  forwarder_nack_test_face_init(&up);
+  forwarder_nack_test_face_init(&down1);
+  forwarder_nack_test_face_init(&down2);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&up.intf, "/o", strlen("/o")), NDN_SUCCESS);
+
+  // A face can take half of the PIT, and still refresh its own entries
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/1", 0x01010101), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/2", 0x02020202), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/3", 0x55555555), NDN_FWD_PIT_FULL);
+  forwarder_nack_test_check(&down1, NDN_NACK_REASON_CONGESTION, 0x55555555);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/1", 0x11111111), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder->counters.quota_shed, 1);
+  CU_ASSERT_EQUAL(forwarder->admission[down1.intf.face_id].quota_shed, 1);
+  CU_ASSERT_EQUAL(ndn_pit_face_entry_count(forwarder->pit, down1.intf.face_id), 2);
+
+  // The full PIT makes room for the application by evicting a forwarded entry
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down2, "/o/4", 0x04040404), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down2, "/o/5", 0x05050505), NDN_SUCCESS);
+  interest_len = forwarder_nack_test_interest("/o/app", 0x06060606, interest, sizeof(interest));
+  CU_ASSERT_EQUAL(ndn_forwarder_express_interest(interest, interest_len, on_data_callback2,
+                                                 NULL, NULL), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder->counters.pit_evicted, 1);
+  CU_ASSERT_EQUAL(ndn_pit_face_entry_count(forwarder->pit, down1.intf.face_id) +
+                  ndn_pit_face_entry_count(forwarder->pit, down2.intf.face_id), 3);
+
+  // Without a quota, a face keeps evicting, but never the application's entry
+  CU_ASSERT_EQUAL(ndn_forwarder_set_face_limits(&down2.intf, 0, 0, 1), NDN_SUCCESS);
+  for(i = 0; i < 6; i ++){
+    sprintf(interest_name, "/o/x%d", i);
+    CU_ASSERT_EQUAL(forwarder_admission_test_send(&down2, interest_name, 0x10101010 + i), NDN_SUCCESS);
+  }
+  CU_ASSERT_EQUAL(forwarder->counters.pit_evicted, 7);
+  CU_ASSERT_EQUAL(ndn_pit_face_entry_count(forwarder->pit, down1.intf.face_id), 0);
+  CU_ASSERT_EQUAL(ndn_pit_face_entry_count(forwarder->pit, down2.intf.face_id), 3);
+  tlv_interest_get_header_parsed(interest, interest_len, &options, &app_name);
+  CU_ASSERT_PTR_NOT_NULL(ndn_pit_find_parsed(forwarder->pit, &app_name));
+
+  // A rate limit of 1 Interest per second with a burst of 2
+  CU_ASSERT_EQUAL(ndn_forwarder_set_face_limits(&down1.intf, 0, 1, 2), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/r1", 0x21212121), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/r2", 0x22222222), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down1, "/o/r3", 0x23232323), NDN_FWD_INTEREST_REJECTED);
+  forwarder_nack_test_check(&down1, NDN_NACK_REASON_CONGESTION, 0x23232323);
+  CU_ASSERT_EQUAL(forwarder->counters.rate_shed, 1);
+  CU_ASSERT_EQUAL(forwarder->admission[down1.intf.face_id].rate_shed, 1);
+
+  ndn_forwarder_unregister_face(&up.intf);
+  ndn_forwarder_unregister_face(&down1.intf);
+  ndn_forwarder_unregister_face(&down2.intf);
+  ndn_forwarder_init();
+}
+
+/*
+ *  downstream -- forwarder -- /n upstream
+ */
+void forwarder_negative_cache_test()
+{
+  forwarder_nack_test_face_t up, down;
+  ndn_interest_t interest;
+  ndn_encoder_t encoder;
+  uint8_t buf[256], nack[300];
+  size_t nack_len;
+
+  ndn_forwarder_init();
+  forwarder_nack_test_face_init(&up);
+  forwarder_nack_test_face_init(&down);
+
+  // A name with no route is Nacked from the cache until a covering route is added
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/n/a", 0x01010101), NDN_FWD_NO_ROUTE);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/n/a", 0x02020202), NDN_FWD_NO_ROUTE);
+  forwarder_nack_test_check(&down, NDN_NACK_REASON_NO_ROUTE, 0x02020202);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&up.intf, "/n", strlen("/n")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/n/a", 0x03030303), NDN_SUCCESS);
+  CU_ASSERT_TRUE(up.length > 0);
+
+  // Congestion is not cached: the next Interest goes upstream again
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, sizeof(nack), up.packet, up.length,
+                                NDN_NACK_REASON_CONGESTION, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up.intf, nack, nack_len), NDN_SUCCESS);
+  forwarder_nack_test_check(&down, NDN_NACK_REASON_CONGESTION, 0x03030303);
+  up.length = 0;
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/n/a", 0x04040404), NDN_SUCCESS);
+  CU_ASSERT_TRUE(up.length > 0);
+
+  // A name Nacked by all upstreams for another reason is Nacked at once for a while
+  CU_ASSERT_EQUAL(tlv_make_nack(nack, sizeof(nack), up.packet, up.length,
+                                NDN_NACK_REASON_NO_ROUTE, &nack_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up.intf, nack, nack_len), NDN_SUCCESS);
+  up.length = 0;
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/n/a", 0x07070707), NDN_FWD_NO_ROUTE);
+  forwarder_nack_test_check(&down, NDN_NACK_REASON_NO_ROUTE, 0x07070707);
+  CU_ASSERT_EQUAL(up.length, 0);
+
+  // So is a name which expired unanswered
+  ndn_interest_init(&interest);
+  ndn_name_from_string(&interest.name, "/n/b", strlen("/n/b"));
+  interest.nonce = 0x05050505;
+  interest.lifetime = 20;
+  encoder_init(&encoder, buf, sizeof(buf));
+  CU_ASSERT_EQUAL(ndn_interest_tlv_encode(&encoder, &interest), 0);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&down.intf, buf, encoder.offset), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(up.length, encoder.offset);
+  ndn_time_delay(30);
+  ndn_forwarder_process();
+  up.length = 0;
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/n/b", 0x06060606), NDN_FWD_INTEREST_REJECTED);
+  forwarder_nack_test_check(&down, NDN_NACK_REASON_NONE, 0x06060606);
+  CU_ASSERT_EQUAL(up.length, 0);
+
+  ndn_forwarder_unregister_face(&up.intf);
+  ndn_forwarder_unregister_face(&down.intf);
+}
+
+/** Sends the faces of forwarder_queue_test can still take. -1 for no limit.
+ */
+static int forwarder_queue_test_budget = -1;
+
+static int
+forwarder_queue_test_face_send(struct ndn_face_intf* self, const uint8_t* packet, uint32_t size)
+{
+  if(forwarder_queue_test_budget == 0){
+    return NDN_FWD_FACE_DOWN;
+  }
+  if(forwarder_queue_test_budget > 0){
+    forwarder_queue_test_budget --;
+  }
+  return forwarder_nack_test_face_send(self, packet, size);
+}
+
+/** Encode a Data packet with no content.
+ */
+static size_t
+forwarder_queue_test_data(const char* name, uint8_t* buf, size_t buflen)
+{
+  ndn_data_t data;
+  ndn_encoder_t encoder;
+  memset(&data, 0, sizeof(data));
+  ndn_data_init(&data);
+  ndn_name_from_string(&data.name, name, strlen(name));
+  encoder_init(&encoder, buf, buflen);
+  CU_ASSERT_EQUAL(ndn_data_tlv_encode_digest_sign(&encoder, &data), 0);
+  return encoder.offset;
+}
+
+static ndn_face_queue_t forwarder_queue_test_queue;
+
+/*
+ *  downstream (queued) -- forwarder -- /q upstream
+ */
+void forwarder_queue_test()
+{
+  ndn_face_queue_t* queue = &forwarder_queue_test_queue;
+  forwarder_nack_test_face_t up, down;
+  uint8_t packet[8] = {0}, data[256], marked[300];
+  size_t length, data_len, marked_len;
+  uint8_t *fragment, reason;
+  size_t fragment_len;
+  ndn_time_ms_t now;
+  uint32_t offset;
+  bool nack;
+  int i, wraps;
+
+  // CoDel marks once packets waited above the target for an interval
+  ndn_face_queue_init(queue);
+  for(i = 0; i < NDN_FACE_QUEUE_SIZE; i ++){
+    CU_ASSERT_TRUE(ndn_face_queue_push(queue, packet, sizeof(packet), 0));
+  }
+  CU_ASSERT_FALSE(ndn_face_queue_push(queue, packet, sizeof(packet), 0));
+  CU_ASSERT_EQUAL(queue->dropped, 1);
+  CU_ASSERT_PTR_NOT_NULL(ndn_face_queue_front(queue, &length));
+  CU_ASSERT_EQUAL(length, sizeof(packet));
+  CU_ASSERT_FALSE(ndn_face_queue_should_mark(queue, NDN_CODEL_TARGET));
+  ndn_face_queue_pop(queue, NDN_CODEL_TARGET);
+  CU_ASSERT_FALSE(ndn_face_queue_should_mark(queue, NDN_CODEL_TARGET + NDN_CODEL_INTERVAL - 1));
+  ndn_face_queue_pop(queue, NDN_CODEL_TARGET + NDN_CODEL_INTERVAL - 1);
+  CU_ASSERT_TRUE(ndn_face_queue_should_mark(queue, NDN_CODEL_TARGET + NDN_CODEL_INTERVAL));
+  ndn_face_queue_pop(queue, NDN_CODEL_TARGET + NDN_CODEL_INTERVAL);
+  CU_ASSERT_TRUE(queue->marking);
+  CU_ASSERT_EQUAL(queue->marked, 1);
+  // The next mark comes an interval later, as the square root of 1 is 1
+  CU_ASSERT_FALSE(ndn_face_queue_should_mark(queue, NDN_CODEL_TARGET + 2 * NDN_CODEL_INTERVAL - 1));
+  ndn_face_queue_pop(queue, NDN_CODEL_TARGET + 2 * NDN_CODEL_INTERVAL - 1);
+  CU_ASSERT_TRUE(ndn_face_queue_should_mark(queue, NDN_CODEL_TARGET + 2 * NDN_CODEL_INTERVAL));
+  ndn_face_queue_pop(queue, NDN_CODEL_TARGET + 2 * NDN_CODEL_INTERVAL);
+  CU_ASSERT_EQUAL(queue->marked, 2);
+  // A short wait ends marking
+  CU_ASSERT_TRUE(ndn_face_queue_push(queue, packet, sizeof(packet), 1000));
+  while(!ndn_face_queue_is_empty(queue)){
+    ndn_face_queue_pop(queue, 1000);
+  }
+  CU_ASSERT_FALSE(queue->marking);
+
+  // A packet the face keeps refusing is dropped after the timeout
+  CU_ASSERT_TRUE(ndn_face_queue_push(queue, packet, sizeof(packet), 2000));
+  CU_ASSERT_TRUE(ndn_face_queue_push(queue, packet, sizeof(packet), 2000));
+  CU_ASSERT_FALSE(ndn_face_queue_refuse(queue, 2000));
+  CU_ASSERT_FALSE(ndn_face_queue_refuse(queue, 2000 + NDN_FACE_QUEUE_SEND_TIMEOUT - 1));
+  CU_ASSERT_TRUE(ndn_face_queue_refuse(queue, 2000 + NDN_FACE_QUEUE_SEND_TIMEOUT));
+  CU_ASSERT_EQUAL(queue->count, 1);
+  CU_ASSERT_EQUAL(queue->timed_out, 1);
+  // The next one has a timeout of its own
+  CU_ASSERT_FALSE(ndn_face_queue_refuse(queue, 2000 + NDN_FACE_QUEUE_SEND_TIMEOUT + 1));
+  ndn_face_queue_pop(queue, 2000 + NDN_FACE_QUEUE_SEND_TIMEOUT + 1);
+  CU_ASSERT_EQUAL(queue->drop_time, 0);
+
+  // Data are marked in place, also once the ring wrapped, and other packets are never marked
+  CU_ASSERT_TRUE(ndn_face_queue_push(queue, packet, sizeof(packet), 3000));
+  CU_ASSERT_PTR_NULL(ndn_face_queue_mark_front(queue, &length));
+  data_len = forwarder_queue_test_data("/q/0", data, sizeof(data));
+  CU_ASSERT_EQUAL(tlv_make_congestion_mark(marked, sizeof(marked), data, data_len, 1, &marked_len),
+                  NDN_SUCCESS);
+  ndn_face_queue_pop(queue, 3000);
+  offset = 0;
+  wraps = 0;
+  for(i = 0; i < 2 * NDN_FACE_QUEUE_BYTES / (int)data_len; i ++){
+    CU_ASSERT_TRUE(ndn_face_queue_push(queue, data, data_len, 3000));
+    if(queue->items[(queue->head + queue->count - 1) % NDN_FACE_QUEUE_SIZE].offset < offset){
+      wraps ++;
+    }
+    offset = queue->items[(queue->head + queue->count - 1) % NDN_FACE_QUEUE_SIZE].offset;
+    if(queue->count < NDN_FACE_QUEUE_SIZE / 2){
+      continue;
+    }
+    fragment = ndn_face_queue_mark_front(queue, &length);
+    CU_ASSERT_EQUAL(length, marked_len);
+    CU_ASSERT_EQUAL(memcmp(fragment, marked, marked_len), 0);
+    fragment = ndn_face_queue_front(queue, &length);
+    CU_ASSERT_EQUAL(length, data_len);
+    CU_ASSERT_EQUAL(memcmp(fragment, data, data_len), 0);
+    ndn_face_queue_pop(queue, 3000);
+  }
+  CU_ASSERT_TRUE(wraps > 0);
+  CU_ASSERT_EQUAL(queue->dropped, 1);
+  while(!ndn_face_queue_is_empty(queue)){
+    ndn_face_queue_pop(queue, 3000);
+  }
+
+  ndn_forwarder_init();
+  forwarder_nack_test_face_init(&up);
+  forwarder_nack_test_face_init(&down);
+  down.intf.send = forwarder_queue_test_face_send;
+  CU_ASSERT_EQUAL(ndn_forwarder_set_face_queue(&down.intf, queue), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&up.intf, "/q", strlen("/q")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/q/1", 0x01010101), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/q/2", 0x02020202), NDN_SUCCESS);
+
+  // Data waits while the downstream is busy, and keeps its order
+  forwarder_queue_test_budget = 0;
+  now = ndn_time_now_ms();
+  data_len = forwarder_queue_test_data("/q/1", data, sizeof(data));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up.intf, data, data_len), NDN_SUCCESS);
+  data_len = forwarder_queue_test_data("/q/2", data, sizeof(data));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up.intf, data, data_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(queue->count, 2);
+  // The busy face is retried after a while instead of at once
+  CU_ASSERT_TRUE(ndn_forwarder_next_deadline() >= now + NDN_FACE_QUEUE_RETRY_INTERVAL);
+  CU_ASSERT_TRUE(ndn_forwarder_next_deadline() <= ndn_time_now_ms() + NDN_FACE_QUEUE_RETRY_INTERVAL);
+  ndn_forwarder_process();
+  CU_ASSERT_EQUAL(queue->count, 2);
+  CU_ASSERT_EQUAL(down.length, 0);
+
+  // The first one sets off CoDel, and the second one, after an interval, is marked
+  ndn_time_delay(NDN_CODEL_TARGET + 5);
+  forwarder_queue_test_budget = 1;
+  ndn_forwarder_process();
+  CU_ASSERT_EQUAL(queue->count, 1);
+  CU_ASSERT_EQUAL(tlv_lp_packet_get_congestion_mark(down.packet, down.length), 0);
+  ndn_time_delay(NDN_CODEL_INTERVAL + 10);
+  forwarder_queue_test_budget = -1;
+  ndn_forwarder_process();
+  CU_ASSERT_TRUE(ndn_face_queue_is_empty(queue));
+  CU_ASSERT_EQUAL(queue->marked, 1);
+  CU_ASSERT_TRUE(tlv_lp_packet_get_congestion_mark(down.packet, down.length) > 0);
+  CU_ASSERT_EQUAL(tlv_lp_packet_parse(down.packet, down.length, &fragment, &fragment_len,
+                                      &nack, &reason), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(fragment_len, data_len);
+  CU_ASSERT_EQUAL(memcmp(fragment, data, data_len), 0);
+
+  // Marked Data from an upstream is forwarded without the mark
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/q/3", 0x03030303), NDN_SUCCESS);
+  data_len = forwarder_queue_test_data("/q/3", data, sizeof(data));
+  CU_ASSERT_EQUAL(tlv_make_congestion_mark(marked, sizeof(marked), data, data_len, 1, &marked_len),
+                  NDN_SUCCESS);
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up.intf, marked, marked_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(down.length, data_len);
+  CU_ASSERT_EQUAL(memcmp(down.packet, data, data_len), 0);
+
+  ndn_forwarder_unregister_face(&up.intf);
+  ndn_forwarder_unregister_face(&down.intf);
+}
+
+/*
+ *  downstream -- forwarder -- /b upstream
+ */
+void forwarder_batch_test()
+{
+  forwarder_nack_test_face_t up, down;
+  uint8_t data1[256], data2[256], bad[4] = {0};
+  uint8_t* packets[3] = {data1, bad, data2};
+  size_t lengths[3];
+
+  ndn_forwarder_init();
+  forwarder_nack_test_face_init(&up);
+  forwarder_nack_test_face_init(&down);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&up.intf, "/b", strlen("/b")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/b/1", 0x01010101), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/b/2", 0x02020202), NDN_SUCCESS);
+
+  // A malformed packet in the middle doesn't stop the batch, and the last Data is sent last
+  lengths[0] = forwarder_queue_test_data("/b/1", data1, sizeof(data1));
+  lengths[1] = sizeof(bad);
+  lengths[2] = forwarder_queue_test_data("/b/2", data2, sizeof(data2));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive_batch(&up.intf, packets, lengths, 3), 2);
+  CU_ASSERT_EQUAL(down.length, lengths[2]);
+  CU_ASSERT_EQUAL(memcmp(down.packet, data2, lengths[2]), 0);
+  CU_ASSERT_EQUAL(ndn_pit_face_entry_count(ndn_forwarder_get()->pit, down.intf.face_id), 0);
+
+  ndn_forwarder_unregister_face(&up.intf);
+  ndn_forwarder_unregister_face(&down.intf);
+}
+
+/*
+ *  downstream -- forwarder (with CS) -- /c upstream
+ */
+void forwarder_cs_test()
+{
+  forwarder_nack_test_face_t up, down;
+  ndn_forwarder_config_t config;
+  uint8_t data[256], interest[256];
+  size_t data_len, interest_len;
+  interest_options_t options;
+  ndn_parsed_name_t name;
+
+  // The content store is left out unless it is given a size
+  ndn_forwarder_init();
+  if(NDN_CS_MAX_SIZE < NDN_CS_PAGE_SIZE){
+    CU_ASSERT_PTR_NULL(ndn_forwarder_get()->cs);
+  }
+
+  ndn_forwarder_config_default(&config);
+  config.cs_size = NDN_CS_PAGE_SIZE;
+  config.alloc = ndn_posix_alloc;
+  config.free = ndn_posix_free;
+  CU_ASSERT_EQUAL_FATAL(ndn_forwarder_init_with_config(&config), NDN_SUCCESS);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ndn_forwarder_get()->cs);
+  forwarder_nack_test_face_init(&up);
+  forwarder_nack_test_face_init(&down);
+  CU_ASSERT_EQUAL(ndn_forwarder_add_route_by_str(&up.intf, "/c", strlen("/c")), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/c/1", 0x01010101), NDN_SUCCESS);
+  data_len = forwarder_queue_test_data("/c/1", data, sizeof(data));
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&up.intf, data, data_len), NDN_SUCCESS);
+
+  // The Interest asked again is answered from the CS, and the upstream doesn't see it
+  up.length = 0;
+  down.length = 0;
+  CU_ASSERT_EQUAL(forwarder_admission_test_send(&down, "/c/1", 0x02020202), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(up.length, 0);
+  CU_ASSERT_EQUAL(down.length, data_len);
+  CU_ASSERT_EQUAL(memcmp(down.packet, data, data_len), 0);
+
+  // Even if the name was Nacked since
+  interest_len = forwarder_nack_test_interest("/c/1", 0x03030303, interest, sizeof(interest));
+  CU_ASSERT_EQUAL(tlv_interest_get_header_parsed(interest, interest_len, &options, &name), NDN_SUCCESS);
+  ndn_negative_cache_add(&ndn_forwarder_get()->pit->negative_cache, name.hash,
+                         NDN_NACK_REASON_NO_ROUTE, ndn_time_now_ms());
+  down.length = 0;
+  CU_ASSERT_EQUAL(ndn_forwarder_receive(&down.intf, interest, interest_len), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(down.length, data_len);
+
+  ndn_forwarder_unregister_face(&up.intf);
+  ndn_forwarder_unregister_face(&down.intf);
+  ndn_forwarder_init();
+}
+
 void add_forwarder_test_suite()
 {
   CU_pSuite pSuite = NULL;
@@ -522,7 +1321,16 @@ void add_forwarder_test_suite()
   }
   if (NULL == CU_add_test(pSuite, "forwarder_tests", (void (*)(void))run_forwarder_tests) ||
       NULL == CU_add_test(pSuite, "forwarder_put_data_test", forwarder_put_data_test) ||
-      NULL == CU_add_test(pSuite, "forwarder_pointer_test", forwarder_pointer_test))
+      NULL == CU_add_test(pSuite, "forwarder_pointer_test", forwarder_pointer_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_config_test", forwarder_config_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_cs_test", forwarder_cs_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_nack_test", forwarder_nack_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_strategy_test", forwarder_strategy_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_adaptive_test", forwarder_adaptive_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_admission_test", forwarder_admission_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_negative_cache_test", forwarder_negative_cache_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_queue_test", forwarder_queue_test) ||
+      NULL == CU_add_test(pSuite, "forwarder_batch_test", forwarder_batch_test))
   {
     CU_cleanup_registry();
     // return CU_get_error();
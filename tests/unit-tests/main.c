@@ -23,6 +23,9 @@
 #include "hmac/hmac-tests.h"
 #include "metainfo/metainfo-tests.h"
 #include "name-encode-decode/name-encode-decode-tests.h"
+#include "pit/pit-tests.h"
+#include "cs/cs-tests.h"
+#include "faceset/faceset-tests.h"
 #include "random/random-tests.h"
 #include "schematized-trust/trust-schema-tests.h"
 // #include "service-discovery/service-discovery-tests.h"
@@ -46,6 +49,9 @@ int main() {
     add_hmac_test_suite();
     add_metainfo_test_suite();
     add_name_encode_decode_test_suite();
+    add_pit_test_suite();
+    add_cs_test_suite();
+    add_faceset_test_suite();
     add_random_test_suite();
     add_sign_verify_test_suite();
     add_signature_test_suite();
@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2018 Zhiyi Zhang, Tianyuan Yu, Edward Lu, Hanwen Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include "pit-tests.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "../CUnit/CUnit.h"
+
+#include "ndn-lite/ndn-constants.h"
+#include "ndn-lite/ndn-error-code.h"
+#include "ndn-lite/encode/name.h"
+#include "ndn-lite/encode/forwarder-helper.h"
+#include "ndn-lite/forwarder/pit.h"
+#include "ndn-lite/forwarder/name-tree.h"
+
+#define PIT_TEST_CAPACITY 4
+
+static uint8_t pit_test_nametree[NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE)];
+static uint8_t pit_test_memory[NDN_PIT_RESERVE_SIZE(PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE)];
+static uint8_t pit_test_empty_memory[NDN_PIT_RESERVE_SIZE(0, NDN_FACE_TABLE_MAX_SIZE)];
+
+static size_t
+pit_test_encode_name(const char* str, uint8_t* buf, size_t buflen)
+{
+  ndn_name_t name;
+  ndn_encoder_t encoder;
+  int ret_val = ndn_name_from_string(&name, str, strlen(str));
+  CU_ASSERT_EQUAL(ret_val, 0);
+  encoder_init(&encoder, buf, buflen);
+  ndn_name_tlv_encode(&encoder, &name);
+  return encoder.offset;
+}
+
+void run_pit_test_1(void) {
+  uint8_t name1[64], name2[64], name3[64];
+  size_t len1, len2, len3;
+  ndn_pit_entry_t *entry1, *entry2, *ret_entry;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+
+  len1 = pit_test_encode_name("/ucla/cs", name1, sizeof(name1));
+  len2 = pit_test_encode_name("/ucla/cs/ndn", name2, sizeof(name2));
+  len3 = pit_test_encode_name("/ucla/ee/ndn", name3, sizeof(name3));
+
+  // insert and exact match
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, name1, len1));
+  entry1 = ndn_pit_find_or_insert(pit, name1, len1);
+  CU_ASSERT_PTR_NOT_NULL(entry1);
+  CU_ASSERT_FALSE(ndn_pit_entry_is_empty(entry1));
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find_or_insert(pit, name1, len1), entry1);
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, name1, len1), entry1);
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, name2, len2));
+
+  // longest prefix match
+  ret_entry = ndn_pit_prefix_match(pit, name2, len2);
+  CU_ASSERT_PTR_EQUAL(ret_entry, entry1);
+  entry2 = ndn_pit_find_or_insert(pit, name2, len2);
+  CU_ASSERT_PTR_NOT_NULL(entry2);
+  CU_ASSERT_PTR_NOT_EQUAL(entry2, entry1);
+  ret_entry = ndn_pit_prefix_match(pit, name2, len2);
+  CU_ASSERT_PTR_EQUAL(ret_entry, entry2);
+  CU_ASSERT_PTR_NULL(ndn_pit_prefix_match(pit, name3, len3));
+
+  // remove
+  ndn_pit_remove_entry(pit, entry1);
+  CU_ASSERT_TRUE(ndn_pit_entry_is_empty(entry1));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, name1, len1));
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, name2, len2), entry2);
+  CU_ASSERT_PTR_EQUAL(ndn_pit_prefix_match(pit, name2, len2), entry2);
+}
+
+void run_pit_test_full(void) {
+  uint8_t name[64];
+  size_t len;
+  char name_str[32];
+  ndn_pit_entry_t *entries[PIT_TEST_CAPACITY];
+  int i;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+
+  for(i = 0; i < PIT_TEST_CAPACITY; i ++){
+    sprintf(name_str, "/full/%d", i);
+    len = pit_test_encode_name(name_str, name, sizeof(name));
+    entries[i] = ndn_pit_find_or_insert(pit, name, len);
+    CU_ASSERT_PTR_NOT_NULL(entries[i]);
+  }
+  len = pit_test_encode_name("/full/extra", name, sizeof(name));
+  CU_ASSERT_PTR_NULL(ndn_pit_find_or_insert(pit, name, len));
+
+  // A removed entry is reused
+  ndn_pit_remove_entry(pit, entries[1]);
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find_or_insert(pit, name, len), entries[1]);
+  for(i = 0; i < PIT_TEST_CAPACITY; i ++){
+    if(i == 1){
+      continue;
+    }
+    sprintf(name_str, "/full/%d", i);
+    len = pit_test_encode_name(name_str, name, sizeof(name));
+    CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, name, len), entries[i]);
+  }
+
+  // A PIT with no entries stays within its memory and takes nothing
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_empty_memory, 0, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  pit = (ndn_pit_t*)pit_test_empty_memory;
+  CU_ASSERT_PTR_NULL(ndn_pit_find_or_insert(pit, name, len));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, name, len));
+}
+
+static int pit_test_timeout_count;
+
+static void
+pit_test_on_data(const uint8_t* data, uint32_t data_size, void* userdata)
+{
+  (void)data;
+  (void)data_size;
+  (void)userdata;
+}
+
+static void
+pit_test_on_timeout(void* userdata)
+{
+  (void)userdata;
+  pit_test_timeout_count ++;
+}
+
+void run_pit_test_timeout(void) {
+  uint8_t name[64];
+  size_t len;
+  ndn_pit_entry_t *app_entry, *fwd_entry;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+  pit_test_timeout_count = 0;
+  CU_ASSERT_EQUAL(ndn_pit_next_expiry(pit), NDN_PIT_NO_EXPIRY);
+
+  // Expressed by the application at 1000 with lifetime 100
+  len = pit_test_encode_name("/timeout/app", name, sizeof(name));
+  app_entry = ndn_pit_find_or_insert(pit, name, len);
+  app_entry->options.lifetime = 100;
+  app_entry->on_data = pit_test_on_data;
+  app_entry->on_timeout = pit_test_on_timeout;
+  app_entry->last_time = app_entry->express_time = 1000;
+  ndn_pit_refresh_expiry(pit, app_entry);
+
+  // Received from a face at 1000 with lifetime 50, then again at 1040
+  len = pit_test_encode_name("/timeout/fwd", name, sizeof(name));
+  fwd_entry = ndn_pit_find_or_insert(pit, name, len);
+  fwd_entry->options.lifetime = 50;
+  fwd_entry->last_time = 1000;
+  ndn_pit_refresh_expiry(pit, fwd_entry);
+  CU_ASSERT_EQUAL(ndn_pit_next_expiry(pit), 1050);
+  fwd_entry->last_time = 1040;
+  ndn_pit_refresh_expiry(pit, fwd_entry);
+  CU_ASSERT_EQUAL(ndn_pit_next_expiry(pit), 1090);
+
+  ndn_pit_process_timeouts(pit, 1089);
+  CU_ASSERT_FALSE(ndn_pit_entry_is_empty(fwd_entry));
+  ndn_pit_process_timeouts(pit, 1090);
+  CU_ASSERT_TRUE(ndn_pit_entry_is_empty(fwd_entry));
+  CU_ASSERT_FALSE(ndn_pit_entry_is_empty(app_entry));
+  CU_ASSERT_EQUAL(ndn_pit_next_expiry(pit), 1100);
+
+  // The application is notified exactly once, then the entry is removed
+  ndn_pit_process_timeouts(pit, 1100);
+  CU_ASSERT_EQUAL(pit_test_timeout_count, 1);
+  CU_ASSERT_TRUE(ndn_pit_entry_is_empty(app_entry));
+  CU_ASSERT_EQUAL(ndn_pit_next_expiry(pit), NDN_PIT_NO_EXPIRY);
+  ndn_pit_process_timeouts(pit, 2000);
+  CU_ASSERT_EQUAL(pit_test_timeout_count, 1);
+}
+
+void run_pit_test_unregister_face(void) {
+  uint8_t names[PIT_TEST_CAPACITY][64];
+  size_t lens[PIT_TEST_CAPACITY];
+  ndn_pit_entry_t* entries[PIT_TEST_CAPACITY];
+  interest_options_t options;
+  ndn_table_id_t face, free_record;
+  int i;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+
+  lens[0] = pit_test_encode_name("/face/a", names[0], sizeof(names[0]));
+  lens[1] = pit_test_encode_name("/face/b", names[1], sizeof(names[1]));
+  lens[2] = pit_test_encode_name("/face/c", names[2], sizeof(names[2]));
+  lens[3] = pit_test_encode_name("/face/d", names[3], sizeof(names[3]));
+  memset(&options, 0, sizeof(options));
+  options.lifetime = 100;
+
+  // a: {1, 2}, b: {1}, c: {2}
+  for(i = 0; i < 3; i ++){
+    entries[i] = ndn_pit_find_or_insert(pit, names[i], lens[i]);
+    CU_ASSERT_PTR_NOT_NULL(entries[i]);
+  }
+  ndn_pit_add_incoming_face(pit, entries[0], 1);
+  ndn_pit_add_incoming_face(pit, entries[0], 2);
+  ndn_pit_add_incoming_face(pit, entries[0], 2);
+  ndn_pit_add_incoming_face(pit, entries[1], 1);
+  ndn_pit_add_incoming_face(pit, entries[2], 2);
+
+  ndn_pit_unregister_face(pit, 1);
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, names[0], lens[0]), entries[0]);
+  CU_ASSERT_FALSE(ndn_faceset_contains(&entries[0]->incoming_faces, 1));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[1], lens[1]));
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, names[2], lens[2]), entries[2]);
+  ndn_pit_unregister_face(pit, 2);
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[0], lens[0]));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[2], lens[2]));
+
+  // An upstream-only face leaves with its out-record, even one the pool had no room for
+  entries[0] = ndn_pit_find_or_insert(pit, names[0], lens[0]);
+  ndn_pit_add_incoming_face(pit, entries[0], 1);
+  CU_ASSERT_PTR_NOT_NULL(ndn_pit_insert_out_record(pit, entries[0], 3, &options, 1000));
+  free_record = pit->free_record;
+  pit->free_record = NDN_INVALID_ID;
+  CU_ASSERT_PTR_NULL(ndn_pit_insert_out_record(pit, entries[0], 4, &options, 1000));
+  pit->free_record = free_record;
+  CU_ASSERT_TRUE(ndn_faceset_contains(&entries[0]->outgoing_faces, 4));
+  ndn_pit_unregister_face(pit, 3);
+  ndn_pit_unregister_face(pit, 4);
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, names[0], lens[0]), entries[0]);
+  CU_ASSERT_TRUE(ndn_faceset_is_empty(&entries[0]->outgoing_faces));
+  CU_ASSERT_PTR_NULL(ndn_pit_find_record(pit, entries[0]->out_records, 3));
+  CU_ASSERT_EQUAL(ndn_face_index_first(&pit->face_index, 3), NDN_INVALID_ID);
+  CU_ASSERT_EQUAL(ndn_face_index_first(&pit->face_index, 4), NDN_INVALID_ID);
+  ndn_pit_unregister_face(pit, 1);
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[0], lens[0]));
+
+  // More links than the pool holds fall back to a scan
+  for(i = 0; i < PIT_TEST_CAPACITY; i ++){
+    entries[i] = ndn_pit_find_or_insert(pit, names[i], lens[i]);
+    CU_ASSERT_PTR_NOT_NULL(entries[i]);
+    for(face = 0; face <= NDN_MAX_FACE_PER_PIT_ENTRY; face ++){
+      ndn_pit_add_incoming_face(pit, entries[i], face);
+    }
+  }
+  CU_ASSERT_FALSE(ndn_faceset_is_empty(&pit->face_index.overflow));
+  for(face = 0; face <= NDN_MAX_FACE_PER_PIT_ENTRY; face ++){
+    ndn_pit_unregister_face(pit, face);
+  }
+  for(i = 0; i < PIT_TEST_CAPACITY; i ++){
+    CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[i], lens[i]));
+  }
+  CU_ASSERT_TRUE(ndn_faceset_is_empty(&pit->face_index.overflow));
+}
+
+void run_pit_test_match_data(void) {
+  uint8_t name1[64], name2[64], name3[64], name4[64], long_name[2 + 3 * 40];
+  size_t len1, len2, len3, len4;
+  ndn_parsed_name_t parsed;
+  ndn_pit_entry_t *entry1, *entry2, *entry3;
+  ndn_pit_entry_t *matches[NDN_PIT_MAX_MATCHES];
+  size_t count;
+  int i;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+
+  len1 = pit_test_encode_name("/ucla", name1, sizeof(name1));
+  len2 = pit_test_encode_name("/ucla/cs", name2, sizeof(name2));
+  len3 = pit_test_encode_name("/ucla/cs/ndn", name3, sizeof(name3));
+  len4 = pit_test_encode_name("/ucla/ee", name4, sizeof(name4));
+  entry1 = ndn_pit_find_or_insert(pit, name1, len1);
+  entry1->options.can_be_prefix = true;
+  CU_ASSERT_EQUAL(tlv_name_parse(name2, len2, &parsed), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(parsed.count, 2);
+  entry2 = ndn_pit_find_or_insert_parsed(pit, &parsed);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry2);
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, name2, len2), entry2);
+  entry2->options.can_be_prefix = false;
+
+  // Every entry must match exactly unless it has CanBePrefix
+  count = ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES);
+  CU_ASSERT_EQUAL(count, 2);
+  CU_ASSERT_PTR_EQUAL(matches[0], entry1);
+  CU_ASSERT_PTR_EQUAL(matches[1], entry2);
+  tlv_name_parse(name3, len3, &parsed);
+  count = ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES);
+  CU_ASSERT_EQUAL(count, 1);
+  CU_ASSERT_PTR_EQUAL(matches[0], entry1);
+  entry2->options.can_be_prefix = true;
+  count = ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES);
+  CU_ASSERT_EQUAL(count, 2);
+  CU_ASSERT_PTR_EQUAL(matches[1], entry2);
+  CU_ASSERT_EQUAL(ndn_pit_match_data(pit, &parsed, matches, 1), 1);
+  CU_ASSERT_PTR_EQUAL(matches[0], entry1);
+  tlv_name_parse(name4, len4, &parsed);
+  count = ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES);
+  CU_ASSERT_EQUAL(count, 1);
+  CU_ASSERT_PTR_EQUAL(matches[0], entry1);
+  entry1->options.can_be_prefix = false;
+  CU_ASSERT_EQUAL(ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES), 0);
+
+  // Names longer than NDN_FWD_NAME_MAX_COMPONENTS
+  long_name[0] = TLV_Name;
+  long_name[1] = 3 * 40;
+  for(i = 0; i < 40; i ++){
+    long_name[2 + 3 * i] = TLV_GenericNameComponent;
+    long_name[3 + 3 * i] = 1;
+    long_name[4 + 3 * i] = 'a' + i % 26;
+  }
+  CU_ASSERT_EQUAL(tlv_name_parse(long_name, sizeof(long_name), &parsed), NDN_SUCCESS);
+  CU_ASSERT_EQUAL(parsed.count, 40);
+  CU_ASSERT_EQUAL(ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES), 0);
+  entry3 = ndn_pit_find_or_insert_parsed(pit, &parsed);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry3);
+  CU_ASSERT_EQUAL(ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES), 1);
+  CU_ASSERT_PTR_EQUAL(matches[0], entry3);
+  long_name[sizeof(long_name) - 1] = 'z';
+  tlv_name_parse(long_name, sizeof(long_name), &parsed);
+  CU_ASSERT_EQUAL(ndn_pit_match_data(pit, &parsed, matches, NDN_PIT_MAX_MATCHES), 0);
+
+  // Truncated names are rejected
+  CU_ASSERT_NOT_EQUAL(tlv_name_parse(long_name, sizeof(long_name) - 1, &parsed), NDN_SUCCESS);
+}
+
+void run_pit_test_records(void) {
+  uint8_t name[64];
+  size_t len;
+  ndn_parsed_name_t parsed;
+  interest_options_t options = {.lifetime = 1000, .nonce = 0x1234, .hop_limit = 8};
+  ndn_pit_entry_t *entry;
+  ndn_pit_record_t *record;
+  int i;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+
+  len = pit_test_encode_name("/records/a", name, sizeof(name));
+  CU_ASSERT_EQUAL(tlv_name_parse(name, len, &parsed), NDN_SUCCESS);
+  entry = ndn_pit_find_or_insert_parsed(pit, &parsed);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+
+  // Every downstream keeps its own nonce
+  record = ndn_pit_insert_in_record(pit, entry, 1, &options, 100);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(record);
+  CU_ASSERT_EQUAL(record->expiry, 1100);
+  CU_ASSERT_EQUAL(record->hop_limit, 8);
+  options.nonce = 0x5678;
+  CU_ASSERT_PTR_NOT_NULL(ndn_pit_insert_in_record(pit, entry, 2, &options, 200));
+  CU_ASSERT_TRUE(ndn_faceset_contains(&entry->incoming_faces, 2));
+  CU_ASSERT_PTR_EQUAL(ndn_pit_insert_in_record(pit, entry, 1, &options, 300), record);
+  CU_ASSERT_EQUAL(record->nonce, 0x5678);
+  CU_ASSERT_EQUAL(ndn_pit_check_nonce(pit, entry, 1, 0x5678), NDN_PIT_NONCE_LOOP);
+  options.nonce = 0x1234;
+  ndn_pit_insert_in_record(pit, entry, 1, &options, 300);
+  CU_ASSERT_EQUAL(ndn_pit_check_nonce(pit, entry, 1, 0x1234), NDN_PIT_NONCE_SAME_FACE);
+  CU_ASSERT_EQUAL(ndn_pit_check_nonce(pit, entry, 2, 0x1234), NDN_PIT_NONCE_LOOP);
+  CU_ASSERT_EQUAL(ndn_pit_check_nonce(pit, entry, 3, 0x9ABC), NDN_PIT_NONCE_NEW);
+
+  // A nonce sent upstream coming back is a loop
+  ndn_pit_insert_out_record(pit, entry, 3, &options, 300);
+  CU_ASSERT_TRUE(ndn_faceset_contains(&entry->outgoing_faces, 3));
+  CU_ASSERT_EQUAL(ndn_pit_check_nonce(pit, entry, 3, 0x1234), NDN_PIT_NONCE_LOOP);
+  ndn_pit_expire_out_records(pit, entry, 1299);
+  CU_ASSERT_TRUE(ndn_faceset_contains(&entry->outgoing_faces, 3));
+  ndn_pit_expire_out_records(pit, entry, 1300);
+  CU_ASSERT_FALSE(ndn_faceset_contains(&entry->outgoing_faces, 3));
+  CU_ASSERT_PTR_NULL(ndn_pit_find_record(pit, entry->out_records, 3));
+  CU_ASSERT_TRUE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x1234, 1300));
+
+  // Removing a face drops its records
+  ndn_pit_unregister_face(pit, 1);
+  CU_ASSERT_PTR_NULL(ndn_pit_find_record(pit, entry->in_records, 1));
+  CU_ASSERT_PTR_NOT_NULL(ndn_pit_find_record(pit, entry->in_records, 2));
+
+  // Nonces sent by a removed entry are dead until their lifetime passes
+  options.nonce = 0x4321;
+  ndn_pit_insert_out_record(pit, entry, 3, &options, 400);
+  ndn_pit_remove_entry(pit, entry);
+  CU_ASSERT_TRUE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x4321, 401));
+  CU_ASSERT_FALSE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x5678, 401));
+  CU_ASSERT_FALSE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x4321, 400 + NDN_DEAD_NONCE_LIFETIME));
+
+  // The oldest dead nonces are dropped when the list is full, and all records are free again
+  for(i = 0; i < NDN_DEAD_NONCE_LIST_SIZE; i ++){
+    entry = ndn_pit_find_or_insert_parsed(pit, &parsed);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+    options.nonce = 0x10000 + i;
+    ndn_pit_insert_in_record(pit, entry, 1, &options, 500);
+    ndn_pit_insert_out_record(pit, entry, 2, &options, 500);
+    ndn_pit_remove_entry(pit, entry);
+  }
+  CU_ASSERT_FALSE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x4321, 501));
+  CU_ASSERT_TRUE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x10000, 501));
+  CU_ASSERT_TRUE(ndn_pit_is_dead_nonce(pit, parsed.hash, 0x10000 + NDN_DEAD_NONCE_LIST_SIZE - 1, 501));
+  for(i = 0; i < NDN_PIT_RECORD_COUNT(PIT_TEST_CAPACITY); i ++){
+    CU_ASSERT_NOT_EQUAL(pit->free_record, NDN_INVALID_ID);
+    pit->free_record = pit->records[pit->free_record].next;
+  }
+  CU_ASSERT_EQUAL(pit->free_record, NDN_INVALID_ID);
+}
+
+void run_pit_test_evict(void) {
+  uint8_t names[PIT_TEST_CAPACITY][64];
+  size_t lens[PIT_TEST_CAPACITY];
+  ndn_pit_entry_t* entries[PIT_TEST_CAPACITY];
+  const ndn_time_ms_t lifetimes[PIT_TEST_CAPACITY] = {50, 500, 4000, 100};
+  const ndn_time_ms_t times[PIT_TEST_CAPACITY] = {900, 1000, 1010, 1020};
+  int i;
+
+  ndn_nametree_init(pit_test_nametree, NDN_NAMETREE_MAX_SIZE);
+  ndn_pit_init(pit_test_memory, PIT_TEST_CAPACITY, NDN_FACE_TABLE_MAX_SIZE, (ndn_nametree_t*)pit_test_nametree);
+  ndn_pit_t *pit = (ndn_pit_t*)pit_test_memory;
+
+  lens[0] = pit_test_encode_name("/evict/app", names[0], sizeof(names[0]));
+  lens[1] = pit_test_encode_name("/evict/b", names[1], sizeof(names[1]));
+  lens[2] = pit_test_encode_name("/evict/c", names[2], sizeof(names[2]));
+  lens[3] = pit_test_encode_name("/evict/d", names[3], sizeof(names[3]));
+  for(i = 0; i < PIT_TEST_CAPACITY; i ++){
+    entries[i] = ndn_pit_find_or_insert(pit, names[i], lens[i]);
+    CU_ASSERT_PTR_NOT_NULL(entries[i]);
+    entries[i]->options.lifetime = lifetimes[i];
+    if(i == 0){
+      entries[i]->on_data = pit_test_on_data;
+      entries[i]->on_timeout = pit_test_on_timeout;
+      entries[i]->express_time = times[i];
+    }
+    ndn_pit_touch(pit, entries[i], times[i]);
+  }
+  // Received again: b (1530) is now newer than c (5010) and d (1120)
+  ndn_pit_touch(pit, entries[1], 1030);
+  CU_ASSERT_FALSE(ndn_pit_evict(pit, NDN_PIT_EVICT_NONE));
+
+  // The application's entry is the oldest and expires first, but is never evicted
+  CU_ASSERT_TRUE(ndn_pit_evict(pit, NDN_PIT_EVICT_OLDEST));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[2], lens[2]));
+  CU_ASSERT_TRUE(ndn_pit_evict(pit, NDN_PIT_EVICT_NEAREST_EXPIRY));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[3], lens[3]));
+  CU_ASSERT_TRUE(ndn_pit_evict(pit, NDN_PIT_EVICT_OLDEST));
+  CU_ASSERT_PTR_NULL(ndn_pit_find(pit, names[1], lens[1]));
+  CU_ASSERT_FALSE(ndn_pit_evict(pit, NDN_PIT_EVICT_OLDEST));
+  CU_ASSERT_FALSE(ndn_pit_evict(pit, NDN_PIT_EVICT_NEAREST_EXPIRY));
+  CU_ASSERT_PTR_EQUAL(ndn_pit_find(pit, names[0], lens[0]), entries[0]);
+
+  // Freed entries leave the list
+  entries[1] = ndn_pit_find_or_insert(pit, names[1], lens[1]);
+  ndn_pit_touch(pit, entries[1], 2000);
+  CU_ASSERT_EQUAL(pit->lru_tail, entries[1] - &pit->slots[0]);
+  CU_ASSERT_TRUE(ndn_pit_evict(pit, NDN_PIT_EVICT_NEAREST_EXPIRY));
+  CU_ASSERT_EQUAL(pit->lru_head, entries[0] - &pit->slots[0]);
+  CU_ASSERT_EQUAL(pit->lru_tail, entries[0] - &pit->slots[0]);
+}
+
+void add_pit_test_suite()
+{
+  CU_pSuite pSuite = NULL;
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("PIT Test", NULL, NULL);
+  if (NULL == pSuite)
+  {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+  if (NULL == CU_add_test(pSuite, "pit_test_1", run_pit_test_1) ||
+      NULL == CU_add_test(pSuite, "pit_test_full", run_pit_test_full) ||
+      NULL == CU_add_test(pSuite, "pit_test_timeout", run_pit_test_timeout) ||
+      NULL == CU_add_test(pSuite, "pit_test_unregister_face", run_pit_test_unregister_face) ||
+      NULL == CU_add_test(pSuite, "pit_test_match_data", run_pit_test_match_data) ||
+      NULL == CU_add_test(pSuite, "pit_test_records", run_pit_test_records) ||
+      NULL == CU_add_test(pSuite, "pit_test_evict", run_pit_test_evict)) {
+    CU_cleanup_registry();
+    // return CU_get_error();
+    return;
+  }
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2020 Hanwen Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef PIT_TESTS_H
+#define PIT_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// add PIT test suite to CUnit registry
+void add_pit_test_suite(void);
+
+#endif // PIT_TESTS_H
@@ -20,6 +20,7 @@
 #include "ndn-lite/util/memory-pool.h"
 #include "ndn-lite/util/msg-queue.h"
 #include "ndn-lite/forwarder/name-tree.h"
+#include "ndn-lite/encode/tlv.h"
 #include "ndn-lite/ndn-constants.h"
 #include <string.h>
 
@@ -251,7 +252,7 @@ bool _run_nametree_test(){
   ndn_nametree_init(nametree, 10);
   for(i = 0; i < 10 - 4; i ++){
     name20[4] = i;
-    ptr1 = ndn_nametree_find_or_insert(nametree, name20, strlen((char*)name20));
+    ptr1 = ndn_nametree_find_or_insert(nametree, name20, sizeof(name20) - 1);
     ptr1->fib_id = 0;
   }
   uint8_t name21[] = "\x07\x10\x08\x03ndn\x08\x09name-tree";
@@ -266,6 +267,7 @@ bool _run_nametree_test(){
   ptr1 = ndn_nametree_find_or_insert(nametree, name21, strlen((char*)name21));
   CU_ASSERT_PTR_NOT_NULL(ptr1);
   ptr1->fib_id = NDN_INVALID_ID;
+  ndn_nametree_release(nametree, ptr1);
 
   ptr1 = ndn_nametree_find_or_insert(nametree, name22, strlen((char*)name22));
   CU_ASSERT_PTR_NOT_NULL(ptr1);
@@ -273,6 +275,244 @@ bool _run_nametree_test(){
   return true;
 }
 
+bool _run_nametree_fanout_test(){
+  static uint8_t nametree_buf[NDN_NAMETREE_RESERVE_SIZE(300)];
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_buf;
+  uint8_t name[] = {0x07, 0x07, 0x08, 0x01, 'f', 0x08, 0x02, 0x00, 0x00};
+  nametree_entry_t *parent, *ptr;
+  int i, seq;
+
+  ndn_nametree_init(nametree, 300);
+  parent = ndn_nametree_find_or_insert(nametree, name, 5);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(parent);
+
+  // Children are inserted out of order, and the parent is promoted as they grow
+  for(i = 0; i < 200; i ++){
+    seq = (i * 37) % 200;
+    name[7] = seq >> 8;
+    name[8] = seq;
+    ptr = ndn_nametree_find_or_insert(nametree, name, sizeof(name));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(ptr);
+    if(i + 1 == NDN_NAMETREE_LIST_MAX){
+      CU_ASSERT_EQUAL(parent->child_kind, NDN_NAMETREE_CHILD_LIST);
+    }
+    else if(i + 1 == NDN_NAMETREE_ARRAY_MAX){
+      CU_ASSERT_EQUAL(parent->child_kind, NDN_NAMETREE_CHILD_ARRAY);
+    }
+  }
+  CU_ASSERT_EQUAL(parent->child_kind, NDN_NAMETREE_CHILD_HASH);
+  CU_ASSERT_EQUAL(parent->child_count, 200);
+  for(seq = 0; seq < 200; seq ++){
+    name[7] = seq >> 8;
+    name[8] = seq;
+    ptr = ndn_nametree_find(nametree, name, sizeof(name));
+    CU_ASSERT_PTR_NOT_NULL(ptr);
+    CU_ASSERT_EQUAL(ptr, ndn_nametree_find_or_insert(nametree, name, sizeof(name)));
+  }
+
+  // Releasing unreferenced children demotes the parent at half the limit
+  parent->fib_id = 0;
+  for(seq = 0; seq < 200; seq ++){
+    if(seq % 50 == 0){
+      continue;
+    }
+    name[7] = seq >> 8;
+    name[8] = seq;
+    ndn_nametree_release(nametree, ndn_nametree_find(nametree, name, sizeof(name)));
+    if(parent->child_count == NDN_NAMETREE_ARRAY_MAX / 2){
+      CU_ASSERT_EQUAL(parent->child_kind, NDN_NAMETREE_CHILD_ARRAY);
+    }
+  }
+  CU_ASSERT_EQUAL(parent->child_kind, NDN_NAMETREE_CHILD_LIST);
+  CU_ASSERT_EQUAL(parent->child_count, 4);
+  for(seq = 0; seq < 200; seq ++){
+    name[7] = seq >> 8;
+    name[8] = seq;
+    ptr = ndn_nametree_find(nametree, name, sizeof(name));
+    if(seq % 50 == 0){
+      CU_ASSERT_PTR_NOT_NULL(ptr);
+    }
+    else{
+      CU_ASSERT_PTR_NULL(ptr);
+    }
+  }
+
+  // Releasing the last reference frees the parent, and all nodes are free again
+  for(seq = 0; seq < 200; seq += 50){
+    name[7] = seq >> 8;
+    name[8] = seq;
+    ndn_nametree_release(nametree, ndn_nametree_find(nametree, name, sizeof(name)));
+  }
+  CU_ASSERT_PTR_NOT_NULL(ndn_nametree_find(nametree, name, 5));
+  parent->fib_id = NDN_INVALID_ID;
+  ndn_nametree_release(nametree, parent);
+  CU_ASSERT_PTR_NULL(ndn_nametree_find(nametree, name, 5));
+  name[4] = 'g';
+  for(i = 0; i < 300 - 2; i ++){
+    name[7] = i >> 8;
+    name[8] = i;
+    CU_ASSERT_PTR_NOT_NULL(ndn_nametree_find_or_insert(nametree, name, sizeof(name)));
+  }
+  name[7] = i >> 8;
+  name[8] = i;
+  CU_ASSERT_PTR_NULL(ndn_nametree_find_or_insert(nametree, name, sizeof(name)));
+  return true;
+}
+
+bool _run_nametree_component_test(){
+  static uint8_t nametree_buf[NDN_NAMETREE_RESERVE_SIZE(16)];
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_buf;
+  uint8_t name1[2 + 2 + 40], name2[2 + 2 + 40];
+  uint8_t name3[] = "\x07\x07\x08\x01p\x08\x02xy";
+  uint8_t name4[] = "\x07\x07\x08\x01q\x08\x02xy";
+  uint8_t name5[4 + 1000];
+  nametree_entry_t *ptr1, *ptr2, *ptr3, *ptr4;
+  const uint8_t *comp1, *comp2;
+  size_t len1, len2;
+  int i;
+
+  ndn_nametree_init(nametree, 16);
+
+  // Components longer than the old 36-byte buffer which differ in the last byte
+  name1[0] = name2[0] = TLV_Name;
+  name1[1] = name2[1] = 42;
+  name1[2] = name2[2] = TLV_GenericNameComponent;
+  name1[3] = name2[3] = 40;
+  memset(&name1[4], 'x', 40);
+  memset(&name2[4], 'x', 40);
+  name2[43] = 'y';
+  ptr1 = ndn_nametree_find_or_insert(nametree, name1, sizeof(name1));
+  ptr2 = ndn_nametree_find_or_insert(nametree, name2, sizeof(name2));
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ptr1);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ptr2);
+  CU_ASSERT_PTR_NOT_EQUAL(ptr1, ptr2);
+  CU_ASSERT_PTR_EQUAL(ndn_nametree_find(nametree, name1, sizeof(name1)), ptr1);
+  comp1 = ndn_nametree_component(nametree, ptr1, &len1);
+  CU_ASSERT_EQUAL(len1, 42);
+  CU_ASSERT_EQUAL(memcmp(comp1, &name1[2], 42), 0);
+
+  // Equal components under different parents are stored once
+  ptr3 = ndn_nametree_find_or_insert(nametree, name3, sizeof(name3) - 1);
+  ptr4 = ndn_nametree_find_or_insert(nametree, name4, sizeof(name4) - 1);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ptr3);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(ptr4);
+  CU_ASSERT_PTR_NOT_EQUAL(ptr3, ptr4);
+  CU_ASSERT_EQUAL(ptr3->comp, ptr4->comp);
+  comp1 = ndn_nametree_component(nametree, ptr3, &len1);
+  comp2 = ndn_nametree_component(nametree, ptr4, &len2);
+  CU_ASSERT_PTR_EQUAL(comp1, comp2);
+  CU_ASSERT_EQUAL(len1, 4);
+
+  // Truncated names are rejected instead of being read past their end
+  CU_ASSERT_PTR_NULL(ndn_nametree_find_or_insert(nametree, name3, sizeof(name3) - 2));
+  ndn_nametree_release(nametree, ptr1);
+  ndn_nametree_release(nametree, ptr2);
+  ndn_nametree_release(nametree, ptr3);
+  ndn_nametree_release(nametree, ptr4);
+
+  // Freed components are reused, and too long ones are rejected
+  name5[0] = TLV_Name;
+  name5[1] = 253;
+  name5[2] = (1000 + 2) >> 8;
+  name5[3] = (1000 + 2) & 0xFF;
+  name5[4] = TLV_GenericNameComponent;
+  name5[5] = 100;
+  memset(&name5[6], 'z', sizeof(name5) - 6);
+  for(i = 0; i < 100; i ++){
+    name5[6] = i;
+    ptr1 = ndn_nametree_find_or_insert(nametree, name5, 4 + 2 + 100);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(ptr1);
+    ndn_nametree_release(nametree, ptr1);
+  }
+  name5[5] = 253;
+  name5[6] = (1000 - 4) >> 8;
+  name5[7] = (1000 - 4) & 0xFF;
+  CU_ASSERT_PTR_NULL(ndn_nametree_find_or_insert(nametree, name5, sizeof(name5)));
+  return true;
+}
+
+bool _run_nametree_arena_churn_test(){
+  static uint8_t nametree_buf[NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE)];
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_buf;
+  nametree_entry_t *entries[NDN_NAMETREE_MAX_SIZE];
+  uint8_t long_name[2 + 2 + 40];
+  uint8_t short_name[] = "\x07\x06\x08\x04" "abcd";
+  int i, count, round;
+
+  ndn_nametree_init(nametree, NDN_NAMETREE_MAX_SIZE);
+  long_name[0] = TLV_Name;
+  long_name[1] = 42;
+  long_name[2] = TLV_GenericNameComponent;
+  long_name[3] = 40;
+  memset(&long_name[4], 'x', 40);
+
+  for(round = 0; round < 3; round ++){
+    // Fill the arena with large components
+    for(count = 0; count < NDN_NAMETREE_MAX_SIZE; count ++){
+      long_name[4] = count;
+      entries[count] = ndn_nametree_find_or_insert(nametree, long_name, sizeof(long_name));
+      if(entries[count] == NULL){
+        break;
+      }
+      entries[count]->fib_id = 0;
+    }
+    CU_ASSERT(count > 20);
+    for(i = 0; i < count; i ++){
+      entries[i]->fib_id = NDN_INVALID_ID;
+      ndn_nametree_release(nametree, entries[i]);
+    }
+
+    // Their space is split for small components
+    for(i = 0; i < 20; i ++){
+      short_name[4] = 'a' + i;
+      entries[i] = ndn_nametree_find_or_insert(nametree, short_name, sizeof(short_name) - 1);
+      CU_ASSERT_PTR_NOT_NULL_FATAL(entries[i]);
+      entries[i]->fib_id = 0;
+    }
+    // Releasing every other one leaves holes
+    for(i = 0; i < 20; i += 2){
+      entries[i]->fib_id = NDN_INVALID_ID;
+      ndn_nametree_release(nametree, entries[i]);
+    }
+    for(i = 1; i < 20; i += 2){
+      entries[i]->fib_id = NDN_INVALID_ID;
+      ndn_nametree_release(nametree, entries[i]);
+    }
+    // And merged back for large ones in the next round
+  }
+  return true;
+}
+
+bool _run_nametree_digest_test(){
+  static uint8_t nametree_buf[NDN_NAMETREE_RESERVE_SIZE(NDN_NAMETREE_MAX_SIZE)];
+  ndn_nametree_t *nametree = (ndn_nametree_t*)nametree_buf;
+  uint8_t name[2 + 2 + 32];
+  int i;
+
+  ndn_nametree_init(nametree, NDN_NAMETREE_MAX_SIZE);
+  name[0] = TLV_Name;
+  name[1] = 34;
+  name[2] = TLV_ImplicitSha256DigestComponent;
+  name[3] = 32;
+  memset(&name[4], 0xd1, 32);
+
+  // Every node but the root holds a distinct digest, so the nodes run out before the arena
+  for(i = 0; i < NDN_NAMETREE_MAX_SIZE - 1; i ++){
+    name[4] = i;
+    name[5] = i >> 8;
+    CU_ASSERT_PTR_NOT_NULL(ndn_nametree_find_or_insert(nametree, name, sizeof(name)));
+  }
+  name[4] = i;
+  name[5] = i >> 8;
+  CU_ASSERT_PTR_NULL(ndn_nametree_find_or_insert(nametree, name, sizeof(name)));
+  for(i = 0; i < NDN_NAMETREE_MAX_SIZE - 1; i ++){
+    name[4] = i;
+    name[5] = i >> 8;
+    CU_ASSERT_PTR_NOT_NULL(ndn_nametree_find(nametree, name, sizeof(name)));
+  }
+  return true;
+}
+
 void _run_util_test(util_test_t *test) {
   
   _current_test_name = test->test_names[test->test_name_index];
@@ -281,6 +521,10 @@ void _run_util_test(util_test_t *test) {
   _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_memory_pool_test());
   _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_msg_queue_test());
   _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_nametree_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_nametree_fanout_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_nametree_component_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_nametree_arena_churn_test());
+  _all_function_calls_succeeded = (_all_function_calls_succeeded && _run_nametree_digest_test());
 
   if (_all_function_calls_succeeded)
   {
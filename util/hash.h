@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2018-2020
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * See AUTHORS.md for complete list of NDN-LITE authors and contributors.
+ */
+
+#ifndef UTIL_HASH_H_
+#define UTIL_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup NDNUtil
+ */
+
+/** @defgroup NDNUtilHash Hash Function
+ * @ingroup NDNUtil
+ *
+ * Non-cryptographic hash (32-bit FNV-1a) used by forwarder tables.
+ * The hash is incremental: hashing A then B gives the same value as hashing AB,
+ * so the hash of every name prefix can be computed in one pass.
+ * @{
+ */
+
+/** The initial value of a hash.
+ */
+#define NDN_HASH_INIT 2166136261u
+
+/** Continue a hash with more bytes.
+ * @param[in] hash The current hash value. #NDN_HASH_INIT for a new hash.
+ * @param[in] buf The bytes to add.
+ * @param[in] len The length of @c buf.
+ * @return The updated hash value.
+ */
+static inline uint32_t
+ndn_hash_update(uint32_t hash, const uint8_t* buf, size_t len)
+{
+  while(len --){
+    hash ^= *buf ++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/** Hash a byte string.
+ * @param[in] buf The bytes to hash.
+ * @param[in] len The length of @c buf.
+ * @return The hash value.
+ */
+static inline uint32_t
+ndn_hash(const uint8_t* buf, size_t len)
+{
+  return ndn_hash_update(NDN_HASH_INIT, buf, len);
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_HASH_H_